@@ -0,0 +1,24 @@
+#pragma once
+
+/*Every benchmark is a free function that prints its own results. They run headless (no window or GL context)
+so they can be compared across machines, and all paths are relative to the project directory like the demos.*/
+
+void meshCacheBenchmark();
+void meshOptimizerBenchmark();
+void objParserBenchmark();
+void meshletBenchmark();
+void lodBenchmark();
+void textureBenchmark();
+void mipBenchmark();
+void tangentBenchmark();
+void noiseBenchmark();
+void terrainLodBenchmark();
+void terrainMeshBenchmark();
+void terrainFileBenchmark();
+void heightfieldBenchmark();
+void erosionBenchmark();
+void rayTracerBenchmark();
+void bvhBenchmark();
+void pathTracerBenchmark();
+void raySuiteBenchmark();
+void wavefrontBenchmark();
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm\gtc\type_ptr.hpp>
+#include "Bvh.h"
+#include "MeshCache.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const char * models[] = {
+	"../../Models/Bear/bear-obj.obj",
+	"../../Models/Dog/dog.obj",
+	"../../Models/Gears/Gear.obj",
+};
+
+static const size_t RAY_COUNT = 1 << 16;
+static const size_t CHECK_COUNT = 1024; // rays also tested against every triangle
+
+// rays from points around the model at twice its radius towards points inside its bounding sphere, most of them
+// hitting it the way camera rays would
+static void makeRays(const glm::vec3 & center, float radius, vector<BvhRay> & rays)
+{
+	std::mt19937 random(7);
+	std::normal_distribution<float> gaussian;
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto onSphere = [&]() {
+		glm::vec3 point(gaussian(random), gaussian(random), gaussian(random));
+		return glm::normalize(point);
+	};
+
+	rays.resize(RAY_COUNT);
+	for (auto & ray : rays)
+	{
+		ray.origin = center + onSphere() * radius * 2.0f;
+		glm::vec3 target = center + onSphere() * radius * std::cbrt(unit(random));
+		ray.direction = target - ray.origin;
+	}
+}
+
+// every triangle against the ray, what the compute shader demo does with its spheres
+static bool bruteForce(const Bvh & bvh, const BvhRay & ray, BvhHit & hit)
+{
+	hit.hit = false;
+	float nearest = ray.maxDistance;
+	for (const auto & triangle : bvh.triangles())
+	{
+		glm::vec3 p = glm::cross(ray.direction, triangle.edge2);
+		float determinant = glm::dot(triangle.edge1, p);
+		if (std::fabs(determinant) < 1e-12f) continue;
+		glm::vec3 s = ray.origin - triangle.vertex;
+		float u = glm::dot(s, p) / determinant;
+		glm::vec3 q = glm::cross(s, triangle.edge1);
+		float v = glm::dot(ray.direction, q) / determinant;
+		float distance = glm::dot(triangle.edge2, q) / determinant;
+		if (u < 0.0f || v < 0.0f || u + v > 1.0f || distance <= ray.minDistance || distance >= nearest) continue;
+		nearest = distance;
+		hit.hit = true;
+		hit.distance = distance;
+		hit.triangle = triangle.index;
+	}
+	return hit.hit;
+}
+
+void bvhBenchmark()
+{
+	ThreadPool pool;
+
+	std::cout << std::left << std::setw(34) << "model"
+		<< std::right << std::setw(9) << "tris"
+		<< std::setw(12) << "1 thread ms"
+		<< std::setw(9) << "pool ms"
+		<< std::setw(6) << "same"
+		<< std::setw(9) << "nodes"
+		<< std::setw(8) << "wide"
+		<< std::setw(8) << "leaves"
+		<< std::setw(7) << "depth"
+		<< std::setw(8) << "SAH" << std::endl;
+
+	struct Traversal
+	{
+		const char * model;
+		const char * layout;
+		BvhStats stats;
+		double singleTime = 0.0, poolTime = 0.0;
+		size_t mismatches = 0;
+	};
+	vector<Traversal> traversals;
+
+	for (auto model : models)
+	{
+		MeshCache cache;
+		if (!loadMeshCache(model, cache, &pool)) {
+			std::cout << model << ": failed to load" << std::endl;
+			continue;
+		}
+
+		// every submesh into one index array over the shared vertex block
+		auto positions = reinterpret_cast<const float*>(static_cast<const char*>(cache.vertexData()) + cache.positionOffset());
+		vector<uint32_t> indices;
+		for (uint32_t i = 0; i < cache.header->submeshCount; i++)
+		{
+			const MeshCacheSubmesh & submesh = cache.submeshes[i];
+			for (uint32_t x = 0; x < submesh.indexCount; x++)
+			{
+				uint32_t index = cache.indexSize() == sizeof(uint16_t)
+					? static_cast<const uint16_t*>(cache.indexData())[submesh.indexOffset + x]
+					: static_cast<const uint32_t*>(cache.indexData())[submesh.indexOffset + x];
+				indices.push_back(index + submesh.vertexOffset);
+			}
+		}
+
+		Bvh single, threaded;
+		Timer singleTimer;
+		single.build(positions, sizeof(float) * 3, indices.data(), indices.size());
+		double singleBuild = singleTimer.elapsedMilliseconds();
+		Timer threadedTimer;
+		threaded.build(positions, sizeof(float) * 3, indices.data(), indices.size(), BvhOptions(), &pool);
+		double threadedBuild = threadedTimer.elapsedMilliseconds();
+
+		// the jobs make the same splits as one thread, only in another order
+		bool same = single.nodes().size() == threaded.nodes().size()
+			&& std::memcmp(single.nodes().data(), threaded.nodes().data(), single.nodes().size() * sizeof(BvhNode)) == 0
+			&& std::memcmp(single.triangles().data(), threaded.triangles().data(), single.triangles().size() * sizeof(BvhTriangle)) == 0;
+
+		std::cout << std::left << std::setw(34) << model
+			<< std::right << std::setw(9) << indices.size() / 3
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(12) << singleBuild
+			<< std::setw(9) << threadedBuild
+			<< std::setw(6) << (same ? "yes" : "NO")
+			<< std::setw(9) << threaded.nodes().size()
+			<< std::setw(8) << threaded.wideNodes().size()
+			<< std::setw(8) << threaded.leafCount()
+			<< std::setw(7) << threaded.depth()
+			<< std::setprecision(1) << std::setw(8) << threaded.sahCost() << std::endl;
+
+		glm::vec3 low = glm::make_vec3(cache.header->boundsMin);
+		glm::vec3 high = glm::make_vec3(cache.header->boundsMax);
+		vector<BvhRay> rays;
+		makeRays((low + high) * 0.5f, glm::length(high - low) * 0.5f, rays);
+
+		vector<BvhHit> reference(CHECK_COUNT);
+		for (size_t i = 0; i < CHECK_COUNT; i++) bruteForce(threaded, rays[i], reference[i]);
+
+		for (int wide = 0; wide < 2; wide++)
+		{
+			Traversal traversal;
+			traversal.model = model;
+			traversal.layout = wide ? "wide" : "binary";
+			vector<BvhHit> hits(RAY_COUNT);
+
+			Timer traversalTimer;
+			threaded.intersect(rays.data(), hits.data(), RAY_COUNT, nullptr, &traversal.stats, wide != 0);
+			traversal.singleTime = traversalTimer.elapsedMilliseconds();
+
+			Timer poolTimer;
+			threaded.intersect(rays.data(), hits.data(), RAY_COUNT, &pool, nullptr, wide != 0);
+			traversal.poolTime = poolTimer.elapsedMilliseconds();
+
+			// a hit on the shared edge of two triangles may land on either, the distance has to agree
+			traversal.mismatches = 0;
+			for (size_t i = 0; i < CHECK_COUNT; i++)
+			{
+				if (hits[i].hit != reference[i].hit
+					|| (hits[i].hit && std::abs(hits[i].distance - reference[i].distance) > 1e-4f * reference[i].distance))
+					traversal.mismatches++;
+			}
+			traversals.push_back(traversal);
+		}
+	}
+
+	std::cout << std::endl << std::left << std::setw(34) << "model"
+		<< std::setw(8) << "layout"
+		<< std::right << std::setw(7) << "hits"
+		<< std::setw(9) << "nodes"
+		<< std::setw(9) << "boxes"
+		<< std::setw(9) << "tris"
+		<< std::setw(11) << "1 thr Mr/s"
+		<< std::setw(11) << "pool Mr/s"
+		<< std::setw(10) << "mismatch" << std::endl;
+
+	auto rate = [](double milliseconds) { return RAY_COUNT / (milliseconds / 1000.0) / 1e6; };
+	for (const auto & traversal : traversals)
+	{
+		double rays = static_cast<double>(traversal.stats.rays);
+		std::cout << std::left << std::setw(34) << traversal.model
+			<< std::setw(8) << traversal.layout
+			<< std::right << std::fixed << std::setprecision(1)
+			<< std::setw(6) << 100.0 * traversal.stats.hits / rays << "%"
+			<< std::setw(9) << traversal.stats.nodes / rays
+			<< std::setw(9) << traversal.stats.boxes / rays
+			<< std::setw(9) << traversal.stats.triangles / rays
+			<< std::setprecision(2)
+			<< std::setw(11) << rate(traversal.singleTime)
+			<< std::setw(11) << rate(traversal.poolTime)
+			<< std::setw(10) << traversal.mismatches << std::endl;
+	}
+
+	std::cout << "Builds are binned SAH (16 bins, leaves of at most 4), on one thread and over " << pool.size() + 1
+		<< " threads; same compares their node and triangle arrays. nodes is the depth first binary node count, wide "
+		<< "the four wide one, SAH the expected triangle tests per ray through the root box. Below, " << RAY_COUNT
+		<< " nearest hit rays per model aimed into its bounding sphere: nodes visited, box and triangle tests per ray, "
+		<< "and mismatch counts the first " << CHECK_COUNT << " rays whose hit differs from testing every triangle"
+		<< std::endl;
+}
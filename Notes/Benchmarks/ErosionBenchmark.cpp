@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Erosion.h"
+#include "Noise.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const uint32_t sizes[] = { 1024, 2048 };
+
+static const float HEIGHT_SCALE = 120.0f;
+static const uint32_t ITERATIONS = 16;
+static const uint32_t FULL_ITERATIONS = 400; // what a baked terrain gets
+
+void erosionBenchmark()
+{
+	// 1, 2, 4 ... threads up to every hardware thread, the caller of parallelFor counting as one
+	unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+	vector<unsigned> threadCounts;
+	for (unsigned threads = 1; threads < hardware; threads *= 2) threadCounts.push_back(threads);
+	threadCounts.push_back(hardware);
+
+	std::cout << std::left << std::setw(7) << "size"
+		<< std::right << std::setw(9) << "threads"
+		<< std::setw(10) << "iter/s"
+		<< std::setw(12) << "Mcells/s"
+		<< std::setw(10) << "speedup"
+		<< std::setw(12) << "efficiency"
+		<< std::setw(11) << "same bits"
+		<< std::setw(11) << "full s" << std::endl;
+
+	for (auto size : sizes)
+	{
+		vector<float> heights(size_t(size) * size);
+		{
+			ThreadPool pool;
+			NoiseOptions noise;
+			noise.octaves = 6;
+			noise.frequency = 1.0f / 256.0f;
+			generateNoise(heights.data(), size, size, size, 0.0f, 0.0f, 1.0f, 1.0f, noise, &pool);
+			for (auto & height : heights) height *= HEIGHT_SCALE;
+		}
+
+		vector<float> reference(heights.size()), eroded(heights.size());
+		double singleRate = 0.0;
+		for (auto threads : threadCounts)
+		{
+			std::unique_ptr<ThreadPool> pool;
+			if (threads > 1) pool.reset(new ThreadPool(threads - 1));
+
+			// the first iterations fill the fields and the caches, they are not timed
+			TerrainErosion erosion(heights.data(), size, size, 1.0f);
+			erosion.run(2, pool.get());
+			Timer timer;
+			erosion.run(ITERATIONS, pool.get());
+			double seconds = timer.elapsedMilliseconds() / 1000.0;
+
+			double rate = ITERATIONS / seconds;
+			if (threads == 1) singleRate = rate;
+
+			// every thread count has to land on the bits one thread gives
+			erosion.readHeights(threads == 1 ? reference.data() : eroded.data(), size);
+			bool same = threads == 1 || std::memcmp(reference.data(), eroded.data(), reference.size() * sizeof(float)) == 0;
+
+			std::cout << std::left << std::setw(7) << size
+				<< std::right << std::setw(9) << threads
+				<< std::fixed << std::setprecision(1)
+				<< std::setw(10) << rate
+				<< std::setw(12) << rate * size * size / 1e6
+				<< std::setw(9) << rate / singleRate << "x"
+				<< std::setw(11) << 100.0 * rate / singleRate / threads << "%"
+				<< std::setw(11) << (same ? "yes" : "NO")
+				<< std::setw(11) << FULL_ITERATIONS / rate << std::endl;
+		}
+	}
+
+	std::cout << "An iteration is the hydraulic passes (flux, sediment transport, water and erosion) and the two thermal "
+		<< "ones, " << ITERATIONS << " timed after 2 untimed. full s is the time " << FULL_ITERATIONS << " iterations "
+		<< "would take, roughly what a baked terrain gets. same bits compares the heights with the single thread run"
+		<< std::endl;
+}
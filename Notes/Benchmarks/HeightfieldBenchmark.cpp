@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Heightfield.h"
+#include "Noise.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const uint32_t sizes[] = { 1025, 4097 };
+
+static const float HEIGHT_SCALE = 120.0f;
+static const size_t RAY_COUNT = 16384;
+static const size_t SAMPLE_COUNT = 1 << 20;
+
+// what the demos would cast: mouse picks from a camera above the terrain, and line of sight between points standing
+// on it, which graze the surface all the way and are the worst case for the hierarchy
+static void makeRays(const Heightfield & field, bool grazing, vector<HeightfieldRay> & rays)
+{
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	glm::vec2 extent = field.extent();
+	rays.resize(RAY_COUNT);
+
+	for (auto & ray : rays)
+	{
+		glm::vec3 from, to;
+		if (grazing)
+		{
+			from.x = unit(random) * extent.x, from.z = unit(random) * extent.y;
+			to.x = unit(random) * extent.x, to.z = unit(random) * extent.y;
+			from.y = field.height(from.x, from.z) + 2.0f;
+			to.y = field.height(to.x, to.z) + 2.0f;
+		}
+		else
+		{
+			from = glm::vec3(extent.x * 0.5f, field.maxHeight() + 30.0f, extent.y * 0.5f);
+			to = glm::vec3(unit(random) * extent.x, field.minHeight(), unit(random) * extent.y);
+		}
+		ray.origin = from;
+		ray.direction = to - from;
+		ray.maxDistance = glm::length(ray.direction) * (grazing ? 1.0f : 2.0f);
+	}
+}
+
+void heightfieldBenchmark()
+{
+	ThreadPool pool;
+
+	std::cout << std::left << std::setw(7) << "size"
+		<< std::setw(9) << "rays"
+		<< std::right << std::setw(10) << "build ms"
+		<< std::setw(8) << "hits"
+		<< std::setw(12) << "dda cells"
+		<< std::setw(12) << "mip cells"
+		<< std::setw(10) << "dda Mr/s"
+		<< std::setw(10) << "mip Mr/s"
+		<< std::setw(10) << "pool Mr/s"
+		<< std::setw(10) << "speedup"
+		<< std::setw(11) << "mismatch"
+		<< std::setw(11) << "max diff" << std::endl;
+
+	for (auto size : sizes)
+	{
+		vector<float> heights(size_t(size) * size);
+		NoiseOptions noise;
+		noise.octaves = 6;
+		noise.frequency = 1.0f / 256.0f;
+		generateNoise(heights.data(), size, size, size, 0.0f, 0.0f, 1.0f, 1.0f, noise, &pool);
+		for (auto & height : heights) height *= HEIGHT_SCALE;
+
+		Timer buildTimer;
+		Heightfield field(heights.data(), size, size, 1.0f, &pool);
+		double buildTime = buildTimer.elapsedMilliseconds();
+
+		for (int grazing = 0; grazing < 2; grazing++)
+		{
+			vector<HeightfieldRay> rays;
+			makeRays(field, grazing != 0, rays);
+			vector<HeightfieldHit> brute(RAY_COUNT), single(RAY_COUNT), threaded(RAY_COUNT);
+
+			HeightfieldStats bruteStats, mipStats;
+			Timer bruteTimer;
+			field.raycast(rays.data(), brute.data(), RAY_COUNT, nullptr, &bruteStats, false);
+			double bruteTime = bruteTimer.elapsedMilliseconds();
+
+			Timer singleTimer;
+			field.raycast(rays.data(), single.data(), RAY_COUNT, nullptr, &mipStats);
+			double singleTime = singleTimer.elapsedMilliseconds();
+
+			Timer threadedTimer;
+			field.raycast(rays.data(), threaded.data(), RAY_COUNT, &pool);
+			double threadedTime = threadedTimer.elapsedMilliseconds();
+
+			// both walks test the same patches with the same arithmetic, they should only differ on a seam the floats
+			// put on the other side
+			size_t mismatches = 0;
+			float difference = 0.0f;
+			for (size_t i = 0; i < RAY_COUNT; i++)
+			{
+				if (brute[i].hit != single[i].hit || single[i].hit != threaded[i].hit) mismatches++;
+				else if (brute[i].hit) difference = std::max(difference, std::abs(brute[i].distance - single[i].distance));
+			}
+
+			auto rate = [](double milliseconds) { return RAY_COUNT / (milliseconds / 1000.0) / 1e6; };
+			std::cout << std::left << std::setw(7) << size << std::setw(9) << (grazing ? "grazing" : "picking")
+				<< std::right << std::fixed << std::setprecision(1)
+				<< std::setw(10) << buildTime
+				<< std::setw(7) << 100.0 * mipStats.hits / RAY_COUNT << "%"
+				<< std::setw(12) << double(bruteStats.cells) / RAY_COUNT
+				<< std::setw(12) << double(mipStats.cells) / RAY_COUNT
+				<< std::setprecision(2)
+				<< std::setw(10) << rate(bruteTime)
+				<< std::setw(10) << rate(singleTime)
+				<< std::setw(10) << rate(threadedTime)
+				<< std::setprecision(1)
+				<< std::setw(9) << bruteTime / singleTime << "x"
+				<< std::setw(11) << mismatches
+				<< std::setw(11) << std::setprecision(5) << difference << std::endl;
+		}
+
+		// point queries, the other thing gameplay asks the terrain
+		std::mt19937 random(5);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		glm::vec2 extent = field.extent();
+		vector<glm::vec2> points(SAMPLE_COUNT);
+		for (auto & point : points) point = glm::vec2(unit(random) * extent.x, unit(random) * extent.y);
+
+		float sum = 0.0f;
+		Timer heightTimer;
+		for (const auto & point : points) sum += field.height(point.x, point.y);
+		double heightTime = heightTimer.elapsedMilliseconds();
+
+		Timer normalTimer;
+		for (const auto & point : points) sum += field.normal(point.x, point.y).y;
+		double normalTime = normalTimer.elapsedMilliseconds();
+
+		std::cout << std::left << std::setw(7) << size << std::right << std::fixed << std::setprecision(1)
+			<< "height " << SAMPLE_COUNT / (heightTime / 1000.0) / 1e6 << " M/s, normal "
+			<< SAMPLE_COUNT / (normalTime / 1000.0) / 1e6 << " M/s (checksum " << std::setprecision(0) << sum << ")" << std::endl;
+	}
+
+	std::cout << "dda walks every cell along the ray on one thread, mip the min-max hierarchy on one thread, pool the "
+		<< "hierarchy over " << pool.size() << " threads. cells are hierarchy cells visited per ray, speedup is dda over "
+		<< "mip on one thread and mismatch counts rays whose hit differs between the walks" << std::endl;
+}
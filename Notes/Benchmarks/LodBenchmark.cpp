@@ -0,0 +1,127 @@
+#include <glm\gtx\transform.hpp>
+#include <glm\gtc\random.hpp>
+#include <glm\gtc\type_ptr.hpp>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "LodSelection.h"
+#include "MeshCache.h"
+#include "MeshSimplifier.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const char * models[] = {
+	"../../Models/Bear/bear-obj.obj",
+	"../../Models/Dog/dog.obj",
+	"../../Models/Gears/Gear.obj",
+};
+
+static const unsigned instanceCounts[] = { 1000, 10000, 100000 };
+
+// same sweep as the InstancedRendering demo: the eye flies from the front of the field halfway in
+static const int views = 32;
+
+void lodBenchmark()
+{
+	std::cout << std::left << std::setw(34) << "model"
+		<< std::right << std::setw(7) << "level"
+		<< std::setw(12) << "triangles"
+		<< std::setw(12) << "error"
+		<< std::setw(14) << "simplify ms" << std::endl;
+
+	for (auto model : models)
+	{
+		MeshCache cache;
+		if (!loadMeshCache(model, cache)) {
+			std::cout << model << ": failed to load" << std::endl;
+			continue;
+		}
+
+		// the chain is already in the cache, simplify the full mesh again to time it
+		const MeshCacheSubmesh & submesh = cache.submeshes[0];
+		auto positions = reinterpret_cast<const float*>(static_cast<const char*>(cache.vertexData()) + cache.positionOffset()) + 3 * submesh.vertexOffset;
+		vector<uint32_t> indices(submesh.indexCount);
+		for (uint32_t x = 0; x < submesh.indexCount; x++)
+		{
+			indices[x] = cache.indexSize() == sizeof(uint16_t)
+				? static_cast<const uint16_t*>(cache.indexData())[submesh.indexOffset + x]
+				: static_cast<const uint32_t*>(cache.indexData())[submesh.indexOffset + x];
+		}
+
+		for (uint32_t level = 0; level < submesh.lodCount; level++)
+		{
+			double simplifyTime = 0.0;
+			if (level > 0) {
+				vector<uint32_t> simplified(indices.size());
+				Timer timer;
+				simplified.resize(simplifyMesh(simplified.data(), indices.data(), indices.size(), positions, sizeof(float) * 3,
+					submesh.vertexCount, (indices.size() / 6) * 3, 0.05f));
+				simplifyTime = timer.elapsedMilliseconds();
+				indices.swap(simplified);
+			}
+
+			std::cout << std::left << std::setw(34) << (level == 0 ? model : "") << std::right << std::fixed
+				<< std::setw(7) << level
+				<< std::setw(12) << submesh.lods[level].indexCount / 3
+				<< std::setprecision(4)
+				<< std::setw(12) << submesh.lods[level].error
+				<< std::setprecision(2)
+				<< std::setw(14) << simplifyTime << std::endl;
+		}
+	}
+
+	std::cout << std::endl << std::left << std::setw(34) << "model"
+		<< std::right << std::setw(10) << "instances"
+		<< std::setw(16) << "full tris"
+		<< std::setw(16) << "lod tris"
+		<< std::setw(10) << "ratio"
+		<< std::setw(14) << "select ms" << std::endl;
+
+	for (auto model : models)
+	{
+		MeshCache cache;
+		if (!loadMeshCache(model, cache)) continue;
+
+		const MeshCacheSubmesh & submesh = cache.submeshes[0];
+		glm::vec3 low = glm::make_vec3(cache.header->boundsMin);
+		glm::vec3 high = glm::make_vec3(cache.header->boundsMax);
+		float size = glm::length(high - low);
+		const float fieldOfView = glm::radians(90.0f);
+		float projectionScale = lodProjectionScale(fieldOfView, 720.0f);
+
+		for (auto count : instanceCounts)
+		{
+			// a field that keeps the density constant, spaced by the size of the model
+			float spread = glm::pow(count / 1000.0f, 1.0f / 3.0f) * size;
+			vector<glm::vec3> centers(count);
+			for (auto & center : centers)
+				center = glm::linearRand(glm::vec3(-10.0f, -4.0f, -3.0f), glm::vec3(10.0f, 4.0f, -20.0f)) * spread;
+
+			LodBuckets buckets;
+			uint64_t fullTriangles = 0, lodTriangles = 0;
+			double selectTime = 0.0;
+			for (int view = 0; view < views; view++)
+			{
+				glm::vec3 eye(0.0f, 0.0f, -11.5f * spread * view / views);
+				selectLods(submesh, centers.data(), centers.size(), 1.0f, eye, projectionScale, 1.0f, buckets, false);
+				fullTriangles += buckets.triangles;
+
+				Timer timer;
+				selectLods(submesh, centers.data(), centers.size(), 1.0f, eye, projectionScale, 1.0f, buckets);
+				selectTime += timer.elapsedMilliseconds();
+				lodTriangles += buckets.triangles;
+			}
+
+			std::cout << std::left << std::setw(34) << model << std::right << std::fixed
+				<< std::setw(10) << count
+				<< std::setw(16) << fullTriangles / views
+				<< std::setw(16) << lodTriangles / views
+				<< std::setprecision(1)
+				<< std::setw(9) << 100.0 * lodTriangles / fullTriangles << "%"
+				<< std::setprecision(3)
+				<< std::setw(14) << selectTime / views << std::endl;
+		}
+	}
+}
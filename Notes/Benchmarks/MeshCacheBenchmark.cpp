@@ -0,0 +1,90 @@
+#include <assimp\Importer.hpp>
+#include <assimp\scene.h>
+#include <assimp\postprocess.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "MeshCache.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+// every model under Models/ that has geometry
+static const char * models[] = {
+	"../../Models/Cube/cube.obj",
+	"../../Models/Bear/bear-obj.obj",
+	"../../Models/Dog/dog.obj",
+	"../../Models/Gears/Gear.obj",
+};
+
+static const int runs = 5;
+
+void meshCacheBenchmark()
+{
+	std::cout << std::left << std::setw(34) << "model"
+		<< std::right << std::setw(12) << "assimp ms"
+		<< std::setw(12) << "bake ms"
+		<< std::setw(12) << "cache ms"
+		<< std::setw(12) << "cache KB"
+		<< std::setw(10) << "speedup" << std::endl;
+
+	vector<char> uploadBuffer;
+
+	for (auto model : models)
+	{
+		// Assimp path, exactly what the demos call at startup
+		double assimpBest = 1e30;
+		bool loaded = true;
+		for (int run = 0; run < runs; run++)
+		{
+			Timer timer;
+			Assimp::Importer importer;
+			const aiScene * scene = importer.ReadFile(model, aiProcess_Triangulate);
+			double elapsed = timer.elapsedMilliseconds();
+			if (!scene) {
+				std::cout << model << ": Assimp failed to load" << std::endl;
+				loaded = false;
+				break;
+			}
+			assimpBest = std::min(assimpBest, elapsed);
+		}
+		if (!loaded) continue;
+
+		std::string cachePath = std::string(model) + ".rwmesh";
+		Timer bakeTimer;
+		if (!bakeMeshCache(model, cachePath.c_str())) continue;
+		double bakeTime = bakeTimer.elapsedMilliseconds();
+
+		// cache path: map, validate and copy both blocks out the way glBufferData would
+		double cacheBest = 1e30;
+		size_t cacheSize = 0;
+		for (int run = 0; run < runs; run++)
+		{
+			Timer timer;
+			MeshCache cache;
+			if (!openMeshCache(cachePath.c_str(), model, cache)) {
+				std::cout << model << ": cache failed to open" << std::endl;
+				loaded = false;
+				break;
+			}
+
+			uploadBuffer.resize(cache.vertexBytes() + cache.indexBytes());
+			memcpy(uploadBuffer.data(), cache.vertexData(), cache.vertexBytes());
+			memcpy(uploadBuffer.data() + cache.vertexBytes(), cache.indexData(), cache.indexBytes());
+			cacheBest = std::min(cacheBest, timer.elapsedMilliseconds());
+			cacheSize = cache.file.size();
+		}
+		if (!loaded) continue;
+
+		std::cout << std::left << std::setw(34) << model << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << assimpBest
+			<< std::setw(12) << bakeTime
+			<< std::setw(12) << cacheBest
+			<< std::setw(12) << cacheSize / 1024
+			<< std::setw(9) << std::setprecision(1) << assimpBest / cacheBest << "x" << std::endl;
+	}
+}
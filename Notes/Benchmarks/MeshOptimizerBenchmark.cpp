@@ -0,0 +1,149 @@
+#include <assimp\Importer.hpp>
+#include <assimp\scene.h>
+#include <assimp\postprocess.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "MeshOptimizer.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const char * models[] = {
+	"../../Models/Bear/bear-obj.obj",
+	"../../Models/Dog/dog.obj",
+	"../../Models/Gears/Gear.obj",
+};
+
+// the passes in the order the mesh cache runs them, each one measured on the output of the previous
+enum Stage
+{
+	STAGE_UNINDEXED,
+	STAGE_WELDED,
+	STAGE_VERTEX_CACHE,
+	STAGE_OVERDRAW,
+	STAGE_VERTEX_FETCH,
+	STAGE_COUNT
+};
+
+static const char * stageNames[STAGE_COUNT] = { "unindexed", "welded", "vertex cache", "overdraw", "vertex fetch" };
+
+struct StageTotals
+{
+	uint64_t vertexCount = 0;
+	uint64_t triangleCount = 0;
+	uint64_t transformedVertices = 0;
+	uint64_t indexBytes = 0;
+	double milliseconds = 0.0;
+
+	void add(const VertexCacheStatistics & statistics, size_t indexCount, size_t vertexCount, double elapsed)
+	{
+		this->vertexCount += statistics.vertexCount;
+		triangleCount += statistics.triangleCount;
+		transformedVertices += statistics.transformedVertices;
+		indexBytes += indexCount * (fitsShortIndices(vertexCount) ? sizeof(uint16_t) : sizeof(uint32_t));
+		milliseconds += elapsed;
+	}
+};
+
+void meshOptimizerBenchmark()
+{
+	for (auto model : models)
+	{
+		Assimp::Importer importer;
+		const aiScene * scene = importer.ReadFile(model, aiProcess_Triangulate);
+		if (!scene) {
+			std::cout << model << ": Assimp failed to load" << std::endl;
+			continue;
+		}
+
+		StageTotals totals[STAGE_COUNT];
+
+		for (uint32_t meshIndex = 0; meshIndex < scene->mNumMeshes; meshIndex++)
+		{
+			const aiMesh * mesh = scene->mMeshes[meshIndex];
+			size_t vertexCount = mesh->mNumVertices;
+
+			vector<float> vertices(vertexCount * 8, 0.0f);
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				float * vertex = &vertices[i * 8];
+				vertex[0] = mesh->mVertices[i].x;
+				vertex[1] = mesh->mVertices[i].y;
+				vertex[2] = mesh->mVertices[i].z;
+				if (mesh->HasNormals()) {
+					vertex[3] = mesh->mNormals[i].x;
+					vertex[4] = mesh->mNormals[i].y;
+					vertex[5] = mesh->mNormals[i].z;
+				}
+				if (mesh->HasTextureCoords(0)) {
+					vertex[6] = mesh->mTextureCoords[0][i].x;
+					vertex[7] = mesh->mTextureCoords[0][i].y;
+				}
+			}
+
+			vector<uint32_t> indices;
+			for (uint32_t i = 0; i < mesh->mNumFaces; i++)
+			{
+				if (mesh->mFaces[i].mNumIndices != 3) continue;
+				for (uint32_t x = 0; x < 3; x++) indices.push_back(mesh->mFaces[i].mIndices[x]);
+			}
+
+			// what the demos drew before: glDrawArrays over every face corner, no index buffer at all
+			totals[STAGE_UNINDEXED].add(analyzeVertexCache(indices.data(), indices.size(), vertexCount), 0, vertexCount, 0.0);
+
+			Timer timer;
+			VertexStream stream = { vertices.data(), sizeof(float) * 8 };
+			vector<uint32_t> remap;
+			size_t weldedCount = weldVertices(remap, indices.data(), indices.size(), vertexCount, &stream, 1);
+			vector<float> welded(weldedCount * 8);
+			remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+			remapVertexBuffer(welded.data(), vertices.data(), vertexCount, sizeof(float) * 8, remap.data());
+			double elapsed = timer.elapsedMilliseconds();
+			totals[STAGE_WELDED].add(analyzeVertexCache(indices.data(), indices.size(), weldedCount), indices.size(), weldedCount, elapsed);
+
+			vector<uint32_t> ordered(indices.size());
+			timer.reset();
+			optimizeVertexCache(ordered.data(), indices.data(), indices.size(), weldedCount);
+			elapsed = timer.elapsedMilliseconds();
+			totals[STAGE_VERTEX_CACHE].add(analyzeVertexCache(ordered.data(), ordered.size(), weldedCount), ordered.size(), weldedCount, elapsed);
+
+			timer.reset();
+			optimizeOverdraw(indices.data(), ordered.data(), ordered.size(), welded.data(), sizeof(float) * 8, weldedCount);
+			elapsed = timer.elapsedMilliseconds();
+			totals[STAGE_OVERDRAW].add(analyzeVertexCache(indices.data(), indices.size(), weldedCount), indices.size(), weldedCount, elapsed);
+
+			timer.reset();
+			optimizeVertexFetch(remap, indices.data(), indices.size(), weldedCount);
+			remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+			remapVertexBuffer(vertices.data(), welded.data(), weldedCount, sizeof(float) * 8, remap.data());
+			elapsed = timer.elapsedMilliseconds();
+			totals[STAGE_VERTEX_FETCH].add(analyzeVertexCache(indices.data(), indices.size(), weldedCount), indices.size(), weldedCount, elapsed);
+		}
+
+		std::cout << model << std::endl;
+		std::cout << std::left << std::setw(16) << "  stage"
+			<< std::right << std::setw(10) << "vertices"
+			<< std::setw(11) << "triangles"
+			<< std::setw(8) << "ACMR"
+			<< std::setw(8) << "ATVR"
+			<< std::setw(12) << "index KB"
+			<< std::setw(10) << "ms" << std::endl;
+
+		for (int stage = 0; stage < STAGE_COUNT; stage++)
+		{
+			const StageTotals & total = totals[stage];
+			std::cout << std::left << "  " << std::setw(14) << stageNames[stage] << std::right << std::fixed
+				<< std::setw(10) << total.vertexCount
+				<< std::setw(11) << total.triangleCount
+				<< std::setprecision(3)
+				<< std::setw(8) << (total.triangleCount ? double(total.transformedVertices) / total.triangleCount : 0.0)
+				<< std::setw(8) << (total.vertexCount ? double(total.transformedVertices) / total.vertexCount : 0.0)
+				<< std::setprecision(1)
+				<< std::setw(12) << total.indexBytes / 1024.0
+				<< std::setprecision(3)
+				<< std::setw(10) << total.milliseconds << std::endl;
+		}
+	}
+}
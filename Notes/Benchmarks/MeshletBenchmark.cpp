@@ -0,0 +1,117 @@
+#include <glm\gtx\transform.hpp>
+#include <glm\gtc\type_ptr.hpp>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "MeshCache.h"
+#include "Meshlets.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const char * models[] = {
+	"../../Models/Bear/bear-obj.obj",
+	"../../Models/Dog/dog.obj",
+	"../../Models/Gears/Gear.obj",
+};
+
+// the eye sits in the middle of a gridSize x gridSize field of copies and turns around once over the views
+static const int gridSize = 10;
+static const int views = 16;
+
+void meshletBenchmark()
+{
+	ThreadPool pool;
+
+	std::cout << std::left << std::setw(34) << "model"
+		<< std::right << std::setw(10) << "clusters"
+		<< std::setw(10) << "build ms"
+		<< std::setw(10) << "frustum"
+		<< std::setw(10) << "backface"
+		<< std::setw(12) << "tris culled"
+		<< std::setw(12) << "1 thread ms"
+		<< std::setw(8) << "pool ms" << std::endl;
+
+	for (auto model : models)
+	{
+		MeshCache cache;
+		if (!loadMeshCache(model, cache, &pool)) {
+			std::cout << model << ": failed to load" << std::endl;
+			continue;
+		}
+
+		Timer timer;
+		MeshletMesh meshlets;
+		auto positions = reinterpret_cast<const float*>(static_cast<const char*>(cache.vertexData()) + cache.positionOffset());
+		vector<uint32_t> indices;
+		for (uint32_t i = 0; i < cache.header->submeshCount; i++)
+		{
+			const MeshCacheSubmesh & submesh = cache.submeshes[i];
+			indices.resize(submesh.indexCount);
+			for (uint32_t x = 0; x < submesh.indexCount; x++)
+			{
+				indices[x] = cache.indexSize() == sizeof(uint16_t)
+					? static_cast<const uint16_t*>(cache.indexData())[submesh.indexOffset + x]
+					: static_cast<const uint32_t*>(cache.indexData())[submesh.indexOffset + x];
+			}
+			buildMeshlets(meshlets, indices.data(), indices.size(), positions + 3 * submesh.vertexOffset, sizeof(float) * 3,
+				submesh.vertexCount, submesh.vertexOffset);
+		}
+		double buildTime = timer.elapsedMilliseconds();
+
+		glm::vec3 low = glm::make_vec3(cache.header->boundsMin);
+		glm::vec3 high = glm::make_vec3(cache.header->boundsMax);
+		glm::vec3 extent = high - low;
+		float spacing = glm::max(extent.x, glm::max(extent.y, extent.z)) * 1.5f;
+
+		vector<glm::mat4> instances;
+		for (int z = 0; z < gridSize; z++)
+		{
+			for (int x = 0; x < gridSize; x++)
+			{
+				glm::vec3 position = glm::vec3(x - gridSize / 2 + 0.5f, 0.0f, z - gridSize / 2 + 0.5f) * spacing;
+				instances.push_back(glm::translate(position) * glm::rotate(0.7f * (x + z), glm::vec3(0.3f, 1.0f, 0.2f)) * glm::translate(-(low + high) * 0.5f));
+			}
+		}
+
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, spacing * gridSize * 2.0f);
+		MeshletCuller serialCuller(nullptr);
+		MeshletCuller poolCuller(&pool);
+		vector<DrawElementsIndirectCommand> commands;
+		MeshletCullStatistics total;
+		double serialTime = 0.0, poolTime = 0.0;
+
+		for (int view = 0; view < views; view++)
+		{
+			float angle = 6.2831853f * view / views;
+			glm::vec3 eye(0.0f, spacing * 0.5f, 0.0f);
+			glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + glm::vec3(cos(angle), -0.25f, sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+
+			serialCuller.cull(meshlets, instances.data(), instances.size(), viewProjection, eye, commands);
+			serialTime += serialCuller.statistics().milliseconds;
+			poolCuller.cull(meshlets, instances.data(), instances.size(), viewProjection, eye, commands);
+			poolTime += poolCuller.statistics().milliseconds;
+
+			const MeshletCullStatistics & statistics = poolCuller.statistics();
+			total.clusters += statistics.clusters;
+			total.frustumCulled += statistics.frustumCulled;
+			total.backfaceCulled += statistics.backfaceCulled;
+			total.triangles += statistics.triangles;
+			total.trianglesCulled += statistics.trianglesCulled;
+		}
+
+		std::cout << std::left << std::setw(34) << model << std::right << std::fixed
+			<< std::setw(10) << meshlets.meshlets.size()
+			<< std::setprecision(2)
+			<< std::setw(10) << buildTime
+			<< std::setprecision(1)
+			<< std::setw(9) << 100.0 * total.frustumCulled / total.clusters << "%"
+			<< std::setw(9) << 100.0 * total.backfaceCulled / total.clusters << "%"
+			<< std::setw(11) << 100.0 * total.trianglesCulled / total.triangles << "%"
+			<< std::setprecision(3)
+			<< std::setw(12) << serialTime / views
+			<< std::setw(8) << poolTime / views << std::endl;
+	}
+}
@@ -0,0 +1,122 @@
+#include <SOIL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "MipGenerator.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const char * images[] = {
+	"../../Models/Dog/dogColor.png",
+	"../../Models/Dog/dogNormal.png",
+	"../../Models/Dog/dogSpecular.png",
+	"../../Models/Cube/Outdoors/posx.jpg",
+};
+
+static const int RUNS = 3;
+
+static float toLinear(uint8_t value)
+{
+	float v = value / 255.0f;
+	return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+static float toSrgb(float value)
+{
+	float v = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	return v * 255.0f;
+}
+
+// how far the 1x1 level lands from the true average color of the image, in sRGB codes. Filtering the encoded values
+// shows up here as the whole texture getting darker in the distance.
+static double brightnessDrift(const vector<MipLevel> & levels)
+{
+	const MipLevel & top = levels[0];
+	double sum[3] = {};
+	for (size_t i = 0; i < size_t(top.width) * top.height; i++)
+		for (int c = 0; c < 3; c++) sum[c] += toLinear(top.pixels[i * 4 + c]);
+
+	const uint8_t * last = levels.back().pixels.data();
+	double drift = 0.0;
+	for (int c = 0; c < 3; c++)
+		drift += (last[c] - toSrgb(static_cast<float>(sum[c] / (size_t(top.width) * top.height)))) / 3.0;
+	return drift;
+}
+
+void mipBenchmark()
+{
+	ThreadPool pool;
+
+	std::cout << std::left << std::setw(38) << "image"
+		<< std::setw(16) << "filter"
+		<< std::right << std::setw(8) << "levels"
+		<< std::setw(12) << "1 thread"
+		<< std::setw(10) << "pool"
+		<< std::setw(10) << "speedup"
+		<< std::setw(12) << "Mtexels/s"
+		<< std::setw(8) << "drift" << std::endl;
+
+	for (auto image : images)
+	{
+		int width, height, channels;
+		unsigned char * pixels = SOIL_load_image(image, &width, &height, &channels, SOIL_LOAD_RGBA);
+		if (!pixels) {
+			std::cout << image << ": failed to load" << std::endl;
+			continue;
+		}
+
+		bool normalMap = strstr(image, "Normal") != nullptr;
+		bool first = true;
+
+		// the gamma space box filter is what the driver's glGenerateMipmap does, for comparison
+		for (int variant = -1; variant < MIP_FILTER_COUNT; variant++)
+		{
+			MipChainOptions options;
+			options.filter = variant < 0 ? MIP_FILTER_BOX : static_cast<MipFilter>(variant);
+			options.srgb = variant >= 0;
+			options.normalMap = normalMap;
+			if (normalMap && variant < 0) continue;
+
+			vector<MipLevel> levels;
+			double serialTime = 1e30, poolTime = 1e30;
+			for (int run = 0; run < RUNS; run++)
+			{
+				Timer timer;
+				buildMipChain(levels, pixels, width, height, options);
+				serialTime = std::min(serialTime, timer.elapsedMilliseconds());
+
+				timer.reset();
+				buildMipChain(levels, pixels, width, height, options, &pool);
+				poolTime = std::min(poolTime, timer.elapsedMilliseconds());
+			}
+
+			std::string filterName = mipFilterName(options.filter);
+			if (!normalMap) filterName += options.srgb ? " (linear)" : " (gamma)";
+
+			std::cout << std::left << std::setw(38) << (first ? image : "")
+				<< std::setw(16) << filterName
+				<< std::right << std::fixed << std::setprecision(2)
+				<< std::setw(8) << levels.size()
+				<< std::setw(12) << serialTime
+				<< std::setw(10) << poolTime
+				<< std::setprecision(1)
+				<< std::setw(9) << serialTime / poolTime << "x"
+				<< std::setw(12) << double(width) * height / (poolTime * 1000.0)
+				<< std::setw(8);
+			if (normalMap) std::cout << "-" << std::endl;
+			else std::cout << brightnessDrift(levels) << std::endl;
+			first = false;
+		}
+
+		SOIL_free_image_data(pixels);
+	}
+
+	std::cout << "pool: " << pool.size() << " workers plus the calling thread, Mtexels/s counts the source level only" << std::endl;
+}
@@ -0,0 +1,146 @@
+#include <glm\gtc\noise.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "Noise.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const uint32_t resolutions[] = { 1024, 4096, 16384 };
+
+// a full 16k grid is a gigabyte of floats, past this many samples only a band of rows is generated
+static const size_t MAX_SAMPLES = size_t(4096) * 8192;
+
+// the terrain demos' settings: 6 cells across the grid, scaled by 1 / 1.5 and mapped to 0..255
+static const float FREQUENCY = 6.0f;
+static const float SCALE = 1.5f;
+
+// the heightmap loop from the terrain demos: one glm::perlin per pixel, x outer and y inner
+static void demoLoop(vector<uint8_t> & heightMap, uint32_t width, uint32_t height, uint32_t rows)
+{
+	float xFactor = 1.0f / (width - 1);
+	float yFactor = 1.0f / (height - 1);
+	for (size_t x = 0; x < width; x++)
+	{
+		for (size_t y = 0; y < rows; y++)
+		{
+			glm::vec2 p(x * xFactor * FREQUENCY, y * yFactor * FREQUENCY);
+			float value = glm::perlin(p) / SCALE;
+			float result = (value + 1.0f) / 2.0f;
+			heightMap[x + width * y] = static_cast<uint8_t>(result * 255.0f);
+		}
+	}
+}
+
+static double generate(vector<float> & heights, vector<uint8_t> & heightMap, uint32_t width, uint32_t height, uint32_t rows,
+	const NoiseOptions & options, ThreadPool * pool)
+{
+	Timer timer;
+	generateNoise(heights.data(), width, width, rows, 0.0f, 0.0f, FREQUENCY / (width - 1), FREQUENCY / (height - 1), options, pool);
+	quantizeHeights(heightMap.data(), heights.data(), size_t(width) * rows, 127.5f / SCALE, 127.5f);
+	return timer.elapsedMilliseconds();
+}
+
+void noiseBenchmark()
+{
+	ThreadPool pool;
+	NoiseSimd best = noiseSimdSupported();
+
+	std::cout << std::left << std::setw(8) << "size"
+		<< std::right << std::setw(7) << "rows"
+		<< std::setw(12) << "demo loop"
+		<< std::setw(10) << "scalar"
+		<< std::setw(10) << "sse2"
+		<< std::setw(10) << "avx2"
+		<< std::setw(10) << "pool"
+		<< std::setw(10) << "speedup"
+		<< std::setw(12) << "max diff"
+		<< std::setw(10) << "bytes" << std::endl;
+
+	for (auto resolution : resolutions)
+	{
+		uint32_t width = resolution, height = resolution;
+		uint32_t rows = static_cast<uint32_t>(std::min<size_t>(height, MAX_SAMPLES / width));
+		double pixels = double(width) * rows / 1e6;
+
+		vector<float> heights(size_t(width) * rows);
+		vector<uint8_t> reference(size_t(width) * rows), heightMap(size_t(width) * rows);
+
+		Timer timer;
+		demoLoop(reference, width, height, rows);
+		double demoTime = timer.elapsedMilliseconds();
+
+		NoiseOptions options;
+		options.frequency = 1.0f; // the steps already carry the frequency, like the demo's p
+		double times[3] = {};
+		for (int simd = NOISE_SIMD_SCALAR; simd <= NOISE_SIMD_AVX2; simd++)
+		{
+			if (simd == NOISE_SIMD_AVX2 && best != NOISE_SIMD_AVX2) continue;
+			options.simd = static_cast<NoiseSimd>(simd);
+			times[simd] = generate(heights, heightMap, width, height, rows, options, nullptr);
+		}
+
+		options.simd = NOISE_SIMD_BEST;
+		double poolTime = generate(heights, heightMap, width, height, rows, options, &pool);
+
+		// against glm itself, and how many of the 8 bit heights came out different from the demo's
+		float maxDiff = 0.0f;
+		for (uint32_t y = 0; y < rows; y += 7)
+			for (uint32_t x = 0; x < width; x += 7)
+			{
+				glm::vec2 p(x * (FREQUENCY / (width - 1)), y * (FREQUENCY / (height - 1)));
+				maxDiff = std::max(maxDiff, std::fabs(glm::perlin(p) - heights[size_t(y) * width + x]));
+			}
+		size_t differentBytes = 0;
+		for (size_t i = 0; i < reference.size(); i++) differentBytes += reference[i] != heightMap[i];
+
+		auto rate = [&](double milliseconds) { return milliseconds > 0.0 ? pixels / (milliseconds / 1000.0) : 0.0; };
+		std::cout << std::left << std::setw(8) << resolution << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(7) << rows
+			<< std::setw(12) << rate(demoTime)
+			<< std::setw(10) << rate(times[NOISE_SIMD_SCALAR])
+			<< std::setw(10) << rate(times[NOISE_SIMD_SSE2])
+			<< std::setw(10) << rate(times[NOISE_SIMD_AVX2])
+			<< std::setw(10) << rate(poolTime)
+			<< std::setw(9) << demoTime / poolTime << "x"
+			<< std::scientific << std::setprecision(1)
+			<< std::setw(12) << maxDiff
+			<< std::fixed
+			<< std::setw(10) << differentBytes << std::endl;
+	}
+
+	// the multi octave variants the terrain generators use, all on the pool with the best kernel
+	std::cout << std::endl << std::left << std::setw(24) << "4096 x 4096, 6 octaves"
+		<< std::right << std::setw(12) << "Mpixels/s" << std::endl;
+
+	const uint32_t size = 4096;
+	vector<float> heights(size_t(size) * size);
+	NoiseBasis bases[] = { NOISE_PERLIN, NOISE_SIMPLEX };
+	NoiseFractal fractals[] = { NOISE_FBM, NOISE_RIDGED };
+	for (auto basis : bases)
+		for (auto fractal : fractals)
+		{
+			NoiseOptions options;
+			options.basis = basis;
+			options.fractal = fractal;
+			options.octaves = 6;
+			options.frequency = 8.0f / size;
+
+			Timer timer;
+			generateNoise(heights.data(), size, size, size, 0.0f, 0.0f, 1.0f, 1.0f, options, &pool);
+			double elapsed = timer.elapsedMilliseconds();
+
+			std::string name = std::string(basis == NOISE_PERLIN ? "perlin" : "simplex") + (fractal == NOISE_FBM ? " fbm" : " ridged");
+			std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+				<< std::setw(12) << double(size) * size / 1e6 / (elapsed / 1000.0) << std::endl;
+		}
+
+	std::cout << "Mpixels/s throughout, kernels other than pool on one thread. best kernel: " << noiseSimdName(best)
+		<< ", pool: " << pool.size() << " workers plus the calling thread" << std::endl;
+	std::cout << "max diff is against glm::perlin on every 7th sample, bytes counts 8 bit heights that differ from the demo loop" << std::endl;
+}
@@ -0,0 +1,129 @@
+#include <assimp\Importer.hpp>
+#include <assimp\scene.h>
+#include <assimp\postprocess.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "ObjParser.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+static const char * models[] = {
+	"../../Models/Bear/bear-obj.obj",
+	"../../Models/Dog/dog.obj",
+	"../../Models/Gears/Gear.obj",
+};
+
+static const int runs = 5;
+
+static bool closeEnough(float a, float b)
+{
+	// Assimp's fast_atof is not correctly rounded, allow it the last bit or so
+	return fabsf(a - b) <= 1e-5f * std::max(1.0f, fabsf(a));
+}
+
+// same meshes, same triangles, same attribute values in the same order
+static size_t countMismatches(const aiScene * scene, const ObjModel & model)
+{
+	if (scene->mNumMeshes != model.meshes.size()) {
+		std::cout << "  mesh count differs: assimp " << scene->mNumMeshes << ", parser " << model.meshes.size() << std::endl;
+		return std::max<size_t>(1, scene->mNumMeshes + model.meshes.size());
+	}
+
+	size_t mismatches = 0;
+	for (uint32_t m = 0; m < scene->mNumMeshes; m++)
+	{
+		const aiMesh * expected = scene->mMeshes[m];
+		const ObjMesh & mesh = model.meshes[m];
+
+		size_t triangles = 0;
+		for (uint32_t f = 0; f < expected->mNumFaces; f++) triangles += expected->mFaces[f].mNumIndices == 3;
+		if (triangles * 3 != mesh.indices.size()) {
+			std::cout << "  mesh " << m << " triangle count differs: assimp " << triangles << ", parser " << mesh.indices.size() / 3 << std::endl;
+			mismatches += triangles;
+			continue;
+		}
+
+		size_t corner = 0;
+		for (uint32_t f = 0; f < expected->mNumFaces; f++)
+		{
+			const aiFace & face = expected->mFaces[f];
+			if (face.mNumIndices != 3) continue;
+
+			bool same = true;
+			for (uint32_t k = 0; k < 3; k++, corner++)
+			{
+				uint32_t a = face.mIndices[k];
+				uint32_t b = mesh.indices[corner];
+				for (int c = 0; c < 3; c++)
+				{
+					same = same && closeEnough(expected->mVertices[a][c], mesh.positions[b * 3 + c]);
+					if (expected->HasNormals() && !mesh.normals.empty())
+						same = same && closeEnough(expected->mNormals[a][c], mesh.normals[b * 3 + c]);
+				}
+				if (expected->HasTextureCoords(0) && !mesh.uvs.empty()) {
+					same = same && closeEnough(expected->mTextureCoords[0][a].x, mesh.uvs[b * 2 + 0]);
+					same = same && closeEnough(expected->mTextureCoords[0][a].y, mesh.uvs[b * 2 + 1]);
+				}
+			}
+			mismatches += !same;
+		}
+	}
+
+	return mismatches;
+}
+
+void objParserBenchmark()
+{
+	ThreadPool pool;
+
+	std::cout << std::left << std::setw(34) << "model"
+		<< std::right << std::setw(12) << "assimp ms"
+		<< std::setw(12) << "1 thread"
+		<< std::setw(14) << (std::to_string(pool.size() + 1) + " threads")
+		<< std::setw(10) << "speedup"
+		<< std::setw(12) << "mismatches" << std::endl;
+
+	for (auto model : models)
+	{
+		double assimpBest = 1e30;
+		for (int run = 0; run < runs; run++)
+		{
+			Timer timer;
+			Assimp::Importer importer;
+			importer.ReadFile(model, aiProcess_Triangulate);
+			assimpBest = std::min(assimpBest, timer.elapsedMilliseconds());
+		}
+
+		double serialBest = 1e30;
+		double parallelBest = 1e30;
+		ObjModel parsed;
+		for (int run = 0; run < runs; run++)
+		{
+			Timer timer;
+			if (!parseObj(model, parsed)) break;
+			serialBest = std::min(serialBest, timer.elapsedMilliseconds());
+
+			timer.reset();
+			parseObj(model, parsed, &pool);
+			parallelBest = std::min(parallelBest, timer.elapsedMilliseconds());
+		}
+
+		Assimp::Importer importer;
+		const aiScene * scene = importer.ReadFile(model, aiProcess_Triangulate);
+		if (!scene) {
+			std::cout << model << ": Assimp failed to load" << std::endl;
+			continue;
+		}
+
+		std::cout << std::left << std::setw(34) << model << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << assimpBest
+			<< std::setw(12) << serialBest
+			<< std::setw(14) << parallelBest
+			<< std::setw(9) << std::setprecision(1) << assimpBest / parallelBest << "x"
+			<< std::setw(12) << countMismatches(scene, parsed) << std::endl;
+	}
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "PathTracer.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+struct PathBenchmarkScene
+{
+	const char * name;
+	SphereScene scene;
+	const char * image; // the adaptive image and its sample counts (name_samples.bmp)
+};
+
+// root mean square of the luminance difference, what the tile error estimates for one image against the truth
+static double rmsDifference(const RayImage & a, const RayImage & b)
+{
+	double total = 0.0;
+	for (size_t i = 0; i < a.pixels.size(); i++)
+	{
+		double difference = glm::dot(glm::vec3(a.pixels[i] - b.pixels[i]), glm::vec3(0.2126f, 0.7152f, 0.0722f));
+		total += difference * difference;
+	}
+	return std::sqrt(total / std::max<size_t>(a.pixels.size(), 1));
+}
+
+void pathTracerBenchmark()
+{
+	ThreadPool pool;
+
+	vector<PathBenchmarkScene> scenes = {
+		{ "raytracing", raytracingScene(), "pathtracing" },
+		{ "compute", computeShaderScene(), "pathcompute" },
+	};
+
+	std::cout << std::left << std::setw(12) << "scene"
+		<< std::setw(10) << "sampling"
+		<< std::right << std::setw(8) << "passes"
+		<< std::setw(9) << "avg spp"
+		<< std::setw(9) << "max spp"
+		<< std::setw(10) << "Msamples"
+		<< std::setw(9) << "Mrays"
+		<< std::setw(13) << "converge ms"
+		<< std::setw(9) << "Mrays/s"
+		<< std::setw(10) << "rms diff"
+		<< std::setw(8) << "saved" << std::endl;
+
+	for (auto & entry : scenes)
+	{
+		uint32_t width = entry.scene.width, height = entry.scene.height;
+		RayImage images[2];
+		double times[2];
+		for (int adaptive = 0; adaptive < 2; adaptive++)
+		{
+			PathTraceOptions options;
+			options.adaptive = adaptive != 0;
+			ProgressiveRenderer renderer;
+			renderer.reset(entry.scene, width, height, options);
+
+			uint64_t rays = 0;
+			Timer timer;
+			while (!renderer.converged()) rays += renderer.pass(&pool);
+			times[adaptive] = timer.elapsedMilliseconds();
+			renderer.resolve(images[adaptive]);
+
+			double pixels = double(width) * height;
+			std::cout << std::left << std::setw(12) << entry.name
+				<< std::setw(10) << (adaptive ? "adaptive" : "uniform")
+				<< std::right << std::setw(8) << renderer.passCount()
+				<< std::fixed << std::setprecision(1)
+				<< std::setw(9) << renderer.sampleCount() / pixels
+				<< std::setw(9) << renderer.maxTileSamples()
+				<< std::setprecision(2)
+				<< std::setw(10) << renderer.sampleCount() / 1e6
+				<< std::setw(9) << rays / 1e6
+				<< std::setprecision(1) << std::setw(13) << times[adaptive]
+				<< std::setprecision(2) << std::setw(9) << rays / (times[adaptive] / 1000.0) / 1e6;
+			if (adaptive)
+			{
+				std::cout << std::setprecision(4) << std::setw(10) << rmsDifference(images[0], images[1])
+					<< std::setprecision(1) << std::setw(7) << times[0] / times[1] << "x";
+			}
+			std::cout << std::endl;
+			std::cout.unsetf(std::ios::floatfield);
+
+			if (adaptive)
+			{
+				RayImage counts;
+				renderer.resolveSampleCounts(counts);
+				std::string name = entry.image;
+				if (!saveRayImage((name + ".bmp").c_str(), images[1]) || !saveRayImage((name + "_samples.bmp").c_str(), counts))
+					std::cout << "could not write " << name << ".bmp" << std::endl;
+			}
+		}
+	}
+
+	PathTraceOptions defaults;
+	std::cout << "Progressive path tracing of the RayTracer scenes at their demos' size: the light a sphere of radius "
+		<< defaults.lightRadius << ", " << defaults.bounces << " diffuse bounce, " << defaults.samplesPerPass
+		<< " samples per pixel and pass on tiles of " << defaults.tileSize << " x " << defaults.tileSize << " over "
+		<< pool.size() + 1 << " threads, until every tile's error is below " << defaults.threshold << " (after at least "
+		<< defaults.minSamples << " samples). uniform keeps sampling all tiles until the last converges, adaptive stops "
+		<< "each tile on its own; converge ms is the time to get there, rays include shadow and bounce rays, rms diff the "
+		<< "luminance difference of the two images and saved the time uniform takes over adaptive. pathtracing.bmp and "
+		<< "pathcompute.bmp are the adaptive images, _samples.bmp their samples per tile" << std::endl;
+}
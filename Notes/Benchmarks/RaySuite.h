@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm\glm.hpp>
+#include "Bvh.h"
+#include "RayTracer.h"
+
+class ThreadPool;
+
+/*The scenes of the ray suite, shared by raySuiteBenchmark and wavefrontBenchmark: the two sphere sets of the demos,
+three models and a field of instances of one of them, each with a fixed camera and light so runs compare.*/
+
+const uint32_t SUITE_WIDTH = 1024;
+const uint32_t SUITE_HEIGHT = 576;
+const uint32_t SUITE_SEED = 1234;
+const uint32_t FIELD_INSTANCES = 1000;
+
+enum SuiteKind
+{
+	SUITE_SPHERES,
+	SUITE_MESH,
+	SUITE_FIELD, // the mesh placed FIELD_INSTANCES times
+};
+
+struct SuiteEntry
+{
+	const char * name;
+	SuiteKind kind;
+	const char * model; // for a mesh or field
+	uint32_t sphereScene; // 0 the Raytracing one, 1 the ComputeShader one
+};
+
+const SuiteEntry SUITE_ENTRIES[] = {
+	{ "raytracing", SUITE_SPHERES, nullptr, 0 },
+	{ "compute", SUITE_SPHERES, nullptr, 1 },
+	{ "bear", SUITE_MESH, "../../Models/Bear/bear-obj.obj", 0 },
+	{ "dog", SUITE_MESH, "../../Models/Dog/dog.obj", 0 },
+	{ "gear", SUITE_MESH, "../../Models/Gears/Gear.obj", 0 },
+	{ "bearfield", SUITE_FIELD, "../../Models/Bear/bear-obj.obj", 0 },
+};
+
+// what the rays of one entry are traced against, and from where
+struct SuiteScene
+{
+	SuiteKind kind;
+	std::vector<RaySphere> spheres;
+	std::vector<glm::vec3> positions;
+	std::vector<uint32_t> indices;
+	std::unique_ptr<Bvh> mesh;
+	std::unique_ptr<BvhInstances> field;
+	std::vector<glm::mat3> normalMatrices; // per instance of the field
+	size_t primitives = 0; // spheres, or triangles counting every instance
+	double buildMilliseconds = 0.0;
+
+	RayCamera camera;
+	glm::vec3 light;
+	float offset = 1e-4f; // secondary rays start this far off the surface
+};
+
+// Loads the entry's model through the mesh cache and builds its hierarchies on the pool, false if the model is missing.
+bool loadScene(const SuiteEntry & entry, ThreadPool & pool, SuiteScene & scene);
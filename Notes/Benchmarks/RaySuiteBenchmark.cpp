@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm\gtc\matrix_transform.hpp>
+#include "Bvh.h"
+#include "MeshCache.h"
+#include "PathTracer.h"
+#include "RaySuite.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const size_t RAY_BLOCK = 256;
+static const char * RESULTS_PATH = "raysuite.csv";
+
+static bool intersect(const SuiteScene & scene, const BvhRay & ray, BvhHit & hit)
+{
+	if (scene.kind == SUITE_SPHERES)
+	{
+		int sphere = traceSpheres(scene.spheres, ray.origin, ray.direction, ray.maxDistance, hit.distance, false);
+		hit.hit = sphere >= 0;
+		hit.triangle = hit.hit ? static_cast<uint32_t>(sphere) : 0;
+		return hit.hit;
+	}
+	return scene.kind == SUITE_MESH ? scene.mesh->intersect(ray, hit, nullptr, true) : scene.field->intersect(ray, hit);
+}
+
+static bool occluded(const SuiteScene & scene, const BvhRay & ray)
+{
+	if (scene.kind == SUITE_SPHERES)
+	{
+		float distance;
+		return traceSpheres(scene.spheres, ray.origin, ray.direction, ray.maxDistance, distance, true) >= 0;
+	}
+	return scene.kind == SUITE_MESH ? scene.mesh->occluded(ray, nullptr, true) : scene.field->occluded(ray);
+}
+
+// geometric normal at the hit, facing back along the ray
+static glm::vec3 normalAt(const SuiteScene & scene, const BvhRay & ray, const BvhHit & hit)
+{
+	glm::vec3 normal;
+	if (scene.kind == SUITE_SPHERES)
+	{
+		const RaySphere & sphere = scene.spheres[hit.triangle];
+		normal = ray.origin + ray.direction * hit.distance - sphere.center;
+	}
+	else
+	{
+		const uint32_t * corner = &scene.indices[size_t(hit.triangle) * 3];
+		glm::vec3 p0 = scene.positions[corner[0]], p1 = scene.positions[corner[1]], p2 = scene.positions[corner[2]];
+		normal = glm::cross(p1 - p0, p2 - p0);
+		if (scene.kind == SUITE_FIELD) normal = scene.normalMatrices[hit.instance] * normal;
+	}
+	normal = glm::normalize(normal);
+	return glm::dot(normal, ray.direction) > 0.0f ? -normal : normal;
+}
+
+// a pinhole at eye looking at target, vertical field of view in radians
+static RayCamera lookAt(const glm::vec3 & eye, const glm::vec3 & target, float fieldOfView)
+{
+	glm::vec3 forward = glm::normalize(target - eye);
+	glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+	glm::vec3 up = glm::cross(right, forward);
+	float halfHeight = std::tan(fieldOfView * 0.5f), halfWidth = halfHeight * SUITE_WIDTH / SUITE_HEIGHT;
+
+	RayCamera camera;
+	camera.origin = eye;
+	camera.originU = camera.originV = glm::vec3(0.0f);
+	camera.direction = forward - right * halfWidth - up * halfHeight;
+	camera.directionU = right * (2.0f * halfWidth);
+	camera.directionV = up * (2.0f * halfHeight);
+	camera.pixelOffset = 0.5f;
+	return camera;
+}
+
+bool loadScene(const SuiteEntry & entry, ThreadPool & pool, SuiteScene & scene)
+{
+	scene.kind = entry.kind;
+	if (entry.kind == SUITE_SPHERES)
+	{
+		SphereScene spheres = entry.sphereScene ? computeShaderScene() : raytracingScene();
+		scene.spheres = spheres.spheres;
+		scene.primitives = spheres.spheres.size();
+		scene.camera = spheres.camera;
+		scene.light = spheres.light;
+		return true;
+	}
+
+	MeshCache cache;
+	if (!loadMeshCache(entry.model, cache, &pool)) return false;
+
+	// every submesh into one index array over the shared vertex block
+	auto positions = reinterpret_cast<const glm::vec3*>(static_cast<const char*>(cache.vertexData()) + cache.positionOffset());
+	scene.positions.assign(positions, positions + cache.header->vertexCount);
+	for (uint32_t i = 0; i < cache.header->submeshCount; i++)
+	{
+		const MeshCacheSubmesh & submesh = cache.submeshes[i];
+		for (uint32_t x = 0; x < submesh.indexCount; x++)
+		{
+			uint32_t index = cache.indexSize() == sizeof(uint16_t)
+				? static_cast<const uint16_t*>(cache.indexData())[submesh.indexOffset + x]
+				: static_cast<const uint32_t*>(cache.indexData())[submesh.indexOffset + x];
+			scene.indices.push_back(index + submesh.vertexOffset);
+		}
+	}
+
+	Timer timer;
+	scene.mesh.reset(new Bvh());
+	scene.mesh->build(&scene.positions[0].x, sizeof(glm::vec3), scene.indices.data(), scene.indices.size(), BvhOptions(), &pool);
+	glm::vec3 low = scene.mesh->boundsMin(), high = scene.mesh->boundsMax();
+	glm::vec3 center = (low + high) * 0.5f;
+	float radius = glm::length(high - low) * 0.5f;
+	scene.primitives = scene.indices.size() / 3;
+
+	if (entry.kind == SUITE_MESH)
+	{
+		scene.buildMilliseconds = timer.elapsedMilliseconds();
+		scene.camera = lookAt(center + glm::normalize(glm::vec3(0.4f, 0.3f, 1.0f)) * radius * 2.2f, center, glm::radians(45.0f));
+		scene.light = center + glm::normalize(glm::vec3(-0.5f, 1.0f, 0.6f)) * radius * 4.0f;
+		scene.offset = radius * 1e-4f;
+		return true;
+	}
+
+	// the InstancedRendering demo's field of 1000 bears, from a fixed seed instead of rand()
+	std::mt19937 random(SUITE_SEED);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	vector<BvhInstance> instances(FIELD_INSTANCES);
+	scene.normalMatrices.resize(FIELD_INSTANCES);
+	for (uint32_t i = 0; i < FIELD_INSTANCES; i++)
+	{
+		glm::vec3 position = glm::mix(glm::vec3(-100.0f, -40.0f, -30.0f), glm::vec3(100.0f, 40.0f, -200.0f),
+			glm::vec3(unit(random), unit(random), unit(random)));
+		float angle = glm::radians(360.0f * unit(random));
+		glm::mat4 transform = glm::rotate(glm::translate(glm::mat4(1.0f), position), angle, glm::normalize(glm::vec3(1.0f)));
+		instances[i] = { scene.mesh.get(), transform };
+		scene.normalMatrices[i] = glm::transpose(glm::inverse(glm::mat3(transform)));
+	}
+	scene.field.reset(new BvhInstances());
+	scene.field->build(instances.data(), instances.size(), BvhOptions(), &pool);
+	scene.buildMilliseconds = timer.elapsedMilliseconds();
+	scene.primitives *= FIELD_INSTANCES;
+
+	// from in front of the field, where the demo's camera starts its flight
+	scene.camera = lookAt(glm::vec3(0.0f, 0.0f, 40.0f), glm::vec3(0.0f, 0.0f, -115.0f), glm::radians(45.0f));
+	scene.light = glm::vec3(50.0f, 300.0f, 0.0f);
+	scene.offset = 1e-3f;
+	return true;
+}
+
+// body(i) for every ray in blocks over the pool, milliseconds taken
+template <class Body>
+static double traceAll(size_t count, ThreadPool & pool, Body body)
+{
+	size_t blocks = (count + RAY_BLOCK - 1) / RAY_BLOCK;
+	Timer timer;
+	pool.parallelFor(blocks, [&](size_t block) {
+		size_t end = std::min((block + 1) * RAY_BLOCK, count);
+		for (size_t i = block * RAY_BLOCK; i < end; i++) body(i);
+	});
+	return timer.elapsedMilliseconds();
+}
+
+struct SuiteResult
+{
+	const char * scene;
+	const char * rays;
+	size_t primitives;
+	double buildMilliseconds;
+	size_t count;
+	size_t hits;
+	double milliseconds;
+};
+
+static void writeResults(const vector<SuiteResult> & results, unsigned threads)
+{
+	bool header = !std::ifstream(RESULTS_PATH).good();
+	std::ofstream file(RESULTS_PATH, std::ios::app);
+	if (!file)
+	{
+		std::cout << "could not write " << RESULTS_PATH << std::endl;
+		return;
+	}
+
+	char date[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+	if (header) file << "date,scene,rays,primitives,build_ms,count,hits,ms,mrays_per_s,threads,width,height,seed\n";
+	for (const auto & result : results)
+	{
+		file << date << ',' << result.scene << ',' << result.rays << ',' << result.primitives << ','
+			<< result.buildMilliseconds << ',' << result.count << ',' << result.hits << ',' << result.milliseconds << ','
+			<< result.count / (result.milliseconds / 1000.0) / 1e6 << ',' << threads << ',' << SUITE_WIDTH << ',' << SUITE_HEIGHT
+			<< ',' << SUITE_SEED << '\n';
+	}
+}
+
+void raySuiteBenchmark()
+{
+	ThreadPool pool;
+	unsigned threads = static_cast<unsigned>(pool.size()) + 1;
+	vector<SuiteResult> results;
+
+	std::cout << std::left << std::setw(12) << "scene"
+		<< std::right << std::setw(10) << "prims"
+		<< std::setw(10) << "build ms"
+		<< std::left << std::setw(2) << "" << std::setw(9) << "rays"
+		<< std::right << std::setw(9) << "count"
+		<< std::setw(8) << "hits"
+		<< std::setw(10) << "ms"
+		<< std::setw(9) << "Mrays/s" << std::endl;
+
+	for (const auto & entry : SUITE_ENTRIES)
+	{
+		SuiteScene scene;
+		if (!loadScene(entry, pool, scene))
+		{
+			std::cout << entry.name << ": failed to load " << entry.model << std::endl;
+			continue;
+		}
+
+		// one ray through the center of every pixel
+		vector<BvhRay> primary(size_t(SUITE_WIDTH) * SUITE_HEIGHT);
+		for (uint32_t y = 0; y < SUITE_HEIGHT; y++)
+		{
+			for (uint32_t x = 0; x < SUITE_WIDTH; x++)
+			{
+				float u = (x + scene.camera.pixelOffset) / SUITE_WIDTH, v = (y + scene.camera.pixelOffset) / SUITE_HEIGHT;
+				BvhRay & ray = primary[size_t(y) * SUITE_WIDTH + x];
+				ray.origin = scene.camera.origin + scene.camera.originU * u + scene.camera.originV * v;
+				ray.direction = scene.camera.direction + scene.camera.directionU * u + scene.camera.directionV * v;
+			}
+		}
+		vector<BvhHit> primaryHits(primary.size());
+		double primaryTime = traceAll(primary.size(), pool, [&](size_t i) { intersect(scene, primary[i], primaryHits[i]); });
+
+		// from every primary hit a ray to the light and one cosine distributed bounce, in pixel order
+		std::mt19937 random(SUITE_SEED);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		vector<BvhRay> shadow, diffuse;
+		for (size_t i = 0; i < primary.size(); i++)
+		{
+			if (!primaryHits[i].hit) continue;
+			glm::vec3 normal = normalAt(scene, primary[i], primaryHits[i]);
+			glm::vec3 start = primary[i].origin + primary[i].direction * primaryHits[i].distance + normal * scene.offset;
+
+			BvhRay toLight;
+			toLight.origin = start;
+			toLight.direction = scene.light - start;
+			toLight.maxDistance = 1.0f;
+			shadow.push_back(toLight);
+
+			glm::vec3 tangent = glm::normalize(glm::cross(std::fabs(normal.x) > 0.5f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f), normal));
+			glm::vec3 bitangent = glm::cross(normal, tangent);
+			float r = std::sqrt(unit(random)), phi = 6.2831853f * unit(random);
+			BvhRay bounce;
+			bounce.origin = start;
+			bounce.direction = tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + normal * std::sqrt(std::max(0.0f, 1.0f - r * r));
+			diffuse.push_back(bounce);
+		}
+
+		vector<char> shadowHits(shadow.size());
+		double shadowTime = traceAll(shadow.size(), pool, [&](size_t i) { shadowHits[i] = occluded(scene, shadow[i]); });
+		vector<BvhHit> diffuseHits(diffuse.size());
+		double diffuseTime = traceAll(diffuse.size(), pool, [&](size_t i) { intersect(scene, diffuse[i], diffuseHits[i]); });
+
+		auto countHits = [](const vector<BvhHit> & hits) {
+			return static_cast<size_t>(std::count_if(hits.begin(), hits.end(), [](const BvhHit & hit) { return hit.hit; }));
+		};
+		SuiteResult sceneResults[] = {
+			{ entry.name, "primary", scene.primitives, scene.buildMilliseconds, primary.size(), countHits(primaryHits), primaryTime },
+			{ entry.name, "shadow", scene.primitives, scene.buildMilliseconds, shadow.size(),
+				static_cast<size_t>(std::count(shadowHits.begin(), shadowHits.end(), 1)), shadowTime },
+			{ entry.name, "diffuse", scene.primitives, scene.buildMilliseconds, diffuse.size(), countHits(diffuseHits), diffuseTime },
+		};
+
+		for (const auto & result : sceneResults)
+		{
+			std::cout << std::left << std::setw(12) << result.scene
+				<< std::right << std::setw(10) << result.primitives
+				<< std::fixed << std::setprecision(2) << std::setw(10) << result.buildMilliseconds
+				<< std::left << std::setw(2) << "" << std::setw(9) << result.rays
+				<< std::right << std::setw(9) << result.count
+				<< std::setprecision(1) << std::setw(7) << (result.count ? 100.0 * result.hits / result.count : 0.0) << "%"
+				<< std::setprecision(2) << std::setw(10) << result.milliseconds
+				<< std::setw(9) << (result.milliseconds > 0.0 ? result.count / (result.milliseconds / 1000.0) / 1e6 : 0.0)
+				<< std::endl;
+			std::cout.unsetf(std::ios::floatfield);
+			results.push_back(result);
+		}
+	}
+
+	writeResults(results, threads);
+
+	std::cout << "Fixed cameras at " << SUITE_WIDTH << " x " << SUITE_HEIGHT << ", one primary ray per pixel center, then from every "
+		<< "primary hit one shadow ray to the scene's light (any hit) and one cosine distributed diffuse bounce (nearest "
+		<< "hit) drawn with seed " << SUITE_SEED << ", each kind timed on its own over " << threads << " threads. The sphere "
+		<< "sets are the Raytracing and ComputeShader demos' tested one by one, the models go through a binned SAH BVH "
+		<< "(wide layout), bearfield is the InstancedRendering demo's " << FIELD_INSTANCES << " bears as instances of one "
+		<< "BVH under a BVH of their boxes; prims counts every instance's triangles and build ms both levels. Rows are "
+		<< "appended to " << RESULTS_PATH << " with the date, to chart from one run to the next" << std::endl;
+}
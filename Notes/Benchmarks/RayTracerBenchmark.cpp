@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RayTracer.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const uint32_t WIDTH = 1920;
+static const uint32_t HEIGHT = 1080;
+static const uint32_t FRAMES = 4;
+
+struct BenchmarkScene
+{
+	const char * name;
+	SphereScene scene;
+	const char * image; // written at the demo's size, nullptr for none
+};
+
+static float maxDifference(const RayImage & a, const RayImage & b)
+{
+	float difference = 0.0f;
+	for (size_t i = 0; i < a.pixels.size(); i++)
+	{
+		glm::vec4 delta = glm::abs(a.pixels[i] - b.pixels[i]);
+		difference = std::max(difference, std::max(std::max(delta.x, delta.y), delta.z));
+	}
+	return difference;
+}
+
+void rayTracerBenchmark()
+{
+	// 1, 2, 4 ... threads up to every hardware thread, the caller of parallelFor counting as one
+	unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+	vector<unsigned> threadCounts;
+	for (unsigned threads = 1; threads < hardware; threads *= 2) threadCounts.push_back(threads);
+	threadCounts.push_back(hardware);
+
+	vector<RaySimd> simds = { RAY_SIMD_SCALAR, RAY_SIMD_SSE2 };
+	if (raySimdSupported() == RAY_SIMD_AVX2) simds.push_back(RAY_SIMD_AVX2);
+
+	vector<BenchmarkScene> scenes = {
+		{ "raytracing", raytracingScene(), "raytracing.bmp" },
+		{ "compute", computeShaderScene(), "computeshader.bmp" },
+		{ "compute64", computeShaderScene(64, 1, 4.0f), nullptr },
+	};
+
+	std::cout << std::left << std::setw(12) << "scene"
+		<< std::setw(8) << "simd"
+		<< std::right << std::setw(9) << "threads"
+		<< std::setw(10) << "ms"
+		<< std::setw(11) << "Mrays/s"
+		<< std::setw(10) << "speedup"
+		<< std::setw(12) << "max diff" << std::endl;
+
+	for (auto & entry : scenes)
+	{
+		if (entry.image)
+		{
+			RayImage image;
+			renderSpheres(entry.scene, entry.scene.width, entry.scene.height, image);
+			if (!saveRayImage(entry.image, image)) std::cout << "could not write " << entry.image << std::endl;
+		}
+
+		RayImage reference, image;
+		double scalarRate = 0.0;
+		for (auto simd : simds)
+		{
+			for (auto threads : threadCounts)
+			{
+				std::unique_ptr<ThreadPool> pool;
+				if (threads > 1) pool.reset(new ThreadPool(threads - 1));
+
+				RayRenderOptions options;
+				options.simd = simd;
+				RayImage & target = simd == RAY_SIMD_SCALAR && threads == 1 ? reference : image;
+
+				// the first frame touches the image memory, it is not timed
+				renderSpheres(entry.scene, WIDTH, HEIGHT, target, options, pool.get());
+				uint64_t rays = 0;
+				Timer timer;
+				for (uint32_t frame = 0; frame < FRAMES; frame++)
+					rays += renderSpheres(entry.scene, WIDTH, HEIGHT, target, options, pool.get());
+				double seconds = timer.elapsedMilliseconds() / 1000.0;
+
+				double rate = rays / seconds / 1e6;
+				if (simd == RAY_SIMD_SCALAR && threads == 1) scalarRate = rate;
+
+				std::cout << std::left << std::setw(12) << entry.name
+					<< std::setw(8) << raySimdName(simd)
+					<< std::right << std::setw(9) << threads
+					<< std::fixed << std::setprecision(2)
+					<< std::setw(10) << seconds * 1000.0 / FRAMES
+					<< std::setw(11) << rate
+					<< std::setprecision(1) << std::setw(9) << rate / scalarRate << "x"
+					<< std::scientific << std::setprecision(1)
+					<< std::setw(12) << (&target == &reference ? 0.0f : maxDifference(reference, target))
+					<< std::endl;
+				std::cout.unsetf(std::ios::floatfield);
+			}
+		}
+	}
+
+	std::cout << "One primary ray per pixel at " << WIDTH << " x " << HEIGHT << ", " << FRAMES << " frames timed after "
+		<< "one untimed, tiles of 32 x 32 pixels handed out to the threads. compute is the ComputeShader demo's 3 spheres, "
+		<< "compute64 64 of them over a wider area. speedup is against the scalar kernel on one thread, max diff the "
+		<< "largest color difference to its image. raytracing.bmp and computeshader.bmp are the two demo scenes at their "
+		<< "own size" << std::endl;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cstring>
+#include "Benchmarks.h"
+
+struct Benchmark
+{
+	const char * name;
+	void(*run)();
+};
+
+static const Benchmark benchmarks[] = {
+	{ "meshcache", meshCacheBenchmark },
+	{ "meshoptimizer", meshOptimizerBenchmark },
+	{ "objparser", objParserBenchmark },
+	{ "meshlets", meshletBenchmark },
+	{ "lod", lodBenchmark },
+	{ "textures", textureBenchmark },
+	{ "mips", mipBenchmark },
+	{ "tangents", tangentBenchmark },
+	{ "noise", noiseBenchmark },
+	{ "cdlod", terrainLodBenchmark },
+	{ "terrainmesh", terrainMeshBenchmark },
+	{ "terrainfile", terrainFileBenchmark },
+	{ "heightfield", heightfieldBenchmark },
+	{ "erosion", erosionBenchmark },
+	{ "raytracer", rayTracerBenchmark },
+	{ "bvh", bvhBenchmark },
+	{ "pathtracer", pathTracerBenchmark },
+	{ "raysuite", raySuiteBenchmark },
+	{ "wavefront", wavefrontBenchmark },
+};
+
+int main(int argc, char ** argv) {
+	/*
+	Benchmarks [name...]
+	Runs every benchmark when no name is given, otherwise only the named ones.
+	*/
+	bool ranAny = false;
+	for (const auto & benchmark : benchmarks)
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++)
+			selected = selected || strcmp(argv[i], benchmark.name) == 0;
+
+		if (!selected) continue;
+
+		std::cout << "== " << benchmark.name << " ==" << std::endl;
+		benchmark.run();
+		std::cout << std::endl;
+		ranAny = true;
+	}
+
+	if (!ranAny) {
+		std::cout << "Unknown benchmark, available:";
+		for (const auto & benchmark : benchmarks) std::cout << " " << benchmark.name;
+		std::cout << std::endl;
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+#include <glm\glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "MeshCache.h"
+#include "TangentSpace.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const char * models[] = {
+	"../../Models/Bear/bear-obj.obj",
+	"../../Models/Dog/dog.obj",
+	"../../Models/Gears/Gear.obj",
+};
+
+static const int RUNS = 5;
+
+// bytes per vertex of the two ways to give the vertex shader a tangent frame, and of the vertices they end up in
+// (see VertexFormat): float normal + tangent with sign against one snorm16 quaternion
+static const int FLOAT_FRAME_BYTES = 7 * 4, QTANGENT_FRAME_BYTES = 4 * 2;
+static const int FLOAT_VERTEX_BYTES = 12 * 4, QTANGENT_VERTEX_BYTES = 20;
+
+static float angleDegrees(const glm::vec3 & a, const glm::vec3 & b)
+{
+	return glm::degrees(std::acos(glm::clamp(glm::dot(glm::normalize(a), glm::normalize(b)), -1.0f, 1.0f)));
+}
+
+void tangentBenchmark()
+{
+	ThreadPool pool;
+
+	std::cout << std::left << std::setw(34) << "model"
+		<< std::right << std::setw(12) << "triangles"
+		<< std::setw(12) << "1 thread"
+		<< std::setw(10) << "pool"
+		<< std::setw(10) << "speedup"
+		<< std::setw(10) << "Mtris/s"
+		<< std::setw(10) << "mirrored"
+		<< std::setw(12) << "normal err"
+		<< std::setw(13) << "tangent err"
+		<< std::setw(10) << "flipped" << std::endl;
+
+	for (auto model : models)
+	{
+		MeshCache cache;
+		if (!loadMeshCache(model, cache)) {
+			std::cout << model << ": failed to load" << std::endl;
+			continue;
+		}
+
+		// every submesh in one index list over the whole vertex block, the way the bake sees them one at a time
+		size_t vertexCount = cache.header->vertexCount;
+		vector<uint32_t> indices;
+		for (uint32_t s = 0; s < cache.header->submeshCount; s++)
+		{
+			const MeshCacheSubmesh & submesh = cache.submeshes[s];
+			for (uint32_t x = 0; x < submesh.indexCount; x++)
+			{
+				uint32_t index = cache.indexSize() == sizeof(uint16_t)
+					? static_cast<const uint16_t*>(cache.indexData())[submesh.indexOffset + x]
+					: static_cast<const uint32_t*>(cache.indexData())[submesh.indexOffset + x];
+				indices.push_back(index + submesh.vertexOffset);
+			}
+		}
+
+		auto block = static_cast<const char*>(cache.vertexData());
+		auto positions = reinterpret_cast<const float*>(block + cache.positionOffset());
+		auto normals = reinterpret_cast<const float*>(block + cache.normalOffset());
+		auto uvs = reinterpret_cast<const float*>(block + cache.uvOffset());
+
+		vector<float> tangents(vertexCount * 4);
+		double serialTime = 1e30, poolTime = 1e30;
+		for (int run = 0; run < RUNS; run++)
+		{
+			Timer timer;
+			generateTangents(tangents.data(), indices.data(), indices.size(), positions, sizeof(float) * 3,
+				normals, sizeof(float) * 3, uvs, sizeof(float) * 2, vertexCount);
+			serialTime = std::min(serialTime, timer.elapsedMilliseconds());
+
+			timer.reset();
+			generateTangents(tangents.data(), indices.data(), indices.size(), positions, sizeof(float) * 3,
+				normals, sizeof(float) * 3, uvs, sizeof(float) * 2, vertexCount, &pool);
+			poolTime = std::min(poolTime, timer.elapsedMilliseconds());
+		}
+
+		// round trip through the quaternion against the frame it came from, tangent made perpendicular like the encoder does
+		size_t mirrored = 0, flipped = 0, measured = 0;
+		float normalError = 0.0f, tangentError = 0.0f;
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			glm::vec3 normal(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+			if (glm::length(normal) == 0.0f) continue;
+			normal = glm::normalize(normal);
+			glm::vec3 tangent(tangents[i * 4], tangents[i * 4 + 1], tangents[i * 4 + 2]);
+			tangent = glm::normalize(tangent - normal * glm::dot(normal, tangent));
+			if (tangents[i * 4 + 3] < 0.0f) mirrored++;
+
+			int16_t encoded[4];
+			float decodedNormal[3], decodedTangent[4];
+			encodeQTangent(&normals[i * 3], &tangents[i * 4], encoded);
+			decodeQTangent(encoded, decodedNormal, decodedTangent);
+
+			normalError = std::max(normalError, angleDegrees(normal, glm::vec3(decodedNormal[0], decodedNormal[1], decodedNormal[2])));
+			tangentError = std::max(tangentError, angleDegrees(tangent, glm::vec3(decodedTangent[0], decodedTangent[1], decodedTangent[2])));
+			if ((decodedTangent[3] < 0.0f) != (tangents[i * 4 + 3] < 0.0f)) flipped++;
+			measured++;
+		}
+
+		std::cout << std::left << std::setw(34) << model << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(12) << indices.size() / 3
+			<< std::setw(12) << serialTime
+			<< std::setw(10) << poolTime
+			<< std::setprecision(1)
+			<< std::setw(9) << serialTime / poolTime << "x"
+			<< std::setw(10) << indices.size() / 3 / (poolTime * 1000.0)
+			<< std::setw(10) << mirrored
+			<< std::setprecision(4)
+			<< std::setw(11) << normalError << "d"
+			<< std::setw(12) << tangentError << "d"
+			<< std::setw(10) << flipped << std::endl;
+
+		if (measured == 0) std::cout << "  (no normals, nothing to encode)" << std::endl;
+	}
+
+	std::cout << "tangent frame: float " << FLOAT_FRAME_BYTES << " B, qtangent " << QTANGENT_FRAME_BYTES
+		<< " B. Whole vertex: float " << FLOAT_VERTEX_BYTES << " B, qtangent " << QTANGENT_VERTEX_BYTES << " B" << std::endl;
+	std::cout << "pool: " << pool.size() << " workers plus the calling thread, errors are the worst vertex in degrees" << std::endl;
+}
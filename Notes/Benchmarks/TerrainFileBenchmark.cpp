@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Noise.h"
+#include "TerrainFile.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const uint32_t sizes[] = { 2048, 8192 };
+static const TerrainFileFormat formats[] = { TERRAIN_FILE_UINT16, TERRAIN_FILE_FLOAT };
+
+static const char * PATH = "benchmark.rwterrain";
+static const float HEIGHT_SCALE = 120.0f;
+static const int RANDOM_TILES = 256;
+
+void terrainFileBenchmark()
+{
+	ThreadPool pool;
+
+	std::cout << std::left << std::setw(8) << "size"
+		<< std::setw(8) << "format"
+		<< std::right << std::setw(11) << "noise ms"
+		<< std::setw(10) << "bake ms"
+		<< std::setw(10) << "file MB"
+		<< std::setw(10) << "bmp MB"
+		<< std::setw(8) << "levels"
+		<< std::setw(9) << "open us"
+		<< std::setw(12) << "1st tile us"
+		<< std::setw(10) << "tile us"
+		<< std::setw(10) << "read ms"
+		<< std::setw(8) << "GB/s"
+		<< std::setw(11) << "max error" << std::endl;
+
+	for (auto size : sizes)
+	{
+		// what the demos paid on every launch before
+		Timer noiseTimer;
+		vector<float> heights(size_t(size) * size);
+		NoiseOptions noise;
+		noise.octaves = 6;
+		noise.frequency = 1.0f / 512.0f;
+		generateNoise(heights.data(), size, size, size, 0.0f, 0.0f, 1.0f, 1.0f, noise, &pool);
+		for (auto & height : heights) height *= HEIGHT_SCALE;
+		double noiseTime = noiseTimer.elapsedMilliseconds();
+		uint64_t key = terrainNoiseKey(size, size, noise, { HEIGHT_SCALE });
+
+		for (auto format : formats)
+		{
+			TerrainFileOptions options;
+			options.format = format;
+			Timer bakeTimer;
+			if (!bakeTerrainFile(PATH, heights.data(), size, size, key, options, &pool)) return;
+			double bakeTime = bakeTimer.elapsedMilliseconds();
+
+			Timer openTimer;
+			TerrainFile terrain;
+			if (!openTerrainFile(PATH, key, terrain)) {
+				std::cout << "Could not open " << PATH << std::endl;
+				return;
+			}
+			double openTime = openTimer.elapsedMilliseconds();
+
+			const TerrainFileLevel & base = terrain.level(0);
+			uint32_t tileSize = terrain.tileSize();
+			vector<float> tile(size_t(tileSize) * tileSize);
+
+			Timer firstTimer;
+			terrain.readTile(0, base.tilesX / 2, base.tilesZ / 2, tile.data());
+			double firstTime = firstTimer.elapsedMilliseconds();
+
+			// scattered tiles of every level, the access a streamer or ray marcher makes
+			std::mt19937 random(7);
+			Timer tileTimer;
+			for (int i = 0; i < RANDOM_TILES; i++)
+			{
+				uint32_t level = random() % terrain.levelCount();
+				const TerrainFileLevel & info = terrain.level(level);
+				terrain.readTile(level, random() % info.tilesX, random() % info.tilesZ, tile.data());
+			}
+			double tileTime = tileTimer.elapsedMilliseconds() / RANDOM_TILES;
+
+			vector<float> decoded(heights.size());
+			Timer readTimer;
+			terrain.readRegion(0, 0, 0, size, size, decoded.data(), size, &pool);
+			double readTime = readTimer.elapsedMilliseconds();
+
+			float error = 0.0f;
+			for (size_t i = 0; i < heights.size(); i++) error = std::max(error, std::abs(decoded[i] - heights[i]));
+
+			double fileMegabytes = terrain.file.size() / (1024.0 * 1024.0);
+			double bmpMegabytes = (size_t(size) * size + 1078) / (1024.0 * 1024.0);
+			std::cout << std::left << std::setw(8) << size << std::setw(8) << (format == TERRAIN_FILE_UINT16 ? "uint16" : "float")
+				<< std::right << std::fixed << std::setprecision(1)
+				<< std::setw(11) << noiseTime
+				<< std::setw(10) << bakeTime
+				<< std::setw(10) << fileMegabytes
+				<< std::setw(10) << bmpMegabytes
+				<< std::setw(8) << terrain.levelCount()
+				<< std::setw(9) << openTime * 1000.0
+				<< std::setw(12) << firstTime * 1000.0
+				<< std::setw(10) << tileTime * 1000.0
+				<< std::setw(10) << readTime
+				<< std::setw(8) << heights.size() * sizeof(float) / (readTime / 1000.0) / 1e9
+				<< std::setw(11) << std::setprecision(4) << error << std::endl;
+
+			terrain.file.close();
+			std::remove(PATH);
+		}
+	}
+
+	std::cout << "noise ms is generating the heights like the demos did every launch, bmp MB what the 8 bit dump took. "
+		<< "Tiles are read decoded to floats, tile us averages " << RANDOM_TILES << " tiles picked from every level. The file "
+		<< "was just written, so its pages are likely still cached: reads from a cold disk take what the disk takes, "
+		<< "the open time does not change" << std::endl;
+}
@@ -0,0 +1,96 @@
+#include <glm\gtc\matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "Noise.h"
+#include "TerrainLod.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+// heightmap samples along a side, the terrain grows while the LOD settings (and so the view distance) stay the same
+static const uint32_t sizes[] = { 1025, 2049, 4097 };
+
+static const float HEIGHT_SCALE = 120.0f;
+
+// the eye circles the middle of the terrain looking along its path, like the TerrainLod demo
+static const int views = 64;
+
+void terrainLodBenchmark()
+{
+	ThreadPool pool;
+	// one level less than the demo, so the view distance (1536) ends inside all but the smallest terrain
+	TerrainLodSettings settings;
+	settings.levels = 5;
+
+	std::cout << std::left << std::setw(8) << "size"
+		<< std::right << std::setw(9) << "culling"
+		<< std::setw(14) << "full tris"
+		<< std::setw(12) << "avg tris"
+		<< std::setw(12) << "max tris"
+		<< std::setw(10) << "nodes"
+		<< std::setw(10) << "visited"
+		<< std::setw(12) << "select us"
+		<< std::setw(10) << "max us"
+		<< std::setw(10) << "build ms" << std::endl;
+
+	for (auto size : sizes)
+	{
+		vector<float> heights(size_t(size) * size);
+		NoiseOptions noise;
+		noise.octaves = 6;
+		noise.frequency = 1.0f / 512.0f;
+		generateNoise(heights.data(), size, size, size, 0.0f, 0.0f, 1.0f, 1.0f, noise, &pool);
+		for (auto & height : heights) height *= HEIGHT_SCALE;
+
+		Timer buildTimer;
+		TerrainLod lod(heights.data(), size, size, settings, &pool);
+		double buildTime = buildTimer.elapsedMilliseconds();
+
+		glm::vec2 extent = lod.extent();
+		glm::vec2 center = extent * 0.5f;
+		float radius = std::min(extent.x, extent.y) * 0.35f;
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.5f, lod.viewDistance());
+		uint64_t fullTriangles = uint64_t(size - 1) * (size - 1) * 2;
+
+		TerrainLodSelection selection;
+		for (int culling = 1; culling >= 0; culling--)
+		{
+			uint64_t triangles = 0, maxTriangles = 0, visited = 0;
+			double milliseconds = 0.0, maxMilliseconds = 0.0;
+			for (int view = 0; view < views; view++)
+			{
+				float angle = glm::two_pi<float>() * view / views;
+				glm::vec3 eye(center.x + radius * std::cos(angle), HEIGHT_SCALE + 30.0f, center.y + radius * std::sin(angle));
+				glm::vec3 forward(-std::sin(angle), -0.3f, std::cos(angle));
+				glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + forward, glm::vec3(0, 1, 0));
+
+				lod.select(viewProjection, eye, selection, culling != 0);
+				triangles += selection.triangles;
+				maxTriangles = std::max(maxTriangles, selection.triangles);
+				visited += selection.visited;
+				milliseconds += selection.milliseconds;
+				maxMilliseconds = std::max(maxMilliseconds, selection.milliseconds);
+			}
+
+			std::cout << std::left << std::setw(8) << size << std::right << std::fixed << std::setprecision(1)
+				<< std::setw(9) << (culling ? "on" : "off")
+				<< std::setw(14) << fullTriangles
+				<< std::setw(12) << triangles / views
+				<< std::setw(12) << maxTriangles
+				<< std::setw(10) << lod.nodeCount()
+				<< std::setw(10) << visited / views
+				<< std::setw(12) << milliseconds * 1000.0 / views
+				<< std::setw(10) << maxMilliseconds * 1000.0
+				<< std::setw(10) << buildTime << std::endl;
+		}
+	}
+
+	std::cout << "grid " << settings.gridResolution << ", " << settings.levels << " levels, level 0 out to " << settings.lodDistance
+		<< ", view distance " << settings.lodDistance * (1 << (settings.levels - 1)) << ". full tris is the whole heightmap as one grid, "
+		<< "visited counts the node boxes tested per view, build ms the min/max tree" << std::endl;
+}
@@ -0,0 +1,193 @@
+#include <glm\glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "MeshOptimizer.h"
+#include "Noise.h"
+#include "TerrainMesh.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+// the Terrain demo's chunk and height scale
+static const uint32_t CHUNK_CELLS = 64;
+static const float HEIGHT_SCALE = 60.0f;
+static const size_t STREAMER_BUDGET = 48 * 1024 * 1024;
+
+// kernel throughput on one bordered grid this many vertices along a side
+static const uint32_t KERNEL_SIDE = 4096;
+static const int KERNEL_RUNS = 5;
+
+struct Layout
+{
+	const char * name;
+	size_t vertexBytes;
+	size_t indexBytes;
+	bool strips;
+};
+
+// createGrid's vertex (position, up normal, uv) and 32 bit list, the streamer's vec3 / vec3 vertex and 16 bit list, and
+// the height and normal vertex with 16 bit strips
+static const Layout layouts[] = {
+	{ "grid", 36, 4, false },
+	{ "chunk list", 24, 2, false },
+	{ "compact", sizeof(TerrainMeshVertex), 2, true },
+};
+
+static void listIndices(vector<uint32_t> & indices, uint32_t cells)
+{
+	uint32_t side = cells + 1;
+	indices.clear();
+	for (uint32_t z = 0; z < cells; z++)
+	{
+		for (uint32_t x = 0; x < cells; x++)
+		{
+			uint32_t v00 = z * side + x, v01 = v00 + 1, v10 = v00 + side, v11 = v10 + 1;
+			uint32_t quad[] = { v00, v10, v01, v01, v10, v11 };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+// the triangles a strip with restarts assembles into, in submission order
+static void stripTriangles(vector<uint32_t> & triangles, const vector<uint16_t> & strip)
+{
+	triangles.clear();
+	size_t start = 0;
+	for (size_t i = 0; i <= strip.size(); i++)
+	{
+		if (i < strip.size() && strip[i] != TERRAIN_RESTART_INDEX) continue;
+		for (size_t k = start; k + 2 < i; k++)
+		{
+			bool odd = (k - start) & 1;
+			triangles.push_back(strip[k + (odd ? 1 : 0)]);
+			triangles.push_back(strip[k + (odd ? 0 : 1)]);
+			triangles.push_back(strip[k + 2]);
+		}
+		start = i + 1;
+	}
+}
+
+static void printLayouts()
+{
+	uint32_t side = CHUNK_CELLS + 1;
+	size_t vertexCount = size_t(side) * side;
+
+	vector<uint32_t> list, strip;
+	listIndices(list, CHUNK_CELLS);
+	vector<uint16_t> strip16;
+	buildTerrainStrips(strip16, CHUNK_CELLS);
+	stripTriangles(strip, strip16);
+
+	std::cout << "one " << CHUNK_CELLS << " x " << CHUNK_CELLS << " chunk, " << vertexCount << " vertices, "
+		<< list.size() / 3 << " triangles" << std::endl;
+	std::cout << std::left << std::setw(12) << "layout"
+		<< std::right << std::setw(8) << "vertex"
+		<< std::setw(10) << "indices"
+		<< std::setw(12) << "vertex KB"
+		<< std::setw(12) << "index KB"
+		<< std::setw(10) << "memory"
+		<< std::setw(8) << "ACMR"
+		<< std::setw(12) << "B / tri"
+		<< std::setw(10) << "fetch"
+		<< std::setw(12) << "in 48 MB" << std::endl;
+
+	double baseMemory = 0.0, baseFetch = 0.0;
+	for (const auto & layout : layouts)
+	{
+		size_t indexCount = layout.strips ? strip16.size() : list.size();
+		const vector<uint32_t> & triangles = layout.strips ? strip : list;
+		VertexCacheStatistics cache = analyzeVertexCache(triangles.data(), triangles.size(), vertexCount);
+
+		size_t vertexBytes = vertexCount * layout.vertexBytes;
+		size_t indexBytes = indexCount * layout.indexBytes;
+		double memory = double(vertexBytes + indexBytes);
+		// what the input assembler reads per triangle: the indices plus a vertex for every post-transform cache miss
+		double fetch = (double(indexBytes) + double(cache.transformedVertices) * layout.vertexBytes) / cache.triangleCount;
+		if (baseMemory == 0.0) {
+			baseMemory = memory;
+			baseFetch = fetch;
+		}
+
+		std::cout << std::left << std::setw(12) << layout.name << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(8) << layout.vertexBytes
+			<< std::setw(10) << indexCount
+			<< std::setw(12) << vertexBytes / 1024.0
+			<< std::setw(12) << indexBytes / 1024.0
+			<< std::setw(9) << memory / baseMemory * 100.0 << "%"
+			<< std::setw(8) << cache.acmr
+			<< std::setw(12) << fetch
+			<< std::setw(9) << fetch / baseFetch * 100.0 << "%"
+			<< std::setw(12) << STREAMER_BUDGET / vertexBytes << std::endl;
+	}
+	std::cout << "memory and fetch relative to the grid layout, ACMR through a " << VERTEX_CACHE_SIZE
+		<< " entry FIFO, in 48 MB is how many chunks the streamer's default budget holds" << std::endl << std::endl;
+}
+
+// what the streamer did before: float normals from the same central differences
+static void referenceNormal(const float * heights, size_t pitch, uint32_t x, uint32_t z, float slopeScale, glm::vec3 & normal)
+{
+	const float * sample = heights + (z + 1) * pitch + x + 1;
+	float dx = (sample[1] - sample[-1]) * slopeScale;
+	float dz = (sample[pitch] - sample[-ptrdiff_t(pitch)]) * slopeScale;
+	normal = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+}
+
+static void printKernel()
+{
+	ThreadPool pool;
+	uint32_t bordered = KERNEL_SIDE + 2;
+	vector<float> heights(size_t(bordered) * bordered);
+	NoiseOptions noise;
+	noise.octaves = 6;
+	noise.frequency = 1.0f / 256.0f;
+	generateNoise(heights.data(), bordered, bordered, bordered, 0.0f, 0.0f, 1.0f, 1.0f, noise, &pool);
+
+	vector<TerrainMeshVertex> vertices(size_t(KERNEL_SIDE) * KERNEL_SIDE);
+	double single = 1e30, parallel = 1e30;
+	for (int run = 0; run < KERNEL_RUNS; run++)
+	{
+		Timer timer;
+		buildTerrainVertices(vertices.data(), heights.data(), KERNEL_SIDE, KERNEL_SIDE, HEIGHT_SCALE, 1.0f);
+		single = std::min(single, timer.elapsedMilliseconds());
+
+		timer.reset();
+		buildTerrainVertices(vertices.data(), heights.data(), KERNEL_SIDE, KERNEL_SIDE, HEIGHT_SCALE, 1.0f, &pool);
+		parallel = std::min(parallel, timer.elapsedMilliseconds());
+	}
+
+	// how much the encoding loses against float heights and normals
+	float heightError = 0.0f, angleError = 0.0f;
+	for (uint32_t z = 0; z < KERNEL_SIDE; z++)
+	{
+		for (uint32_t x = 0; x < KERNEL_SIDE; x++)
+		{
+			const TerrainMeshVertex & vertex = vertices[size_t(z) * KERNEL_SIDE + x];
+			float height = heights[(z + 1) * size_t(bordered) + x + 1] * HEIGHT_SCALE;
+			heightError = std::max(heightError, std::abs(decodeTerrainHeight(vertex, HEIGHT_SCALE) - height));
+
+			glm::vec3 normal, decoded;
+			referenceNormal(heights.data(), bordered, x, z, HEIGHT_SCALE / 2.0f, normal);
+			decodeTerrainNormal(vertex, &decoded[0]);
+			float cosine = glm::dot(normal, glm::normalize(decoded));
+			angleError = std::max(angleError, std::acos(std::min(cosine, 1.0f)));
+		}
+	}
+
+	double mvertices = double(KERNEL_SIDE) * KERNEL_SIDE / 1e6;
+	std::cout << "normal kernel, " << KERNEL_SIDE << " x " << KERNEL_SIDE << " vertices: " << std::fixed << std::setprecision(2)
+		<< single << " ms on 1 thread (" << mvertices / single * 1000.0 << " Mvertices/s), " << parallel << " ms on "
+		<< pool.size() + 1 << " (" << mvertices / parallel * 1000.0 << " Mvertices/s, " << single / parallel << "x)" << std::endl;
+	std::cout << "encoding error: height " << std::setprecision(4) << heightError << " units of " << HEIGHT_SCALE
+		<< ", normal " << std::setprecision(2) << glm::degrees(angleError) << " degrees" << std::endl;
+}
+
+void terrainMeshBenchmark()
+{
+	printLayouts();
+	printKernel();
+}
@@ -0,0 +1,115 @@
+#include <SOIL.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Benchmarks.h"
+
+using std::vector;
+
+static const char * images[] = {
+	"../../Models/Dog/dogColor.png",
+	"../../Models/Dog/dogNormal.png",
+	"../../Models/Dog/dogSpecular.png",
+	"../../Models/Cube/Outdoors/posx.jpg",
+};
+
+// peak signal to noise ratio of the first level over the channels the format keeps
+static double peakSignalToNoise(const uint8_t * original, const uint8_t * decoded, size_t texels, int channels)
+{
+	double squaredError = 0.0;
+	for (size_t i = 0; i < texels; i++)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			double difference = double(original[i * 4 + c]) - decoded[i * 4 + c];
+			squaredError += difference * difference;
+		}
+	}
+	double meanError = squaredError / (texels * channels);
+	return meanError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanError) : 99.0;
+}
+
+void textureBenchmark()
+{
+	ThreadPool pool;
+	vector<uint8_t> uploadBuffer;
+
+	std::cout << std::left << std::setw(38) << "image"
+		<< std::right << std::setw(8) << "format"
+		<< std::setw(12) << "decode ms"
+		<< std::setw(10) << "bake ms"
+		<< std::setw(9) << "map ms"
+		<< std::setw(12) << "RGBA8 KB"
+		<< std::setw(10) << "cache KB"
+		<< std::setw(8) << "ratio"
+		<< std::setw(9) << "PSNR" << std::endl;
+
+	for (auto image : images)
+	{
+		// what every launch paid before the cache, decoding the source with SOIL
+		int width, height, channels;
+		Timer decodeTimer;
+		unsigned char * pixels = SOIL_load_image(image, &width, &height, &channels, SOIL_LOAD_RGBA);
+		double decodeTime = decodeTimer.elapsedMilliseconds();
+		if (!pixels) {
+			std::cout << image << ": failed to load" << std::endl;
+			continue;
+		}
+
+		for (int format = 0; format < TEXTURE_FORMAT_COUNT; format++)
+		{
+			TextureFormat textureFormat = static_cast<TextureFormat>(format);
+			std::string cachePath = std::string(image) + "." + textureFormatName(textureFormat) + ".rwtex";
+
+			Timer bakeTimer;
+			bool normalMap = textureFormat == TEXTURE_FORMAT_BC5;
+			bool baked = bakeTextureCache(image, cachePath.c_str(), textureFormat, normalMap, &pool);
+			double bakeTime = bakeTimer.elapsedMilliseconds();
+
+			// what every launch pays now: map, validate and copy every level out the way glCompressedTexSubImage2D would
+			TextureCache cache;
+			Timer mapTimer;
+			if (!baked || !openTextureCache(cachePath.c_str(), image, textureFormat, cache, normalMap)) {
+				std::cout << image << ": baking " << textureFormatName(textureFormat) << " failed" << std::endl;
+				continue;
+			}
+			uploadBuffer.resize(cache.compressedBytes());
+			size_t uploaded = 0;
+			for (uint32_t level = 0; level < cache.header->levelCount; level++)
+			{
+				memcpy(uploadBuffer.data() + uploaded, cache.levelData(level), static_cast<size_t>(cache.levels[level].size));
+				uploaded += static_cast<size_t>(cache.levels[level].size);
+			}
+			double mapTime = mapTimer.elapsedMilliseconds();
+
+			vector<uint8_t> decoded(size_t(width) * height * 4);
+			decompressImage(decoded.data(), cache.levelData(0), width, height, textureFormat);
+			int comparedChannels = textureFormat == TEXTURE_FORMAT_BC5 ? 2 : textureFormat == TEXTURE_FORMAT_BC1 ? 3 : 4;
+
+			std::cout << std::left << std::setw(38) << (format == 0 ? image : "") << std::right << std::fixed
+				<< std::setw(8) << textureFormatName(textureFormat)
+				<< std::setprecision(2)
+				<< std::setw(12) << decodeTime
+				<< std::setw(10) << bakeTime
+				<< std::setw(9) << mapTime
+				<< std::setw(12) << cache.uncompressedBytes() / 1024
+				<< std::setw(10) << cache.compressedBytes() / 1024
+				<< std::setprecision(1)
+				<< std::setw(7) << double(cache.uncompressedBytes()) / cache.compressedBytes() << "x"
+				<< std::setprecision(2)
+				<< std::setw(9) << peakSignalToNoise(pixels, decoded.data(), size_t(width) * height, comparedChannels) << std::endl;
+		}
+
+		SOIL_free_image_data(pixels);
+	}
+
+	// texture fetches move whole blocks, so the bytes per texel above are also what sampling costs in bandwidth
+	std::cout << "bits per texel: RGBA8 32, bc1 4, bc3 / bc5 / bc7 8" << std::endl;
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cfloat>
+#include <iomanip>
+#include <iostream>
+#include "RaySuite.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Wavefront.h"
+#include "Benchmarks.h"
+
+static const uint32_t WAVEFRONT_RUNS = 3; // the fastest counts
+
+static float maxDifference(const RayImage & a, const RayImage & b)
+{
+	float difference = 0.0f;
+	for (size_t i = 0; i < a.pixels.size(); i++)
+	{
+		glm::vec4 delta = glm::abs(a.pixels[i] - b.pixels[i]);
+		difference = std::max(difference, std::max(std::max(delta.x, delta.y), delta.z));
+	}
+	return difference;
+}
+
+void wavefrontBenchmark()
+{
+	ThreadPool pool;
+	unsigned threads = static_cast<unsigned>(pool.size()) + 1;
+	WavefrontOptions defaults;
+
+	std::cout << std::left << std::setw(11) << "scene"
+		<< std::setw(11) << "renderer"
+		<< std::right << std::setw(9) << "Mrays"
+		<< std::setw(10) << "ms"
+		<< std::setw(9) << "Mrays/s"
+		<< std::setw(10) << "2nd Mrays"
+		<< std::setw(10) << "2nd ms"
+		<< std::setw(9) << "Mrays/s"
+		<< std::setw(8) << "speedup"
+		<< std::setw(10) << "max diff"
+		<< std::setw(9) << "sort ms"
+		<< std::setw(9) << "trace ms"
+		<< std::setw(9) << "shade ms" << std::endl;
+
+	for (const auto & entry : SUITE_ENTRIES)
+	{
+		if (entry.kind == SUITE_SPHERES) continue;
+		SuiteScene suite;
+		if (!loadScene(entry, pool, suite))
+		{
+			std::cout << entry.name << ": failed to load " << entry.model << std::endl;
+			continue;
+		}
+
+		WavefrontScene scene;
+		scene.mesh = suite.mesh.get();
+		scene.instances = suite.field.get();
+		scene.positions = suite.positions.data();
+		scene.indices = suite.indices.data();
+		scene.normalMatrices = suite.normalMatrices.empty() ? nullptr : suite.normalMatrices.data();
+		scene.camera = suite.camera;
+		scene.light = suite.light;
+		const Bvh & top = suite.field ? suite.field->topLevel() : *suite.mesh;
+		scene.boundsMin = top.boundsMin();
+		scene.boundsMax = top.boundsMax();
+		scene.offset = suite.offset;
+
+		RayImage reference;
+		double loopSecondaryRate = 0.0;
+		for (int renderer = 0; renderer < 3; renderer++)
+		{
+			// the camera rays and their shadow rays alone, then the whole paths: the difference is the bounces
+			WavefrontOptions direct = defaults, full = defaults;
+			direct.bounces = 0;
+			direct.sort = full.sort = renderer == 2;
+			auto render = [&](const WavefrontOptions & options, RayImage & image, WavefrontStats & stats) {
+				return renderer == 0 ? renderPerPixel(scene, SUITE_WIDTH, SUITE_HEIGHT, image, options, &pool, &stats)
+					: renderWavefront(scene, SUITE_WIDTH, SUITE_HEIGHT, image, options, &pool, &stats);
+			};
+
+			// the fastest of a few runs each, on the bear the bounces add a tenth of the rays and a few milliseconds
+			RayImage directImage, image;
+			WavefrontStats directStats, stats;
+			uint64_t directRays = 0, rays = 0;
+			double directTime = DBL_MAX, time = DBL_MAX;
+			render(direct, directImage, directStats);
+			for (uint32_t run = 0; run < WAVEFRONT_RUNS; run++)
+			{
+				Timer directTimer;
+				directRays = render(direct, directImage, directStats);
+				directTime = std::min(directTime, directTimer.elapsedMilliseconds());
+				Timer fullTimer;
+				rays = render(full, renderer == 0 ? reference : image, stats);
+				time = std::min(time, fullTimer.elapsedMilliseconds());
+			}
+
+			double secondaryRays = double(rays - directRays), secondaryTime = time - directTime;
+			double secondaryRate = secondaryTime > 0.0 ? secondaryRays / (secondaryTime / 1000.0) / 1e6 : 0.0;
+			if (renderer == 0) loopSecondaryRate = secondaryRate;
+
+			const char * names[] = { "per pixel", "wavefront", "sorted" };
+			std::cout << std::left << std::setw(11) << entry.name
+				<< std::setw(11) << names[renderer]
+				<< std::right << std::fixed << std::setprecision(2)
+				<< std::setw(9) << rays / 1e6
+				<< std::setprecision(1) << std::setw(10) << time
+				<< std::setprecision(2) << std::setw(9) << rays / (time / 1000.0) / 1e6
+				<< std::setw(10) << secondaryRays / 1e6
+				<< std::setprecision(1) << std::setw(10) << secondaryTime
+				<< std::setprecision(2) << std::setw(9) << secondaryRate
+				<< std::setprecision(2) << std::setw(7) << secondaryRate / loopSecondaryRate << "x"
+				<< std::scientific << std::setprecision(1)
+				<< std::setw(10) << (renderer == 0 ? 0.0f : maxDifference(reference, image));
+			std::cout.unsetf(std::ios::floatfield);
+			if (renderer)
+			{
+				std::cout << std::fixed << std::setprecision(1)
+					<< std::setw(9) << stats.sortMilliseconds
+					<< std::setw(9) << stats.intersectMilliseconds + stats.shadowMilliseconds
+					<< std::setw(9) << stats.generateMilliseconds + stats.shadeMilliseconds;
+				std::cout.unsetf(std::ios::floatfield);
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	std::cout << "One path per pixel at " << SUITE_WIDTH << " x " << SUITE_HEIGHT << " through the raysuite cameras: camera ray, "
+		<< "shadow ray to the light and " << defaults.bounces << " diffuse bounces with a shadow ray each, over " << threads
+		<< " threads, the fastest of " << WAVEFRONT_RUNS << " runs. per pixel follows each path to its end before the next pixel, wavefront runs every stage over all "
+		<< "paths of a bounce from structure of arrays queues, sorted also bins the bounce and shadow rays by direction "
+		<< "octant and origin Morton cell first. 2nd counts what the bounces add over a run with camera and shadow rays "
+		<< "only, speedup its throughput against per pixel, max diff the largest color difference to the per pixel image. "
+		<< "trace ms is the intersect and shadow stages, shade ms generation and shading, all summed over the bounces"
+		<< std::endl;
+}
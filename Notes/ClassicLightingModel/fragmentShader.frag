@@ -2,9 +2,13 @@
 
 out vec4 fColor;
 in vec2 texCoord;
-in vec3 normal;
+in vec3 vertexNormal;
+in vec4 vertexTangent;
 in vec3 position;
 
+// the shading normal the lighting subroutines read, vertexNormal bent by the normal map
+vec3 normal;
+
 //light values
 uniform vec3 ambient; 
 uniform vec3 diffuse;
@@ -25,6 +29,7 @@ uniform vec4 light; // this can be direction or position
 uniform vec4 eye; // this can be direction or position
 
 layout(binding=0) uniform sampler2D tex;
+layout(binding=1) uniform sampler2D normalMap; // BC5, only x and y are stored
 
 subroutine vec4 LightFunc(vec4 color);
 
@@ -130,9 +135,26 @@ subroutine (LightFunc) vec4 spotLighting(vec4 color) {
 
 subroutine uniform LightFunc lighting;
 
+// The flip below keeps mesh v pointing up the image, so green is +bitangent like the OpenGL convention the map uses
+vec3 perturbNormal(vec2 uv)
+{
+	vec3 n = normalize(vertexNormal);
+	if (dot(vertexTangent.xyz, vertexTangent.xyz) == 0.0)
+		return n;
+
+	// interpolation leaves the tangent a little off perpendicular, straighten it before building the basis
+	vec3 t = normalize(vertexTangent.xyz - n * dot(n, vertexTangent.xyz));
+	vec3 b = (vertexTangent.w < 0.0 ? -1.0 : 1.0) * cross(n, t);
+
+	vec2 xy = texture(normalMap, uv).rg * 2.0 - 1.0;
+	vec3 mapped = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+	return normalize(mat3(t, b, n) * mapped);
+}
+
 void main() {
 	vec2 flippedTexCoord = vec2(texCoord.x, 1.0f-texCoord.y);
 	vec4 textureColor = texture(tex,flippedTexCoord);
+	normal = perturbNormal(flippedTexCoord);
 	
     fColor = lighting(textureColor);
 }
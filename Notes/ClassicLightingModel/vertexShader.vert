@@ -1,19 +1,20 @@
 #version 440 core
 
-layout (location = 0) in vec4 vPosition;
-layout (location = 1) in vec4 vNormal;
-layout (location = 2) in vec2 vTexCoord;
+// the vertex inputs and decodePosition / decodeNormal / decodeTangent / decodeTexCoord are prepended by VertexFormat
 
 uniform mat4 viewProjection;
 uniform mat4 model;
 uniform mat3 normalMatrix;
 out vec2 texCoord;
-out vec3 normal;
+out vec3 vertexNormal;
+out vec4 vertexTangent; // zero when the layout has no tangents
 out vec3 position;
 
 void main(){
-	texCoord = vTexCoord;
-	normal =  normalize(normalMatrix * vNormal.xyz);
-	position =  (model * vPosition).xyz;
+	texCoord = decodeTexCoord();
+	vertexNormal =  normalize(normalMatrix * decodeNormal());
+	vec4 tangent = decodeTangent();
+	vertexTangent = vec4(normalMatrix * tangent.xyz, tangent.w);
+	position =  (model * decodePosition()).xyz;
     gl_Position = viewProjection * vec4(position,1.0);
 }
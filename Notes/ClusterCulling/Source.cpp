@@ -0,0 +1,278 @@
+#include <glad\glad.h>
+#include <GLFW\glfw3.h>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <streambuf>
+#include <glm\glm.hpp>
+#include <glm\gtx\transform.hpp>
+#include <glm\gtc\random.hpp>
+#include <glm\gtc\type_ptr.hpp>
+#include <vector>
+#include "MeshCache.h"
+#include "Meshlets.h"
+#include "ThreadPool.h"
+#include "GpuTimer.h"
+
+using std::vector;
+
+void error_callback(int error, const char* description)
+{
+	fprintf(stderr, "Error: %s\n", description);
+}
+
+bool culling = true;
+
+static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+	// draw every cluster to compare against
+	if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+		culling = !culling;
+		std::cout << "Cluster culling " << (culling ? "on" : "off") << std::endl;
+	}
+}
+
+void init();
+
+GLFWwindow* window;
+int width, height;
+
+GLuint createShader(const char * filename, GLuint shaderType) {
+
+	std::ifstream shaderCodeStream(filename);
+	if (!shaderCodeStream.is_open()) {
+		std::cout << "The file " << filename << " does not exist!" << std::endl;
+		exit(-1);
+	}
+
+	auto shaderCode = std::string((std::istreambuf_iterator<char>(shaderCodeStream)), std::istreambuf_iterator<char>());
+	auto shaderCharArray = shaderCode.c_str();
+
+	GLuint shader = glCreateShader(shaderType);
+	glShaderSource(shader, 1, &shaderCharArray, nullptr);
+	glCompileShader(shader);
+	GLint status;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+	if (status != GL_TRUE) {
+		GLint logSize = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logSize);
+		char * log = new char[logSize];
+		glGetShaderInfoLog(shader, logSize, nullptr, log);
+		std::cout << "Shader Error: " << log << std::endl;
+		delete[] log;
+		exit(-1);
+	}
+
+	return shader;
+}
+
+int main() {
+	init();
+
+	/*
+	A field of gears drawn cluster by cluster. Every frame the CPU throws away the clusters outside the frustum and
+	the ones whose normal cone faces away from the eye, and whatever is left goes to the GPU as one
+	glMultiDrawElementsIndirect call. C switches the culling off to compare.
+	*/
+
+	ThreadPool pool;
+	MeshCache gearCache;
+	if (!loadMeshCache("../../Models/Gears/Gear.obj", gearCache, &pool)) {
+		std::cout << "Loading scene failed" << std::endl;
+		exit(-1);
+	}
+
+	// clusters are built from the optimized cache at startup, their triangles replace the cache's index buffer
+	MeshletMesh gearMeshlets;
+	auto positions = reinterpret_cast<const float*>(reinterpret_cast<const char*>(gearCache.vertexData()) + gearCache.positionOffset());
+	vector<uint32_t> submeshIndices;
+	for (uint32_t i = 0; i < gearCache.header->submeshCount; i++)
+	{
+		const MeshCacheSubmesh & submesh = gearCache.submeshes[i];
+		submeshIndices.resize(submesh.indexCount);
+		for (uint32_t x = 0; x < submesh.indexCount; x++)
+		{
+			submeshIndices[x] = gearCache.indexSize() == sizeof(GLushort)
+				? reinterpret_cast<const uint16_t*>(gearCache.indexData())[submesh.indexOffset + x]
+				: reinterpret_cast<const uint32_t*>(gearCache.indexData())[submesh.indexOffset + x];
+		}
+		buildMeshlets(gearMeshlets, submeshIndices.data(), submeshIndices.size(), positions + 3 * submesh.vertexOffset, sizeof(float) * 3,
+			submesh.vertexCount, submesh.vertexOffset);
+	}
+	std::cout << "Gear: " << gearMeshlets.triangleCount() << " triangles in " << gearMeshlets.meshlets.size() << " clusters" << std::endl;
+
+	GLuint gearVertexArray;
+	glGenVertexArrays(1, &gearVertexArray);
+	glBindVertexArray(gearVertexArray);
+
+	GLuint gearBuffer; // position, normal
+	glGenBuffers(1, &gearBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, gearBuffer);
+	glBufferData(GL_ARRAY_BUFFER, gearCache.vertexBytes(), gearCache.vertexData(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(gearCache.positionOffset()));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(gearCache.normalOffset()));
+	glEnableVertexAttribArray(1);
+
+	GLuint gearIndexBuffer;
+	glGenBuffers(1, &gearIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gearIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * gearMeshlets.indices.size(), gearMeshlets.indices.data(), GL_STATIC_DRAW);
+
+	// a grid of randomly turned gears around the eye
+	const int gridSize = 12;
+	glm::vec3 extent = glm::make_vec3(gearCache.header->boundsMax) - glm::make_vec3(gearCache.header->boundsMin);
+	float spacing = glm::max(extent.x, glm::max(extent.y, extent.z)) * 1.5f;
+	glm::vec3 gearCenter = (glm::make_vec3(gearCache.header->boundsMax) + glm::make_vec3(gearCache.header->boundsMin)) * 0.5f;
+
+	vector<glm::mat4> models;
+	for (int z = 0; z < gridSize; z++)
+	{
+		for (int x = 0; x < gridSize; x++)
+		{
+			glm::vec3 position = glm::vec3(x - gridSize / 2 + 0.5f, 0.0f, z - gridSize / 2 + 0.5f) * spacing;
+			models.push_back(glm::translate(position)
+				* glm::rotate(glm::linearRand(0.0f, 6.28f), glm::sphericalRand(1.0f))
+				* glm::translate(-gearCenter));
+		}
+	}
+
+	GLuint modelBuffer;
+	glGenBuffers(1, &modelBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, modelBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * models.size(), models.data(), GL_STATIC_DRAW);
+	GLuint matLocation = 2;
+	for (GLuint i = 0; i < 4; i++)
+	{
+		glVertexAttribPointer(matLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<void*>(sizeof(glm::vec4) * i));
+		glEnableVertexAttribArray(matLocation + i);
+		glVertexAttribDivisor(matLocation + i, 1);
+	}
+
+	GLuint indirectBuffer;
+	glGenBuffers(1, &indirectBuffer);
+
+	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
+	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+
+	GLint programStatus;
+	glGetProgramiv(program, GL_LINK_STATUS, &programStatus);
+	if (programStatus != GL_TRUE) {
+		GLint logLength;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+		char * log = new char[logLength];
+		glGetProgramInfoLog(program, logLength, nullptr, log);
+		std::cerr << "Program Error: " << log << std::endl;
+		delete[] log;
+		exit(-1);
+	}
+
+	glDetachShader(program, vertexShader);
+	glDetachShader(program, fragmentShader);
+	glUseProgram(program);
+
+	auto viewProjectionIndex = glGetUniformLocation(program, "viewProjection");
+	glm::vec3 lightDirection = glm::normalize(glm::vec3(-0.3f, -1.0f, -0.5f));
+	glUniform3fv(glGetUniformLocation(program, "lightDirection"), 1, &lightDirection[0]);
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / height, 0.1f, spacing * gridSize * 2.0f);
+
+	MeshletCuller culler(&pool);
+	vector<DrawElementsIndirectCommand> commands;
+	GpuTimer drawTimer;
+	double cullMilliseconds = 0.0;
+	int frame = 0;
+
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
+	while (!glfwWindowShouldClose(window))
+	{
+		// the eye turns around in the middle of the field, so most gears are behind it at any time
+		float time = static_cast<float>(glfwGetTime()) * 0.3f;
+		glm::vec3 eye(0.0f, spacing * 0.5f, 0.0f);
+		glm::vec3 direction(cos(time), -0.25f, sin(time));
+		glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + direction, glm::vec3(0.0f, 1.0f, 0.0f));
+
+		culler.cull(gearMeshlets, models.data(), models.size(), viewProjection, eye, commands, culling);
+		cullMilliseconds += culler.statistics().milliseconds;
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * commands.size(), commands.data(), GL_STREAM_DRAW);
+
+		glViewport(0, 0, width, height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glUniformMatrix4fv(viewProjectionIndex, 1, GL_FALSE, &viewProjection[0][0]);
+
+		drawTimer.begin();
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(commands.size()), 0);
+		drawTimer.end();
+
+		if (++frame % 120 == 0) {
+			const MeshletCullStatistics & statistics = culler.statistics();
+			std::cout << "clusters " << statistics.clusters
+				<< ", frustum culled " << statistics.frustumCulled
+				<< ", backface culled " << statistics.backfaceCulled
+				<< ", triangles culled " << statistics.trianglesCulled << " / " << statistics.triangles
+				<< ", cull " << cullMilliseconds / 120 << " ms"
+				<< ", draw " << drawTimer.averageMilliseconds() << " ms" << std::endl;
+			cullMilliseconds = 0.0;
+			drawTimer.reset();
+		}
+
+#ifndef NDEBUG
+		glFinish();
+#endif
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	drawTimer.release();
+	glDeleteBuffers(1, &indirectBuffer);
+	glDeleteBuffers(1, &modelBuffer);
+	glDeleteBuffers(1, &gearIndexBuffer);
+	glDeleteBuffers(1, &gearBuffer);
+	glDeleteVertexArrays(1, &gearVertexArray);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	glDeleteProgram(program);
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	return 0;
+}
+
+void init() {
+	if (!glfwInit()) {
+		//failed
+		glfwTerminate();
+		exit(-1);
+	}
+
+	glfwSetErrorCallback(error_callback);
+
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+	window = glfwCreateWindow(1024, 768, "Cluster Culling", NULL, NULL);
+	if (!window)
+	{
+		// Window or OpenGL context creation failed
+		glfwTerminate();
+		exit(-1);
+	}
+
+	glfwMakeContextCurrent(window);
+	gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+	glfwSwapInterval(1);
+	glfwGetFramebufferSize(window, &width, &height);
+	glfwSetKeyCallback(window, key_callback);
+	std::cout << "OpenGL Version: " << GLVersion.major << "." << GLVersion.minor << " loaded" << std::endl;
+}
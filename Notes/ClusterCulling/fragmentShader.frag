@@ -0,0 +1,11 @@
+#version 440 core
+
+in vec3 normal;
+out vec4 fColor;
+
+uniform vec3 lightDirection;
+
+void main() {
+	float diffuse = max(dot(normalize(normal), -lightDirection), 0.0);
+    fColor = vec4(vec3(0.15) + vec3(0.6, 0.65, 0.8) * diffuse, 1);
+}
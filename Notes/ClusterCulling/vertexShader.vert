@@ -0,0 +1,13 @@
+#version 440 core
+
+layout (location = 0) in vec4 vPosition;
+layout (location = 1) in vec3 vNormal;
+layout (location = 2) in mat4 model; // per instance, the indirect commands pick it through their baseInstance
+
+uniform mat4 viewProjection;
+out vec3 normal;
+
+void main(){
+	normal = mat3(model) * vNormal;
+    gl_Position = viewProjection * model * vPosition;
+}
@@ -0,0 +1,168 @@
+#include "AssetLoader.h"
+#include <SOIL.h>
+#include <iomanip>
+#include <iostream>
+
+AssetLoader::AssetLoader(ThreadPool & pool) : pool(pool), uploadedCount(0), anyFailed(false), totalMilliseconds(0.0)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+	// the jobs point into assets, nothing may be freed while a worker can still write to it
+	pool.wait();
+
+	for (auto & asset : assets)
+	{
+		if (asset->type == ASSET_IMAGE && asset->image.pixels)
+			SOIL_free_image_data(const_cast<unsigned char*>(asset->image.pixels));
+	}
+}
+
+void AssetLoader::loadMesh(const std::string & path, MeshCache & cache, std::function<void(const MeshCache &)> upload)
+{
+	Asset * asset = new Asset();
+	asset->type = ASSET_MESH;
+	asset->path = path;
+	asset->mesh = &cache;
+	asset->meshUpload = std::move(upload);
+	submit(asset);
+}
+
+void AssetLoader::loadImage(const std::string & path, std::function<void(const LoadedImage &)> upload)
+{
+	Asset * asset = new Asset();
+	asset->type = ASSET_IMAGE;
+	asset->path = path;
+	asset->imageUpload = std::move(upload);
+	submit(asset);
+}
+
+void AssetLoader::loadTexture(const std::string & path, TextureFormat format, TextureCache & cache,
+	std::function<void(const TextureCache &)> upload, bool normalMap)
+{
+	Asset * asset = new Asset();
+	asset->type = ASSET_TEXTURE;
+	asset->path = path;
+	asset->texture = &cache;
+	asset->textureFormat = format;
+	asset->normalMap = normalMap;
+	asset->textureUpload = std::move(upload);
+	submit(asset);
+}
+
+void AssetLoader::submit(Asset * asset)
+{
+	if (uploadedCount == assets.size()) loadTimer.reset();
+	assets.emplace_back(asset);
+
+	pool.submit([this, asset] {
+		Timer timer;
+		decode(*asset);
+		asset->decodeMilliseconds = timer.elapsedMilliseconds();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finished.push_back(asset);
+		}
+		assetFinished.notify_one();
+	});
+}
+
+void AssetLoader::decode(Asset & asset)
+{
+	if (asset.type == ASSET_MESH) {
+		asset.failed = !loadMeshCache(asset.path.c_str(), *asset.mesh, &pool);
+	}
+	else if (asset.type == ASSET_TEXTURE) {
+		asset.failed = !loadTextureCache(asset.path.c_str(), asset.textureFormat, *asset.texture, asset.normalMap, &pool);
+	}
+	else {
+		// SOIL (stb_image underneath) keeps no decoder state between calls, only the failure string is shared
+		asset.image.pixels = SOIL_load_image(asset.path.c_str(), &asset.image.width, &asset.image.height, &asset.image.channels, SOIL_LOAD_AUTO);
+		asset.failed = asset.image.pixels == nullptr;
+	}
+}
+
+void AssetLoader::upload(Asset & asset)
+{
+	if (asset.failed) {
+		std::cout << "Loading " << asset.path << " failed" << std::endl;
+		anyFailed = true;
+	}
+	else {
+		Timer timer;
+		if (asset.type == ASSET_MESH && asset.meshUpload) asset.meshUpload(*asset.mesh);
+		if (asset.type == ASSET_IMAGE && asset.imageUpload) asset.imageUpload(asset.image);
+		if (asset.type == ASSET_TEXTURE && asset.textureUpload) asset.textureUpload(*asset.texture);
+		asset.uploadMilliseconds = timer.elapsedMilliseconds();
+	}
+
+	// the GL copy is made, the decoded pixels are not needed anymore
+	if (asset.type == ASSET_IMAGE && asset.image.pixels) {
+		SOIL_free_image_data(const_cast<unsigned char*>(asset.image.pixels));
+		asset.image.pixels = nullptr;
+	}
+
+	uploadedCount++;
+	if (uploadedCount == assets.size()) totalMilliseconds = loadTimer.elapsedMilliseconds();
+}
+
+bool AssetLoader::pump()
+{
+	std::deque<Asset *> ready;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ready.swap(finished);
+	}
+
+	for (auto asset : ready) upload(*asset);
+	return uploadedCount == assets.size();
+}
+
+bool AssetLoader::finish()
+{
+	while (uploadedCount < assets.size())
+	{
+		Asset * asset;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			assetFinished.wait(lock, [this] { return !finished.empty(); });
+			asset = finished.front();
+			finished.pop_front();
+		}
+
+		upload(*asset);
+	}
+
+	return !anyFailed;
+}
+
+void AssetLoader::printTimings() const
+{
+	double decodeTotal = 0.0;
+	double uploadTotal = 0.0;
+
+	std::cout << std::fixed << std::setprecision(2);
+	for (const auto & asset : assets)
+	{
+		std::cout << std::left << std::setw(48) << asset->path << std::right
+			<< " decode " << std::setw(9) << asset->decodeMilliseconds << " ms"
+			<< "  upload " << std::setw(8) << asset->uploadMilliseconds << " ms";
+
+		// what the compressed chain saves next to uncompressed RGBA8 with mips, texture fetches shrink by the same ratio
+		if (asset->type == ASSET_TEXTURE && !asset->failed) {
+			const TextureCache & texture = *asset->texture;
+			std::cout << "  " << textureFormatName(texture.format()) << " " << texture.compressedBytes() / 1024 << " KB (RGBA8 "
+				<< texture.uncompressedBytes() / 1024 << " KB)";
+		}
+		std::cout << std::endl;
+		decodeTotal += asset->decodeMilliseconds;
+		uploadTotal += asset->uploadMilliseconds;
+	}
+
+	std::cout << assets.size() << " assets on " << pool.size() << " threads: " << totalMilliseconds << " ms total ("
+		<< decodeTotal << " ms decode, " << uploadTotal << " ms upload if done serially)" << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout.precision(6);
+}
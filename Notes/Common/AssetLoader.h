@@ -0,0 +1,96 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+/*Loads the meshes and images a demo needs on a ThreadPool instead of one after another on the main thread.
+
+Workers only do the CPU side (mapping / baking mesh and texture caches, decoding images with SOIL). Every finished
+asset is queued for the GL thread, which runs its upload callback from pump() or finish(), then frees the decoded pixels.
+
+	ThreadPool pool;
+	AssetLoader loader(pool);
+	loader.loadMesh("bear.obj", bearCache);
+	loader.loadImage("face.jpg", [&](const LoadedImage & image) { glTexSubImage2D(...); });
+	loader.loadTexture("face.jpg", TEXTURE_FORMAT_BC7, faceCache, [&](const TextureCache & cache) { faceTexture = createTexture(cache); });
+	if (!loader.finish()) exit(-1); // completion fence, every upload has run once this returns
+	loader.printTimings();*/
+
+struct LoadedImage
+{
+	int width;
+	int height;
+	int channels;
+	const unsigned char * pixels;
+};
+
+class AssetLoader
+{
+public:
+	explicit AssetLoader(ThreadPool & pool);
+	~AssetLoader();
+
+	AssetLoader(const AssetLoader &) = delete;
+	AssetLoader & operator=(const AssetLoader &) = delete;
+
+	// cache has to stay alive until finish() returns, upload (optional) runs on the GL thread once it is mapped
+	void loadMesh(const std::string & path, MeshCache & cache, std::function<void(const MeshCache &)> upload = nullptr);
+
+	// the pixels are only valid during upload, channels is whatever the file has (SOIL_LOAD_AUTO)
+	void loadImage(const std::string & path, std::function<void(const LoadedImage &)> upload);
+
+	// the block compressed mip chain of the image, baked on the first run. cache has to stay alive until finish() returns
+	void loadTexture(const std::string & path, TextureFormat format, TextureCache & cache, std::function<void(const TextureCache &)> upload,
+		bool normalMap = false);
+
+	// GL thread: runs the uploads of everything finished so far without blocking. Returns true when nothing is left.
+	bool pump();
+
+	// GL thread: the completion fence. Uploads assets as they finish until all of them are in,
+	// returns false if any of them failed to load.
+	bool finish();
+
+	void printTimings() const;
+
+private:
+	enum AssetType { ASSET_MESH, ASSET_IMAGE, ASSET_TEXTURE };
+
+	struct Asset
+	{
+		AssetType type;
+		std::string path;
+		MeshCache * mesh;
+		std::function<void(const MeshCache &)> meshUpload;
+		LoadedImage image;
+		std::function<void(const LoadedImage &)> imageUpload;
+		TextureCache * texture;
+		TextureFormat textureFormat;
+		bool normalMap;
+		std::function<void(const TextureCache &)> textureUpload;
+		bool failed;
+		double decodeMilliseconds;
+		double uploadMilliseconds;
+	};
+
+	void submit(Asset * asset);
+	void decode(Asset & asset);
+	void upload(Asset & asset);
+
+	ThreadPool & pool;
+	std::vector<std::unique_ptr<Asset>> assets;
+	std::deque<Asset *> finished;
+	std::mutex mutex;
+	std::condition_variable assetFinished;
+	size_t uploadedCount;
+	bool anyFailed;
+	Timer loadTimer; // started by the first load after the previous finish()
+	double totalMilliseconds;
+};
@@ -0,0 +1,1276 @@
+#include "Bvh.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <emmintrin.h>
+
+// rays per job, enough to pay for the job and small enough that a batch of a few thousand still spreads out
+static const size_t RAY_BLOCK = 256;
+
+// primitives one job bins near the top of the tree, nodes with fewer than two chunks are binned by the job building them
+static const size_t BIN_CHUNK = 32768;
+
+// deeper nodes are made leaves whatever their size, so the traversal stacks below cannot overflow
+static const uint32_t MAX_DEPTH = 64;
+
+static const uint32_t MAX_BINS = 64;
+
+namespace {
+
+struct Box
+{
+	glm::vec3 low = glm::vec3(FLT_MAX);
+	glm::vec3 high = glm::vec3(-FLT_MAX);
+
+	void grow(const glm::vec3 & point) { low = glm::min(low, point); high = glm::max(high, point); }
+	void grow(const Box & box) { low = glm::min(low, box.low); high = glm::max(high, box.high); }
+	float area() const
+	{
+		glm::vec3 extent = high - low;
+		return extent.x < 0.0f ? 0.0f : 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+};
+
+struct Bin
+{
+	Box bounds; // of the primitives
+	Box centroids;
+	uint32_t count = 0;
+};
+
+struct Split
+{
+	int axis = -1; // -1 for none
+	uint32_t bin = 0; // bins [0, bin] go left
+	float cost = FLT_MAX;
+};
+
+struct Builder
+{
+	const BvhOptions & options;
+	ThreadPool * pool;
+	uint32_t binCount;
+	std::vector<Box> primitiveBounds;
+	std::vector<glm::vec3> centroids;
+	std::vector<uint32_t> order; // primitive indices, each node's primitives a contiguous range
+
+	Builder(const BvhOptions & options, ThreadPool * pool)
+		: options(options), pool(pool), binCount(std::min(std::max(options.binCount, 2u), MAX_BINS)) {}
+
+	uint32_t binOf(float centroid, float low, float scale) const
+	{
+		int bin = static_cast<int>((centroid - low) * scale);
+		return static_cast<uint32_t>(std::min(std::max(bin, 0), static_cast<int>(binCount) - 1));
+	}
+
+	// bins[axis * binCount + bin] for the primitives order[first, first + count)
+	void fillBins(uint32_t first, uint32_t count, const Box & centroidBounds, Bin * bins) const
+	{
+		glm::vec3 extent = centroidBounds.high - centroidBounds.low;
+		float scale[3];
+		for (int axis = 0; axis < 3; axis++) scale[axis] = extent[axis] > 0.0f ? binCount / extent[axis] : 0.0f;
+
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			uint32_t primitive = order[i];
+			const glm::vec3 & centroid = centroids[primitive];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				Bin & bin = bins[axis * binCount + binOf(centroid[axis], centroidBounds.low[axis], scale[axis])];
+				bin.bounds.grow(primitiveBounds[primitive]);
+				bin.centroids.grow(centroid);
+				bin.count++;
+			}
+		}
+	}
+
+	Split findSplit(uint32_t first, uint32_t count, const Box & bounds, const Box & centroidBounds, bool parallel) const
+	{
+		std::vector<Bin> bins(3 * binCount);
+		size_t chunks = (count + BIN_CHUNK - 1) / BIN_CHUNK;
+		if (parallel && chunks > 1)
+		{
+			std::vector<Bin> chunkBins(chunks * bins.size());
+			pool->parallelFor(chunks, [&](size_t chunk) {
+				uint32_t begin = static_cast<uint32_t>(chunk * BIN_CHUNK);
+				uint32_t end = std::min(begin + static_cast<uint32_t>(BIN_CHUNK), count);
+				fillBins(first + begin, end - begin, centroidBounds, &chunkBins[chunk * bins.size()]);
+			});
+			for (size_t chunk = 0; chunk < chunks; chunk++)
+			{
+				for (size_t i = 0; i < bins.size(); i++)
+				{
+					const Bin & bin = chunkBins[chunk * bins.size() + i];
+					bins[i].bounds.grow(bin.bounds);
+					bins[i].centroids.grow(bin.centroids);
+					bins[i].count += bin.count;
+				}
+			}
+		}
+		else fillBins(first, count, centroidBounds, bins.data());
+
+		// sweep from the right for the area and count of every right side, then from the left evaluating each split
+		Split best;
+		float inverseArea = 1.0f / bounds.area();
+		float rightArea[MAX_BINS];
+		uint32_t rightCount[MAX_BINS];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (!(centroidBounds.high[axis] > centroidBounds.low[axis])) continue;
+			const Bin * axisBins = &bins[axis * binCount];
+
+			Box right;
+			uint32_t rightPrimitives = 0;
+			for (uint32_t bin = binCount - 1; bin > 0; bin--)
+			{
+				right.grow(axisBins[bin].bounds);
+				rightPrimitives += axisBins[bin].count;
+				rightArea[bin] = right.area();
+				rightCount[bin] = rightPrimitives;
+			}
+
+			Box left;
+			uint32_t leftPrimitives = 0;
+			for (uint32_t bin = 0; bin + 1 < binCount; bin++)
+			{
+				left.grow(axisBins[bin].bounds);
+				leftPrimitives += axisBins[bin].count;
+				if (!leftPrimitives || !rightCount[bin + 1]) continue;
+
+				float cost = options.traversalCost
+					+ (left.area() * leftPrimitives + rightArea[bin + 1] * rightCount[bin + 1]) * inverseArea;
+				if (cost < best.cost)
+				{
+					best.axis = axis;
+					best.bin = bin;
+					best.cost = cost;
+				}
+			}
+		}
+		return best;
+	}
+
+	void rangeBounds(uint32_t first, uint32_t count, Box & bounds, Box & centroidBounds) const
+	{
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			bounds.grow(primitiveBounds[order[i]]);
+			centroidBounds.grow(centroids[order[i]]);
+		}
+	}
+
+	// Appends the subtree over order[first, first + count) to nodes, depth first, its inner nodes pointing at their
+	// second child by index into nodes. Returns the subtree's depth.
+	uint32_t build(uint32_t first, uint32_t count, const Box & bounds, const Box & centroidBounds, uint32_t depth,
+		std::vector<BvhNode> & nodes)
+	{
+		uint32_t node = static_cast<uint32_t>(nodes.size());
+		nodes.push_back({ bounds.low, first, bounds.high, count });
+		if (count <= 1 || depth + 1 >= MAX_DEPTH || !(bounds.area() > 0.0f)) return 1;
+
+		bool parallel = pool && count >= options.parallelThreshold;
+		bool forced = count > options.maxLeafSize;
+		Split split = findSplit(first, count, bounds, centroidBounds, parallel);
+
+		uint32_t leftCount;
+		if (split.axis >= 0 && (forced || split.cost < count))
+		{
+			int axis = split.axis;
+			float low = centroidBounds.low[axis];
+			float scale = binCount / (centroidBounds.high[axis] - low);
+			uint32_t * middle = std::partition(order.data() + first, order.data() + first + count, [&](uint32_t primitive) {
+				return binOf(centroids[primitive][axis], low, scale) <= split.bin;
+			});
+			leftCount = static_cast<uint32_t>(middle - (order.data() + first));
+		}
+		else if (forced)
+		{
+			// every centroid in one spot, any half is as good as the other
+			leftCount = count / 2;
+		}
+		else return 1;
+
+		Box childBounds[2], childCentroids[2];
+		uint32_t childFirst[2] = { first, first + leftCount };
+		uint32_t childCount[2] = { leftCount, count - leftCount };
+		nodes[node].count = 0;
+
+		if (parallel)
+		{
+			std::vector<BvhNode> subtrees[2];
+			uint32_t depths[2];
+			pool->parallelFor(2, [&](size_t side) {
+				rangeBounds(childFirst[side], childCount[side], childBounds[side], childCentroids[side]);
+				depths[side] = build(childFirst[side], childCount[side], childBounds[side], childCentroids[side], depth + 1,
+					subtrees[side]);
+			});
+
+			// the subtrees were numbered from 0, they now start after this node and after the first subtree
+			for (int side = 0; side < 2; side++)
+			{
+				uint32_t offset = static_cast<uint32_t>(nodes.size());
+				if (side == 1) nodes[node].rightOrFirst = offset;
+				for (auto & subtree : subtrees[side])
+				{
+					if (!subtree.count) subtree.rightOrFirst += offset;
+					nodes.push_back(subtree);
+				}
+			}
+			return 1 + std::max(depths[0], depths[1]);
+		}
+
+		rangeBounds(childFirst[0], childCount[0], childBounds[0], childCentroids[0]);
+		uint32_t leftDepth = build(childFirst[0], childCount[0], childBounds[0], childCentroids[0], depth + 1, nodes);
+		nodes[node].rightOrFirst = static_cast<uint32_t>(nodes.size());
+		rangeBounds(childFirst[1], childCount[1], childBounds[1], childCentroids[1]);
+		uint32_t rightDepth = build(childFirst[1], childCount[1], childBounds[1], childCentroids[1], depth + 1, nodes);
+		return 1 + std::max(leftDepth, rightDepth);
+	}
+};
+
+void setSlot(BvhWideNode & wide, uint32_t slot, const BvhNode & node)
+{
+	wide.minX[slot] = node.boundsMin.x;
+	wide.minY[slot] = node.boundsMin.y;
+	wide.minZ[slot] = node.boundsMin.z;
+	wide.maxX[slot] = node.boundsMax.x;
+	wide.maxY[slot] = node.boundsMax.y;
+	wide.maxZ[slot] = node.boundsMax.z;
+	wide.child[slot] = node.rightOrFirst;
+	wide.count[slot] = node.count;
+}
+
+float nodeArea(const BvhNode & node)
+{
+	glm::vec3 extent = node.boundsMax - node.boundsMin;
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+// Appends the wide node standing for binary inner node index and everything under it. Returns its index.
+uint32_t collapse(const std::vector<BvhNode> & nodes, uint32_t index, std::vector<BvhWideNode> & wide)
+{
+	uint32_t children[BVH_WIDTH] = { index + 1, nodes[index].rightOrFirst };
+	uint32_t childCount = 2;
+	while (childCount < BVH_WIDTH)
+	{
+		int largest = -1;
+		for (uint32_t i = 0; i < childCount; i++)
+		{
+			const BvhNode & child = nodes[children[i]];
+			if (!child.count && (largest < 0 || nodeArea(child) > nodeArea(nodes[children[largest]]))) largest = i;
+		}
+		if (largest < 0) break;
+
+		// its first child takes its slot and the second one goes on the end, keeping the depth first order
+		uint32_t opened = children[largest];
+		for (uint32_t i = childCount; i > static_cast<uint32_t>(largest) + 1; i--) children[i] = children[i - 1];
+		children[largest] = opened + 1;
+		children[largest + 1] = nodes[opened].rightOrFirst;
+		childCount++;
+	}
+
+	uint32_t slot = static_cast<uint32_t>(wide.size());
+	wide.emplace_back();
+	for (uint32_t i = 0; i < BVH_WIDTH; i++)
+	{
+		BvhNode empty = { glm::vec3(FLT_MAX), 0, glm::vec3(-FLT_MAX), 0 };
+		setSlot(wide[slot], i, i < childCount ? nodes[children[i]] : empty);
+	}
+	for (uint32_t i = 0; i < childCount; i++)
+	{
+		if (!nodes[children[i]].count)
+		{
+			uint32_t child = collapse(nodes, children[i], wide);
+			wide[slot].child[i] = child;
+		}
+	}
+	return slot;
+}
+
+// The whole tree over the primitive boxes in builder, which fills in the rest. Returns its depth.
+uint32_t buildTree(Builder & builder, std::vector<BvhNode> & nodes)
+{
+	uint32_t count = static_cast<uint32_t>(builder.primitiveBounds.size());
+	builder.centroids.resize(count);
+	builder.order.resize(count);
+
+	size_t chunks = (count + BIN_CHUNK - 1) / BIN_CHUNK;
+	std::vector<Box> chunkBounds(chunks), chunkCentroids(chunks);
+	ThreadPool::forEach(builder.pool, chunks, [&](size_t chunk) {
+		uint32_t begin = static_cast<uint32_t>(chunk * BIN_CHUNK);
+		uint32_t end = std::min(begin + static_cast<uint32_t>(BIN_CHUNK), count);
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const Box & bounds = builder.primitiveBounds[i];
+			builder.centroids[i] = (bounds.low + bounds.high) * 0.5f;
+			builder.order[i] = i;
+			chunkBounds[chunk].grow(bounds);
+			chunkCentroids[chunk].grow(builder.centroids[i]);
+		}
+	});
+
+	Box bounds, centroidBounds;
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+	{
+		bounds.grow(chunkBounds[chunk]);
+		centroidBounds.grow(chunkCentroids[chunk]);
+	}
+	nodes.reserve(count / std::max(builder.options.maxLeafSize / 2, 1u) + 1);
+	return builder.build(0, count, bounds, centroidBounds, 0, nodes);
+}
+
+// the sign of every direction component decides which face of a box the ray enters through
+struct RaySetup
+{
+	glm::vec3 origin;
+	glm::vec3 inverse;
+	bool negative[3];
+
+	RaySetup(const BvhRay & ray) : origin(ray.origin)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			// a tiny component instead of 0 keeps the slabs finite and the comparisons free of NaN
+			float direction = ray.direction[axis];
+			if (std::fabs(direction) < 1e-20f) direction = direction < 0.0f ? -1e-20f : 1e-20f;
+			inverse[axis] = 1.0f / direction;
+			negative[axis] = inverse[axis] < 0.0f;
+		}
+	}
+
+	// entry distance into the box if the ray crosses it within [start, end], otherwise FLT_MAX
+	float enter(const glm::vec3 & low, const glm::vec3 & high, float start, float end) const
+	{
+		float tNear = start, tFar = end;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float nearPlane = negative[axis] ? high[axis] : low[axis];
+			float farPlane = negative[axis] ? low[axis] : high[axis];
+			tNear = std::max(tNear, (nearPlane - origin[axis]) * inverse[axis]);
+			tFar = std::min(tFar, (farPlane - origin[axis]) * inverse[axis]);
+		}
+		return tNear <= tFar ? tNear : FLT_MAX;
+	}
+};
+
+// Moller-Trumbore against the stored vertex and edges, a hit strictly between start and end
+bool intersectTriangle(const BvhTriangle & triangle, const BvhRay & ray, float start, float end, float & distance,
+	float & u, float & v)
+{
+	glm::vec3 p = glm::cross(ray.direction, triangle.edge2);
+	float determinant = glm::dot(triangle.edge1, p);
+	if (std::fabs(determinant) < 1e-12f) return false;
+	float inverse = 1.0f / determinant;
+
+	glm::vec3 s = ray.origin - triangle.vertex;
+	u = glm::dot(s, p) * inverse;
+	if (u < 0.0f || u > 1.0f) return false;
+	glm::vec3 q = glm::cross(s, triangle.edge1);
+	v = glm::dot(ray.direction, q) * inverse;
+	if (v < 0.0f || u + v > 1.0f) return false;
+
+	distance = glm::dot(triangle.edge2, q) * inverse;
+	return distance > start && distance < end;
+}
+
+struct StackEntry
+{
+	uint32_t node; // node index, or first triangle
+	uint32_t count; // triangles for a leaf of a wide node
+	float distance; // where the ray enters its box
+};
+
+// all four lanes set where the bit of the lane is
+__m128 laneSelect(uint32_t mask)
+{
+	__m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+	return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(mask)), bits), bits));
+}
+
+__m128 blend(__m128 select, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(select, a), _mm_andnot_ps(select, b));
+}
+
+uint32_t laneCount(uint32_t mask)
+{
+	return (mask & 1) + (mask >> 1 & 1) + (mask >> 2 & 1) + (mask >> 3 & 1);
+}
+
+uint32_t smallestBit(uint32_t mask)
+{
+	uint32_t lane = 0;
+	while (!(mask & (1u << lane))) lane++;
+	return lane;
+}
+
+float smallestLane(__m128 x)
+{
+	x = _mm_min_ps(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)));
+	x = _mm_min_ps(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_cvtss_f32(x);
+}
+
+BvhRay laneRay(const BvhPacket & packet, uint32_t lane)
+{
+	BvhRay ray;
+	ray.origin = glm::vec3(packet.originX[lane], packet.originY[lane], packet.originZ[lane]);
+	ray.direction = glm::vec3(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]);
+	ray.minDistance = packet.minDistance[lane];
+	ray.maxDistance = packet.maxDistance[lane];
+	return ray;
+}
+
+// the lanes of the packet whose direction is negative along each axis
+void negativeLanes(const BvhPacket & packet, uint32_t negative[3])
+{
+	const float * directions[3] = { packet.directionX, packet.directionY, packet.directionZ };
+	for (int axis = 0; axis < 3; axis++)
+		negative[axis] = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(directions[axis]), _mm_setzero_ps()))) & packet.mask;
+}
+
+// Whether the packet's rays all point into the same octant, so one sign per axis picks the near and far planes of a
+// box for all of them. Rays in different octants share few nodes and go one at a time.
+bool sameOctant(const BvhPacket & packet)
+{
+	uint32_t negative[3];
+	negativeLanes(packet, negative);
+	uint32_t lanes = packet.mask & ((1u << BVH_PACKET) - 1);
+	return (!negative[0] || negative[0] == lanes) && (!negative[1] || negative[1] == lanes) && (!negative[2] || negative[2] == lanes);
+}
+
+// a RaySetup in every lane, for a packet of rays in the same octant
+struct PacketSetup
+{
+	__m128 origin[3];
+	__m128 direction[3];
+	__m128 inverse[3];
+	__m128 start;
+	bool negative[3];
+
+	PacketSetup(const BvhPacket & packet)
+	{
+		const float * origins[3] = { packet.originX, packet.originY, packet.originZ };
+		const float * directions[3] = { packet.directionX, packet.directionY, packet.directionZ };
+		__m128 tiny = _mm_set1_ps(1e-20f), sign = _mm_set1_ps(-0.0f);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			origin[axis] = _mm_loadu_ps(origins[axis]);
+			direction[axis] = _mm_loadu_ps(directions[axis]);
+			__m128 small = _mm_cmplt_ps(_mm_andnot_ps(sign, direction[axis]), tiny);
+			__m128 replacement = _mm_or_ps(tiny, _mm_and_ps(_mm_cmplt_ps(direction[axis], _mm_setzero_ps()), sign));
+			inverse[axis] = _mm_div_ps(_mm_set1_ps(1.0f), blend(small, replacement, direction[axis]));
+		}
+		start = _mm_loadu_ps(packet.minDistance);
+		uint32_t lanes[3];
+		negativeLanes(packet, lanes);
+		for (int axis = 0; axis < 3; axis++) negative[axis] = lanes[axis] != 0;
+	}
+
+	// the lanes that cross the box within [start, end], and where each enters it
+	uint32_t enter(const glm::vec3 & low, const glm::vec3 & high, __m128 end, __m128 & distance) const
+	{
+		__m128 tNear = start, tFar = end;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float nearPlane = negative[axis] ? high[axis] : low[axis];
+			float farPlane = negative[axis] ? low[axis] : high[axis];
+			tNear = _mm_max_ps(tNear, _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(nearPlane), origin[axis]), inverse[axis]));
+			tFar = _mm_min_ps(tFar, _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(farPlane), origin[axis]), inverse[axis]));
+		}
+		distance = tNear;
+		return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+	}
+};
+
+// intersectTriangle in every lane, the same operations in the same order: the lanes with a hit between start and end
+uint32_t intersectTriangle(const BvhTriangle & triangle, const PacketSetup & ray, __m128 end, __m128 & distance,
+	__m128 & u, __m128 & v)
+{
+	const __m128 * d = ray.direction;
+	__m128 edge1[3] = { _mm_set1_ps(triangle.edge1.x), _mm_set1_ps(triangle.edge1.y), _mm_set1_ps(triangle.edge1.z) };
+	__m128 edge2[3] = { _mm_set1_ps(triangle.edge2.x), _mm_set1_ps(triangle.edge2.y), _mm_set1_ps(triangle.edge2.z) };
+	__m128 p[3] = {
+		_mm_sub_ps(_mm_mul_ps(d[1], edge2[2]), _mm_mul_ps(edge2[1], d[2])),
+		_mm_sub_ps(_mm_mul_ps(d[2], edge2[0]), _mm_mul_ps(edge2[2], d[0])),
+		_mm_sub_ps(_mm_mul_ps(d[0], edge2[1]), _mm_mul_ps(edge2[0], d[1])) };
+	__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1[0], p[0]), _mm_mul_ps(edge1[1], p[1])), _mm_mul_ps(edge1[2], p[2]));
+	__m128 valid = _mm_cmpnlt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), determinant), _mm_set1_ps(1e-12f));
+	if (!_mm_movemask_ps(valid)) return 0;
+	__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+	__m128 s[3] = {
+		_mm_sub_ps(ray.origin[0], _mm_set1_ps(triangle.vertex.x)),
+		_mm_sub_ps(ray.origin[1], _mm_set1_ps(triangle.vertex.y)),
+		_mm_sub_ps(ray.origin[2], _mm_set1_ps(triangle.vertex.z)) };
+	u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(s[0], p[0]), _mm_mul_ps(s[1], p[1])), _mm_mul_ps(s[2], p[2])), inverse);
+	valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpnlt_ps(u, _mm_setzero_ps()), _mm_cmpngt_ps(u, _mm_set1_ps(1.0f))));
+	if (!_mm_movemask_ps(valid)) return 0;
+	__m128 q[3] = {
+		_mm_sub_ps(_mm_mul_ps(s[1], edge1[2]), _mm_mul_ps(edge1[1], s[2])),
+		_mm_sub_ps(_mm_mul_ps(s[2], edge1[0]), _mm_mul_ps(edge1[2], s[0])),
+		_mm_sub_ps(_mm_mul_ps(s[0], edge1[1]), _mm_mul_ps(edge1[0], s[1])) };
+	v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], q[0]), _mm_mul_ps(d[1], q[1])), _mm_mul_ps(d[2], q[2])), inverse);
+	valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpnlt_ps(v, _mm_setzero_ps()), _mm_cmpngt_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f))));
+
+	distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2[0], q[0]), _mm_mul_ps(edge2[1], q[1])), _mm_mul_ps(edge2[2], q[2])), inverse);
+	valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpgt_ps(distance, ray.start), _mm_cmplt_ps(distance, end)));
+	return static_cast<uint32_t>(_mm_movemask_ps(valid));
+}
+
+struct PacketEntry
+{
+	__m128 distance; // where each lane enters the box
+	uint32_t node; // node index, or first triangle
+	uint32_t count; // triangles for a leaf of a wide node
+	uint32_t mask; // the lanes that enter it
+	float nearest; // the smallest of their distances, which orders the children
+};
+
+}
+
+void Bvh::build(const float * positions, size_t positionStride, const uint32_t * indices, size_t indexCount,
+	const BvhOptions & options, ThreadPool * pool)
+{
+	clear(options);
+	uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+	if (!triangleCount) return;
+
+	auto vertex = [&](uint32_t index) {
+		const float * p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + index * positionStride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	Builder builder(options, pool);
+	builder.primitiveBounds.resize(triangleCount);
+	size_t chunks = (triangleCount + BIN_CHUNK - 1) / BIN_CHUNK;
+	ThreadPool::forEach(pool, chunks, [&](size_t chunk) {
+		uint32_t begin = static_cast<uint32_t>(chunk * BIN_CHUNK);
+		uint32_t end = std::min(begin + static_cast<uint32_t>(BIN_CHUNK), triangleCount);
+		for (uint32_t triangle = begin; triangle < end; triangle++)
+		{
+			Box & bounds = builder.primitiveBounds[triangle];
+			bounds.grow(vertex(indices[triangle * 3 + 0]));
+			bounds.grow(vertex(indices[triangle * 3 + 1]));
+			bounds.grow(vertex(indices[triangle * 3 + 2]));
+		}
+	});
+	treeDepth = buildTree(builder, binaryNodes);
+
+	leafTriangles.resize(triangleCount);
+	ThreadPool::forEach(pool, chunks, [&](size_t chunk) {
+		uint32_t begin = static_cast<uint32_t>(chunk * BIN_CHUNK);
+		uint32_t end = std::min(begin + static_cast<uint32_t>(BIN_CHUNK), triangleCount);
+		for (uint32_t i = begin; i < end; i++)
+		{
+			uint32_t triangle = builder.order[i];
+			glm::vec3 a = vertex(indices[triangle * 3 + 0]);
+			BvhTriangle & stored = leafTriangles[i];
+			stored.vertex = a;
+			stored.index = triangle;
+			stored.edge1 = vertex(indices[triangle * 3 + 1]) - a;
+			stored.edge2 = vertex(indices[triangle * 3 + 2]) - a;
+			stored.padding1 = stored.padding2 = 0.0f;
+		}
+	});
+
+	leafPrimitives.swap(builder.order);
+	finish(options);
+}
+
+void Bvh::buildFromBounds(const glm::vec3 * boundsMin, const glm::vec3 * boundsMax, size_t count, const BvhOptions & options,
+	ThreadPool * pool)
+{
+	clear(options);
+	if (!count) return;
+
+	Builder builder(options, pool);
+	builder.primitiveBounds.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		builder.primitiveBounds[i].low = boundsMin[i];
+		builder.primitiveBounds[i].high = boundsMax[i];
+	}
+	treeDepth = buildTree(builder, binaryNodes);
+
+	leafPrimitives.swap(builder.order);
+	finish(options);
+}
+
+void Bvh::clear(const BvhOptions & options)
+{
+	binaryNodes.clear();
+	fourWideNodes.clear();
+	leafTriangles.clear();
+	leafPrimitives.clear();
+	nodeCost = options.traversalCost;
+	treeDepth = leaves = 0;
+}
+
+void Bvh::finish(const BvhOptions & options)
+{
+	for (const auto & node : binaryNodes) leaves += node.count ? 1 : 0;
+
+	if (options.wide)
+	{
+		fourWideNodes.reserve(binaryNodes.size() / 2 + 1);
+		if (binaryNodes[0].count)
+		{
+			// a single leaf still needs a node to hang from
+			fourWideNodes.emplace_back();
+			BvhNode empty = { glm::vec3(FLT_MAX), 0, glm::vec3(-FLT_MAX), 0 };
+			for (uint32_t i = 0; i < BVH_WIDTH; i++) setSlot(fourWideNodes[0], i, i ? empty : binaryNodes[0]);
+		}
+		else collapse(binaryNodes, 0, fourWideNodes);
+	}
+}
+
+float Bvh::sahCost() const
+{
+	if (binaryNodes.empty()) return 0.0f;
+	float rootArea = nodeArea(binaryNodes[0]);
+	if (!(rootArea > 0.0f)) return static_cast<float>(binaryNodes[0].count);
+
+	double cost = 0.0;
+	for (const auto & node : binaryNodes)
+		cost += nodeArea(node) / rootArea * (node.count ? node.count : nodeCost);
+	return static_cast<float>(cost);
+}
+
+template <bool anyHit>
+bool Bvh::traverse(const BvhRay & ray, BvhHit & hit, BvhStats * stats) const
+{
+	hit.hit = false;
+	if (leafTriangles.empty()) return false;
+
+	RaySetup setup(ray);
+	float nearest = ray.maxDistance;
+	uint64_t nodes = 0, boxes = 1, triangles = 0;
+
+	StackEntry stack[MAX_DEPTH];
+	uint32_t stackSize = 0;
+	uint32_t index = 0;
+	bool visit = setup.enter(binaryNodes[0].boundsMin, binaryNodes[0].boundsMax, ray.minDistance, nearest) != FLT_MAX;
+	while (visit)
+	{
+		const BvhNode & node = binaryNodes[index];
+		nodes++;
+		if (node.count)
+		{
+			for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++)
+			{
+				triangles++;
+				float distance, u, v;
+				if (intersectTriangle(leafTriangles[i], ray, ray.minDistance, nearest, distance, u, v))
+				{
+					nearest = distance;
+					hit.hit = true;
+					hit.distance = distance;
+					hit.triangle = leafTriangles[i].index;
+					hit.u = u;
+					hit.v = v;
+					if (anyHit) break;
+				}
+			}
+			if (anyHit && hit.hit) break;
+		}
+		else
+		{
+			// the nearer child next, the farther one for later
+			uint32_t first = index + 1, second = node.rightOrFirst;
+			float firstDistance = setup.enter(binaryNodes[first].boundsMin, binaryNodes[first].boundsMax, ray.minDistance, nearest);
+			float secondDistance = setup.enter(binaryNodes[second].boundsMin, binaryNodes[second].boundsMax, ray.minDistance, nearest);
+			boxes += 2;
+			if (secondDistance < firstDistance)
+			{
+				std::swap(first, second);
+				std::swap(firstDistance, secondDistance);
+			}
+			if (firstDistance != FLT_MAX)
+			{
+				if (secondDistance != FLT_MAX) stack[stackSize++] = { second, 0, secondDistance };
+				index = first;
+				continue;
+			}
+		}
+
+		// back to the nearest postponed node the ray can still reach before the best hit so far
+		visit = false;
+		while (stackSize)
+		{
+			const StackEntry & entry = stack[--stackSize];
+			if (entry.distance <= nearest)
+			{
+				index = entry.node;
+				visit = true;
+				break;
+			}
+		}
+	}
+
+	if (stats)
+	{
+		stats->rays++;
+		stats->hits += hit.hit ? 1 : 0;
+		stats->nodes += nodes;
+		stats->boxes += boxes;
+		stats->triangles += triangles;
+	}
+	return hit.hit;
+}
+
+// The single ray walk of the wide layout from first on, nearest the best hit so far. traverseWide starts it at the root,
+// a packet hands over the walks of rays it is down to one of.
+template <bool anyHit>
+static void walkWide(const std::vector<BvhWideNode> & wideNodes, const std::vector<BvhTriangle> & triangles,
+	const BvhRay & ray, const RaySetup & setup, StackEntry first, float & nearest, BvhHit & hit, BvhStats & counts)
+{
+	__m128 originX = _mm_set1_ps(setup.origin.x), originY = _mm_set1_ps(setup.origin.y), originZ = _mm_set1_ps(setup.origin.z);
+	__m128 inverseX = _mm_set1_ps(setup.inverse.x), inverseY = _mm_set1_ps(setup.inverse.y), inverseZ = _mm_set1_ps(setup.inverse.z);
+	__m128 start = _mm_set1_ps(ray.minDistance);
+
+	// a node pushes at most three entries more than it pops
+	StackEntry stack[MAX_DEPTH * (BVH_WIDTH - 1) + 1];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = first;
+	while (stackSize)
+	{
+		StackEntry entry = stack[--stackSize];
+		if (entry.distance > nearest) continue;
+
+		if (entry.count)
+		{
+			for (uint32_t i = entry.node; i < entry.node + entry.count; i++)
+			{
+				counts.triangles++;
+				float distance, u, v;
+				if (intersectTriangle(triangles[i], ray, ray.minDistance, nearest, distance, u, v))
+				{
+					nearest = distance;
+					hit.hit = true;
+					hit.distance = distance;
+					hit.triangle = triangles[i].index;
+					hit.u = u;
+					hit.v = v;
+					if (anyHit) break;
+				}
+			}
+			if (anyHit && hit.hit) break;
+			continue;
+		}
+
+		const BvhWideNode & node = wideNodes[entry.node];
+		counts.nodes++;
+		counts.boxes += BVH_WIDTH;
+		__m128 nearX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(setup.negative[0] ? node.maxX : node.minX), originX), inverseX);
+		__m128 farX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(setup.negative[0] ? node.minX : node.maxX), originX), inverseX);
+		__m128 nearY = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(setup.negative[1] ? node.maxY : node.minY), originY), inverseY);
+		__m128 farY = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(setup.negative[1] ? node.minY : node.maxY), originY), inverseY);
+		__m128 nearZ = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(setup.negative[2] ? node.maxZ : node.minZ), originZ), inverseZ);
+		__m128 farZ = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(setup.negative[2] ? node.minZ : node.maxZ), originZ), inverseZ);
+		__m128 enter = _mm_max_ps(_mm_max_ps(nearX, nearY), _mm_max_ps(nearZ, start));
+		__m128 leave = _mm_min_ps(_mm_min_ps(farX, farY), _mm_min_ps(farZ, _mm_set1_ps(nearest)));
+		int mask = _mm_movemask_ps(_mm_cmple_ps(enter, leave));
+		if (!mask) continue;
+
+		float distances[BVH_WIDTH];
+		_mm_storeu_ps(distances, enter);
+
+		// farthest pushed first so the nearest comes off the stack next
+		StackEntry children[BVH_WIDTH];
+		uint32_t childCount = 0;
+		for (uint32_t i = 0; i < BVH_WIDTH; i++)
+		{
+			if (!(mask & (1 << i))) continue;
+			StackEntry child = { node.child[i], node.count[i], distances[i] };
+			uint32_t at = childCount++;
+			for (; at > 0 && children[at - 1].distance < child.distance; at--) children[at] = children[at - 1];
+			children[at] = child;
+		}
+		for (uint32_t i = 0; i < childCount; i++) stack[stackSize++] = children[i];
+	}
+}
+
+template <bool anyHit>
+bool Bvh::traverseWide(const BvhRay & ray, BvhHit & hit, BvhStats * stats) const
+{
+	hit.hit = false;
+	if (fourWideNodes.empty() || leafTriangles.empty()) return false;
+
+	RaySetup setup(ray);
+	float nearest = ray.maxDistance;
+	BvhStats counts;
+	counts.boxes = 1;
+	if (setup.enter(binaryNodes[0].boundsMin, binaryNodes[0].boundsMax, ray.minDistance, nearest) != FLT_MAX)
+		walkWide<anyHit>(fourWideNodes, leafTriangles, ray, setup, { 0, 0, ray.minDistance }, nearest, hit, counts);
+
+	if (stats)
+	{
+		stats->rays++;
+		stats->hits += hit.hit ? 1 : 0;
+		stats->nodes += counts.nodes;
+		stats->boxes += counts.boxes;
+		stats->triangles += counts.triangles;
+	}
+	return hit.hit;
+}
+
+template <bool anyHit>
+uint32_t Bvh::traversePacket(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats) const
+{
+	hits.mask = 0;
+	uint32_t live = packet.mask & ((1u << BVH_PACKET) - 1); // lanes still looking, an any hit lane stops at its first
+	if (fourWideNodes.empty() || leafTriangles.empty() || !live) return 0;
+
+	PacketSetup setup(packet);
+	__m128 nearest = _mm_loadu_ps(packet.maxDistance);
+	__m128 hitU = _mm_setzero_ps(), hitV = _mm_setzero_ps();
+	__m128i hitTriangle = _mm_setzero_si128();
+	uint64_t nodes = 0, boxes = laneCount(live), triangles = 0;
+
+	// a node pushes at most three entries more than it pops
+	PacketEntry stack[MAX_DEPTH * (BVH_WIDTH - 1) + 1];
+	uint32_t stackSize = 0;
+	PacketEntry root = { _mm_setzero_ps(), 0, 0, 0, 0.0f };
+	root.mask = setup.enter(binaryNodes[0].boundsMin, binaryNodes[0].boundsMax, nearest, root.distance) & live;
+	if (root.mask) stack[stackSize++] = root;
+	while (stackSize)
+	{
+		// the lanes that entered the box and can still find something in it nearer than what they have
+		const PacketEntry entry = stack[--stackSize];
+		uint32_t active = entry.mask & live & static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(entry.distance, nearest)));
+		if (!active) continue;
+
+		// a single lane is cheaper on its own, it walks the subtree the single ray way and its result goes back in
+		if (!(active & (active - 1)))
+		{
+			uint32_t lane = smallestBit(active);
+			float laneValues[BVH_PACKET];
+			_mm_storeu_ps(laneValues, nearest);
+			BvhRay ray = laneRay(packet, lane);
+			ray.maxDistance = laneValues[lane];
+			_mm_storeu_ps(laneValues, entry.distance);
+			BvhHit hit;
+			BvhStats counts;
+			walkWide<anyHit>(fourWideNodes, leafTriangles, ray, RaySetup(ray), { entry.node, entry.count, laneValues[lane] },
+				ray.maxDistance, hit, counts);
+			nodes += counts.nodes;
+			boxes += counts.boxes;
+			triangles += counts.triangles;
+			if (!hit.hit) continue;
+
+			__m128 select = laneSelect(active);
+			nearest = blend(select, _mm_set1_ps(hit.distance), nearest);
+			hitU = blend(select, _mm_set1_ps(hit.u), hitU);
+			hitV = blend(select, _mm_set1_ps(hit.v), hitV);
+			__m128i index = _mm_set1_epi32(static_cast<int>(hit.triangle));
+			hitTriangle = _mm_or_si128(_mm_and_si128(_mm_castps_si128(select), index), _mm_andnot_si128(_mm_castps_si128(select), hitTriangle));
+			hits.mask |= active;
+			if (anyHit)
+			{
+				live &= ~active;
+				if (!live) break;
+			}
+			continue;
+		}
+
+		if (entry.count)
+		{
+			for (uint32_t i = entry.node; i < entry.node + entry.count; i++)
+			{
+				triangles += laneCount(active);
+				__m128 distance, u, v;
+				uint32_t found = intersectTriangle(leafTriangles[i], setup, nearest, distance, u, v) & active;
+				if (!found) continue;
+				__m128 select = laneSelect(found);
+				nearest = blend(select, distance, nearest);
+				hitU = blend(select, u, hitU);
+				hitV = blend(select, v, hitV);
+				__m128i index = _mm_set1_epi32(static_cast<int>(leafTriangles[i].index));
+				hitTriangle = _mm_or_si128(_mm_and_si128(_mm_castps_si128(select), index), _mm_andnot_si128(_mm_castps_si128(select), hitTriangle));
+				hits.mask |= found;
+				if (anyHit)
+				{
+					live &= ~found;
+					active &= ~found;
+					if (!active) break;
+				}
+			}
+			if (anyHit && !live) break;
+			continue;
+		}
+
+		// the lanes that did not come along miss every child
+		const BvhWideNode & node = fourWideNodes[entry.node];
+		nodes++;
+		boxes += BVH_WIDTH * laneCount(active);
+		__m128 end = blend(laneSelect(active), nearest, _mm_set1_ps(-FLT_MAX));
+
+		// farthest pushed first so the nearest comes off the stack next
+		PacketEntry children[BVH_WIDTH];
+		uint32_t childCount = 0;
+		for (uint32_t i = 0; i < BVH_WIDTH; i++)
+		{
+			PacketEntry child = { _mm_setzero_ps(), node.child[i], node.count[i], 0, 0.0f };
+			child.mask = setup.enter(glm::vec3(node.minX[i], node.minY[i], node.minZ[i]), glm::vec3(node.maxX[i], node.maxY[i], node.maxZ[i]),
+				end, child.distance);
+			if (!child.mask) continue;
+			child.nearest = smallestLane(blend(laneSelect(child.mask), child.distance, _mm_set1_ps(FLT_MAX)));
+			uint32_t at = childCount++;
+			for (; at > 0 && children[at - 1].nearest < child.nearest; at--) children[at] = children[at - 1];
+			children[at] = child;
+		}
+		for (uint32_t i = 0; i < childCount; i++) stack[stackSize++] = children[i];
+	}
+
+	_mm_storeu_ps(hits.distance, nearest);
+	_mm_storeu_ps(hits.u, hitU);
+	_mm_storeu_ps(hits.v, hitV);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(hits.triangle), hitTriangle);
+	for (uint32_t lane = 0; lane < BVH_PACKET; lane++) hits.instance[lane] = 0;
+
+	if (stats)
+	{
+		stats->rays += laneCount(packet.mask & ((1u << BVH_PACKET) - 1));
+		stats->hits += laneCount(hits.mask);
+		stats->nodes += nodes;
+		stats->boxes += boxes;
+		stats->triangles += triangles;
+	}
+	return hits.mask;
+}
+
+bool Bvh::intersect(const BvhRay & ray, BvhHit & hit, BvhStats * stats, bool wide) const
+{
+	return wide && !fourWideNodes.empty() ? traverseWide<false>(ray, hit, stats) : traverse<false>(ray, hit, stats);
+}
+
+bool Bvh::occluded(const BvhRay & ray, BvhStats * stats, bool wide) const
+{
+	BvhHit hit;
+	return wide && !fourWideNodes.empty() ? traverseWide<true>(ray, hit, stats) : traverse<true>(ray, hit, stats);
+}
+
+void Bvh::intersect(const BvhRay * rays, BvhHit * hits, size_t count, ThreadPool * pool, BvhStats * stats, bool wide) const
+{
+	size_t blocks = (count + RAY_BLOCK - 1) / RAY_BLOCK;
+	std::vector<BvhStats> blockStats(stats ? blocks : 0);
+
+	ThreadPool::forEach(pool, blocks, [&](size_t block) {
+		size_t begin = block * RAY_BLOCK, end = std::min(begin + RAY_BLOCK, count);
+		BvhStats * local = stats ? &blockStats[block] : nullptr;
+		for (size_t i = begin; i < end; i++) intersect(rays[i], hits[i], local, wide);
+	});
+
+	if (!stats) return;
+	for (const auto & block : blockStats)
+	{
+		stats->rays += block.rays;
+		stats->hits += block.hits;
+		stats->nodes += block.nodes;
+		stats->boxes += block.boxes;
+		stats->triangles += block.triangles;
+	}
+}
+
+uint32_t Bvh::intersect(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats) const
+{
+	bool wide = !fourWideNodes.empty();
+	if (wide && sameOctant(packet)) return traversePacket<false>(packet, hits, stats);
+
+	hits.mask = 0;
+	for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+	{
+		BvhHit hit;
+		if (!(packet.mask & (1u << lane)) || !intersect(laneRay(packet, lane), hit, stats, wide)) continue;
+		hits.mask |= 1u << lane;
+		hits.distance[lane] = hit.distance;
+		hits.triangle[lane] = hit.triangle;
+		hits.u[lane] = hit.u;
+		hits.v[lane] = hit.v;
+		hits.instance[lane] = 0;
+	}
+	return hits.mask;
+}
+
+uint32_t Bvh::occluded(const BvhPacket & packet, BvhStats * stats) const
+{
+	BvhPacketHit hits;
+	bool wide = !fourWideNodes.empty();
+	if (wide && sameOctant(packet)) return traversePacket<true>(packet, hits, stats);
+
+	uint32_t blocked = 0;
+	for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+	{
+		if (packet.mask & (1u << lane) && occluded(laneRay(packet, lane), stats, wide)) blocked |= 1u << lane;
+	}
+	return blocked;
+}
+
+void BvhInstances::build(const BvhInstance * instances, size_t count, const BvhOptions & options, ThreadPool * pool)
+{
+	// the world box of an instance is the box around its mesh's eight corners, a little loose when rotated
+	std::vector<glm::vec3> lows(count, glm::vec3(FLT_MAX)), highs(count, glm::vec3(-FLT_MAX));
+	for (size_t i = 0; i < count; i++)
+	{
+		glm::vec3 low = instances[i].bvh->boundsMin(), high = instances[i].bvh->boundsMax();
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 point(corner & 1 ? high.x : low.x, corner & 2 ? high.y : low.y, corner & 4 ? high.z : low.z);
+			point = glm::vec3(instances[i].transform * glm::vec4(point, 1.0f));
+			lows[i] = glm::min(lows[i], point);
+			highs[i] = glm::max(highs[i], point);
+		}
+	}
+
+	// an instance costs a whole traversal, so the top level always splits down to one per leaf
+	BvhOptions topOptions = options;
+	topOptions.maxLeafSize = 1;
+	topOptions.wide = false;
+	instanceTree.buildFromBounds(lows.data(), highs.data(), count, topOptions, pool);
+
+	placements.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		uint32_t source = instanceTree.primitives()[i];
+		placements[i] = { glm::inverse(instances[source].transform), instances[source].bvh, source };
+	}
+}
+
+template <bool anyHit>
+bool BvhInstances::traverse(const BvhRay & ray, BvhHit & hit, BvhStats * stats, bool wide) const
+{
+	hit.hit = false;
+	const std::vector<BvhNode> & nodes = instanceTree.nodes();
+	if (placements.empty()) return false;
+
+	RaySetup setup(ray);
+	float nearest = ray.maxDistance;
+	uint64_t visited = 0, boxes = 1;
+	BvhStats bottom;
+
+	StackEntry stack[MAX_DEPTH];
+	uint32_t stackSize = 0;
+	uint32_t index = 0;
+	bool visit = setup.enter(nodes[0].boundsMin, nodes[0].boundsMax, ray.minDistance, nearest) != FLT_MAX;
+	while (visit)
+	{
+		const BvhNode & node = nodes[index];
+		visited++;
+		if (node.count)
+		{
+			for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++)
+			{
+				const Placement & placement = placements[i];
+				BvhRay local;
+				local.origin = glm::vec3(placement.worldToObject * glm::vec4(ray.origin, 1.0f));
+				local.direction = glm::mat3(placement.worldToObject) * ray.direction;
+				local.minDistance = ray.minDistance;
+				local.maxDistance = nearest;
+
+				BvhHit instanceHit;
+				bool found = anyHit ? placement.bvh->occluded(local, &bottom, wide) : placement.bvh->intersect(local, instanceHit, &bottom, wide);
+				if (!found) continue;
+				if (!anyHit)
+				{
+					nearest = instanceHit.distance;
+					hit = instanceHit;
+				}
+				hit.hit = true;
+				hit.instance = placement.instance;
+				if (anyHit) break;
+			}
+			if (anyHit && hit.hit) break;
+		}
+		else
+		{
+			uint32_t first = index + 1, second = node.rightOrFirst;
+			float firstDistance = setup.enter(nodes[first].boundsMin, nodes[first].boundsMax, ray.minDistance, nearest);
+			float secondDistance = setup.enter(nodes[second].boundsMin, nodes[second].boundsMax, ray.minDistance, nearest);
+			boxes += 2;
+			if (secondDistance < firstDistance)
+			{
+				std::swap(first, second);
+				std::swap(firstDistance, secondDistance);
+			}
+			if (firstDistance != FLT_MAX)
+			{
+				if (secondDistance != FLT_MAX) stack[stackSize++] = { second, 0, secondDistance };
+				index = first;
+				continue;
+			}
+		}
+
+		visit = false;
+		while (stackSize)
+		{
+			const StackEntry & entry = stack[--stackSize];
+			if (entry.distance <= nearest)
+			{
+				index = entry.node;
+				visit = true;
+				break;
+			}
+		}
+	}
+
+	// the instances' own node and triangle tests count towards the ray, their ray counts do not
+	if (stats)
+	{
+		stats->rays++;
+		stats->hits += hit.hit ? 1 : 0;
+		stats->nodes += visited + bottom.nodes;
+		stats->boxes += boxes + bottom.boxes;
+		stats->triangles += bottom.triangles;
+	}
+	return hit.hit;
+}
+
+bool BvhInstances::intersect(const BvhRay & ray, BvhHit & hit, BvhStats * stats, bool wide) const
+{
+	return traverse<false>(ray, hit, stats, wide);
+}
+
+bool BvhInstances::occluded(const BvhRay & ray, BvhStats * stats, bool wide) const
+{
+	BvhHit hit;
+	return traverse<true>(ray, hit, stats, wide);
+}
+
+template <bool anyHit>
+uint32_t BvhInstances::traversePacket(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats) const
+{
+	hits.mask = 0;
+	const std::vector<BvhNode> & nodes = instanceTree.nodes();
+	uint32_t live = packet.mask & ((1u << BVH_PACKET) - 1);
+	if (placements.empty() || !live) return 0;
+
+	PacketSetup setup(packet);
+	__m128 nearest = _mm_loadu_ps(packet.maxDistance);
+	uint64_t visited = 0, boxes = laneCount(live);
+	BvhStats bottom;
+
+	PacketEntry stack[MAX_DEPTH];
+	uint32_t stackSize = 0;
+	PacketEntry root = { _mm_setzero_ps(), 0, 0, 0, 0.0f };
+	root.mask = setup.enter(nodes[0].boundsMin, nodes[0].boundsMax, nearest, root.distance) & live;
+	if (root.mask) stack[stackSize++] = root;
+	while (stackSize)
+	{
+		const PacketEntry entry = stack[--stackSize];
+		uint32_t active = entry.mask & live & static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(entry.distance, nearest)));
+		if (!active) continue;
+
+		const BvhNode & node = nodes[entry.node];
+		visited++;
+		if (node.count)
+		{
+			for (uint32_t i = node.rightOrFirst; i < node.rightOrFirst + node.count; i++)
+			{
+				// the lanes into object space with the arithmetic of the single ray query, the mat4 one for the origin
+				const Placement & placement = placements[i];
+				const glm::mat4 & m = placement.worldToObject;
+				BvhPacket local;
+				float * localOrigins[3] = { local.originX, local.originY, local.originZ };
+				float * localDirections[3] = { local.directionX, local.directionY, local.directionZ };
+				for (int row = 0; row < 3; row++)
+				{
+					__m128 origin = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][row]), setup.origin[0]), _mm_mul_ps(_mm_set1_ps(m[1][row]), setup.origin[1])),
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[2][row]), setup.origin[2]), _mm_set1_ps(m[3][row] * 1.0f)));
+					__m128 direction = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0][row]), setup.direction[0]), _mm_mul_ps(_mm_set1_ps(m[1][row]), setup.direction[1])),
+						_mm_mul_ps(_mm_set1_ps(m[2][row]), setup.direction[2]));
+					_mm_storeu_ps(localOrigins[row], origin);
+					_mm_storeu_ps(localDirections[row], direction);
+				}
+				_mm_storeu_ps(local.minDistance, setup.start);
+				_mm_storeu_ps(local.maxDistance, nearest);
+				local.mask = active;
+
+				BvhPacketHit instanceHits;
+				uint32_t found = anyHit ? placement.bvh->occluded(local, &bottom) : placement.bvh->intersect(local, instanceHits, &bottom);
+				if (!found) continue;
+				for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+				{
+					if (!(found & (1u << lane))) continue;
+					if (!anyHit)
+					{
+						hits.distance[lane] = instanceHits.distance[lane];
+						hits.triangle[lane] = instanceHits.triangle[lane];
+						hits.u[lane] = instanceHits.u[lane];
+						hits.v[lane] = instanceHits.v[lane];
+					}
+					hits.instance[lane] = placement.instance;
+				}
+				hits.mask |= found;
+				if (anyHit)
+				{
+					live &= ~found;
+					active &= ~found;
+					if (!active) break;
+				}
+				else nearest = blend(laneSelect(found), _mm_loadu_ps(instanceHits.distance), nearest);
+			}
+			if (anyHit && !live) break;
+			continue;
+		}
+
+		// the nearer child comes off the stack next
+		__m128 end = blend(laneSelect(active), nearest, _mm_set1_ps(-FLT_MAX));
+		PacketEntry first = { _mm_setzero_ps(), entry.node + 1, 0, 0, 0.0f };
+		PacketEntry second = { _mm_setzero_ps(), node.rightOrFirst, 0, 0, 0.0f };
+		first.mask = setup.enter(nodes[first.node].boundsMin, nodes[first.node].boundsMax, end, first.distance);
+		second.mask = setup.enter(nodes[second.node].boundsMin, nodes[second.node].boundsMax, end, second.distance);
+		boxes += 2 * laneCount(active);
+		first.nearest = smallestLane(blend(laneSelect(first.mask), first.distance, _mm_set1_ps(FLT_MAX)));
+		second.nearest = smallestLane(blend(laneSelect(second.mask), second.distance, _mm_set1_ps(FLT_MAX)));
+		if (second.nearest < first.nearest) std::swap(first, second);
+		if (second.mask) stack[stackSize++] = second;
+		if (first.mask) stack[stackSize++] = first;
+	}
+
+	if (stats)
+	{
+		stats->rays += laneCount(packet.mask & ((1u << BVH_PACKET) - 1));
+		stats->hits += laneCount(hits.mask);
+		stats->nodes += visited + bottom.nodes;
+		stats->boxes += boxes + bottom.boxes;
+		stats->triangles += bottom.triangles;
+	}
+	return hits.mask;
+}
+
+uint32_t BvhInstances::intersect(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats) const
+{
+	if (sameOctant(packet)) return traversePacket<false>(packet, hits, stats);
+
+	hits.mask = 0;
+	for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+	{
+		BvhHit hit;
+		if (!(packet.mask & (1u << lane)) || !traverse<false>(laneRay(packet, lane), hit, stats, true)) continue;
+		hits.mask |= 1u << lane;
+		hits.distance[lane] = hit.distance;
+		hits.triangle[lane] = hit.triangle;
+		hits.u[lane] = hit.u;
+		hits.v[lane] = hit.v;
+		hits.instance[lane] = hit.instance;
+	}
+	return hits.mask;
+}
+
+uint32_t BvhInstances::occluded(const BvhPacket & packet, BvhStats * stats) const
+{
+	BvhPacketHit hits;
+	if (sameOctant(packet)) return traversePacket<true>(packet, hits, stats);
+
+	uint32_t blocked = 0;
+	for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+	{
+		BvhHit hit;
+		if (packet.mask & (1u << lane) && traverse<true>(laneRay(packet, lane), hit, stats, true)) blocked |= 1u << lane;
+	}
+	return blocked;
+}
@@ -0,0 +1,230 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm\glm.hpp>
+
+class ThreadPool;
+
+/*Bounding volume hierarchy over a triangle mesh, for ray queries that cost roughly the log of the triangle count
+instead of a loop over every primitive.
+
+The builder bins the triangle centroids of a node into equal slices along each axis and splits where the surface area
+heuristic (SAH) is lowest: the cost of visiting the node plus, for each side, its triangle count weighted by the chance
+a ray through the node also crosses that side's box, which is the ratio of their surface areas. A node becomes a leaf
+when testing its triangles is cheaper than any split. Once a node is split its two halves share nothing but the index
+array, each side partitioning its own range, so the halves are built as separate jobs on the pool down to a size where
+a job costs more than it saves. The top nodes, which would leave most threads waiting on one, also bin their
+triangles in chunks spread over the pool.
+
+The result is flattened depth first: the first child of a node is the node right after it, so the path a ray usually
+takes walks forwards through memory, and a node only stores where its second child is. Nodes are 32 bytes, two per
+cache line, and laid out like std430 structs, as are the triangles, so both arrays can go into a shader storage
+buffer unchanged. Triangles are stored in leaf order with the first vertex and two edges already worked out, which is
+what the ray test needs. Other shapes, like the spheres of the ComputeShader demo, are built over their boxes: the
+leaves then give ranges of primitives(), and testing them is up to whoever walks the tree.
+
+The wide layout collapses the binary tree into nodes of up to four children, a child replaced by its own children
+while there is room, largest surface first. A node keeps the boxes of its children as structure of arrays, so one
+SSE2 instruction tests a ray against all four; the tree has about a third of the nodes and half the depth.
+
+Rays that start close together and point the same way, like the camera rays of neighbouring pixels or rays sorted by
+origin and direction, can also walk the wide layout as a packet of four, one SSE2 lane each. The packet shares one
+stack: a child box is tested against all four rays at once, and the packet goes into it if any of them does, carrying
+the mask of the lanes that did. A leaf's triangles are each tested against the four rays the same way. Once a node is
+left with one lane that ray finishes the subtree on its own, since a packet of one only adds overhead. Every lane keeps
+its own nearest hit and does the arithmetic of the single ray queries, so a packet finds what its rays would alone.*/
+
+struct BvhNode
+{
+	glm::vec3 boundsMin;
+	uint32_t rightOrFirst; // the second child of an inner node (the first is the next node), the first triangle of a leaf
+	glm::vec3 boundsMax;
+	uint32_t count; // triangles in a leaf, 0 for an inner node
+};
+
+const uint32_t BVH_WIDTH = 4;
+
+struct BvhWideNode
+{
+	// child boxes, an unused slot is empty (min above max) so no ray ever enters it
+	float minX[BVH_WIDTH], maxX[BVH_WIDTH];
+	float minY[BVH_WIDTH], maxY[BVH_WIDTH];
+	float minZ[BVH_WIDTH], maxZ[BVH_WIDTH];
+	uint32_t child[BVH_WIDTH]; // wide node index, or the first triangle of a leaf
+	uint32_t count[BVH_WIDTH]; // triangles in a leaf, 0 for a node
+};
+
+struct BvhTriangle
+{
+	glm::vec3 vertex;
+	uint32_t index; // of the triangle in the source index array
+	glm::vec3 edge1; // second vertex - first
+	float padding1;
+	glm::vec3 edge2; // third vertex - first
+	float padding2;
+};
+
+struct BvhOptions
+{
+	uint32_t binCount = 16; // centroid slices per axis the SAH is evaluated at
+	uint32_t maxLeafSize = 4; // nodes with more triangles are always split
+	float traversalCost = 1.0f; // of visiting a node, relative to testing one triangle
+	uint32_t parallelThreshold = 4096; // nodes with fewer triangles are built by the job that reached them
+	bool wide = true; // also build the four wide layout
+};
+
+// hits are looked for at origin + t * direction for t in [minDistance, maxDistance]
+struct BvhRay
+{
+	glm::vec3 origin;
+	float minDistance = 0.0f;
+	glm::vec3 direction; // does not need to be normalized, distances are in its length
+	float maxDistance = 3.402823466e+38f;
+};
+
+struct BvhHit
+{
+	bool hit = false;
+	float distance = 0.0f;
+	uint32_t triangle = 0; // index into the source index array divided by 3
+	float u = 0.0f, v = 0.0f; // barycentric weights of the second and third vertex
+	uint32_t instance = 0; // index into the instances of a BvhInstances
+};
+
+const uint32_t BVH_PACKET = 4;
+
+// up to four rays as structure of arrays, each quantity of all of them one SSE2 register
+struct BvhPacket
+{
+	float originX[BVH_PACKET], originY[BVH_PACKET], originZ[BVH_PACKET];
+	float directionX[BVH_PACKET], directionY[BVH_PACKET], directionZ[BVH_PACKET];
+	float minDistance[BVH_PACKET], maxDistance[BVH_PACKET];
+	uint32_t mask = (1u << BVH_PACKET) - 1; // the lanes that carry a ray, the others are ignored
+};
+
+// a BvhHit for every lane, only the lanes in mask hit anything
+struct BvhPacketHit
+{
+	uint32_t mask = 0;
+	float distance[BVH_PACKET];
+	uint32_t triangle[BVH_PACKET];
+	float u[BVH_PACKET], v[BVH_PACKET];
+	uint32_t instance[BVH_PACKET];
+};
+
+struct BvhStats
+{
+	uint64_t rays = 0;
+	uint64_t hits = 0;
+	uint64_t nodes = 0; // nodes whose children were tested, leaves included for the binary layout
+	uint64_t boxes = 0; // ray box tests, four per wide node
+	uint64_t triangles = 0; // ray triangle tests
+};
+
+class Bvh
+{
+public:
+	// Builds over indexCount / 3 triangles of positions (3 floats each, positionStride bytes apart), the work spread over
+	// the pool if given. Replaces whatever was built before.
+	void build(const float * positions, size_t positionStride, const uint32_t * indices, size_t indexCount,
+		const BvhOptions & options = BvhOptions(), ThreadPool * pool = nullptr);
+
+	// Builds over count primitives of any other shape given by their boxes. Leaves then refer to primitives(), the ray
+	// queries, which test triangles, find nothing.
+	void buildFromBounds(const glm::vec3 * boundsMin, const glm::vec3 * boundsMax, size_t count,
+		const BvhOptions & options = BvhOptions(), ThreadPool * pool = nullptr);
+
+	const std::vector<BvhNode> & nodes() const { return binaryNodes; }
+	const std::vector<BvhWideNode> & wideNodes() const { return fourWideNodes; }
+	const std::vector<BvhTriangle> & triangles() const { return leafTriangles; }
+	const std::vector<uint32_t> & primitives() const { return leafPrimitives; } // source index of every leaf entry
+	glm::vec3 boundsMin() const { return binaryNodes.empty() ? glm::vec3(0.0f) : binaryNodes[0].boundsMin; }
+	glm::vec3 boundsMax() const { return binaryNodes.empty() ? glm::vec3(0.0f) : binaryNodes[0].boundsMax; }
+
+	uint32_t depth() const { return treeDepth; }
+	uint32_t leafCount() const { return leaves; }
+
+	// expected cost of a ray through the root box by the heuristic, in triangle tests
+	float sahCost() const;
+
+	// Nearest hit, binary or wide layout. The wide one needs options.wide at build time.
+	bool intersect(const BvhRay & ray, BvhHit & hit, BvhStats * stats = nullptr, bool wide = false) const;
+
+	// whether anything is hit at all, stopping at the first triangle found, for shadow rays
+	bool occluded(const BvhRay & ray, BvhStats * stats = nullptr, bool wide = false) const;
+
+	// hits[i] for rays[i], in blocks spread over the pool if given, stats summed over the batch
+	void intersect(const BvhRay * rays, BvhHit * hits, size_t count, ThreadPool * pool = nullptr,
+		BvhStats * stats = nullptr, bool wide = false) const;
+
+	// Nearest hits of a packet's rays walked through the wide layout together, one ray at a time through the binary one
+	// when it was not built. Returns hits.mask.
+	uint32_t intersect(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats = nullptr) const;
+
+	// the lanes whose ray hits anything, each lane dropping out of the packet at its first triangle
+	uint32_t occluded(const BvhPacket & packet, BvhStats * stats = nullptr) const;
+
+private:
+	void clear(const BvhOptions & options);
+	void finish(const BvhOptions & options);
+	template <bool anyHit> bool traverse(const BvhRay & ray, BvhHit & hit, BvhStats * stats) const;
+	template <bool anyHit> bool traverseWide(const BvhRay & ray, BvhHit & hit, BvhStats * stats) const;
+	template <bool anyHit> uint32_t traversePacket(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats) const;
+
+	std::vector<BvhNode> binaryNodes;
+	std::vector<BvhWideNode> fourWideNodes;
+	std::vector<BvhTriangle> leafTriangles;
+	std::vector<uint32_t> leafPrimitives;
+	float nodeCost = 1.0f;
+	uint32_t treeDepth = 0;
+	uint32_t leaves = 0;
+};
+
+// one placement of a mesh's hierarchy, which has to outlive the BvhInstances built over it
+struct BvhInstance
+{
+	const Bvh * bvh;
+	glm::mat4 transform; // object to world, affine
+};
+
+/*Two levels for scenes that place the same meshes many times: a hierarchy over the world boxes of the instances, each
+leaf handing the ray on to its mesh's own hierarchy. The ray goes into object space by the inverse transform instead
+of the triangles into the world, so a thousand bears cost one bear's triangles and nodes plus a thousand boxes.
+An affine transform keeps the ray parameter as it is, so a hit's distance in object space is its distance in the
+world, and the nearest hit so far bounds the search in every instance that follows.*/
+class BvhInstances
+{
+public:
+	// Builds the top level over the instances' boxes. Replaces whatever was built before.
+	void build(const BvhInstance * instances, size_t count, const BvhOptions & options = BvhOptions(),
+		ThreadPool * pool = nullptr);
+
+	const Bvh & topLevel() const { return instanceTree; }
+	size_t instanceCount() const { return placements.size(); }
+
+	// Nearest hit over all instances, hit.instance telling which. wide picks the layout of the meshes' hierarchies.
+	bool intersect(const BvhRay & ray, BvhHit & hit, BvhStats * stats = nullptr, bool wide = true) const;
+
+	bool occluded(const BvhRay & ray, BvhStats * stats = nullptr, bool wide = true) const;
+
+	// The same for a packet, which walks the top level together and goes into every instance as one, moved into its
+	// object space lane by lane. Returns the lanes that hit, as the Bvh packet queries do.
+	uint32_t intersect(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats = nullptr) const;
+
+	uint32_t occluded(const BvhPacket & packet, BvhStats * stats = nullptr) const;
+
+private:
+	struct Placement
+	{
+		glm::mat4 worldToObject;
+		const Bvh * bvh;
+		uint32_t instance;
+	};
+
+	template <bool anyHit> bool traverse(const BvhRay & ray, BvhHit & hit, BvhStats * stats, bool wide) const;
+	template <bool anyHit> uint32_t traversePacket(const BvhPacket & packet, BvhPacketHit & hits, BvhStats * stats) const;
+
+	Bvh instanceTree;
+	std::vector<Placement> placements; // in the top level's leaf order
+};
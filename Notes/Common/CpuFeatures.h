@@ -0,0 +1,33 @@
+#pragma once
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*What the CPU and OS can run, for the files that pick an AVX2 kernel at run time (Noise, RayTracer). The answer is
+worked out once and kept.*/
+
+// AVX2 on the CPU, and an OS that saves the ymm registers across context switches
+inline bool cpuHasAvx2()
+{
+	static const bool supported = [] {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		// the OS has to save the ymm registers too, not just the CPU support them
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+		return __builtin_cpu_supports("avx2") != 0;
+#else
+		return false;
+#endif
+	}();
+	return supported;
+}
@@ -0,0 +1,389 @@
+#include "Erosion.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+// rows per job, a 2k map is 128 jobs a pass
+static const uint32_t BAND_ROWS = 16;
+
+// keeps the divisions finite where there is nothing to divide
+static const float TINY = 1e-12f;
+
+namespace {
+
+struct ScalarLanes
+{
+	typedef float V;
+	typedef bool M;
+	static const int WIDTH = 1;
+
+	static V set(float a) { return a; }
+	static V load(const float * p) { return *p; }
+	static void store(float * p, V a) { *p = a; }
+	static V add(V a, V b) { return a + b; }
+	static V sub(V a, V b) { return a - b; }
+	static V mul(V a, V b) { return a * b; }
+	static V div(V a, V b) { return a / b; }
+	static V sqrt(V a) { return std::sqrt(a); }
+	static V max(V a, V b) { return a > b ? a : b; }
+	static V min(V a, V b) { return a < b ? a : b; }
+	static M greater(V a, V b) { return a > b; }
+	static V select(M m, V a, V b) { return m ? a : b; } // a where m is set
+};
+
+// max / min take the second operand when either is NaN, like maxps / minps, so both lane types agree on every input
+struct Sse2Lanes
+{
+	typedef __m128 V;
+	typedef __m128 M;
+	static const int WIDTH = 4;
+
+	static V set(float a) { return _mm_set1_ps(a); }
+	static V load(const float * p) { return _mm_loadu_ps(p); }
+	static void store(float * p, V a) { _mm_storeu_ps(p, a); }
+	static V add(V a, V b) { return _mm_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+	static V div(V a, V b) { return _mm_div_ps(a, b); }
+	static V sqrt(V a) { return _mm_sqrt_ps(a); }
+	static V max(V a, V b) { return _mm_max_ps(a, b); }
+	static V min(V a, V b) { return _mm_min_ps(a, b); }
+	static M greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+	static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+
+// outflow through the four pipes of every cell, updated in place: only the cell itself reads its own flux here
+struct FluxKernel
+{
+	const float * terrain;
+	const float * water;
+	float * left;
+	float * right;
+	float * up;
+	float * down;
+	size_t pitch;
+	float flow; // time step * gravity * pipe area / pipe length
+	float area; // of a cell
+	float timeStep;
+
+	template <class S>
+	void cells(size_t i) const
+	{
+		typedef typename S::V V;
+		V zero = S::set(0.0f), acceleration = S::set(flow);
+		V depth = S::load(water + i);
+		V surface = S::add(S::load(terrain + i), depth);
+
+		V toLeft = S::max(zero, S::add(S::load(left + i), S::mul(acceleration,
+			S::sub(surface, S::add(S::load(terrain + i - 1), S::load(water + i - 1))))));
+		V toRight = S::max(zero, S::add(S::load(right + i), S::mul(acceleration,
+			S::sub(surface, S::add(S::load(terrain + i + 1), S::load(water + i + 1))))));
+		V toUp = S::max(zero, S::add(S::load(up + i), S::mul(acceleration,
+			S::sub(surface, S::add(S::load(terrain + i - pitch), S::load(water + i - pitch))))));
+		V toDown = S::max(zero, S::add(S::load(down + i), S::mul(acceleration,
+			S::sub(surface, S::add(S::load(terrain + i + pitch), S::load(water + i + pitch))))));
+
+		// never more than the water in the cell within one step
+		V total = S::mul(S::add(S::add(toLeft, toRight), S::add(toUp, toDown)), S::set(timeStep));
+		V scale = S::min(S::set(1.0f), S::div(S::mul(depth, S::set(area)), S::max(total, S::set(TINY))));
+
+		S::store(left + i, S::mul(toLeft, scale));
+		S::store(right + i, S::mul(toRight, scale));
+		S::store(up + i, S::mul(toUp, scale));
+		S::store(down + i, S::mul(toDown, scale));
+	}
+};
+
+// Sediment moves with the water: a cell passes on the share of its sediment that its outflow takes of its water and
+// gathers the same share from its neighbours' inflow, so none is lost or made where flows meet
+struct TransportKernel
+{
+	const float * left;
+	const float * right;
+	const float * up;
+	const float * down;
+	const float * water;
+	const float * sediment;
+	float * nextSediment;
+	size_t pitch;
+	float perVolume; // time step / cell area, outflow times this over the depth is the share of the water leaving
+
+	template <class S>
+	void cells(size_t i) const
+	{
+		typedef typename S::V V;
+		V timeShare = S::set(perVolume), tiny = S::set(TINY);
+
+		V outflow = S::add(S::add(S::load(left + i), S::load(right + i)), S::add(S::load(up + i), S::load(down + i)));
+		V carried = S::load(sediment + i);
+		V kept = S::sub(carried, S::div(S::mul(S::mul(carried, outflow), timeShare), S::max(S::load(water + i), tiny)));
+
+		// sediment / depth of the neighbour times the flow from it
+		V fromLeft = S::div(S::mul(S::load(sediment + i - 1), S::load(right + i - 1)), S::max(S::load(water + i - 1), tiny));
+		V fromRight = S::div(S::mul(S::load(sediment + i + 1), S::load(left + i + 1)), S::max(S::load(water + i + 1), tiny));
+		V fromUp = S::div(S::mul(S::load(sediment + i - pitch), S::load(down + i - pitch)), S::max(S::load(water + i - pitch), tiny));
+		V fromDown = S::div(S::mul(S::load(sediment + i + pitch), S::load(up + i + pitch)), S::max(S::load(water + i + pitch), tiny));
+		V received = S::mul(S::add(S::add(fromLeft, fromRight), S::add(fromUp, fromDown)), timeShare);
+
+		S::store(nextSediment + i, S::max(S::set(0.0f), S::add(kept, received)));
+	}
+};
+
+// water depth and velocity from the fluxes, then dissolving / deposition, evaporation and the next rain. Terrain is
+// read around the cell for the slope so the new heights go to another array, the rest is the cell's own.
+struct WaterKernel
+{
+	const float * left;
+	const float * right;
+	const float * up;
+	const float * down;
+	const float * terrain;
+	float * nextTerrain;
+	float * water;
+	float * sediment;
+	size_t pitch;
+	float spacing;
+	float area;
+	float timeStep;
+	float minDepth;
+	float minSlope;
+	float capacity;
+	float dissolving;
+	float deposition;
+	float keep; // water left after evaporation
+	float rain; // depth added for the next iteration
+
+	template <class S>
+	void cells(size_t i) const
+	{
+		typedef typename S::V V;
+		V zero = S::set(0.0f), half = S::set(0.5f), one = S::set(1.0f);
+
+		V outLeft = S::load(left + i), outRight = S::load(right + i), outUp = S::load(up + i), outDown = S::load(down + i);
+		V fromLeft = S::load(right + i - 1), fromRight = S::load(left + i + 1);
+		V fromUp = S::load(down + i - pitch), fromDown = S::load(up + i + pitch);
+
+		V inflow = S::add(S::add(fromLeft, fromRight), S::add(fromUp, fromDown));
+		V outflow = S::add(S::add(outLeft, outRight), S::add(outUp, outDown));
+		V depth = S::load(water + i);
+		V newDepth = S::max(zero, S::add(depth, S::mul(S::sub(inflow, outflow), S::set(timeStep / area))));
+
+		// the water passing through the cell over the cross section it passes through
+		V flowX = S::mul(half, S::add(S::sub(fromLeft, outLeft), S::sub(outRight, fromRight)));
+		V flowZ = S::mul(half, S::add(S::sub(fromUp, outUp), S::sub(outDown, fromDown)));
+		V section = S::mul(S::max(S::mul(half, S::add(depth, newDepth)), S::set(minDepth)), S::set(spacing));
+		V velocityX = S::div(flowX, section);
+		V velocityZ = S::div(flowZ, section);
+
+		V slopeScale = S::set(0.5f / spacing);
+		V slopeX = S::mul(S::sub(S::load(terrain + i + 1), S::load(terrain + i - 1)), slopeScale);
+		V slopeZ = S::mul(S::sub(S::load(terrain + i + pitch), S::load(terrain + i - pitch)), slopeScale);
+		V slopeSquared = S::add(S::mul(slopeX, slopeX), S::mul(slopeZ, slopeZ));
+		V sine = S::max(S::sqrt(S::div(slopeSquared, S::add(one, slopeSquared))), S::set(minSlope));
+		V speed = S::sqrt(S::add(S::mul(velocityX, velocityX), S::mul(velocityZ, velocityZ)));
+
+		// what the flow can carry, per unit of width, against what it does: more takes terrain into the water, less
+		// drops sediment
+		V carried = S::load(sediment + i);
+		V missing = S::sub(S::mul(S::mul(S::mul(S::set(capacity), sine), speed), newDepth), carried);
+		V change = S::select(S::greater(missing, zero), S::mul(missing, S::set(dissolving)), S::mul(missing, S::set(deposition)));
+
+		S::store(nextTerrain + i, S::sub(S::load(terrain + i), change));
+		S::store(sediment + i, S::add(carried, change));
+		S::store(water + i, S::add(S::mul(newDepth, S::set(keep)), S::set(rain)));
+	}
+};
+
+// How much of its excess over the talus slope each cell sheds to every lower neighbour. The offsets and talus drops
+// of the eight neighbours come from run(), the diagonals are further away so their drop is longer.
+struct ShedKernel
+{
+	const float * terrain;
+	float * shedding;
+	const ptrdiff_t * offsets;
+	const float * drops;
+	float rate;
+
+	template <class S>
+	void cells(size_t i) const
+	{
+		typedef typename S::V V;
+		V zero = S::set(0.0f);
+		V height = S::load(terrain + i);
+		V total = zero, steepest = zero;
+		for (int n = 0; n < 8; n++)
+		{
+			V excess = S::max(zero, S::sub(S::sub(height, S::load(terrain + i + offsets[n])), S::set(drops[n])));
+			total = S::add(total, excess);
+			steepest = S::max(steepest, excess);
+		}
+
+		// half the steepest excess in all, so the cell never ends up below the neighbour it gives to
+		S::store(shedding + i, S::div(S::mul(S::set(rate * 0.5f), steepest), S::max(total, S::set(TINY))));
+	}
+};
+
+struct GatherKernel
+{
+	const float * terrain;
+	const float * shedding;
+	float * nextTerrain;
+	const ptrdiff_t * offsets;
+	const float * drops;
+
+	template <class S>
+	void cells(size_t i) const
+	{
+		typedef typename S::V V;
+		V zero = S::set(0.0f);
+		V height = S::load(terrain + i);
+		V total = zero, received = zero;
+		for (int n = 0; n < 8; n++)
+		{
+			V neighbour = S::load(terrain + i + offsets[n]);
+			V drop = S::set(drops[n]);
+			total = S::add(total, S::max(zero, S::sub(S::sub(height, neighbour), drop)));
+			received = S::add(received, S::mul(S::load(shedding + i + offsets[n]), S::max(zero, S::sub(S::sub(neighbour, height), drop))));
+		}
+		S::store(nextTerrain + i, S::add(S::sub(height, S::mul(S::load(shedding + i), total)), received));
+	}
+};
+
+template <class Kernel>
+void runBand(const Kernel & kernel, size_t pitch, uint32_t width, uint32_t z0, uint32_t z1)
+{
+	for (uint32_t z = z0; z < z1; z++)
+	{
+		size_t row = (size_t(z) + 1) * pitch + 1;
+		uint32_t x = 0;
+		for (; x + Sse2Lanes::WIDTH <= width; x += Sse2Lanes::WIDTH) kernel.template cells<Sse2Lanes>(row + x);
+		for (; x < width; x++) kernel.template cells<ScalarLanes>(row + x);
+	}
+}
+
+}
+
+template <class Kernel>
+static void runPass(const Kernel & kernel, size_t pitch, uint32_t width, uint32_t depth, ThreadPool * pool)
+{
+	size_t bands = (depth + BAND_ROWS - 1) / BAND_ROWS;
+	ThreadPool::forEach(pool, bands, [&](size_t band) {
+		uint32_t z0 = static_cast<uint32_t>(band) * BAND_ROWS;
+		runBand(kernel, pitch, width, z0, std::min(z0 + BAND_ROWS, depth));
+	});
+}
+
+TerrainErosion::TerrainErosion(const float * heights, uint32_t width, uint32_t depth, float cellSpacing, const ErosionOptions & options)
+	: sizeX(std::max(width, 2u)), sizeZ(std::max(depth, 2u)), pitch(size_t(sizeX) + 2), spacing(cellSpacing), config(options),
+	iterations(0)
+{
+	size_t cells = pitch * (size_t(sizeZ) + 2);
+	for (auto field : { &terrain, &nextTerrain, &water, &sediment, &nextSediment, &fluxLeft, &fluxRight, &fluxUp, &fluxDown,
+		&shedding })
+		field->assign(cells, 0.0f);
+
+	for (uint32_t z = 0; z < sizeZ; z++)
+	{
+		const float * row = heights + size_t(std::min(z, depth - 1)) * width;
+		for (uint32_t x = 0; x < sizeX; x++) terrain[index(x, z)] = row[std::min(x, width - 1)];
+	}
+	refreshBorder(terrain);
+
+	// the first rain, every iteration after ends with the next one
+	for (uint32_t z = 0; z < sizeZ; z++)
+		std::fill(water.begin() + index(0, z), water.begin() + index(0, z) + sizeX, config.rain * config.timeStep);
+}
+
+void TerrainErosion::refreshBorder(std::vector<float> & field) const
+{
+	for (uint32_t z = 0; z < sizeZ; z++)
+	{
+		field[index(0, z) - 1] = field[index(0, z)];
+		field[index(sizeX - 1, z) + 1] = field[index(sizeX - 1, z)];
+	}
+	std::copy(field.begin() + pitch, field.begin() + 2 * pitch, field.begin());
+	std::copy(field.begin() + sizeZ * pitch, field.begin() + (sizeZ + 1) * pitch, field.begin() + (sizeZ + 1) * pitch);
+}
+
+void TerrainErosion::run(uint32_t count, ThreadPool * pool)
+{
+	float area = spacing * spacing;
+	float diagonal = std::sqrt(2.0f) * spacing;
+	ptrdiff_t row = static_cast<ptrdiff_t>(pitch);
+	const ptrdiff_t offsets[8] = { -1, 1, -row, row, -row - 1, -row + 1, row - 1, row + 1 };
+	const float drops[8] = {
+		config.talus * spacing, config.talus * spacing, config.talus * spacing, config.talus * spacing,
+		config.talus * diagonal, config.talus * diagonal, config.talus * diagonal, config.talus * diagonal,
+	};
+
+	for (uint32_t iteration = 0; iteration < count; iteration++)
+	{
+		// the pipes have the cell's side as cross section and length, so area / length is the spacing
+		FluxKernel flux = { terrain.data(), water.data(), fluxLeft.data(), fluxRight.data(), fluxUp.data(), fluxDown.data(),
+			pitch, config.timeStep * config.gravity * spacing, area, config.timeStep };
+		runPass(flux, pitch, sizeX, sizeZ, pool);
+
+		// before the depths change, the shares are of the water the fluxes were limited by
+		TransportKernel transport = { fluxLeft.data(), fluxRight.data(), fluxUp.data(), fluxDown.data(), water.data(),
+			sediment.data(), nextSediment.data(), pitch, config.timeStep / area };
+		runPass(transport, pitch, sizeX, sizeZ, pool);
+		sediment.swap(nextSediment);
+
+		WaterKernel flow = { fluxLeft.data(), fluxRight.data(), fluxUp.data(), fluxDown.data(), terrain.data(), nextTerrain.data(),
+			water.data(), sediment.data(), pitch, spacing, area, config.timeStep, config.minDepth, config.minSlope, config.capacity,
+			config.dissolving, config.deposition, std::max(0.0f, 1.0f - config.evaporation * config.timeStep),
+			config.rain * config.timeStep };
+		runPass(flow, pitch, sizeX, sizeZ, pool);
+		terrain.swap(nextTerrain);
+		refreshBorder(terrain);
+
+		if (config.thermalRate > 0.0f)
+		{
+			ShedKernel shed = { terrain.data(), shedding.data(), offsets, drops, config.thermalRate };
+			runPass(shed, pitch, sizeX, sizeZ, pool);
+			GatherKernel gather = { terrain.data(), shedding.data(), nextTerrain.data(), offsets, drops };
+			runPass(gather, pitch, sizeX, sizeZ, pool);
+			terrain.swap(nextTerrain);
+			refreshBorder(terrain);
+		}
+
+		iterations++;
+	}
+}
+
+void TerrainErosion::readHeights(float * destination, size_t rowPitch) const
+{
+	for (uint32_t z = 0; z < sizeZ; z++)
+		std::copy(terrain.begin() + index(0, z), terrain.begin() + index(0, z) + sizeX, destination + z * rowPitch);
+}
+
+double TerrainErosion::volume(const std::vector<float> & field) const
+{
+	double sum = 0.0;
+	for (uint32_t z = 0; z < sizeZ; z++)
+	{
+		const float * row = field.data() + index(0, z);
+		for (uint32_t x = 0; x < sizeX; x++) sum += row[x];
+	}
+	return sum * spacing * spacing;
+}
+
+void erodeHeights(float * heights, uint32_t width, uint32_t depth, float spacing, uint32_t iterations,
+	const ErosionOptions & options, ThreadPool * pool)
+{
+	if (width < 2 || depth < 2) return;
+	TerrainErosion erosion(heights, width, depth, spacing, options);
+	erosion.run(iterations, pool);
+	erosion.readHeights(heights, width);
+}
+
+uint64_t erosionKey(uint64_t sourceKey, uint32_t iterations, const ErosionOptions & options)
+{
+	// carried on from the key, like terrainNoiseKey, field by field
+	float fields[] = { options.timeStep, options.gravity, options.rain, options.evaporation, options.capacity,
+		options.dissolving, options.deposition, options.minSlope, options.minDepth, options.talus, options.thermalRate };
+	uint64_t hash = hashBytes(&iterations, sizeof iterations, sourceKey);
+	return hashBytes(fields, sizeof fields, hash);
+}
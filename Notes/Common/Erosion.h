@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/*Grid based hydraulic and thermal erosion for heightmaps.
+
+Hydraulic erosion is the virtual pipe model of Mei, Decaudin and Hu ("Fast Hydraulic Erosion Simulation and
+Visualization on GPU", 2007). Every cell holds terrain height, water depth, suspended sediment and the outflow through
+pipes to its four neighbours. An iteration:
+
+	flux       the water surface difference to each neighbour accelerates the flow through that pipe, scaled down so
+	           a cell never sends off more water than it has
+	transport  sediment goes with the water, each pipe carrying the share of the cell's sediment it takes of its water
+	water      inflow minus outflow changes the depth, the flow through the cell gives its velocity
+	erosion    sediment capacity is proportional to speed, slope and depth: below capacity the water dissolves
+	           terrain, above it the water deposits; then evaporation, and rain for the next iteration
+
+The paper carries the sediment back along the velocity instead (semi-Lagrangian), which loses whatever meets where
+flows converge, so the valleys the erosion is meant to fill would swallow it. Moving it through the pipes keeps terrain
+plus sediment constant apart from what leaves over the edge.
+
+Thermal erosion then moves material off every slope steeper than the talus angle, half the steepest excess split over
+the lower of the eight neighbours in proportion to how far each is below the angle (two passes, one working out how
+much each cell sheds, one gathering).
+
+Every pass is a kernel over bands of rows spread over the pool, 4 cells per SSE2 instruction with the columns past the
+last full vector run through the same template one at a time. A cell reads its neighbours in the arrays the previous
+pass wrote, so the band boundaries are exchanged through the barrier at the end of each pass rather than copied: the
+one row halo of a band is the last row of the band above it and the first of the one below, already in shared memory.
+No pass writes anything another cell of the same pass reads, so the results are the same bits whatever the thread
+count or band size.
+
+The fields carry a one cell ghost border that repeats the edge heights with no water: water flowing off the edge is
+gone, as is material sliding off it, the terrain stays as high as its edge. Heights and spacing are in world units,
+the rates per unit of simulated time.*/
+
+struct ErosionOptions
+{
+	float timeStep = 0.02f;
+	float gravity = 9.81f;
+	float rain = 0.2f; // water depth per unit of time, on every cell
+	float evaporation = 1.0f; // fraction of the water per unit of time
+
+	float capacity = 0.1f; // sediment the water can carry per unit of speed, slope (sine) and depth
+	float dissolving = 0.1f; // fraction of the missing capacity taken from the terrain per iteration
+	float deposition = 0.1f; // fraction of the excess sediment dropped per iteration
+	float minSlope = 0.05f; // sine of the slope the capacity assumes on flat ground, so standing water still carries some
+	float minDepth = 0.01f; // the depth velocity is computed over, at least, so it does not blow up on wet sand
+
+	float talus = 1.0f; // tangent of the steepest stable slope, 45 degrees
+	float thermalRate = 0.3f; // fraction of half the excess moved per iteration, 0 turns thermal erosion off
+};
+
+class TerrainErosion
+{
+public:
+	// heights in world units, width x depth samples row by row, spacing in world units between samples
+	TerrainErosion(const float * heights, uint32_t width, uint32_t depth, float spacing, const ErosionOptions & options = ErosionOptions());
+
+	// runs whole iterations, every pass spread over the pool if given
+	void run(uint32_t iterations, ThreadPool * pool = nullptr);
+
+	// the eroded heights, destination rowPitch in floats
+	void readHeights(float * destination, size_t rowPitch) const;
+
+	uint32_t width() const { return sizeX; }
+	uint32_t depth() const { return sizeZ; }
+	uint32_t iterationCount() const { return iterations; }
+
+	// summed over the cells, in world units cubed
+	double terrainVolume() const { return volume(terrain); }
+	double waterVolume() const { return volume(water); }
+	double sedimentVolume() const { return volume(sediment); }
+
+private:
+	// one cell of ghost border around every field
+	size_t index(uint32_t x, uint32_t z) const { return (size_t(z) + 1) * pitch + x + 1; }
+	void refreshBorder(std::vector<float> & field) const;
+	double volume(const std::vector<float> & field) const;
+
+	uint32_t sizeX, sizeZ;
+	size_t pitch;
+	float spacing;
+	ErosionOptions config;
+	uint32_t iterations;
+
+	std::vector<float> terrain, nextTerrain;
+	std::vector<float> water, sediment, nextSediment;
+	std::vector<float> fluxLeft, fluxRight, fluxUp, fluxDown; // toward x - 1, x + 1, z - 1, z + 1
+	std::vector<float> shedding; // thermal: the fraction of its excess each cell gives to a lower neighbour
+};
+
+// Erodes width x depth heights in place, a TerrainErosion run over them.
+void erodeHeights(float * heights, uint32_t width, uint32_t depth, float spacing, uint32_t iterations,
+	const ErosionOptions & options = ErosionOptions(), ThreadPool * pool = nullptr);
+
+// Extends a terrain file sourceKey (see terrainNoiseKey) with the erosion that was run on the heights.
+uint64_t erosionKey(uint64_t sourceKey, uint32_t iterations, const ErosionOptions & options);
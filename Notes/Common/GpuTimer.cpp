@@ -0,0 +1,51 @@
+#include "GpuTimer.h"
+
+void GpuTimer::begin()
+{
+	// created on first use so a timer can be declared before the context exists
+	if (!queries[0])
+		glGenQueries(QUERY_COUNT, queries);
+
+	if (pending[current]) {
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &nanoseconds);
+		pending[current] = false;
+		totalNanoseconds += double(nanoseconds);
+		samples++;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void GpuTimer::end()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	pending[current] = true;
+	current = (current + 1) % QUERY_COUNT;
+}
+
+void GpuTimer::reset()
+{
+	// results still in flight belong to the old measurement
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		if (pending[i]) {
+			GLuint64 nanoseconds;
+			glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &nanoseconds);
+			pending[i] = false;
+		}
+	}
+	totalNanoseconds = 0.0;
+	samples = 0;
+}
+
+void GpuTimer::release()
+{
+	if (queries[0])
+		glDeleteQueries(QUERY_COUNT, queries);
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		queries[i] = 0;
+		pending[i] = false;
+	}
+}
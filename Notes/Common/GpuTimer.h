@@ -0,0 +1,36 @@
+#pragma once
+#include <glad\glad.h>
+
+/*GPU side stopwatch over GL_TIME_ELAPSED queries.
+
+Reading a query right after ending it stalls until the GPU catches up, so begin/end cycle through a small ring of
+query objects and the result of each one is only collected when the ring comes back around to it a few frames later.
+Only one begin/end pair may be open at a time, like any GL_TIME_ELAPSED query.*/
+class GpuTimer
+{
+public:
+	GpuTimer() = default;
+
+	GpuTimer(const GpuTimer &) = delete;
+	GpuTimer & operator=(const GpuTimer &) = delete;
+
+	void begin();
+	void end();
+
+	// average over every sample collected since the last reset
+	double averageMilliseconds() const { return samples ? totalNanoseconds / 1e6 / samples : 0.0; }
+	unsigned sampleCount() const { return samples; }
+	void reset();
+
+	// deletes the queries, the demos tear their GL objects down before the context goes away
+	void release();
+
+private:
+	static const int QUERY_COUNT = 4;
+
+	GLuint queries[QUERY_COUNT] = {};
+	bool pending[QUERY_COUNT] = {};
+	int current = 0;
+	double totalNanoseconds = 0.0;
+	unsigned samples = 0;
+};
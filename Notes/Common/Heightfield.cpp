@@ -0,0 +1,308 @@
+#include "Heightfield.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// rays per job, enough to pay for the job and small enough that a batch of a few thousand still spreads out
+static const size_t RAY_BLOCK = 256;
+
+Heightfield::Heightfield(const float * source, uint32_t width, uint32_t depth, float spacing, ThreadPool * pool)
+	: heights(source, source + size_t(width) * depth), sampleCountX(width), sampleCountZ(depth), sampleSpacing(spacing)
+{
+	// a single sample still makes one flat cell
+	if (width < 2 || depth < 2)
+	{
+		sampleCountX = sampleCountZ = 2;
+		heights.assign(4, heights.empty() ? 0.0f : heights[0]);
+	}
+
+	levels.emplace_back();
+	Level & base = levels.back();
+	base.cellsX = sampleCountX - 1;
+	base.cellsZ = sampleCountZ - 1;
+	base.minHeights.resize(size_t(base.cellsX) * base.cellsZ);
+	base.maxHeights.resize(base.minHeights.size());
+
+	// a cell's bilinear patch lies between its lowest and highest corner
+	ThreadPool::forEach(pool, base.cellsZ, [&](size_t z) {
+		const float * row = heights.data() + z * sampleCountX;
+		const float * next = row + sampleCountX;
+		float * low = base.minHeights.data() + z * base.cellsX;
+		float * high = base.maxHeights.data() + z * base.cellsX;
+		for (uint32_t x = 0; x < base.cellsX; x++)
+		{
+			low[x] = std::min(std::min(row[x], row[x + 1]), std::min(next[x], next[x + 1]));
+			high[x] = std::max(std::max(row[x], row[x + 1]), std::max(next[x], next[x + 1]));
+		}
+	});
+
+	// halving rounded up, an odd last column or row merges with itself
+	while (levels.back().cellsX > 1 || levels.back().cellsZ > 1)
+	{
+		levels.emplace_back();
+		const Level & below = levels[levels.size() - 2];
+		Level & level = levels.back();
+		level.cellsX = (below.cellsX + 1) / 2;
+		level.cellsZ = (below.cellsZ + 1) / 2;
+		level.minHeights.resize(size_t(level.cellsX) * level.cellsZ);
+		level.maxHeights.resize(level.minHeights.size());
+
+		ThreadPool::forEach(pool, level.cellsZ, [&](size_t z) {
+			size_t z0 = z * 2 * below.cellsX, z1 = std::min<size_t>(z * 2 + 1, below.cellsZ - 1) * below.cellsX;
+			for (uint32_t x = 0; x < level.cellsX; x++)
+			{
+				uint32_t x0 = x * 2, x1 = std::min(x * 2 + 1, below.cellsX - 1);
+				size_t cell = z * level.cellsX + x;
+				level.minHeights[cell] = std::min(std::min(below.minHeights[z0 + x0], below.minHeights[z0 + x1]),
+					std::min(below.minHeights[z1 + x0], below.minHeights[z1 + x1]));
+				level.maxHeights[cell] = std::max(std::max(below.maxHeights[z0 + x0], below.maxHeights[z0 + x1]),
+					std::max(below.maxHeights[z1 + x0], below.maxHeights[z1 + x1]));
+			}
+		});
+	}
+}
+
+float Heightfield::sample(int x, int z) const
+{
+	x = std::min(std::max(x, 0), static_cast<int>(sampleCountX) - 1);
+	z = std::min(std::max(z, 0), static_cast<int>(sampleCountZ) - 1);
+	return heights[size_t(z) * sampleCountX + x];
+}
+
+float Heightfield::height(float x, float z) const
+{
+	float fx = std::min(std::max(x / sampleSpacing, 0.0f), static_cast<float>(sampleCountX - 1));
+	float fz = std::min(std::max(z / sampleSpacing, 0.0f), static_cast<float>(sampleCountZ - 1));
+	int cellX = std::min(static_cast<int>(fx), static_cast<int>(sampleCountX) - 2);
+	int cellZ = std::min(static_cast<int>(fz), static_cast<int>(sampleCountZ) - 2);
+	float u = fx - cellX, v = fz - cellZ;
+
+	const float * row = heights.data() + size_t(cellZ) * sampleCountX + cellX;
+	const float * next = row + sampleCountX;
+	float top = row[0] + (row[1] - row[0]) * u;
+	float bottom = next[0] + (next[1] - next[0]) * u;
+	return top + (bottom - top) * v;
+}
+
+glm::vec3 Heightfield::normal(float x, float z) const
+{
+	float dx = height(x + sampleSpacing, z) - height(x - sampleSpacing, z);
+	float dz = height(x, z + sampleSpacing) - height(x, z - sampleSpacing);
+	return glm::normalize(glm::vec3(-dx, 2.0f * sampleSpacing, -dz));
+}
+
+// First crossing of the ray (in cell space, the origin and direction as raycast sets them up) with the bilinear patch of
+// one level 0 cell between start and end. Height along the ray minus the patch is a quadratic in the distance from start.
+bool Heightfield::intersectPatch(int cellX, int cellZ, const glm::vec3 & origin, const glm::vec3 & direction, float start,
+	float end, float & distance) const
+{
+	const float * row = heights.data() + size_t(cellZ) * sampleCountX + cellX;
+	const float * next = row + sampleCountX;
+	float h00 = row[0], h10 = row[1], h01 = next[0], h11 = next[1];
+	float slopeX = h10 - h00, slopeZ = h01 - h00, twist = h00 - h10 - h01 + h11;
+
+	float u = origin.x + direction.x * start - cellX;
+	float v = origin.z + direction.z * start - cellZ;
+	float y = origin.y + direction.y * start;
+
+	// f(s) = a s^2 + b s + c
+	float c = y - (h00 + slopeX * u + slopeZ * v + twist * u * v);
+	float b = direction.y - (slopeX * direction.x + slopeZ * direction.z + twist * (u * direction.z + v * direction.x));
+	float a = -twist * direction.x * direction.z;
+	float length = end - start;
+
+	// already under the surface where the ray enters: it crossed on a seam the previous cell rounded away, or starts below
+	if (c <= 0.0f)
+	{
+		distance = start;
+		return true;
+	}
+
+	float first = FLT_MAX;
+	if (std::abs(a) < 1e-12f)
+	{
+		if (b < 0.0f) first = -c / b;
+	}
+	else
+	{
+		float discriminant = b * b - 4.0f * a * c;
+		if (discriminant >= 0.0f)
+		{
+			// the form that does not cancel when b dominates
+			float q = -0.5f * (b + std::copysign(std::sqrt(discriminant), b));
+			float r0 = q / a, r1 = q != 0.0f ? c / q : FLT_MAX;
+			if (r0 >= 0.0f) first = r0;
+			if (r1 >= 0.0f) first = std::min(first, r1);
+		}
+	}
+
+	if (first <= length)
+	{
+		distance = start + first;
+		return true;
+	}
+
+	// the roots can round past the far side of a crossing that touches the exit, take the exit then
+	float s = length;
+	if (a * s * s + b * s + c <= 0.0f)
+	{
+		distance = end;
+		return true;
+	}
+	return false;
+}
+
+bool Heightfield::raycast(const HeightfieldRay & ray, HeightfieldHit & hit, HeightfieldStats * stats, bool hierarchy) const
+{
+	hit.hit = false;
+	if (stats) stats->rays++;
+
+	float directionLength = glm::length(ray.direction);
+	if (!(directionLength > 0.0f)) return false;
+	glm::vec3 worldDirection = ray.direction / directionLength;
+
+	// cell space: x and z in samples, y stays in world units so distances do too
+	float inverseSpacing = 1.0f / sampleSpacing;
+	glm::vec3 origin(ray.origin.x * inverseSpacing, ray.origin.y, ray.origin.z * inverseSpacing);
+	glm::vec3 direction(worldDirection.x * inverseSpacing, worldDirection.y, worldDirection.z * inverseSpacing);
+
+	const Level & base = levels[0];
+	const Level & top = levels.back();
+
+	// clip to the box around the whole heightfield
+	float tNear = 0.0f, tFar = ray.maxDistance;
+	float boxLow[3] = { 0.0f, top.minHeights[0], 0.0f };
+	float boxHigh[3] = { static_cast<float>(base.cellsX), top.maxHeights[0], static_cast<float>(base.cellsZ) };
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (direction[axis] == 0.0f)
+		{
+			if (origin[axis] < boxLow[axis] || origin[axis] > boxHigh[axis]) return false;
+			continue;
+		}
+		float t0 = (boxLow[axis] - origin[axis]) / direction[axis];
+		float t1 = (boxHigh[axis] - origin[axis]) / direction[axis];
+		if (t0 > t1) std::swap(t0, t1);
+		tNear = std::max(tNear, t0);
+		tFar = std::min(tFar, t1);
+	}
+	if (tNear > tFar) return false;
+
+	int stepX = direction.x > 0.0f ? 1 : direction.x < 0.0f ? -1 : 0;
+	int stepZ = direction.z > 0.0f ? 1 : direction.z < 0.0f ? -1 : 0;
+	int cellsX = static_cast<int>(base.cellsX), cellsZ = static_cast<int>(base.cellsZ);
+	int x = std::min(std::max(static_cast<int>(std::floor(origin.x + direction.x * tNear)), 0), cellsX - 1);
+	int z = std::min(std::max(static_cast<int>(std::floor(origin.z + direction.z * tNear)), 0), cellsZ - 1);
+
+	// x / z is the level 0 cell the ray is in at t, the level L cell holding it is x >> L, z >> L
+	int topLevel = hierarchy ? static_cast<int>(levels.size()) - 1 : 0;
+	int level = topLevel;
+	float t = tNear;
+	uint64_t visited = 0, patches = 0;
+	bool found = false;
+	float distance = 0.0f;
+
+	for (;;)
+	{
+		visited++;
+		const Level & current = levels[level];
+		int cellX = x >> level, cellZ = z >> level;
+		int x0 = cellX << level, x1 = std::min((cellX + 1) << level, cellsX);
+		int z0 = cellZ << level, z1 = std::min((cellZ + 1) << level, cellsZ);
+
+		float exitX = stepX > 0 ? (x1 - origin.x) / direction.x : stepX < 0 ? (x0 - origin.x) / direction.x : FLT_MAX;
+		float exitZ = stepZ > 0 ? (z1 - origin.z) / direction.z : stepZ < 0 ? (z0 - origin.z) / direction.z : FLT_MAX;
+		float exit = std::max(std::min(std::min(exitX, exitZ), tFar), t);
+
+		// the lowest the ray gets within the cell is at one of its ends
+		float lowest = origin.y + direction.y * (direction.y >= 0.0f ? t : exit);
+		size_t cell = size_t(cellZ) * current.cellsX + cellX;
+		if (lowest <= current.maxHeights[cell])
+		{
+			if (level > 0)
+			{
+				level--;
+				continue;
+			}
+
+			patches++;
+			if (intersectPatch(x, z, origin, direction, t, exit, distance))
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if (exit >= tFar) break;
+
+		// leave through the nearer side by index; the other axis follows the ray but stays inside the cell it left and
+		// never moves backwards, so rounding cannot send the walk in circles
+		if (exitX <= exitZ)
+		{
+			x = stepX > 0 ? x1 : x0 - 1;
+			int along = static_cast<int>(std::floor(origin.z + direction.z * exit));
+			if (stepZ > 0) z = std::min(std::max(z, along), z1 - 1);
+			else if (stepZ < 0) z = std::max(std::min(z, along), z0);
+		}
+		else
+		{
+			z = stepZ > 0 ? z1 : z0 - 1;
+			int along = static_cast<int>(std::floor(origin.x + direction.x * exit));
+			if (stepX > 0) x = std::min(std::max(x, along), x1 - 1);
+			else if (stepX < 0) x = std::max(std::min(x, along), x0);
+		}
+		if (x < 0 || x >= cellsX || z < 0 || z >= cellsZ) break;
+
+		t = exit;
+		level = std::min(level + 1, topLevel);
+	}
+
+	if (stats)
+	{
+		stats->cells += visited;
+		stats->patches += patches;
+	}
+	if (!found) return false;
+
+	hit.hit = true;
+	hit.distance = distance;
+	hit.position = ray.origin + worldDirection * distance;
+	hit.normal = normal(hit.position.x, hit.position.z);
+	if (stats) stats->hits++;
+	return true;
+}
+
+bool Heightfield::visible(const glm::vec3 & from, const glm::vec3 & to) const
+{
+	HeightfieldRay ray;
+	ray.origin = from;
+	ray.direction = to - from;
+	ray.maxDistance = glm::length(ray.direction);
+	if (!(ray.maxDistance > 0.0f)) return from.y > height(from.x, from.z);
+
+	HeightfieldHit hit;
+	return !raycast(ray, hit);
+}
+
+void Heightfield::raycast(const HeightfieldRay * rays, HeightfieldHit * hits, size_t count, ThreadPool * pool,
+	HeightfieldStats * stats, bool hierarchy) const
+{
+	size_t blocks = (count + RAY_BLOCK - 1) / RAY_BLOCK;
+	std::vector<HeightfieldStats> blockStats(stats ? blocks : 0);
+
+	ThreadPool::forEach(pool, blocks, [&](size_t block) {
+		size_t begin = block * RAY_BLOCK, end = std::min(begin + RAY_BLOCK, count);
+		HeightfieldStats * local = stats ? &blockStats[block] : nullptr;
+		for (size_t i = begin; i < end; i++) raycast(rays[i], hits[i], local, hierarchy);
+	});
+
+	if (!stats) return;
+	for (const auto & block : blockStats)
+	{
+		stats->rays += block.rays;
+		stats->hits += block.hits;
+		stats->cells += block.cells;
+		stats->patches += block.patches;
+	}
+}
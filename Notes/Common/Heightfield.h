@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm\glm.hpp>
+
+class ThreadPool;
+
+/*CPU queries against a heightmap terrain: heights and normals anywhere on it and ray intersection, for picking, line of
+sight and putting things on the ground without reading the heights back from the GPU.
+
+Sample (i, j) sits at world (i * spacing, j * spacing) and the surface between four samples is their bilinear patch,
+what a linearly filtered height texture gives. height() and normal() evaluate that surface, the normal from central
+differences one sample apart.
+
+raycast() walks a min-max mip hierarchy over the cells (maximum mipmaps, Tevs et al. 2008). Level 0 holds the lowest
+and highest corner of every cell, every level above the min / max of the 2 x 2 cells under it. The walk starts at the
+top, skips any cell the ray passes entirely above, steps down into the ones it might hit and back up a level after
+leaving a cell. At level 0 the ray is intersected exactly with the cell's bilinear patch (a quadratic along the ray),
+so a hit lies on the same surface height() returns. Cells are stepped by integer index along the axis the ray leaves
+through, which keeps the walk from stalling on a boundary however the floats round.
+
+A batch of rays is split into blocks spread over the pool; every ray only reads the hierarchy, so any number of
+threads can query the same heightfield.*/
+
+struct HeightfieldRay
+{
+	glm::vec3 origin;
+	glm::vec3 direction; // does not need to be normalized
+	float maxDistance; // along the normalized direction
+};
+
+struct HeightfieldHit
+{
+	bool hit = false;
+	float distance = 0.0f; // along the normalized direction
+	glm::vec3 position;
+	glm::vec3 normal;
+};
+
+struct HeightfieldStats
+{
+	uint64_t rays = 0;
+	uint64_t hits = 0;
+	uint64_t cells = 0; // hierarchy cells visited, level 0 patches included
+	uint64_t patches = 0; // level 0 cells intersected exactly
+};
+
+class Heightfield
+{
+public:
+	// heights in world units, width x depth samples row by row, copied. The hierarchy is built over the pool if given.
+	Heightfield(const float * heights, uint32_t width, uint32_t depth, float spacing = 1.0f, ThreadPool * pool = nullptr);
+
+	uint32_t width() const { return sampleCountX; }
+	uint32_t depth() const { return sampleCountZ; }
+	float spacing() const { return sampleSpacing; }
+	glm::vec2 extent() const { return glm::vec2((sampleCountX - 1) * sampleSpacing, (sampleCountZ - 1) * sampleSpacing); }
+	float minHeight() const { return levels.back().minHeights[0]; }
+	float maxHeight() const { return levels.back().maxHeights[0]; }
+	uint32_t levelCount() const { return static_cast<uint32_t>(levels.size()); }
+
+	// bilinear height and its normal at world x / z, clamped to the edge outside the heightfield
+	float height(float x, float z) const;
+	glm::vec3 normal(float x, float z) const;
+
+	// First hit along the ray. A ray coming in through a side of the heightfield below its edge hits the side, as if the
+	// terrain were a solid block. With hierarchy off every level 0 cell along the ray is tested, the brute force walk the
+	// benchmark compares against.
+	bool raycast(const HeightfieldRay & ray, HeightfieldHit & hit, HeightfieldStats * stats = nullptr, bool hierarchy = true) const;
+
+	// whether the segment between two points clears the terrain
+	bool visible(const glm::vec3 & from, const glm::vec3 & to) const;
+
+	// hits[i] for rays[i], in blocks spread over the pool if given, stats summed over the batch
+	void raycast(const HeightfieldRay * rays, HeightfieldHit * hits, size_t count, ThreadPool * pool = nullptr,
+		HeightfieldStats * stats = nullptr, bool hierarchy = true) const;
+
+private:
+	struct Level
+	{
+		uint32_t cellsX, cellsZ;
+		std::vector<float> minHeights, maxHeights;
+	};
+
+	float sample(int x, int z) const;
+	bool intersectPatch(int cellX, int cellZ, const glm::vec3 & origin, const glm::vec3 & direction, float start, float end,
+		float & distance) const;
+
+	std::vector<float> heights;
+	uint32_t sampleCountX, sampleCountZ;
+	float sampleSpacing;
+	std::vector<Level> levels;
+};
@@ -0,0 +1,46 @@
+#include "LodSelection.h"
+#include <algorithm>
+
+void selectLods(const MeshCacheSubmesh & submesh, const glm::vec3 * centers, size_t count, float scale, const glm::vec3 & eye,
+	float projectionScale, float pixelThreshold, LodBuckets & buckets, bool lodEnabled)
+{
+	uint32_t lodCount = lodEnabled ? std::max(submesh.lodCount, 1u) : 1u;
+
+	// a level is good enough from the distance where its error shrinks to pixelThreshold onwards
+	float switchDistances[MESH_CACHE_MAX_LODS];
+	for (uint32_t level = 0; level < lodCount; level++)
+	{
+		float distance = submesh.lods[level].error * scale * projectionScale / pixelThreshold;
+		switchDistances[level] = distance * distance;
+	}
+
+	std::fill(buckets.count, buckets.count + MESH_CACHE_MAX_LODS, 0u);
+	buckets.instances.resize(count);
+
+	// count first, then spread the ids into their buckets
+	std::vector<uint8_t> & levels = buckets.levels;
+	levels.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		glm::vec3 offset = centers[i] - eye;
+		float distance = glm::dot(offset, offset);
+		uint32_t level = lodCount - 1;
+		while (level > 0 && distance < switchDistances[level]) level--;
+		levels[i] = static_cast<uint8_t>(level);
+		buckets.count[level]++;
+	}
+
+	uint32_t offset = 0;
+	buckets.triangles = 0;
+	for (uint32_t level = 0; level < MESH_CACHE_MAX_LODS; level++)
+	{
+		buckets.first[level] = offset;
+		offset += buckets.count[level];
+		if (buckets.count[level]) buckets.triangles += uint64_t(buckets.count[level]) * (submesh.lods[level].indexCount / 3);
+	}
+
+	uint32_t cursor[MESH_CACHE_MAX_LODS];
+	std::copy(buckets.first, buckets.first + MESH_CACHE_MAX_LODS, cursor);
+	for (size_t i = 0; i < count; i++)
+		buckets.instances[cursor[levels[i]]++] = static_cast<uint32_t>(i);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <glm\glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshCache.h"
+
+/*Per instance level of detail selection for the LOD chains stored in the mesh cache.
+
+Every level records how far (in model units) it strays from the full mesh. Divided by the distance to the eye and
+scaled by the projection that error becomes a size in pixels, and each instance gets the coarsest level whose error
+stays under the pixel threshold. That turns into one switch distance per level, so the per instance work is a squared
+distance and a few compares.
+
+The selected instances are bucketed by level with a counting sort so every level is one instanced draw over a
+contiguous range of instance ids (glDrawElementsInstancedBaseInstance with first as the base instance).*/
+
+struct LodBuckets
+{
+	std::vector<uint32_t> instances; // instance ids grouped by level
+	uint32_t first[MESH_CACHE_MAX_LODS];
+	uint32_t count[MESH_CACHE_MAX_LODS];
+	uint64_t triangles; // submitted by drawing every bucket with its level
+
+	std::vector<uint8_t> levels; // scratch, kept so selecting every frame does not allocate
+};
+
+// Pixels per model unit at distance 1, for a perspective projection with the given vertical field of view.
+inline float lodProjectionScale(float fieldOfView, float viewportHeight)
+{
+	return viewportHeight / (2.0f * glm::tan(fieldOfView * 0.5f));
+}
+
+// Buckets count instances (their world space centers, all using the same uniform scale) by the level of submesh
+// that keeps the error below pixelThreshold. With lodEnabled false everything goes into level 0 for comparison.
+void selectLods(const MeshCacheSubmesh & submesh, const glm::vec3 * centers, size_t count, float scale, const glm::vec3 & eye,
+	float projectionScale, float pixelThreshold, LodBuckets & buckets, bool lodEnabled = true);
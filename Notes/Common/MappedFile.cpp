@@ -0,0 +1,177 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : bytes(nullptr), byteCount(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+}
+
+bool MappedFile::open(const char * filename, MappedFileAccess access)
+{
+	close();
+
+	DWORD flags = access == MAPPED_FILE_RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN;
+	fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		close();
+		return false;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle) {
+		close();
+		return false;
+	}
+
+	bytes = reinterpret_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!bytes) {
+		close();
+		return false;
+	}
+
+	byteCount = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const
+{
+	if (!bytes || offset >= byteCount) return;
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<uint8_t*>(bytes + offset);
+	range.NumberOfBytes = std::min(size, byteCount - offset);
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::close()
+{
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+
+	bytes = nullptr;
+	byteCount = 0;
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile() : bytes(nullptr), byteCount(0), fileDescriptor(-1)
+{
+}
+
+bool MappedFile::open(const char * filename, MappedFileAccess access)
+{
+	close();
+
+	fileDescriptor = ::open(filename, O_RDONLY);
+	if (fileDescriptor < 0) return false;
+
+	struct stat fileInfo;
+	if (fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size == 0) {
+		close();
+		return false;
+	}
+
+	void * mapping = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (mapping == MAP_FAILED) {
+		close();
+		return false;
+	}
+
+	// a baked asset is about to be streamed into a buffer object, so ask for read ahead up front, random access files
+	// only read what gets touched
+	madvise(mapping, static_cast<size_t>(fileInfo.st_size), access == MAPPED_FILE_RANDOM ? MADV_RANDOM : MADV_WILLNEED);
+
+	bytes = reinterpret_cast<const uint8_t*>(mapping);
+	byteCount = static_cast<size_t>(fileInfo.st_size);
+	return true;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const
+{
+	if (!bytes || offset >= byteCount) return;
+
+	// madvise wants a page aligned start
+	size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t start = offset & ~(pageSize - 1);
+	size_t end = std::min(offset + size, byteCount);
+	madvise(const_cast<uint8_t*>(bytes + start), end - start, MADV_WILLNEED);
+}
+
+void MappedFile::close()
+{
+	if (bytes) munmap(const_cast<uint8_t*>(bytes), byteCount);
+	if (fileDescriptor >= 0) ::close(fileDescriptor);
+
+	bytes = nullptr;
+	byteCount = 0;
+	fileDescriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool fileStamp(const char * path, uint64_t & size, int64_t & time)
+{
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_stat64(path, &info) != 0) return false;
+#else
+	struct stat info;
+	if (stat(path, &info) != 0) return false;
+#endif
+	size = static_cast<uint64_t>(info.st_size);
+	time = static_cast<int64_t>(info.st_mtime);
+	return true;
+}
+
+uint64_t hashBytes(const void * data, size_t size, uint64_t hash)
+{
+	// FNV-1a, only used to tell if a source file changed so it does not need to be strong
+	auto bytes = reinterpret_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+uint64_t hashFile(const char * path)
+{
+	MappedFile source;
+	if (!source.open(path)) return 0;
+	return hashBytes(source.data(), source.size());
+}
+
+bool restampFile(const char * cachePath, uint64_t offset, int64_t sourceTime)
+{
+	std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+	if (!file.is_open()) return false;
+	file.seekp(static_cast<std::streamoff>(offset));
+	file.write(reinterpret_cast<const char*>(&sourceTime), sizeof sourceTime);
+	return file.good();
+}
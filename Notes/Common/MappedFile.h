@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*A read only view of a whole file mapped into the address space. The operating system pages the bytes in
+on demand, so "loading" a baked asset is just a map call and the pointer can be handed straight to
+glBufferData / glCompressedTexSubImage2D without an intermediate copy.
+
+Baked assets are read front to back once, so by default the mapping asks for read ahead. Files that are only ever
+touched in small pieces (the tiles of a TerrainFile) are opened with MAPPED_FILE_RANDOM instead, then nothing is read
+until a page is touched or prefetch() asks for it.*/
+
+enum MappedFileAccess
+{
+	MAPPED_FILE_SEQUENTIAL,
+	MAPPED_FILE_RANDOM,
+};
+
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile & operator=(const MappedFile &) = delete;
+
+	bool open(const char * filename, MappedFileAccess access = MAPPED_FILE_SEQUENTIAL);
+	void close();
+
+	bool isOpen() const { return bytes != nullptr; }
+	const uint8_t * data() const { return bytes; }
+	size_t size() const { return byteCount; }
+
+	// Starts reading the pages of a byte range in the background, returns without waiting for them.
+	void prefetch(size_t offset, size_t size) const;
+
+private:
+	const uint8_t * bytes;
+	size_t byteCount;
+#ifdef _WIN32
+	void * fileHandle;
+	void * mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
+
+// The stale checks of the baked caches (meshes, textures, terrain): size and modification time, then a hash of the
+// contents. hashBytes carries on from hash, so keys can be built from several fields one after the other.
+bool fileStamp(const char * path, uint64_t & size, int64_t & time);
+uint64_t hashBytes(const void * data, size_t size, uint64_t hash = 14695981039346656037ull);
+uint64_t hashFile(const char * path);
+
+// Writes a new source time over the one at offset in a cache file, for a source that was touched but hashes the same,
+// so the next open does not hash it again. The rest of the file stays as it is; it must not be mapped meanwhile.
+bool restampFile(const char * cachePath, uint64_t offset, int64_t sourceTime);
@@ -0,0 +1,425 @@
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include "TangentSpace.h"
+#include "ThreadPool.h"
+#include <assimp\Importer.hpp>
+#include <assimp\scene.h>
+#include <assimp\postprocess.h>
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + 15) & ~uint64_t(15);
+}
+
+// one submesh as read from the source file: interleaved position | normal | uv (8 floats) and a triangle list
+struct SourceMesh
+{
+	vector<float> vertices;
+	vector<uint32_t> indices;
+	bool hasNormals;
+	bool hasUvs;
+
+	// simplified levels after the full one, filled in by optimizeSourceMesh
+	vector<vector<uint32_t>> lods;
+	vector<float> lodErrors;
+
+	// xyz and bitangent sign per welded vertex, also from optimizeSourceMesh
+	vector<float> tangents;
+};
+
+// every level aims for half the triangles of the one before and gives up past this error (fraction of the mesh size)
+static const float LOD_TARGET_ERROR = 0.05f;
+// how much a unit of normal / uv difference costs next to a unit of distance
+static const float LOD_NORMAL_WEIGHT = 0.05f;
+static const float LOD_UV_WEIGHT = 0.1f;
+
+static bool importWithAssimp(const char * sourcePath, vector<SourceMesh> & meshes)
+{
+	Assimp::Importer importer;
+	const aiScene * scene = importer.ReadFile(sourcePath, aiProcess_Triangulate);
+
+	if (!scene) {
+		std::cout << "Baking " << sourcePath << " failed: " << importer.GetErrorString() << std::endl;
+		return false;
+	}
+
+	meshes.resize(scene->mNumMeshes);
+	for (uint32_t meshIndex = 0; meshIndex < scene->mNumMeshes; meshIndex++)
+	{
+		const aiMesh * mesh = scene->mMeshes[meshIndex];
+		SourceMesh & target = meshes[meshIndex];
+		target.hasNormals = mesh->HasNormals();
+		target.hasUvs = mesh->HasTextureCoords(0);
+
+		target.vertices.assign(mesh->mNumVertices * 8, 0.0f);
+		for (uint32_t i = 0; i < mesh->mNumVertices; i++)
+		{
+			float * vertex = &target.vertices[i * 8];
+			vertex[0] = mesh->mVertices[i].x;
+			vertex[1] = mesh->mVertices[i].y;
+			vertex[2] = mesh->mVertices[i].z;
+
+			if (target.hasNormals) {
+				vertex[3] = mesh->mNormals[i].x;
+				vertex[4] = mesh->mNormals[i].y;
+				vertex[5] = mesh->mNormals[i].z;
+			}
+
+			if (target.hasUvs) {
+				vertex[6] = mesh->mTextureCoords[0][i].x;
+				vertex[7] = mesh->mTextureCoords[0][i].y;
+			}
+		}
+
+		target.indices.reserve(mesh->mNumFaces * 3);
+		for (uint32_t i = 0; i < mesh->mNumFaces; i++)
+		{
+			const aiFace & face = mesh->mFaces[i];
+			// aiProcess_Triangulate leaves points and lines alone, those have no area so they are dropped
+			if (face.mNumIndices != 3) continue;
+			for (uint32_t x = 0; x < 3; x++) target.indices.push_back(face.mIndices[x]);
+		}
+	}
+
+	return true;
+}
+
+static bool importObj(const char * sourcePath, vector<SourceMesh> & meshes, ThreadPool * pool)
+{
+	ObjModel model;
+	if (!parseObj(sourcePath, model, pool)) {
+		std::cout << "Baking " << sourcePath << " failed" << std::endl;
+		return false;
+	}
+
+	meshes.resize(model.meshes.size());
+	for (size_t meshIndex = 0; meshIndex < model.meshes.size(); meshIndex++)
+	{
+		ObjMesh & mesh = model.meshes[meshIndex];
+		SourceMesh & target = meshes[meshIndex];
+		target.hasNormals = !mesh.normals.empty();
+		target.hasUvs = !mesh.uvs.empty();
+
+		target.vertices.assign(mesh.vertexCount() * 8, 0.0f);
+		for (size_t i = 0; i < mesh.vertexCount(); i++)
+		{
+			float * vertex = &target.vertices[i * 8];
+			memcpy(vertex, &mesh.positions[i * 3], sizeof(float) * 3);
+			if (target.hasNormals) memcpy(vertex + 3, &mesh.normals[i * 3], sizeof(float) * 3);
+			if (target.hasUvs) memcpy(vertex + 6, &mesh.uvs[i * 2], sizeof(float) * 2);
+		}
+
+		target.indices.swap(mesh.indices);
+	}
+
+	return true;
+}
+
+static bool hasExtension(const char * path, const char * extension)
+{
+	size_t pathLength = strlen(path);
+	size_t extensionLength = strlen(extension);
+	if (pathLength < extensionLength) return false;
+
+	for (size_t i = 0; i < extensionLength; i++)
+		if (tolower(path[pathLength - extensionLength + i]) != extension[i]) return false;
+	return true;
+}
+
+// each level is simplified from the previous one, which is faster than starting over from the full mesh every time
+static void buildLodChain(SourceMesh & mesh)
+{
+	const size_t stride = sizeof(float) * 8;
+	size_t vertexCount = mesh.vertices.size() / 8;
+	float weights[5] = {
+		mesh.hasNormals ? LOD_NORMAL_WEIGHT : 0.0f, mesh.hasNormals ? LOD_NORMAL_WEIGHT : 0.0f, mesh.hasNormals ? LOD_NORMAL_WEIGHT : 0.0f,
+		mesh.hasUvs ? LOD_UV_WEIGHT : 0.0f, mesh.hasUvs ? LOD_UV_WEIGHT : 0.0f,
+	};
+	SimplifyAttributes attributes = { mesh.vertices.data() + 3, stride, weights, 5 };
+
+	float extent = 0.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float low = FLT_MAX, high = -FLT_MAX;
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			low = std::min(low, mesh.vertices[i * 8 + axis]);
+			high = std::max(high, mesh.vertices[i * 8 + axis]);
+		}
+		extent = std::max(extent, high - low);
+	}
+
+	// reserved up front so previous stays valid while levels are added
+	mesh.lods.reserve(MESH_CACHE_MAX_LODS - 1);
+	const vector<uint32_t> * previous = &mesh.indices;
+	float error = 0.0f;
+	for (uint32_t level = 1; level < MESH_CACHE_MAX_LODS; level++)
+	{
+		size_t targetIndexCount = (previous->size() / 6) * 3;
+		vector<uint32_t> lod(previous->size());
+		float levelError = 0.0f;
+		lod.resize(simplifyMesh(lod.data(), previous->data(), previous->size(), mesh.vertices.data(), stride, vertexCount,
+			targetIndexCount, LOD_TARGET_ERROR, &attributes, &levelError));
+
+		// a level that barely lost anything is not worth a draw range
+		if (lod.empty() || lod.size() > previous->size() * 9 / 10) break;
+
+		vector<uint32_t> ordered(lod.size());
+		optimizeVertexCache(ordered.data(), lod.data(), lod.size(), vertexCount);
+
+		// errors of the levels add up since each one only knows about the one before
+		error += levelError * extent;
+		mesh.lods.push_back(std::move(ordered));
+		mesh.lodErrors.push_back(error);
+		previous = &mesh.lods.back();
+	}
+}
+
+// weld the duplicated corners and put the triangles and vertices in GPU friendly order
+static void optimizeSourceMesh(SourceMesh & mesh, ThreadPool * pool)
+{
+	const size_t stride = sizeof(float) * 8;
+	size_t sourceCount = mesh.vertices.size() / 8;
+	vector<uint32_t> & indices = mesh.indices;
+
+	VertexStream stream = { mesh.vertices.data(), stride };
+	vector<uint32_t> remap;
+	size_t vertexCount = weldVertices(remap, indices.data(), indices.size(), sourceCount, &stream, 1);
+	vector<float> welded(vertexCount * 8);
+	remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+	remapVertexBuffer(welded.data(), mesh.vertices.data(), sourceCount, stride, remap.data());
+
+	vector<uint32_t> ordered(indices.size());
+	optimizeVertexCache(ordered.data(), indices.data(), indices.size(), vertexCount);
+	optimizeOverdraw(indices.data(), ordered.data(), ordered.size(), welded.data(), stride, vertexCount);
+
+	optimizeVertexFetch(remap, indices.data(), indices.size(), vertexCount);
+	remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+	mesh.vertices.resize(vertexCount * 8);
+	remapVertexBuffer(mesh.vertices.data(), welded.data(), vertexCount, stride, remap.data());
+
+	// after welding, so corners that only differed in precision noise share one tangent
+	mesh.tangents.resize(vertexCount * 4);
+	generateTangents(mesh.tangents.data(), indices.data(), indices.size(), mesh.vertices.data(), stride,
+		mesh.vertices.data() + 3, stride, mesh.vertices.data() + 6, stride, vertexCount, pool);
+
+	buildLodChain(mesh);
+}
+
+bool bakeMeshCache(const char * sourcePath, const char * cachePath, ThreadPool * pool)
+{
+	// .obj goes through our own parser, Assimp is kept for every other format
+	vector<SourceMesh> meshes;
+	bool imported = hasExtension(sourcePath, ".obj") ? importObj(sourcePath, meshes, pool) : importWithAssimp(sourcePath, meshes);
+	if (!imported) return false;
+
+	if (meshes.empty()) {
+		std::cout << "Baking " << sourcePath << " failed: no meshes" << std::endl;
+		return false;
+	}
+
+	MeshCacheHeader header = {};
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.indexSize = sizeof(uint16_t);
+	header.submeshCount = static_cast<uint32_t>(meshes.size());
+	header.attributes = MESH_ATTRIBUTE_POSITION;
+	fileStamp(sourcePath, header.sourceSize, header.sourceTime);
+	header.sourceHash = hashFile(sourcePath);
+
+	ThreadPool::forEach(pool, meshes.size(), [&](size_t meshIndex) { optimizeSourceMesh(meshes[meshIndex], pool); });
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		header.boundsMin[axis] = FLT_MAX;
+		header.boundsMax[axis] = -FLT_MAX;
+	}
+
+	vector<MeshCacheSubmesh> submeshes(meshes.size());
+	for (size_t meshIndex = 0; meshIndex < meshes.size(); meshIndex++)
+	{
+		const SourceMesh & mesh = meshes[meshIndex];
+		uint32_t vertexCount = static_cast<uint32_t>(mesh.vertices.size() / 8);
+		if (mesh.hasNormals) header.attributes |= MESH_ATTRIBUTE_NORMAL;
+		if (mesh.hasUvs) header.attributes |= MESH_ATTRIBUTE_UV | MESH_ATTRIBUTE_TANGENT;
+
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				header.boundsMin[axis] = std::min(header.boundsMin[axis], mesh.vertices[i * 8 + axis]);
+				header.boundsMax[axis] = std::max(header.boundsMax[axis], mesh.vertices[i * 8 + axis]);
+			}
+		}
+
+		MeshCacheSubmesh & submesh = submeshes[meshIndex];
+		submesh.vertexOffset = header.vertexCount;
+		submesh.vertexCount = vertexCount;
+		submesh.indexOffset = header.indexCount;
+		submesh.indexCount = static_cast<uint32_t>(mesh.indices.size());
+		submesh.lodCount = static_cast<uint32_t>(mesh.lods.size() + 1);
+		submesh.lods[0] = { submesh.indexOffset, submesh.indexCount, 0.0f, 0 };
+		header.vertexCount += vertexCount;
+		header.indexCount += static_cast<uint32_t>(mesh.indices.size());
+
+		if (!fitsShortIndices(vertexCount)) header.indexSize = sizeof(uint32_t);
+	}
+
+	// the simplified levels go after every full mesh so the start of the index block looks like it always did
+	for (size_t meshIndex = 0; meshIndex < meshes.size(); meshIndex++)
+	{
+		const SourceMesh & mesh = meshes[meshIndex];
+		MeshCacheSubmesh & submesh = submeshes[meshIndex];
+		for (size_t level = 0; level < mesh.lods.size(); level++)
+		{
+			uint32_t indexCount = static_cast<uint32_t>(mesh.lods[level].size());
+			submesh.lods[level + 1] = { header.indexCount, indexCount, mesh.lodErrors[level], 0 };
+			header.indexCount += indexCount;
+		}
+	}
+
+	// planar layout, the same one the demos build by hand with glBufferSubData
+	vector<float> vertices(header.vertexCount * 12);
+	float * positions = vertices.data();
+	float * normals = positions + header.vertexCount * 3;
+	float * uvs = normals + header.vertexCount * 3;
+	float * tangents = uvs + header.vertexCount * 2;
+	vector<uint8_t> indices(header.indexCount * header.indexSize);
+
+	for (size_t meshIndex = 0; meshIndex < meshes.size(); meshIndex++)
+	{
+		const MeshCacheSubmesh & submesh = submeshes[meshIndex];
+		for (uint32_t i = 0; i < submesh.vertexCount; i++)
+		{
+			const float * vertex = &meshes[meshIndex].vertices[i * 8];
+			uint32_t target = submesh.vertexOffset + i;
+			memcpy(positions + target * 3, vertex, sizeof(float) * 3);
+			memcpy(normals + target * 3, vertex + 3, sizeof(float) * 3);
+			memcpy(uvs + target * 2, vertex + 6, sizeof(float) * 2);
+			memcpy(tangents + target * 4, &meshes[meshIndex].tangents[i * 4], sizeof(float) * 4);
+		}
+
+		for (uint32_t level = 0; level < submesh.lodCount; level++)
+		{
+			const vector<uint32_t> & source = level == 0 ? meshes[meshIndex].indices : meshes[meshIndex].lods[level - 1];
+			uint32_t indexOffset = submesh.lods[level].indexOffset;
+			if (header.indexSize == sizeof(uint16_t))
+				packShortIndices(reinterpret_cast<uint16_t*>(indices.data()) + indexOffset, source.data(), source.size());
+			else
+				memcpy(reinterpret_cast<uint32_t*>(indices.data()) + indexOffset, source.data(), sizeof(uint32_t) * source.size());
+		}
+	}
+
+	header.vertexOffset = alignOffset(sizeof(MeshCacheHeader) + sizeof(MeshCacheSubmesh) * submeshes.size());
+	header.vertexBytes = sizeof(float) * vertices.size();
+	header.indexOffset = alignOffset(header.vertexOffset + header.vertexBytes);
+	header.indexBytes = indices.size();
+
+	// write to a temporary name first so a crash mid bake never leaves a truncated cache behind
+	std::string temporaryPath = std::string(cachePath) + ".tmp";
+	{
+		std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) {
+			std::cout << "Could not write " << temporaryPath << std::endl;
+			return false;
+		}
+
+		static const char padding[16] = {};
+		output.write(reinterpret_cast<const char*>(&header), sizeof header);
+		output.write(reinterpret_cast<const char*>(submeshes.data()), sizeof(MeshCacheSubmesh) * submeshes.size());
+		output.write(padding, header.vertexOffset - (sizeof header + sizeof(MeshCacheSubmesh) * submeshes.size()));
+		output.write(reinterpret_cast<const char*>(vertices.data()), header.vertexBytes);
+		output.write(padding, header.indexOffset - (header.vertexOffset + header.vertexBytes));
+		output.write(reinterpret_cast<const char*>(indices.data()), header.indexBytes);
+
+		if (!output.good()) {
+			std::cout << "Could not write " << temporaryPath << std::endl;
+			return false;
+		}
+	}
+
+	std::remove(cachePath);
+	return std::rename(temporaryPath.c_str(), cachePath) == 0;
+}
+
+// the header, submesh table and both blocks all inside the file
+static bool validMeshCache(const MappedFile & file)
+{
+	auto header = reinterpret_cast<const MeshCacheHeader*>(file.data());
+	return file.size() >= sizeof(MeshCacheHeader)
+		&& header->magic == MESH_CACHE_MAGIC
+		&& header->version == MESH_CACHE_VERSION
+		&& sizeof(MeshCacheHeader) + uint64_t(header->submeshCount) * sizeof(MeshCacheSubmesh) <= file.size()
+		&& header->indexOffset + header->indexBytes <= file.size()
+		&& header->vertexOffset + header->vertexBytes <= file.size();
+}
+
+bool openMeshCache(const char * cachePath, const char * sourcePath, MeshCache & cache)
+{
+	cache.header = nullptr;
+	cache.submeshes = nullptr;
+	if (!cache.file.open(cachePath)) return false;
+	if (!validMeshCache(cache.file)) {
+		cache.file.close();
+		return false;
+	}
+
+	// the cheap size and time check covers the common case, only hash the source when the stamp moved
+	// (a fresh checkout touches every file without changing it)
+	auto header = reinterpret_cast<const MeshCacheHeader*>(cache.file.data());
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (sourcePath && fileStamp(sourcePath, sourceSize, sourceTime)) {
+		if (sourceSize != header->sourceSize) {
+			cache.file.close();
+			return false;
+		}
+
+		if (sourceTime != header->sourceTime) {
+			if (hashFile(sourcePath) != header->sourceHash) {
+				cache.file.close();
+				return false;
+			}
+
+			// same contents under a new time: take the time over so the next launch does not hash again. The mapping
+			// only shares the file for reading, so it is closed around the write.
+			cache.file.close();
+			restampFile(cachePath, offsetof(MeshCacheHeader, sourceTime), sourceTime);
+			if (!cache.file.open(cachePath) || !validMeshCache(cache.file)) {
+				cache.file.close();
+				return false;
+			}
+			header = reinterpret_cast<const MeshCacheHeader*>(cache.file.data());
+		}
+	}
+
+	cache.header = header;
+	cache.submeshes = reinterpret_cast<const MeshCacheSubmesh*>(cache.file.data() + sizeof(MeshCacheHeader));
+	return true;
+}
+
+bool loadMeshCache(const char * sourcePath, MeshCache & cache, ThreadPool * pool)
+{
+	std::string cachePath = std::string(sourcePath) + ".rwmesh";
+
+	if (openMeshCache(cachePath.c_str(), sourcePath, cache)) return true;
+
+	std::cout << "Baking " << sourcePath << " into " << cachePath << std::endl;
+	if (!bakeMeshCache(sourcePath, cachePath.c_str(), pool)) return false;
+
+	return openMeshCache(cachePath.c_str(), sourcePath, cache);
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "MappedFile.h"
+
+/*Baked binary mesh format (.rwmesh)
+
+Parsing a text .obj through Assimp on every launch is by far the slowest part of starting the model demos.
+A cache file holds the same data already laid out the way the demos upload it:
+
+	MeshCacheHeader
+	MeshCacheSubmesh[submeshCount]
+	vertex block : planar positions (vec3) | normals (vec3) | uvs (vec2) | tangents (vec4) for every submesh back to back
+	index block  : triangle list, indices are local to their submesh (draw with glDrawElementsBaseVertex),
+	               followed by the index ranges of the simplified levels of detail
+
+Baking welds the duplicated vertices Assimp produces and runs the MeshOptimizer passes, so the index buffer is already
+in vertex cache / overdraw friendly order. Indices are 16 bit unless a submesh has too many vertices for that.
+Tangents come from generateTangents (TangentSpace) on the welded mesh, xyz and the bitangent sign in w.
+
+Every submesh carries a chain of up to MESH_CACHE_MAX_LODS levels made by MeshSimplifier, each about half the triangles
+of the one before. They reuse the vertices of the full mesh so switching level only switches the index range.
+Level 0 is the full mesh and matches indexOffset / indexCount.
+
+Both blocks start on a 16 byte boundary so they can be passed to glBufferData straight out of the mapped file.
+The header records the size, modification time and a hash of the source file so a stale cache is rebaked.*/
+
+const uint32_t MESH_CACHE_MAGIC = 0x484D5752; // "RWMH"
+const uint32_t MESH_CACHE_VERSION = 4;
+const uint32_t MESH_CACHE_MAX_LODS = 5;
+
+enum MeshAttribute
+{
+	MESH_ATTRIBUTE_POSITION = 1 << 0,
+	MESH_ATTRIBUTE_NORMAL = 1 << 1,
+	MESH_ATTRIBUTE_UV = 1 << 2,
+	MESH_ATTRIBUTE_TANGENT = 1 << 3, // generated whenever there are uvs, perpendicular to the normal otherwise
+};
+
+struct MeshCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceHash;
+	uint64_t sourceSize;
+	int64_t sourceTime;
+
+	uint32_t vertexCount;
+	uint32_t indexCount; // every index in the block, levels of detail included
+	uint32_t indexSize; // 2 or 4 bytes
+	uint32_t attributes; // MeshAttribute bits present in the source, missing ones are zero filled
+	uint32_t submeshCount;
+	uint32_t reserved;
+
+	float boundsMin[3];
+	float boundsMax[3];
+
+	uint64_t vertexOffset; // from the start of the file
+	uint64_t vertexBytes;
+	uint64_t indexOffset;
+	uint64_t indexBytes;
+};
+
+struct MeshCacheLod
+{
+	uint32_t indexOffset; // into the index block, like MeshCacheSubmesh::indexOffset
+	uint32_t indexCount;
+	float error; // largest distance from the full mesh, in model units
+	uint32_t reserved;
+};
+
+struct MeshCacheSubmesh
+{
+	uint32_t vertexOffset;
+	uint32_t vertexCount;
+	uint32_t indexOffset;
+	uint32_t indexCount;
+
+	uint32_t lodCount; // at least 1
+	uint32_t reserved;
+	MeshCacheLod lods[MESH_CACHE_MAX_LODS];
+};
+
+struct MeshCache
+{
+	MappedFile file;
+	const MeshCacheHeader * header = nullptr;
+	const MeshCacheSubmesh * submeshes = nullptr;
+
+	const void * vertexData() const { return file.data() + header->vertexOffset; }
+	const void * indexData() const { return file.data() + header->indexOffset; }
+	size_t vertexBytes() const { return static_cast<size_t>(header->vertexBytes); }
+	size_t indexBytes() const { return static_cast<size_t>(header->indexBytes); }
+	size_t indexSize() const { return header->indexSize; }
+
+	// byte offsets of the planar attribute arrays inside the vertex block
+	size_t positionOffset() const { return 0; }
+	size_t normalOffset() const { return sizeof(float) * 3 * header->vertexCount; }
+	size_t uvOffset() const { return sizeof(float) * 6 * header->vertexCount; }
+	size_t tangentOffset() const { return sizeof(float) * 8 * header->vertexCount; }
+};
+
+class ThreadPool;
+
+// Imports the source model (.obj with ObjParser, anything else with Assimp) and writes the cache file.
+// pool is optional and only used to parse and optimize in parallel.
+bool bakeMeshCache(const char * sourcePath, const char * cachePath, ThreadPool * pool = nullptr);
+
+// Maps an existing cache file. Fails if it is missing, corrupt, from another version or older than sourcePath.
+bool openMeshCache(const char * cachePath, const char * sourcePath, MeshCache & cache);
+
+// Maps sourcePath + ".rwmesh", baking it first if it does not exist or is out of date.
+bool loadMeshCache(const char * sourcePath, MeshCache & cache, ThreadPool * pool = nullptr);
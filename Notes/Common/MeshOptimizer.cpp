@@ -0,0 +1,377 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+using std::vector;
+
+static uint32_t hashVertex(uint32_t vertex, const VertexStream * streams, size_t streamCount)
+{
+	// MurmurHash2 style mix over the raw attribute bytes, attributes are float so the data is always 4 byte aligned
+	uint32_t hash = 0;
+	for (size_t s = 0; s < streamCount; s++)
+	{
+		auto words = reinterpret_cast<const uint32_t*>(reinterpret_cast<const char*>(streams[s].data) + vertex * streams[s].stride);
+		for (size_t i = 0; i < streams[s].stride / 4; i++)
+		{
+			uint32_t k = words[i] * 0x5bd1e995;
+			k ^= k >> 24;
+			hash = (hash * 0x5bd1e995) ^ (k * 0x5bd1e995);
+		}
+	}
+	return hash;
+}
+
+static bool equalVertices(uint32_t a, uint32_t b, const VertexStream * streams, size_t streamCount)
+{
+	for (size_t s = 0; s < streamCount; s++)
+	{
+		auto data = reinterpret_cast<const char*>(streams[s].data);
+		if (memcmp(data + a * streams[s].stride, data + b * streams[s].stride, streams[s].stride) != 0) return false;
+	}
+	return true;
+}
+
+size_t weldVertices(vector<uint32_t> & remap, const uint32_t * indices, size_t indexCount, size_t vertexCount, const VertexStream * streams, size_t streamCount)
+{
+	remap.assign(vertexCount, UNUSED_VERTEX);
+
+	// open addressing with linear probing, kept at most half full
+	size_t tableSize = 1;
+	while (tableSize < vertexCount * 2) tableSize *= 2;
+	vector<uint32_t> table(tableSize, UNUSED_VERTEX);
+
+	uint32_t uniqueCount = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t vertex = indices[i];
+		assert(vertex < vertexCount);
+		if (remap[vertex] != UNUSED_VERTEX) continue;
+
+		size_t bucket = hashVertex(vertex, streams, streamCount) & (tableSize - 1);
+		while (table[bucket] != UNUSED_VERTEX && !equalVertices(table[bucket], vertex, streams, streamCount))
+			bucket = (bucket + 1) & (tableSize - 1);
+
+		if (table[bucket] == UNUSED_VERTEX) {
+			table[bucket] = vertex;
+			remap[vertex] = uniqueCount++;
+		}
+		else {
+			remap[vertex] = remap[table[bucket]];
+		}
+	}
+
+	return uniqueCount;
+}
+
+void remapIndexBuffer(uint32_t * destination, const uint32_t * indices, size_t indexCount, const uint32_t * remap)
+{
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		assert(remap[indices[i]] != UNUSED_VERTEX);
+		destination[i] = remap[indices[i]];
+	}
+}
+
+void remapVertexBuffer(void * destination, const void * vertices, size_t vertexCount, size_t stride, const uint32_t * remap)
+{
+	auto source = reinterpret_cast<const char*>(vertices);
+	auto target = reinterpret_cast<char*>(destination);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		if (remap[i] != UNUSED_VERTEX)
+			memcpy(target + remap[i] * stride, source + i * stride, stride);
+	}
+}
+
+// vertex -> triangles that use it, as one flat array with an offset per vertex
+struct TriangleAdjacency
+{
+	vector<uint32_t> counts;
+	vector<uint32_t> offsets;
+	vector<uint32_t> triangles;
+};
+
+static void buildAdjacency(TriangleAdjacency & adjacency, const uint32_t * indices, size_t indexCount, size_t vertexCount)
+{
+	adjacency.counts.assign(vertexCount, 0);
+	adjacency.offsets.resize(vertexCount);
+	adjacency.triangles.resize(indexCount);
+
+	for (size_t i = 0; i < indexCount; i++) adjacency.counts[indices[i]]++;
+
+	uint32_t offset = 0;
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacency.offsets[v] = offset;
+		offset += adjacency.counts[v];
+	}
+
+	vector<uint32_t> fill(adjacency.offsets);
+	for (size_t i = 0; i < indexCount; i++) adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+}
+
+void optimizeVertexCache(uint32_t * destination, const uint32_t * indices, size_t indexCount, size_t vertexCount, unsigned cacheSize)
+{
+	assert(indexCount % 3 == 0);
+	assert(destination != indices);
+	if (indexCount == 0) return;
+
+	TriangleAdjacency adjacency;
+	buildAdjacency(adjacency, indices, indexCount, vertexCount);
+
+	// live triangles per vertex, the time each vertex entered the cache and the stack of recently used vertices
+	// to fall back on when the current fan runs dry
+	vector<uint32_t> liveTriangles(adjacency.counts);
+	vector<uint32_t> cacheTime(vertexCount, 0);
+	vector<uint32_t> deadEnds;
+	vector<bool> emitted(indexCount / 3, false);
+	vector<uint32_t> candidates;
+	deadEnds.reserve(indexCount);
+
+	uint32_t timestamp = cacheSize + 1;
+	size_t cursor = 0;
+	size_t outputCount = 0;
+	int64_t fanVertex = 0;
+
+	while (fanVertex >= 0)
+	{
+		candidates.clear();
+
+		// emit every remaining triangle around the fanning vertex
+		uint32_t begin = adjacency.offsets[fanVertex];
+		uint32_t end = begin + adjacency.counts[fanVertex];
+		for (uint32_t t = begin; t < end; t++)
+		{
+			uint32_t triangle = adjacency.triangles[t];
+			if (emitted[triangle]) continue;
+
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t vertex = indices[triangle * 3 + k];
+				destination[outputCount++] = vertex;
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+
+				if (timestamp - cacheTime[vertex] > cacheSize)
+					cacheTime[vertex] = timestamp++;
+			}
+
+			emitted[triangle] = true;
+		}
+
+		// next fan: the candidate that will still be in the cache once all its triangles are emitted, oldest first
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates)
+		{
+			if (liveTriangles[vertex] == 0) continue;
+
+			int64_t priority = 0;
+			if (timestamp - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+				priority = timestamp - cacheTime[vertex];
+
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+
+		if (best < 0) {
+			// dead end, go back through the recently used vertices and then sweep the input in order
+			while (!deadEnds.empty() && best < 0)
+			{
+				uint32_t vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex] > 0) best = vertex;
+			}
+
+			while (cursor < vertexCount && best < 0)
+			{
+				if (liveTriangles[cursor] > 0) best = cursor;
+				cursor++;
+			}
+		}
+
+		fanVertex = best;
+	}
+
+	assert(outputCount == indexCount);
+}
+
+// FIFO cache simulation shared by the overdraw optimizer and the statistics, returns the misses of one triangle
+static unsigned cacheMisses(const uint32_t * triangle, vector<uint32_t> & cacheTime, uint32_t & timestamp, unsigned cacheSize)
+{
+	unsigned misses = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		if (timestamp - cacheTime[triangle[k]] > cacheSize) {
+			cacheTime[triangle[k]] = timestamp++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+void optimizeOverdraw(uint32_t * destination, const uint32_t * indices, size_t indexCount, const float * positions, size_t positionStride, size_t vertexCount, float threshold, unsigned cacheSize)
+{
+	assert(indexCount % 3 == 0);
+	assert(destination != indices);
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) return;
+
+	vector<uint32_t> cacheTime(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+
+	// a triangle that misses on all three vertices starts a new patch of the mesh, those are the hard boundaries
+	vector<uint32_t> hardBoundaries;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		if (cacheMisses(indices + t * 3, cacheTime, timestamp, cacheSize) == 3 || t == 0)
+			hardBoundaries.push_back(static_cast<uint32_t>(t));
+	}
+	hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+	// split the patches further wherever the cache has warmed up enough that starting over costs little
+	vector<uint32_t> clusters;
+	for (size_t h = 0; h + 1 < hardBoundaries.size(); h++)
+	{
+		uint32_t start = hardBoundaries[h];
+		uint32_t end = hardBoundaries[h + 1];
+
+		timestamp += cacheSize + 1;
+		unsigned patchMisses = 0;
+		for (uint32_t t = start; t < end; t++) patchMisses += cacheMisses(indices + t * 3, cacheTime, timestamp, cacheSize);
+		float clusterThreshold = threshold * patchMisses / (end - start);
+
+		timestamp += cacheSize + 1;
+		clusters.push_back(start);
+		uint32_t clusterStart = start;
+		unsigned misses = 0;
+		for (uint32_t t = start; t + 1 < end; t++)
+		{
+			misses += cacheMisses(indices + t * 3, cacheTime, timestamp, cacheSize);
+			if (float(misses) / (t + 1 - clusterStart) <= clusterThreshold) {
+				clusters.push_back(t + 1);
+				clusterStart = t + 1;
+				misses = 0;
+				timestamp += cacheSize + 1;
+			}
+		}
+	}
+	clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+	auto position = [&](uint32_t vertex) {
+		return reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + vertex * positionStride);
+	};
+
+	// area weighted centroid and normal of every cluster, clusters facing away from the mesh centre are drawn first
+	// since they are the most likely to occlude the rest
+	size_t clusterCount = clusters.size() - 1;
+	vector<float> clusterData(clusterCount * 7, 0.0f);
+	float meshCentroid[3] = {};
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		float * data = &clusterData[c * 7];
+		for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const float * p0 = position(indices[t * 3 + 0]);
+			const float * p1 = position(indices[t * 3 + 1]);
+			const float * p2 = position(indices[t * 3 + 2]);
+
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+			for (int k = 0; k < 3; k++)
+			{
+				data[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+				data[3 + k] += normal[k];
+			}
+			data[6] += area;
+		}
+
+		for (int k = 0; k < 3; k++) meshCentroid[k] += data[k];
+		meshArea += data[6];
+	}
+
+	for (int k = 0; k < 3; k++) meshCentroid[k] = meshArea > 0.0f ? meshCentroid[k] / meshArea : 0.0f;
+
+	vector<float> sortKeys(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		const float * data = &clusterData[c * 7];
+		float inverseArea = data[6] > 0.0f ? 1.0f / data[6] : 0.0f;
+		float length = sqrtf(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+		float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+		sortKeys[c] = 0.0f;
+		for (int k = 0; k < 3; k++)
+			sortKeys[c] += (data[k] * inverseArea - meshCentroid[k]) * data[3 + k] * inverseLength;
+	}
+
+	vector<uint32_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) order[c] = static_cast<uint32_t>(c);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	size_t outputCount = 0;
+	for (uint32_t c : order)
+	{
+		size_t count = (clusters[c + 1] - clusters[c]) * 3;
+		memcpy(destination + outputCount, indices + clusters[c] * 3, count * sizeof(uint32_t));
+		outputCount += count;
+	}
+}
+
+size_t optimizeVertexFetch(vector<uint32_t> & remap, const uint32_t * indices, size_t indexCount, size_t vertexCount)
+{
+	remap.assign(vertexCount, UNUSED_VERTEX);
+
+	uint32_t nextVertex = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (remap[indices[i]] == UNUSED_VERTEX)
+			remap[indices[i]] = nextVertex++;
+	}
+
+	return nextVertex;
+}
+
+VertexCacheStatistics analyzeVertexCache(const uint32_t * indices, size_t indexCount, size_t vertexCount, unsigned cacheSize)
+{
+	VertexCacheStatistics statistics = {};
+	statistics.triangleCount = static_cast<uint32_t>(indexCount / 3);
+
+	vector<uint32_t> cacheTime(vertexCount, 0);
+	vector<bool> used(vertexCount, false);
+	uint32_t timestamp = cacheSize + 1;
+
+	for (size_t t = 0; t < statistics.triangleCount; t++)
+		statistics.transformedVertices += cacheMisses(indices + t * 3, cacheTime, timestamp, cacheSize);
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (!used[indices[i]]) {
+			used[indices[i]] = true;
+			statistics.vertexCount++;
+		}
+	}
+
+	statistics.acmr = statistics.triangleCount ? float(statistics.transformedVertices) / statistics.triangleCount : 0.0f;
+	statistics.atvr = statistics.vertexCount ? float(statistics.transformedVertices) / statistics.vertexCount : 0.0f;
+	return statistics;
+}
+
+void packShortIndices(uint16_t * destination, const uint32_t * indices, size_t indexCount)
+{
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		assert(indices[i] < 0xffff);
+		destination[i] = static_cast<uint16_t>(indices[i]);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*Index buffer processing for the models the demos load.
+
+Assimp's .obj importer hands back three unique vertices per triangle, so the GPU shades every corner even though
+most of them are shared with the neighbouring triangles. The usual pipeline is
+
+	1. weldVertices        - merge bitwise identical vertices so triangles share them through the index buffer
+	2. optimizeVertexCache - reorder triangles so recently transformed vertices are reused (Tipsify, Sander et al. 2007)
+	3. optimizeOverdraw    - reorder clusters of those triangles so outward facing ones are drawn first
+	4. optimizeVertexFetch - renumber vertices in the order the index buffer first touches them
+
+Every step writes new indices and leaves the input alone. Index arrays are always 32 bit here,
+packShortIndices produces the 16 bit version once the vertex count is known to fit.*/
+
+// One attribute array of the vertices being welded, stride bytes of every vertex are compared
+struct VertexStream
+{
+	const void * data;
+	size_t stride;
+};
+
+// Post-transform cache numbers for an index buffer, replayed through a FIFO cache of cacheSize entries.
+// ACMR (average cache miss ratio) is transformed vertices per triangle: 3 for an unindexed list, ~0.5 is the best possible.
+// ATVR (average transform to vertex ratio) is transformed vertices per unique vertex: 1 is perfect.
+struct VertexCacheStatistics
+{
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+	uint32_t transformedVertices;
+	float acmr;
+	float atvr;
+};
+
+const unsigned VERTEX_CACHE_SIZE = 16;
+const uint32_t UNUSED_VERTEX = ~0u;
+
+// Fills remap (one entry per input vertex) with the welded vertex index and returns the number of unique vertices.
+// Vertices no triangle references get UNUSED_VERTEX.
+size_t weldVertices(std::vector<uint32_t> & remap, const uint32_t * indices, size_t indexCount, size_t vertexCount, const VertexStream * streams, size_t streamCount);
+
+void remapIndexBuffer(uint32_t * destination, const uint32_t * indices, size_t indexCount, const uint32_t * remap);
+void remapVertexBuffer(void * destination, const void * vertices, size_t vertexCount, size_t stride, const uint32_t * remap);
+
+void optimizeVertexCache(uint32_t * destination, const uint32_t * indices, size_t indexCount, size_t vertexCount, unsigned cacheSize = VERTEX_CACHE_SIZE);
+
+// Expects a vertex cache optimized index buffer. threshold is how much worse than the input the ACMR may get,
+// 1.05 keeps the cache gains almost intact while still splitting the mesh into enough clusters to sort.
+void optimizeOverdraw(uint32_t * destination, const uint32_t * indices, size_t indexCount, const float * positions, size_t positionStride, size_t vertexCount, float threshold = 1.05f, unsigned cacheSize = VERTEX_CACHE_SIZE);
+
+// Fills remap with the new vertex order and returns the number of referenced vertices, apply it with remapIndexBuffer / remapVertexBuffer.
+size_t optimizeVertexFetch(std::vector<uint32_t> & remap, const uint32_t * indices, size_t indexCount, size_t vertexCount);
+
+VertexCacheStatistics analyzeVertexCache(const uint32_t * indices, size_t indexCount, size_t vertexCount, unsigned cacheSize = VERTEX_CACHE_SIZE);
+
+// 0xffff is kept free so it can still be used as the primitive restart index
+inline bool fitsShortIndices(size_t vertexCount) { return vertexCount < 0xffff; }
+void packShortIndices(uint16_t * destination, const uint32_t * indices, size_t indexCount);
@@ -0,0 +1,331 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using std::vector;
+
+namespace
+{
+	struct Vector3
+	{
+		float x, y, z;
+	};
+
+	Vector3 operator-(const Vector3 & a, const Vector3 & b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	float dot(const Vector3 & a, const Vector3 & b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	Vector3 cross(const Vector3 & a, const Vector3 & b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+	// symmetric 4x4 of the plane equations, weight is the total area that went in so the error can be averaged
+	struct Quadric
+	{
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double weight;
+
+		void addPlane(const Vector3 & normal, float distance, double planeWeight)
+		{
+			a00 += planeWeight * normal.x * normal.x;
+			a01 += planeWeight * normal.x * normal.y;
+			a02 += planeWeight * normal.x * normal.z;
+			a11 += planeWeight * normal.y * normal.y;
+			a12 += planeWeight * normal.y * normal.z;
+			a22 += planeWeight * normal.z * normal.z;
+			b0 += planeWeight * normal.x * distance;
+			b1 += planeWeight * normal.y * distance;
+			b2 += planeWeight * normal.z * distance;
+			c += planeWeight * distance * distance;
+			weight += planeWeight;
+		}
+
+		void add(const Quadric & other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		double evaluate(const Vector3 & p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + a11 * y * y + 2 * a12 * y * z + a22 * z * z
+				+ 2 * (b0 * x + b1 * y + b2 * z) + c;
+		}
+	};
+
+	enum VertexKind : uint8_t
+	{
+		VERTEX_INTERIOR,
+		VERTEX_BORDER,
+		VERTEX_LOCKED, // seams, corners of borders, non manifold
+	};
+
+	struct Collapse
+	{
+		uint32_t source;
+		uint32_t target;
+		float cost;
+	};
+
+	uint64_t edgeKey(uint32_t a, uint32_t b)
+	{
+		return (uint64_t(a) << 32) | b;
+	}
+}
+
+size_t simplifyMesh(uint32_t * destination, const uint32_t * indices, size_t indexCount, const float * positions, size_t positionStride,
+	size_t vertexCount, size_t targetIndexCount, float targetError, const SimplifyAttributes * attributes, float * resultError)
+{
+	if (resultError) *resultError = 0.0f;
+
+	// positions scaled into the unit cube so errors are relative to the mesh
+	vector<Vector3> points(vertexCount);
+	Vector3 low = { FLT_MAX, FLT_MAX, FLT_MAX }, high = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float * p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + positionStride * i);
+		points[i] = { p[0], p[1], p[2] };
+		low = { std::min(low.x, p[0]), std::min(low.y, p[1]), std::min(low.z, p[2]) };
+		high = { std::max(high.x, p[0]), std::max(high.y, p[1]), std::max(high.z, p[2]) };
+	}
+	float extent = std::max(high.x - low.x, std::max(high.y - low.y, high.z - low.z));
+	float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+	for (auto & point : points)
+		point = { (point.x - low.x) * scale, (point.y - low.y) * scale, (point.z - low.z) * scale };
+
+	// vertices sharing a position are one point of the surface, the lowest index stands for all of them
+	vector<uint32_t> order(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++) order[i] = i;
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		if (points[a].x != points[b].x) return points[a].x < points[b].x;
+		if (points[a].y != points[b].y) return points[a].y < points[b].y;
+		if (points[a].z != points[b].z) return points[a].z < points[b].z;
+		return a < b;
+	});
+	vector<uint32_t> wedge(vertexCount);
+	vector<uint32_t> wedgeSize(vertexCount, 0);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		uint32_t vertex = order[i];
+		bool same = i > 0 && memcmp(&points[order[i - 1]], &points[vertex], sizeof(Vector3)) == 0;
+		wedge[vertex] = same ? wedge[order[i - 1]] : vertex;
+		wedgeSize[wedge[vertex]]++;
+	}
+
+	vector<uint32_t> result(indices, indices + indexCount);
+
+	// open edges, found between the position representatives so uv seams do not look like holes
+	vector<uint64_t> edges;
+	edges.reserve(indexCount);
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t a = wedge[result[i + corner]], b = wedge[result[i + (corner + 1) % 3]];
+			edges.push_back(edgeKey(a, b));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	auto hasEdge = [&](uint32_t a, uint32_t b) { return std::binary_search(edges.begin(), edges.end(), edgeKey(a, b)); };
+	auto isBorderEdge = [&](uint32_t a, uint32_t b) {
+		return (hasEdge(a, b) && !hasEdge(b, a)) || (hasEdge(b, a) && !hasEdge(a, b));
+	};
+
+	vector<uint8_t> openOut(vertexCount, 0), openIn(vertexCount, 0);
+	for (auto key : edges)
+	{
+		uint32_t a = uint32_t(key >> 32), b = uint32_t(key);
+		if (!hasEdge(b, a)) {
+			openOut[a] = uint8_t(std::min(openOut[a] + 1, 2));
+			openIn[b] = uint8_t(std::min(openIn[b] + 1, 2));
+		}
+	}
+
+	vector<uint8_t> kind(vertexCount, VERTEX_INTERIOR);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		uint32_t point = wedge[vertex];
+		if (wedgeSize[point] > 1)
+			kind[vertex] = VERTEX_LOCKED;
+		else if (openOut[point] == 0 && openIn[point] == 0)
+			kind[vertex] = VERTEX_INTERIOR;
+		else if (openOut[point] == 1 && openIn[point] == 1)
+			kind[vertex] = VERTEX_BORDER;
+		else
+			kind[vertex] = VERTEX_LOCKED;
+	}
+
+	// quadrics per surface point: area weighted triangle planes, plus planes through the open edges standing
+	// perpendicular on the surface so borders resist moving inwards
+	vector<Quadric> quadrics(vertexCount, Quadric());
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		const Vector3 & p0 = points[result[i + 0]];
+		const Vector3 & p1 = points[result[i + 1]];
+		const Vector3 & p2 = points[result[i + 2]];
+		Vector3 normal = cross(p1 - p0, p2 - p0);
+		float area = std::sqrt(dot(normal, normal));
+		if (area == 0.0f) continue;
+		normal = { normal.x / area, normal.y / area, normal.z / area };
+
+		for (int corner = 0; corner < 3; corner++)
+			quadrics[wedge[result[i + corner]]].addPlane(normal, -dot(normal, p0), area);
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t a = wedge[result[i + corner]], b = wedge[result[i + (corner + 1) % 3]];
+			if (hasEdge(b, a)) continue;
+
+			Vector3 edge = points[b] - points[a];
+			Vector3 edgeNormal = cross(edge, normal);
+			float length = std::sqrt(dot(edgeNormal, edgeNormal));
+			if (length == 0.0f) continue;
+			edgeNormal = { edgeNormal.x / length, edgeNormal.y / length, edgeNormal.z / length };
+
+			// weighted well above the surface planes, losing the outline is far more visible than a dent
+			double borderWeight = 10.0 * dot(edge, edge);
+			quadrics[a].addPlane(edgeNormal, -dot(edgeNormal, points[a]), borderWeight);
+			quadrics[b].addPlane(edgeNormal, -dot(edgeNormal, points[a]), borderWeight);
+		}
+	}
+
+	auto attributeCost = [&](uint32_t a, uint32_t b) {
+		if (!attributes || !attributes->data) return 0.0f;
+		auto attributeA = reinterpret_cast<const float*>(reinterpret_cast<const char*>(attributes->data) + attributes->stride * a);
+		auto attributeB = reinterpret_cast<const float*>(reinterpret_cast<const char*>(attributes->data) + attributes->stride * b);
+		float cost = 0.0f;
+		for (size_t i = 0; i < attributes->attributeCount; i++)
+		{
+			float difference = (attributeA[i] - attributeB[i]) * attributes->weights[i];
+			cost += difference * difference;
+		}
+		return cost;
+	};
+
+	auto geometricCost = [&](uint32_t source, uint32_t target) {
+		Quadric quadric = quadrics[wedge[source]];
+		quadric.add(quadrics[wedge[target]]);
+		double error = quadric.weight > 0.0 ? quadric.evaluate(points[target]) / quadric.weight : 0.0;
+		return float(std::max(error, 0.0));
+	};
+	auto collapseCost = [&](uint32_t source, uint32_t target) {
+		return geometricCost(source, target) + attributeCost(source, target);
+	};
+
+	auto canCollapse = [&](uint32_t source, uint32_t target) {
+		if (wedge[source] == wedge[target]) return false;
+		if (kind[source] == VERTEX_INTERIOR) return true;
+		if (kind[source] == VERTEX_BORDER) return isBorderEdge(wedge[source], wedge[target]);
+		return false;
+	};
+
+	vector<uint32_t> remap(vertexCount);
+	vector<uint8_t> touched(vertexCount);
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	vector<uint32_t> adjacency;
+	vector<Collapse> collapses;
+	float maximumError = 0.0f;
+	float errorLimit = targetError * targetError;
+
+	while (result.size() > targetIndexCount)
+	{
+		size_t triangleCount = result.size() / 3;
+
+		// triangles around every vertex for the flip test
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (auto vertex : result) adjacencyOffsets[vertex + 1]++;
+		for (size_t i = 0; i < vertexCount; i++) adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+		adjacency.resize(result.size());
+		{
+			vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); i++) adjacency[fill[result[i]]++] = uint32_t(i / 3);
+		}
+
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t a = result[i + corner], b = result[i + (corner + 1) % 3];
+				// only the cheaper direction of every edge is worth keeping
+				bool forward = canCollapse(a, b), backward = canCollapse(b, a);
+				if (!forward && !backward) continue;
+
+				float forwardCost = forward ? collapseCost(a, b) : FLT_MAX;
+				float backwardCost = backward ? collapseCost(b, a) : FLT_MAX;
+				if (forwardCost <= backwardCost) collapses.push_back({ a, b, forwardCost });
+				else collapses.push_back({ b, a, backwardCost });
+			}
+		}
+		if (collapses.empty()) break;
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse & a, const Collapse & b) { return a.cost < b.cost; });
+
+		for (uint32_t i = 0; i < vertexCount; i++) remap[i] = i;
+		std::fill(touched.begin(), touched.end(), 0);
+
+		// an interior collapse removes two triangles, a border one removes one
+		size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+		size_t removed = 0;
+		size_t collapsed = 0;
+
+		for (auto & collapse : collapses)
+		{
+			if (collapse.cost > errorLimit || removed >= trianglesToRemove) break;
+			if (touched[collapse.source] || touched[collapse.target]) continue;
+
+			// moving source onto target must not turn any of its other triangles over
+			const Vector3 & to = points[collapse.target];
+			bool flips = false;
+			for (uint32_t x = adjacencyOffsets[collapse.source]; x < adjacencyOffsets[collapse.source + 1] && !flips; x++)
+			{
+				const uint32_t * triangle = &result[adjacency[x] * 3];
+				if (triangle[0] == collapse.target || triangle[1] == collapse.target || triangle[2] == collapse.target) continue;
+
+				Vector3 corners[3] = { points[triangle[0]], points[triangle[1]], points[triangle[2]] };
+				Vector3 before = cross(corners[1] - corners[0], corners[2] - corners[0]);
+				for (int corner = 0; corner < 3; corner++)
+					if (triangle[corner] == collapse.source) corners[corner] = to;
+				Vector3 after = cross(corners[1] - corners[0], corners[2] - corners[0]);
+				flips = dot(before, after) <= 0.0f;
+			}
+			if (flips) continue;
+
+			maximumError = std::max(maximumError, geometricCost(collapse.source, collapse.target));
+			remap[collapse.source] = collapse.target;
+			quadrics[wedge[collapse.target]].add(quadrics[wedge[collapse.source]]);
+			touched[collapse.source] = touched[collapse.target] = 1;
+			// the triangles around source change shape, their other vertices wait for the next pass
+			for (uint32_t x = adjacencyOffsets[collapse.source]; x < adjacencyOffsets[collapse.source + 1]; x++)
+			{
+				const uint32_t * triangle = &result[adjacency[x] * 3];
+				touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+			}
+
+			removed += kind[collapse.source] == VERTEX_BORDER ? 1 : 2;
+			collapsed++;
+		}
+		if (collapsed == 0) break;
+
+		// drop the triangles that lost an edge
+		size_t write = 0;
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			uint32_t a = remap[result[i * 3 + 0]], b = remap[result[i * 3 + 1]], c = remap[result[i * 3 + 2]];
+			if (a == b || b == c || c == a) continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	std::copy(result.begin(), result.end(), destination);
+	if (resultError) *resultError = std::sqrt(maximumError);
+	return result.size();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*Quadric error metric simplification (Garland and Heckbert 1997) for the level of detail chains in the mesh cache.
+
+Every collapse moves one vertex onto a neighbour, so simplified index buffers keep using the original vertex buffer and
+a whole LOD chain is just a few more index ranges. The cost of a collapse is the quadric error of the planes around
+both vertices, plus the weighted squared difference of the vertex attributes (normal, uv, ...) so collapses across
+shading or texture discontinuities are expensive.
+
+Vertex classes keep the silhouette and the texture layout intact:
+	- border vertices (on an open edge) only slide along the border
+	- seam vertices (same position as another vertex with different attributes) and anything non manifold stay put
+
+Collapses are done in passes over the edges sorted by cost, touching every vertex at most once per pass and rejecting
+collapses that would flip a triangle.
+
+Errors are relative to the size of the mesh: 0.01 is 1% of the largest extent of its bounding box.*/
+
+struct SimplifyAttributes
+{
+	const float * data; // attributeCount floats per vertex, nullptr for position only
+	size_t stride; // bytes
+	const float * weights; // one per attribute, how much a unit of difference is worth compared to a unit of distance
+	size_t attributeCount;
+};
+
+// Writes at most indexCount indices to destination and returns how many were written. Stops at targetIndexCount or
+// when the next collapse would cost more than targetError (distance and attributes together). resultError gets the
+// largest distance error of the collapses done, leaving out the attributes so it can be projected to the screen.
+size_t simplifyMesh(uint32_t * destination, const uint32_t * indices, size_t indexCount, const float * positions, size_t positionStride,
+	size_t vertexCount, size_t targetIndexCount, float targetError, const SimplifyAttributes * attributes = nullptr, float * resultError = nullptr);
@@ -0,0 +1,348 @@
+#include "Meshlets.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <emmintrin.h>
+#include "ThreadPool.h"
+#include "Timer.h"
+
+using std::vector;
+
+static void appendCullingData(MeshletMesh & mesh, const Meshlet & meshlet)
+{
+	mesh.centerX.push_back(meshlet.center[0]);
+	mesh.centerY.push_back(meshlet.center[1]);
+	mesh.centerZ.push_back(meshlet.center[2]);
+	mesh.radius.push_back(meshlet.radius);
+	mesh.coneAxisX.push_back(meshlet.coneAxis[0]);
+	mesh.coneAxisY.push_back(meshlet.coneAxis[1]);
+	mesh.coneAxisZ.push_back(meshlet.coneAxis[2]);
+	mesh.coneCutoff.push_back(meshlet.coneCutoff);
+}
+
+// sphere around the vertices and cone around the normals of meshlet.triangleCount triangles
+static void computeBounds(Meshlet & meshlet, const uint32_t * indices, const vector<uint32_t> & vertices, const float * positions, size_t stride)
+{
+	auto position = [&](uint32_t vertex) {
+		const float * p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + stride * vertex);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	glm::vec3 low(FLT_MAX), high(-FLT_MAX);
+	for (auto vertex : vertices)
+	{
+		low = glm::min(low, position(vertex));
+		high = glm::max(high, position(vertex));
+	}
+
+	glm::vec3 center = (low + high) * 0.5f;
+	float radius = 0.0f;
+	for (auto vertex : vertices)
+		radius = std::max(radius, glm::length(position(vertex) - center));
+
+	vector<glm::vec3> normals;
+	normals.reserve(meshlet.triangleCount);
+	glm::vec3 axis(0.0f);
+	for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+	{
+		glm::vec3 a = position(indices[i * 3 + 0]);
+		glm::vec3 b = position(indices[i * 3 + 1]);
+		glm::vec3 c = position(indices[i * 3 + 2]);
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		float area = glm::length(normal);
+		if (area == 0.0f) continue; // degenerate triangles are never rasterized, they do not widen the cone
+
+		normals.push_back(normal / area);
+		axis += normals.back();
+	}
+
+	float cutoff = 1.0f;
+	float axisLength = glm::length(axis);
+	if (axisLength > 0.0f) {
+		axis /= axisLength;
+		float minimumDot = 1.0f;
+		for (auto & normal : normals)
+			minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+
+		// a cone wider than ~84 degrees half angle hardly ever culls anything, leave it at "never"
+		if (minimumDot > 0.1f)
+			cutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		meshlet.center[i] = center[i];
+		meshlet.coneAxis[i] = axis[i];
+	}
+	meshlet.radius = radius;
+	meshlet.coneCutoff = cutoff;
+}
+
+void buildMeshlets(MeshletMesh & mesh, const uint32_t * indices, size_t indexCount, const float * positions, size_t positionStride,
+	size_t vertexCount, int32_t baseVertex, size_t maxVertices, size_t maxTriangles)
+{
+	// drop the padding of the previous call, it goes back on at the end
+	mesh.centerX.resize(mesh.meshlets.size());
+	mesh.centerY.resize(mesh.meshlets.size());
+	mesh.centerZ.resize(mesh.meshlets.size());
+	mesh.radius.resize(mesh.meshlets.size());
+	mesh.coneAxisX.resize(mesh.meshlets.size());
+	mesh.coneAxisY.resize(mesh.meshlets.size());
+	mesh.coneAxisZ.resize(mesh.meshlets.size());
+	mesh.coneCutoff.resize(mesh.meshlets.size());
+
+	size_t triangleCount = indexCount / 3;
+
+	// triangles around every vertex, the clusters grow through these so they stay connected
+	vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacencyOffsets[indices[i] + 1]++;
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+	vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+			adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	vector<glm::vec3> triangleNormals(triangleCount);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		auto position = [&](uint32_t vertex) {
+			const float * p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + positionStride * vertex);
+			return glm::vec3(p[0], p[1], p[2]);
+		};
+		glm::vec3 a = position(indices[triangle * 3 + 0]);
+		glm::vec3 normal = glm::cross(position(indices[triangle * 3 + 1]) - a, position(indices[triangle * 3 + 2]) - a);
+		float length = glm::length(normal);
+		triangleNormals[triangle] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+	}
+
+	// stamp of the meshlet that last used every vertex, avoids clearing a set per meshlet
+	vector<uint32_t> stamp(vertexCount, UINT32_MAX);
+	vector<uint8_t> emitted(triangleCount, 0);
+	vector<uint32_t> vertices;
+	uint32_t current = 0;
+	glm::vec3 normalSum(0.0f);
+
+	Meshlet meshlet = {};
+	meshlet.indexOffset = static_cast<uint32_t>(mesh.indices.size());
+	meshlet.baseVertex = baseVertex;
+
+	auto finish = [&]() {
+		if (meshlet.triangleCount == 0) return;
+		meshlet.vertexCount = static_cast<uint32_t>(vertices.size());
+		computeBounds(meshlet, &mesh.indices[meshlet.indexOffset], vertices, positions, positionStride);
+		mesh.meshlets.push_back(meshlet);
+		appendCullingData(mesh, meshlet);
+
+		vertices.clear();
+		current++;
+		normalSum = glm::vec3(0.0f);
+		meshlet.indexOffset = static_cast<uint32_t>(mesh.indices.size());
+		meshlet.triangleCount = 0;
+	};
+
+	auto newVertexCount = [&](size_t triangle) {
+		const uint32_t * corners = &indices[triangle * 3];
+		// a triangle may name the same vertex twice, count it once
+		return (stamp[corners[0]] != current ? 1 : 0)
+			+ (stamp[corners[1]] != current && corners[1] != corners[0] ? 1 : 0)
+			+ (stamp[corners[2]] != current && corners[2] != corners[0] && corners[2] != corners[1] ? 1 : 0);
+	};
+
+	size_t seed = 0;
+	for (size_t added = 0; added < triangleCount; added++)
+	{
+		// the next triangle is the neighbour that adds the fewest vertices, ties go to the one closest to the
+		// cluster's average normal so the cone stays narrow. Without neighbours, continue in index buffer order.
+		size_t best = SIZE_MAX;
+		float bestScore = FLT_MAX;
+		glm::vec3 axis = glm::length(normalSum) > 0.0f ? glm::normalize(normalSum) : glm::vec3(0.0f);
+		for (auto vertex : vertices)
+		{
+			for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; i++)
+			{
+				uint32_t triangle = adjacency[i];
+				if (emitted[triangle]) continue;
+				float score = newVertexCount(triangle) + 0.5f * (1.0f - glm::dot(axis, triangleNormals[triangle]));
+				if (score < bestScore) {
+					bestScore = score;
+					best = triangle;
+				}
+			}
+		}
+
+		if (best == SIZE_MAX) {
+			while (emitted[seed]) seed++;
+			best = seed;
+		}
+
+		if (vertices.size() + newVertexCount(best) > maxVertices || meshlet.triangleCount + 1 > maxTriangles) {
+			finish();
+			// a fresh cluster starts from the oldest triangle left, not from a neighbour of the one just closed
+			while (emitted[seed]) seed++;
+			best = seed;
+		}
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t vertex = indices[best * 3 + corner];
+			if (stamp[vertex] != current) {
+				stamp[vertex] = current;
+				vertices.push_back(vertex);
+			}
+			mesh.indices.push_back(vertex);
+		}
+		emitted[best] = 1;
+		normalSum += triangleNormals[best];
+		meshlet.triangleCount++;
+	}
+	finish();
+
+	// padding clusters can never pass the frustum test, the culler masks them out of its counts anyway
+	while (mesh.centerX.size() % 4 != 0)
+	{
+		Meshlet padding = {};
+		padding.radius = -FLT_MAX;
+		padding.coneCutoff = 1.0f;
+		appendCullingData(mesh, padding);
+	}
+}
+
+// planes of the clip volume in the space mvp transforms from, normalized so distances are in that space
+static void extractPlanes(const glm::mat4 & mvp, glm::vec4 planes[6])
+{
+	glm::vec4 row0(mvp[0][0], mvp[1][0], mvp[2][0], mvp[3][0]);
+	glm::vec4 row1(mvp[0][1], mvp[1][1], mvp[2][1], mvp[3][1]);
+	glm::vec4 row2(mvp[0][2], mvp[1][2], mvp[2][2], mvp[3][2]);
+	glm::vec4 row3(mvp[0][3], mvp[1][3], mvp[2][3], mvp[3][3]);
+
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+
+	for (int i = 0; i < 6; i++)
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+static int popCount4(int mask)
+{
+	return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+static void cullInstance(const MeshletMesh & mesh, const glm::mat4 & model, const glm::mat4 & viewProjection, const glm::vec3 & eye,
+	uint32_t instance, bool culling, vector<DrawElementsIndirectCommand> & commands, MeshletCullStatistics & statistics)
+{
+	commands.clear();
+	statistics = MeshletCullStatistics();
+
+	size_t meshletCount = mesh.meshlets.size();
+	statistics.clusters = meshletCount;
+	statistics.triangles = mesh.triangleCount();
+
+	auto emit = [&](const Meshlet & meshlet) {
+		commands.push_back({ meshlet.triangleCount * 3, 1, meshlet.indexOffset, meshlet.baseVertex, instance });
+	};
+
+	if (!culling) {
+		for (auto & meshlet : mesh.meshlets)
+			emit(meshlet);
+		return;
+	}
+
+	glm::vec4 planes[6];
+	extractPlanes(viewProjection * model, planes);
+	glm::vec3 localEye = glm::vec3(glm::inverse(model) * glm::vec4(eye, 1.0f));
+
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = _mm_set1_ps(planes[p].x);
+		planeY[p] = _mm_set1_ps(planes[p].y);
+		planeZ[p] = _mm_set1_ps(planes[p].z);
+		planeW[p] = _mm_set1_ps(planes[p].w);
+	}
+	__m128 eyeX = _mm_set1_ps(localEye.x);
+	__m128 eyeY = _mm_set1_ps(localEye.y);
+	__m128 eyeZ = _mm_set1_ps(localEye.z);
+
+	for (size_t first = 0; first < meshletCount; first += 4)
+	{
+		__m128 centerX = _mm_loadu_ps(&mesh.centerX[first]);
+		__m128 centerY = _mm_loadu_ps(&mesh.centerY[first]);
+		__m128 centerZ = _mm_loadu_ps(&mesh.centerZ[first]);
+		__m128 radius = _mm_loadu_ps(&mesh.radius[first]);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), radius);
+
+		// inside (or touching) all six planes
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		// every triangle faces away: dot(center - eye, axis) >= cutoff * |center - eye| + radius
+		__m128 toX = _mm_sub_ps(centerX, eyeX);
+		__m128 toY = _mm_sub_ps(centerY, eyeY);
+		__m128 toZ = _mm_sub_ps(centerZ, eyeZ);
+		__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(toX, toX), _mm_mul_ps(toY, toY)), _mm_mul_ps(toZ, toZ)));
+		__m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(toX, _mm_loadu_ps(&mesh.coneAxisX[first])), _mm_mul_ps(toY, _mm_loadu_ps(&mesh.coneAxisY[first]))),
+			_mm_mul_ps(toZ, _mm_loadu_ps(&mesh.coneAxisZ[first])));
+		__m128 backface = _mm_cmpge_ps(facing, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&mesh.coneCutoff[first]), distance), radius));
+
+		int valid = meshletCount - first >= 4 ? 0xf : (1 << (meshletCount - first)) - 1;
+		int insideMask = _mm_movemask_ps(inside) & valid;
+		int backfaceMask = _mm_movemask_ps(backface) & insideMask;
+		int visibleMask = insideMask & ~backfaceMask;
+
+		statistics.frustumCulled += popCount4(valid & ~insideMask);
+		statistics.backfaceCulled += popCount4(backfaceMask);
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if (visibleMask & (1 << lane))
+				emit(mesh.meshlets[first + lane]);
+			else if (valid & (1 << lane))
+				statistics.trianglesCulled += mesh.meshlets[first + lane].triangleCount;
+		}
+	}
+}
+
+void MeshletCuller::cull(const MeshletMesh & mesh, const glm::mat4 * models, size_t instanceCount, const glm::mat4 & viewProjection,
+	const glm::vec3 & eye, vector<DrawElementsIndirectCommand> & commands, bool culling)
+{
+	Timer timer;
+	instanceCommands.resize(std::max(instanceCommands.size(), instanceCount));
+	instanceStatistics.resize(instanceCount);
+
+	auto cullOne = [&](size_t instance) {
+		cullInstance(mesh, models[instance], viewProjection, eye, static_cast<uint32_t>(instance), culling,
+			instanceCommands[instance], instanceStatistics[instance]);
+	};
+
+	ThreadPool::forEach(pool, instanceCount, cullOne);
+
+	// compact the per instance lists into the one the indirect buffer gets
+	commands.clear();
+	lastStatistics = MeshletCullStatistics();
+	for (size_t instance = 0; instance < instanceCount; instance++)
+	{
+		commands.insert(commands.end(), instanceCommands[instance].begin(), instanceCommands[instance].end());
+
+		const MeshletCullStatistics & statistics = instanceStatistics[instance];
+		lastStatistics.clusters += statistics.clusters;
+		lastStatistics.frustumCulled += statistics.frustumCulled;
+		lastStatistics.backfaceCulled += statistics.backfaceCulled;
+		lastStatistics.triangles += statistics.triangles;
+		lastStatistics.trianglesCulled += statistics.trianglesCulled;
+	}
+	lastStatistics.milliseconds = timer.elapsedMilliseconds();
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm\glm.hpp>
+
+class ThreadPool;
+
+/*Meshlets (clusters) for culling below the level of a whole mesh.
+
+buildMeshlets cuts an index buffer into runs of at most 64 unique vertices and 124 triangles, taking the triangles in
+the order they come (after optimizeVertexCache neighbouring triangles are also close in space, so the clusters come out
+compact). Every cluster gets
+
+	- a bounding sphere
+	- a normal cone: axis and cutoff such that the whole cluster faces away from any eye for which
+	  dot(center - eye, axis) >= cutoff * |center - eye| + radius
+
+The triangles of every cluster are stored back to back in MeshletMesh::indices, so a visible cluster is one
+glMultiDrawElementsIndirect command. The culling data is also kept as structure of arrays padded to a multiple of four
+so the culler can test four clusters per SSE instruction.*/
+
+const size_t MESHLET_MAX_VERTICES = 64;
+const size_t MESHLET_MAX_TRIANGLES = 124;
+
+struct Meshlet
+{
+	uint32_t indexOffset; // into MeshletMesh::indices
+	uint32_t triangleCount;
+	uint32_t vertexCount; // unique vertices
+	int32_t baseVertex; // of the submesh the cluster came from
+	float center[3];
+	float radius;
+	float coneAxis[3];
+	float coneCutoff; // 1 when the triangles face too many ways to ever be backface culled
+};
+
+struct MeshletMesh
+{
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> indices;
+
+	// culling data, one entry per meshlet plus padding up to a multiple of 4
+	std::vector<float> centerX, centerY, centerZ, radius;
+	std::vector<float> coneAxisX, coneAxisY, coneAxisZ, coneCutoff;
+
+	size_t triangleCount() const { return indices.size() / 3; }
+};
+
+// Same layout as the GL struct read by glMultiDrawElementsIndirect.
+struct DrawElementsIndirectCommand
+{
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	uint32_t baseInstance;
+};
+
+// Appends the clusters of one submesh. Indices are local to it, baseVertex is what the draw adds to them.
+void buildMeshlets(MeshletMesh & mesh, const uint32_t * indices, size_t indexCount, const float * positions, size_t positionStride,
+	size_t vertexCount, int32_t baseVertex, size_t maxVertices = MESHLET_MAX_VERTICES, size_t maxTriangles = MESHLET_MAX_TRIANGLES);
+
+struct MeshletCullStatistics
+{
+	uint64_t clusters = 0; // tested, every cluster once per instance
+	uint64_t frustumCulled = 0;
+	uint64_t backfaceCulled = 0;
+	uint64_t triangles = 0;
+	uint64_t trianglesCulled = 0;
+	double milliseconds = 0.0;
+};
+
+/*Per frame culler. The planes and the eye are moved into the space of each instance, so the bounds never have to be
+transformed; that holds for rotation, translation and uniform scale. Instances are spread over the thread pool.*/
+class MeshletCuller
+{
+public:
+	// pool may be null to cull on the calling thread only
+	explicit MeshletCuller(ThreadPool * pool = nullptr) : pool(pool) {}
+
+	// Replaces commands with one command per visible cluster and instance, baseInstance is the instance index so
+	// per instance attributes (divisor 1) are fetched for the right one. With culling off every cluster is emitted.
+	void cull(const MeshletMesh & mesh, const glm::mat4 * models, size_t instanceCount, const glm::mat4 & viewProjection,
+		const glm::vec3 & eye, std::vector<DrawElementsIndirectCommand> & commands, bool culling = true);
+
+	// numbers of the last cull call
+	const MeshletCullStatistics & statistics() const { return lastStatistics; }
+
+private:
+	ThreadPool * pool;
+	std::vector<std::vector<DrawElementsIndirectCommand>> instanceCommands;
+	std::vector<MeshletCullStatistics> instanceStatistics;
+	MeshletCullStatistics lastStatistics;
+};
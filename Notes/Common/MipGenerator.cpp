@@ -0,0 +1,338 @@
+#include "MipGenerator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <functional>
+
+using std::vector;
+
+namespace
+{
+	const float PI = 3.14159265358979f;
+
+	// rows handed to a worker at a time, one row of a large level is too little work to be worth a queue round trip
+	const uint32_t ROWS_PER_JOB = 16;
+
+	float srgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	struct SrgbTables
+	{
+		float toLinear[256];
+		// linear value half way between code c and c + 1, a linear value encodes to the number of thresholds below it
+		float thresholds[255];
+		// the code of i / 4096, where the search starts. Dark values sit at most a code or two above it.
+		uint8_t start[4097];
+
+		SrgbTables()
+		{
+			for (int c = 0; c < 256; c++) toLinear[c] = srgbToLinear(c / 255.0f);
+			for (int c = 0; c < 255; c++) thresholds[c] = srgbToLinear((c + 0.5f) / 255.0f);
+
+			int code = 0;
+			for (int i = 0; i <= 4096; i++)
+			{
+				while (code < 255 && i / 4096.0f > thresholds[code]) code++;
+				start[i] = static_cast<uint8_t>(code);
+			}
+		}
+
+		uint8_t encode(float value) const
+		{
+			value = std::min(std::max(value, 0.0f), 1.0f);
+			int code = start[static_cast<int>(value * 4096.0f)];
+			while (code < 255 && value > thresholds[code]) code++;
+			return static_cast<uint8_t>(code);
+		}
+	};
+
+	const SrgbTables & srgbTables()
+	{
+		static const SrgbTables tables;
+		return tables;
+	}
+
+	uint8_t encodeUnorm(float value)
+	{
+		return static_cast<uint8_t>(std::min(std::max(value * 255.0f + 0.5f, 0.0f), 255.0f));
+	}
+
+	float sinc(float x)
+	{
+		if (std::fabs(x) < 1e-6f) return 1.0f;
+		return std::sin(PI * x) / (PI * x);
+	}
+
+	// zeroth order modified bessel function of the first kind, the series converges quickly for the alphas used here
+	float besselI0(float x)
+	{
+		float sum = 1.0f, term = 1.0f;
+		for (int k = 1; k < 32; k++)
+		{
+			float factor = x / (2.0f * k);
+			term *= factor * factor;
+			sum += term;
+			if (term < sum * 1e-8f) break;
+		}
+		return sum;
+	}
+
+	// half width of the kernel in texels of the smaller level
+	float filterRadius(MipFilter filter)
+	{
+		switch (filter)
+		{
+		case MIP_FILTER_BOX: return 0.5f;
+		case MIP_FILTER_KAISER: return 2.0f;
+		default: return 3.0f;
+		}
+	}
+
+	// t in texels of the smaller level
+	float filterWeight(MipFilter filter, float t)
+	{
+		t = std::fabs(t);
+		switch (filter)
+		{
+		case MIP_FILTER_BOX:
+			// a source texel straddling the edge of two targets (odd sizes) is shared between them
+			return t < 0.5f ? 1.0f : t == 0.5f ? 0.5f : 0.0f;
+		case MIP_FILTER_KAISER:
+		{
+			const float alpha = 4.0f, radius = 2.0f;
+			if (t >= radius) return 0.0f;
+			float ratio = t / radius;
+			return sinc(t) * besselI0(alpha * std::sqrt(1.0f - ratio * ratio)) / besselI0(alpha);
+		}
+		default:
+			return t < 3.0f ? sinc(t) * sinc(t / 3.0f) : 0.0f;
+		}
+	}
+
+	// Taps of every target texel along one axis. Every target has the same tap count, shorter ones are padded with
+	// zero weights on their last texel, so the inner loops have no branches.
+	struct FilterTaps
+	{
+		uint32_t count;
+		vector<uint32_t> indices; // target * count + tap, clamped to the source
+		vector<float> weights;
+
+		FilterTaps(MipFilter filter, uint32_t sourceSize, uint32_t targetSize)
+		{
+			// the last level on this axis, nothing to filter
+			if (sourceSize == targetSize) {
+				count = 1;
+				indices.resize(targetSize);
+				weights.assign(targetSize, 1.0f);
+				for (uint32_t i = 0; i < targetSize; i++) indices[i] = i;
+				return;
+			}
+
+			float scale = float(sourceSize) / targetSize;
+			float reach = filterRadius(filter) * scale;
+
+			vector<vector<std::pair<uint32_t, float>>> taps(targetSize);
+			count = 0;
+			for (uint32_t i = 0; i < targetSize; i++)
+			{
+				float center = (i + 0.5f) * scale;
+				int first = static_cast<int>(std::floor(center - reach - 0.5f));
+				int last = static_cast<int>(std::ceil(center + reach - 0.5f));
+
+				float sum = 0.0f;
+				for (int j = first; j <= last; j++)
+				{
+					float weight = filterWeight(filter, (j + 0.5f - center) / scale);
+					if (weight == 0.0f) continue;
+
+					uint32_t clamped = static_cast<uint32_t>(std::min(std::max(j, 0), int(sourceSize) - 1));
+					taps[i].push_back({ clamped, weight });
+					sum += weight;
+				}
+				for (auto & tap : taps[i]) tap.second /= sum;
+				count = std::max(count, static_cast<uint32_t>(taps[i].size()));
+			}
+
+			indices.resize(size_t(targetSize) * count);
+			weights.assign(size_t(targetSize) * count, 0.0f);
+			for (uint32_t i = 0; i < targetSize; i++)
+			{
+				for (uint32_t k = 0; k < count; k++)
+				{
+					size_t tap = std::min<size_t>(k, taps[i].size() - 1);
+					indices[i * count + k] = taps[i][tap].first;
+					if (k < taps[i].size()) weights[i * count + k] = taps[i][k].second;
+				}
+			}
+		}
+	};
+
+	void forRows(ThreadPool * pool, uint32_t rows, const std::function<void(uint32_t, uint32_t)> & body)
+	{
+		size_t jobs = (rows + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+		auto runJob = [&](size_t job) {
+			uint32_t first = static_cast<uint32_t>(job) * ROWS_PER_JOB;
+			body(first, std::min(first + ROWS_PER_JOB, rows));
+		};
+
+		ThreadPool::forEach(pool, jobs, runJob);
+	}
+
+	void decodeLevel(float * destination, const uint8_t * pixels, uint32_t width, uint32_t height, const MipChainOptions & options, ThreadPool * pool)
+	{
+		const SrgbTables & tables = srgbTables();
+		forRows(pool, height, [&](uint32_t firstRow, uint32_t lastRow) {
+			for (size_t i = size_t(firstRow) * width; i < size_t(lastRow) * width; i++)
+			{
+				const uint8_t * texel = pixels + i * 4;
+				float * target = destination + i * 4;
+				for (int c = 0; c < 3; c++)
+				{
+					if (options.normalMap) target[c] = texel[c] / 127.5f - 1.0f;
+					else if (options.srgb) target[c] = tables.toLinear[texel[c]];
+					else target[c] = texel[c] / 255.0f;
+				}
+				target[3] = texel[3] / 255.0f;
+			}
+		});
+	}
+
+	// filters source down to target along the rows into scratch, then down the columns of scratch into target.
+	// Normal map levels are renormalized before they are stored, since the next level is filtered from them.
+	void filterLevel(float * target, vector<float> & scratch, const float * source, uint32_t width, uint32_t height,
+		uint32_t targetWidth, uint32_t targetHeight, const MipChainOptions & options, ThreadPool * pool)
+	{
+		FilterTaps columns(options.filter, width, targetWidth);
+		FilterTaps rows(options.filter, height, targetHeight);
+		scratch.resize(size_t(targetWidth) * height * 4);
+		float * horizontal = scratch.data();
+
+		forRows(pool, height, [&](uint32_t firstRow, uint32_t lastRow) {
+			for (uint32_t y = firstRow; y < lastRow; y++)
+			{
+				const float * sourceRow = source + size_t(y) * width * 4;
+				float * targetRow = horizontal + size_t(y) * targetWidth * 4;
+				for (uint32_t x = 0; x < targetWidth; x++)
+				{
+					const uint32_t * indices = &columns.indices[size_t(x) * columns.count];
+					const float * weights = &columns.weights[size_t(x) * columns.count];
+
+					__m128 sum = _mm_setzero_ps();
+					for (uint32_t k = 0; k < columns.count; k++)
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(sourceRow + indices[k] * 4)));
+					_mm_storeu_ps(targetRow + x * 4, sum);
+				}
+			}
+		});
+
+		forRows(pool, targetHeight, [&](uint32_t firstRow, uint32_t lastRow) {
+			for (uint32_t y = firstRow; y < lastRow; y++)
+			{
+				const uint32_t * indices = &rows.indices[size_t(y) * rows.count];
+				const float * weights = &rows.weights[size_t(y) * rows.count];
+				float * targetRow = target + size_t(y) * targetWidth * 4;
+
+				// accumulates a whole row per tap, so the source rows stream through the cache once each
+				memset(targetRow, 0, size_t(targetWidth) * 4 * sizeof(float));
+				for (uint32_t k = 0; k < rows.count; k++)
+				{
+					const float * sourceRow = horizontal + size_t(indices[k]) * targetWidth * 4;
+					__m128 weight = _mm_set1_ps(weights[k]);
+					for (uint32_t x = 0; x < targetWidth; x++)
+					{
+						__m128 sum = _mm_loadu_ps(targetRow + x * 4);
+						_mm_storeu_ps(targetRow + x * 4, _mm_add_ps(sum, _mm_mul_ps(weight, _mm_loadu_ps(sourceRow + x * 4))));
+					}
+				}
+
+				if (options.normalMap) {
+					for (uint32_t x = 0; x < targetWidth; x++)
+					{
+						float * normal = targetRow + x * 4;
+						float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+						if (length > 0.0f) {
+							for (int c = 0; c < 3; c++) normal[c] /= length;
+						}
+						else {
+							normal[0] = 0.0f;
+							normal[1] = 0.0f;
+							normal[2] = 1.0f;
+						}
+					}
+				}
+			}
+		});
+	}
+
+	void encodeLevel(MipLevel & level, const float * source, const MipChainOptions & options, ThreadPool * pool)
+	{
+		const SrgbTables & tables = srgbTables();
+		level.pixels.resize(size_t(level.width) * level.height * 4);
+		uint8_t * pixels = level.pixels.data();
+
+		forRows(pool, level.height, [&](uint32_t firstRow, uint32_t lastRow) {
+			for (size_t i = size_t(firstRow) * level.width; i < size_t(lastRow) * level.width; i++)
+			{
+				const float * texel = source + i * 4;
+				uint8_t * target = pixels + i * 4;
+				for (int c = 0; c < 3; c++)
+				{
+					if (options.normalMap) target[c] = encodeUnorm((texel[c] + 1.0f) * 0.5f);
+					else if (options.srgb) target[c] = tables.encode(texel[c]);
+					else target[c] = encodeUnorm(texel[c]);
+				}
+				target[3] = encodeUnorm(texel[3]);
+			}
+		});
+	}
+}
+
+const char * mipFilterName(MipFilter filter)
+{
+	static const char * names[] = { "box", "kaiser", "lanczos" };
+	return filter < MIP_FILTER_COUNT ? names[filter] : "unknown";
+}
+
+uint32_t mipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t count = 1;
+	while (width > 1 || height > 1)
+	{
+		width = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+		count++;
+	}
+	return count;
+}
+
+void buildMipChain(vector<MipLevel> & levels, const uint8_t * pixels, uint32_t width, uint32_t height,
+	const MipChainOptions & options, ThreadPool * pool)
+{
+	levels.resize(mipLevelCount(width, height));
+	levels[0].width = width;
+	levels[0].height = height;
+	levels[0].pixels.assign(pixels, pixels + size_t(width) * height * 4);
+	if (levels.size() == 1) return;
+
+	vector<float> current(size_t(width) * height * 4), next, scratch;
+	decodeLevel(current.data(), pixels, width, height, options, pool);
+
+	for (size_t level = 1; level < levels.size(); level++)
+	{
+		uint32_t targetWidth = std::max(width / 2, 1u), targetHeight = std::max(height / 2, 1u);
+		next.resize(size_t(targetWidth) * targetHeight * 4);
+		filterLevel(next.data(), scratch, current.data(), width, height, targetWidth, targetHeight, options, pool);
+
+		levels[level].width = targetWidth;
+		levels[level].height = targetHeight;
+		encodeLevel(levels[level], next.data(), options, pool);
+
+		current.swap(next);
+		width = targetWidth;
+		height = targetHeight;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/*CPU mip chain builder for rgba8 images.
+
+Every level is filtered from the one above it with a separable kernel, first along the rows into a scratch image and
+then down the columns. The kernel is laid out in units of the smaller level, so odd sizes (a 5 wide level going to 2)
+come out right instead of dropping the last column.
+
+	box      the 2x2 average, what glGenerateMipmap does on most drivers. Cheap but it lets a lot of aliasing through.
+	kaiser   windowed sinc (alpha 4) two texels of the smaller level to either side, 8 taps per direction at 2:1.
+	         Sharp levels with very little aliasing, the default.
+	lanczos  three lobe windowed sinc, 12 taps per direction. A little sharper than kaiser and rings a little more.
+
+sRGB images are decoded to linear floats before filtering and encoded again per level. Averaging the encoded values
+darkens every level, a black and white checker box filters to 128 which displays as 22% grey rather than 50%, so
+detailed color maps visibly darken in the distance. Alpha is always linear. Normal maps are decoded to vectors and
+renormalized per level.
+
+The float image of the previous level is kept, so the error of the 8 bit rounding does not build up down the chain.
+Each pass splits its rows over the pool and the kernels work on one texel (four channels) per SSE register.*/
+
+enum MipFilter
+{
+	MIP_FILTER_BOX,
+	MIP_FILTER_KAISER,
+	MIP_FILTER_LANCZOS,
+	MIP_FILTER_COUNT,
+};
+
+const char * mipFilterName(MipFilter filter);
+
+struct MipChainOptions
+{
+	MipFilter filter = MIP_FILTER_KAISER;
+	bool srgb = true; // rgb is sRGB encoded, like every color map the demos load
+	bool normalMap = false; // rgb is a unit vector, takes precedence over srgb
+};
+
+struct MipLevel
+{
+	uint32_t width;
+	uint32_t height;
+	std::vector<uint8_t> pixels; // rgba8
+};
+
+// levels in a full chain down to 1x1
+uint32_t mipLevelCount(uint32_t width, uint32_t height);
+
+// Fills levels with the whole chain of the width x height rgba8 image, levels[0] is a copy of pixels.
+// pool is optional and spreads the rows of every pass over the workers.
+void buildMipChain(std::vector<MipLevel> & levels, const uint8_t * pixels, uint32_t width, uint32_t height,
+	const MipChainOptions & options = MipChainOptions(), ThreadPool * pool = nullptr);
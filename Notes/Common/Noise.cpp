@@ -0,0 +1,123 @@
+#include "Noise.h"
+#include "CpuFeatures.h"
+#include "NoiseKernel.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+// samples per job, wide enough for whole vectors and short enough that a 1k grid still spreads over every worker
+static const uint32_t TILE_WIDTH = 256;
+static const uint32_t TILE_HEIGHT = 32;
+
+const char * noiseSimdName(NoiseSimd simd)
+{
+	switch (simd)
+	{
+	case NOISE_SIMD_SCALAR: return "scalar";
+	case NOISE_SIMD_SSE2: return "sse2";
+	case NOISE_SIMD_AVX2: return "avx2";
+	default: return "best";
+	}
+}
+
+NoiseSimd noiseSimdSupported()
+{
+	return cpuHasAvx2() ? NOISE_SIMD_AVX2 : NOISE_SIMD_SSE2;
+}
+
+void setupNoise(NoiseSetup & setup, const NoiseOptions & options)
+{
+	setup.basis = options.basis;
+	setup.fractal = options.fractal;
+	setup.octaves = std::max(1, std::min(options.octaves, NOISE_MAX_OCTAVES));
+
+	// whole cells, so the seed moves the field without changing what it looks like. Kept well under 289 cells,
+	// a larger shift would only wrap around the permutation.
+	uint32_t hash = options.seed * 0x9e3779b9u;
+	hash ^= hash >> 16;
+	float seedX = static_cast<float>(hash % 251);
+	float seedY = static_cast<float>((hash >> 8) % 241);
+
+	float frequency = options.frequency, amplitude = 1.0f, total = 0.0f;
+	for (int octave = 0; octave < setup.octaves; octave++)
+	{
+		setup.frequency[octave] = frequency;
+		setup.amplitude[octave] = amplitude;
+		// irrational looking steps keep the lattice points of the octaves from stacking up
+		setup.offsetX[octave] = seedX + octave * 19.19f;
+		setup.offsetY[octave] = seedY + octave * 7.37f;
+		total += amplitude;
+		frequency *= options.lacunarity;
+		amplitude *= options.gain;
+	}
+	setup.normalize = total > 0.0f ? 1.0f / total : 1.0f;
+	setup.originX = setup.originY = 0.0f;
+	setup.stepX = setup.stepY = 1.0f;
+}
+
+void noiseTileSse2(float * heights, size_t rowPitch, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, const NoiseSetup & setup)
+{
+	NoiseKernel<Sse2Lanes>::tile(heights, rowPitch, x0, x1, y0, y1, setup);
+}
+
+float noise2D(float x, float y, const NoiseOptions & options)
+{
+	NoiseSetup setup;
+	setupNoise(setup, options);
+	return NoiseKernel<ScalarLanes>::fractal(x, y, setup);
+}
+
+void generateNoise(float * heights, size_t rowPitch, uint32_t width, uint32_t height, float originX, float originY,
+	float stepX, float stepY, const NoiseOptions & options, ThreadPool * pool)
+{
+	NoiseSetup setup;
+	setupNoise(setup, options);
+	setup.originX = originX;
+	setup.originY = originY;
+	setup.stepX = stepX;
+	setup.stepY = stepY;
+
+	NoiseSimd simd = options.simd;
+	if (simd == NOISE_SIMD_BEST || (simd == NOISE_SIMD_AVX2 && noiseSimdSupported() != NOISE_SIMD_AVX2))
+		simd = noiseSimdSupported();
+
+	uint32_t tilesX = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+	uint32_t tilesY = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+	auto runTile = [&](size_t tile) {
+		uint32_t x0 = static_cast<uint32_t>(tile % tilesX) * TILE_WIDTH;
+		uint32_t y0 = static_cast<uint32_t>(tile / tilesX) * TILE_HEIGHT;
+		uint32_t x1 = std::min(x0 + TILE_WIDTH, width);
+		uint32_t y1 = std::min(y0 + TILE_HEIGHT, height);
+
+		if (simd == NOISE_SIMD_AVX2) noiseTileAvx2(heights, rowPitch, x0, x1, y0, y1, setup);
+		else if (simd == NOISE_SIMD_SSE2) noiseTileSse2(heights, rowPitch, x0, x1, y0, y1, setup);
+		else NoiseKernel<ScalarLanes>::tile(heights, rowPitch, x0, x1, y0, y1, setup);
+	};
+
+	size_t tiles = size_t(tilesX) * tilesY;
+	ThreadPool::forEach(pool, tiles, runTile);
+}
+
+void quantizeHeights(uint8_t * destination, const float * heights, size_t count, float scale, float bias)
+{
+	__m128 scales = _mm_set1_ps(scale), biases = _mm_set1_ps(bias);
+	__m128 low = _mm_setzero_ps(), high = _mm_set1_ps(255.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		// clamp before converting so the saturating packs only ever see 0..255
+		__m128i parts[4];
+		for (int part = 0; part < 4; part++)
+		{
+			__m128 value = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(heights + i + part * 4), scales), biases);
+			parts[part] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(value, low), high));
+		}
+		__m128i words = _mm_packs_epi32(parts[0], parts[1]);
+		__m128i words2 = _mm_packs_epi32(parts[2], parts[3]);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(words, words2));
+	}
+
+	for (; i < count; i++)
+		destination[i] = static_cast<uint8_t>(std::min(std::max(heights[i] * scale + bias, 0.0f), 255.0f));
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+/*2D gradient noise and heightmap generation.
+
+Both bases are Stefan Gustavson's formulations, the same ones glm::perlin and glm::simplex use, so a single octave
+matches what the terrain demos used to get from glm one sample at a time (to within float rounding):
+
+	perlin   classic gradient noise on the square lattice, four corners per sample, about [-1, 1]
+	simplex  three corners of the skewed triangle lattice, fewer artifacts along the axes and cheaper per sample
+
+Octaves are layered on top:
+
+	fbm      sum of octaves, each at lacunarity times the frequency and gain times the amplitude of the one before
+	ridged   1 - |noise| squared per octave, each weighted by the one before so ridges stay sharp and valleys smooth
+
+Every octave after the first is shifted by a fixed offset so the lattices do not line up, and the seed shifts the whole
+field by whole lattice cells. The result is divided by the summed amplitudes so it stays about [-1, 1].
+
+generateNoise fills a row-major grid in tiles spread over the pool. Inside a tile the kernels evaluate 4 (SSE2) or 8
+(AVX2, picked at runtime when the CPU has it) horizontally adjacent samples per instruction. The hashing works on
+floats below 2^24 the whole way, so the lanes need no gathers, and no FMA is used so every instruction set produces the
+same bits.*/
+
+enum NoiseBasis
+{
+	NOISE_PERLIN,
+	NOISE_SIMPLEX,
+};
+
+enum NoiseFractal
+{
+	NOISE_FBM,
+	NOISE_RIDGED,
+};
+
+enum NoiseSimd
+{
+	NOISE_SIMD_SCALAR,
+	NOISE_SIMD_SSE2,
+	NOISE_SIMD_AVX2,
+	NOISE_SIMD_BEST, // the widest the CPU supports
+};
+
+const int NOISE_MAX_OCTAVES = 16;
+
+struct NoiseOptions
+{
+	NoiseBasis basis = NOISE_PERLIN;
+	NoiseFractal fractal = NOISE_FBM;
+	int octaves = 1;
+	float frequency = 1.0f; // lattice cells per unit of the sample coordinates
+	float lacunarity = 2.0f;
+	float gain = 0.5f;
+	uint32_t seed = 0;
+	NoiseSimd simd = NOISE_SIMD_BEST;
+};
+
+const char * noiseSimdName(NoiseSimd simd);
+
+// what NOISE_SIMD_BEST resolves to on this CPU
+NoiseSimd noiseSimdSupported();
+
+// One sample, what every lane of the SIMD kernels computes.
+float noise2D(float x, float y, const NoiseOptions & options);
+
+// Fills width x height samples, sample (i, j) at (originX + i * stepX, originY + j * stepY) goes to
+// heights[j * rowPitch + i]. rowPitch is in floats, so a grid can be written into part of a larger one.
+void generateNoise(float * heights, size_t rowPitch, uint32_t width, uint32_t height, float originX, float originY,
+	float stepX, float stepY, const NoiseOptions & options, ThreadPool * pool = nullptr);
+
+// destination[i] = heights[i] * scale + bias, truncated and clamped to 0..255 like a static_cast of the same value
+void quantizeHeights(uint8_t * destination, const float * heights, size_t count, float scale, float bias);
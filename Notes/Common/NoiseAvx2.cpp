@@ -0,0 +1,38 @@
+// Compiled with /arch:AVX2 (see the project files), only ever called once noiseSimdSupported() has seen AVX2
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+#include "NoiseKernel.h"
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2Lanes
+{
+	typedef __m256 V;
+	typedef __m256 M;
+	static const int WIDTH = 8;
+
+	static V set(float a) { return _mm256_set1_ps(a); }
+	static V ramp(uint32_t first) { return _mm256_add_ps(_mm256_set1_ps(static_cast<float>(first)), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)); }
+	static void store(float * p, V a) { _mm256_storeu_ps(p, a); }
+	static V add(V a, V b) { return _mm256_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+	static V max(V a, V b) { return _mm256_max_ps(a, b); }
+	static V min(V a, V b) { return _mm256_min_ps(a, b); }
+	static V abs(V a) { return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+	static V floor(V a) { return _mm256_floor_ps(a); }
+	static M greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static M less(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+};
+
+}
+
+void noiseTileAvx2(float * heights, size_t rowPitch, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, const NoiseSetup & setup)
+{
+	NoiseKernel<Avx2Lanes>::tile(heights, rowPitch, x0, x1, y0, y1, setup);
+	// back to SSE code after this, clear the upper halves so it does not pay the transition penalty
+	_mm256_zeroupper();
+}
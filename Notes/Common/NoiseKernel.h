@@ -0,0 +1,250 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <emmintrin.h>
+#include "Noise.h"
+
+/*The noise kernels shared by Noise.cpp (scalar and SSE2) and NoiseAvx2.cpp (compiled for AVX2), only for those two.
+
+Each kernel is written once against a lane type S that supplies the arithmetic (add, mul, floor, select ...) for 1, 4
+or 8 floats. Everything is in an unnamed namespace so the two files get their own copies: the AVX2 file must not hand
+the linker an AVX encoded instance of a template the SSE2 file also uses.*/
+
+// per octave constants, filled once by generateNoise
+struct NoiseSetup
+{
+	NoiseBasis basis;
+	NoiseFractal fractal;
+	int octaves;
+	float frequency[NOISE_MAX_OCTAVES];
+	float amplitude[NOISE_MAX_OCTAVES];
+	float offsetX[NOISE_MAX_OCTAVES];
+	float offsetY[NOISE_MAX_OCTAVES];
+	float normalize; // 1 / summed amplitudes
+
+	float originX, originY;
+	float stepX, stepY;
+};
+
+void setupNoise(NoiseSetup & setup, const NoiseOptions & options);
+
+// columns [x0, x1) of rows [y0, y1), SSE2 and AVX2 fill the columns past the last full vector one sample at a time
+void noiseTileSse2(float * heights, size_t rowPitch, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, const NoiseSetup & setup);
+void noiseTileAvx2(float * heights, size_t rowPitch, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, const NoiseSetup & setup);
+
+namespace {
+
+struct ScalarLanes
+{
+	typedef float V;
+	typedef bool M;
+	static const int WIDTH = 1;
+
+	static V set(float a) { return a; }
+	static V ramp(uint32_t first) { return static_cast<float>(first); }
+	static void store(float * p, V a) { *p = a; }
+	static V add(V a, V b) { return a + b; }
+	static V sub(V a, V b) { return a - b; }
+	static V mul(V a, V b) { return a * b; }
+	static V max(V a, V b) { return a > b ? a : b; }
+	static V min(V a, V b) { return a < b ? a : b; }
+	static V abs(V a) { return std::fabs(a); }
+	static V floor(V a) { return std::floor(a); }
+	static M greater(V a, V b) { return a > b; }
+	static M less(V a, V b) { return a < b; }
+	static V select(M m, V a, V b) { return m ? a : b; } // a where m is set
+};
+
+struct Sse2Lanes
+{
+	typedef __m128 V;
+	typedef __m128 M;
+	static const int WIDTH = 4;
+
+	static V set(float a) { return _mm_set1_ps(a); }
+	static V ramp(uint32_t first) { return _mm_add_ps(_mm_set1_ps(static_cast<float>(first)), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)); }
+	static void store(float * p, V a) { _mm_storeu_ps(p, a); }
+	static V add(V a, V b) { return _mm_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+	static V max(V a, V b) { return _mm_max_ps(a, b); }
+	static V min(V a, V b) { return _mm_min_ps(a, b); }
+	static V abs(V a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+	static M greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+	static M less(V a, V b) { return _mm_cmplt_ps(a, b); }
+	static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+	// SSE2 has no roundps: truncate, then step down where that rounded up (negative fractions).
+	// Exact for |a| < 2^31, the lattice coordinates never get near that.
+	static V floor(V a)
+	{
+		V truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+		return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+	}
+};
+
+template <class S>
+struct NoiseKernel
+{
+	typedef typename S::V V;
+
+	// the representative in [0, 289), the reciprocal can land one period off near multiples of 289 so that is fixed up
+	static V mod289(V x)
+	{
+		V r = S::sub(x, S::mul(S::floor(S::mul(x, S::set(1.0f / 289.0f))), S::set(289.0f)));
+		r = S::add(r, S::select(S::less(r, S::set(0.0f)), S::set(289.0f), S::set(0.0f)));
+		return S::sub(r, S::select(S::less(r, S::set(289.0f)), S::set(0.0f), S::set(289.0f)));
+	}
+
+	// (34 x^2 + x) mod 289, a permutation of 0..288 that needs no table. Inputs stay below 578 so every product is
+	// an exact integer in a float.
+	static V permute(V x)
+	{
+		return mod289(S::mul(S::add(S::mul(x, S::set(34.0f)), S::set(1.0f)), x));
+	}
+
+	// one of 41 gradients spread over a diamond, picked by the hash, normalized with the Taylor inverse square root
+	// and dotted with the offset (fx, fy) from its corner
+	static V gradient(V hash, V fx, V fy)
+	{
+		V scaled = S::mul(hash, S::set(1.0f / 41.0f));
+		V gx = S::sub(S::mul(S::set(2.0f), S::sub(scaled, S::floor(scaled))), S::set(1.0f));
+		V gy = S::sub(S::abs(gx), S::set(0.5f));
+		gx = S::sub(gx, S::floor(S::add(gx, S::set(0.5f))));
+		V lengthSquared = S::add(S::mul(gx, gx), S::mul(gy, gy));
+		V norm = S::sub(S::set(1.79284291400159f), S::mul(S::set(0.85373472095314f), lengthSquared));
+		return S::mul(norm, S::add(S::mul(gx, fx), S::mul(gy, fy)));
+	}
+
+	static V mix(V a, V b, V t)
+	{
+		return S::add(a, S::mul(t, S::sub(b, a)));
+	}
+
+	static V fade(V t)
+	{
+		V cubed = S::mul(S::mul(t, t), t);
+		return S::mul(cubed, S::add(S::mul(t, S::sub(S::mul(t, S::set(6.0f)), S::set(15.0f))), S::set(10.0f)));
+	}
+
+	static V perlin(V x, V y)
+	{
+		V cellX = S::floor(x), cellY = S::floor(y);
+		V fx0 = S::sub(x, cellX), fy0 = S::sub(y, cellY);
+		V fx1 = S::sub(fx0, S::set(1.0f)), fy1 = S::sub(fy0, S::set(1.0f));
+
+		V ix0 = mod289(cellX), ix1 = mod289(S::add(cellX, S::set(1.0f)));
+		V iy0 = mod289(cellY), iy1 = mod289(S::add(cellY, S::set(1.0f)));
+		V px0 = permute(ix0), px1 = permute(ix1);
+
+		V n00 = gradient(permute(S::add(px0, iy0)), fx0, fy0);
+		V n10 = gradient(permute(S::add(px1, iy0)), fx1, fy0);
+		V n01 = gradient(permute(S::add(px0, iy1)), fx0, fy1);
+		V n11 = gradient(permute(S::add(px1, iy1)), fx1, fy1);
+
+		V fadeX = fade(fx0);
+		V n = mix(mix(n00, n10, fadeX), mix(n01, n11, fadeX), fade(fy0));
+		return S::mul(S::set(2.3f), n);
+	}
+
+	// contribution of one simplex corner at offset (x, y) whose hash is hash
+	static V simplexCorner(V hash, V x, V y)
+	{
+		V m = S::max(S::sub(S::set(0.5f), S::add(S::mul(x, x), S::mul(y, y))), S::set(0.0f));
+		m = S::mul(m, m);
+		m = S::mul(m, m);
+
+		V scaled = S::mul(hash, S::set(1.0f / 41.0f));
+		V gx = S::sub(S::mul(S::set(2.0f), S::sub(scaled, S::floor(scaled))), S::set(1.0f));
+		V h = S::sub(S::abs(gx), S::set(0.5f));
+		V a0 = S::sub(gx, S::floor(S::add(gx, S::set(0.5f))));
+		m = S::mul(m, S::sub(S::set(1.79284291400159f), S::mul(S::set(0.85373472095314f), S::add(S::mul(a0, a0), S::mul(h, h)))));
+		return S::mul(m, S::add(S::mul(a0, x), S::mul(h, y)));
+	}
+
+	static V simplex(V x, V y)
+	{
+		const float C0 = 0.211324865405187f; // (3 - sqrt(3)) / 6
+		const float C1 = 0.366025403784439f; // (sqrt(3) - 1) / 2
+		const float C2 = -0.577350269189626f; // 2 * C0 - 1
+
+		V skew = S::mul(S::add(x, y), S::set(C1));
+		V i = S::floor(S::add(x, skew)), j = S::floor(S::add(y, skew));
+		V unskew = S::mul(S::add(i, j), S::set(C0));
+		V x0 = S::add(S::sub(x, i), unskew), y0 = S::add(S::sub(y, j), unskew);
+
+		// the middle corner is one step along x or y depending on which half of the cell the sample is in
+		V i1 = S::select(S::greater(x0, y0), S::set(1.0f), S::set(0.0f));
+		V j1 = S::sub(S::set(1.0f), i1);
+		V x1 = S::sub(S::add(x0, S::set(C0)), i1), y1 = S::sub(S::add(y0, S::set(C0)), j1);
+		V x2 = S::add(x0, S::set(C2)), y2 = S::add(y0, S::set(C2));
+
+		i = mod289(i);
+		j = mod289(j);
+		V p0 = permute(S::add(permute(j), i));
+		V p1 = permute(S::add(S::add(permute(S::add(j, j1)), i), i1));
+		V p2 = permute(S::add(S::add(permute(S::add(j, S::set(1.0f))), i), S::set(1.0f)));
+
+		V sum = S::add(S::add(simplexCorner(p0, x0, y0), simplexCorner(p1, x1, y1)), simplexCorner(p2, x2, y2));
+		return S::mul(S::set(130.0f), sum);
+	}
+
+	static V basis(V x, V y, NoiseBasis type)
+	{
+		return type == NOISE_SIMPLEX ? simplex(x, y) : perlin(x, y);
+	}
+
+	static V fractal(V x, V y, const NoiseSetup & setup)
+	{
+		V sum = S::set(0.0f);
+		V weight = S::set(1.0f);
+		for (int octave = 0; octave < setup.octaves; octave++)
+		{
+			V frequency = S::set(setup.frequency[octave]);
+			V n = basis(S::add(S::mul(x, frequency), S::set(setup.offsetX[octave])),
+				S::add(S::mul(y, frequency), S::set(setup.offsetY[octave])), setup.basis);
+
+			if (setup.fractal == NOISE_RIDGED) {
+				// the ridge is where the noise crosses zero, sharpened by the square and damped where the octave
+				// before was low so the valleys stay smooth
+				V ridge = S::sub(S::set(1.0f), S::abs(n));
+				ridge = S::mul(S::mul(ridge, ridge), weight);
+				weight = S::min(S::max(S::mul(ridge, S::set(2.0f)), S::set(0.0f)), S::set(1.0f));
+				n = ridge;
+			}
+
+			sum = S::add(sum, S::mul(n, S::set(setup.amplitude[octave])));
+		}
+
+		sum = S::mul(sum, S::set(setup.normalize));
+		// ridged sums to [0, 1], moved to the same [-1, 1] as fbm
+		if (setup.fractal == NOISE_RIDGED) sum = S::sub(S::mul(sum, S::set(2.0f)), S::set(1.0f));
+		return sum;
+	}
+
+	static void tile(float * heights, size_t rowPitch, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, const NoiseSetup & setup)
+	{
+		for (uint32_t row = y0; row < y1; row++)
+		{
+			float * target = heights + rowPitch * row;
+			V y = S::set(setup.originY + static_cast<float>(row) * setup.stepY);
+
+			uint32_t column = x0;
+			for (; column + S::WIDTH <= x1; column += S::WIDTH)
+			{
+				// from the column index rather than stepping, so every lane width lands on the same coordinates
+				V x = S::add(S::set(setup.originX), S::mul(S::ramp(column), S::set(setup.stepX)));
+				S::store(target + column, fractal(x, y, setup));
+			}
+
+			for (; column < x1; column++)
+			{
+				float x = setup.originX + static_cast<float>(column) * setup.stepX;
+				target[column] = NoiseKernel<ScalarLanes>::fractal(x, setup.originY + static_cast<float>(row) * setup.stepY, setup);
+			}
+		}
+	}
+};
+
+}
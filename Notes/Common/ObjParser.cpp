@@ -0,0 +1,564 @@
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+using std::vector;
+using std::string;
+
+static const double powersOfTen[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static const char * skipSpaces(const char * text, const char * end)
+{
+	while (text < end && isSpace(*text)) text++;
+	return text;
+}
+
+const char * parseFloat(const char * text, const char * end, float & value)
+{
+	const char * start = text;
+	bool negative = false;
+	if (text < end && (*text == '-' || *text == '+')) negative = *text++ == '-';
+
+	// up to 19 significant digits fit in the mantissa, anything longer takes the slow path
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int significantDigits = 0;
+	bool anyDigits = false;
+	bool truncated = false;
+
+	for (; text < end && isDigit(*text); text++)
+	{
+		anyDigits = true;
+		if (significantDigits < 19) {
+			mantissa = mantissa * 10 + (*text - '0');
+			if (mantissa) significantDigits++;
+		}
+		else {
+			exponent++;
+			truncated = truncated || *text != '0';
+		}
+	}
+
+	if (text < end && *text == '.') {
+		for (text++; text < end && isDigit(*text); text++)
+		{
+			anyDigits = true;
+			if (significantDigits < 19) {
+				mantissa = mantissa * 10 + (*text - '0');
+				if (mantissa) significantDigits++;
+				exponent--;
+			}
+			else {
+				truncated = truncated || *text != '0';
+			}
+		}
+	}
+
+	if (!anyDigits) {
+		// nan, inf and friends
+		char buffer[64];
+		size_t length = std::min<size_t>(end - start, sizeof buffer - 1);
+		memcpy(buffer, start, length);
+		buffer[length] = '\0';
+		char * parsedEnd;
+		value = strtof(buffer, &parsedEnd);
+		return parsedEnd == buffer ? nullptr : start + (parsedEnd - buffer);
+	}
+
+	if (text < end && (*text == 'e' || *text == 'E')) {
+		const char * exponentStart = text++;
+		bool negativeExponent = false;
+		if (text < end && (*text == '-' || *text == '+')) negativeExponent = *text++ == '-';
+
+		if (text < end && isDigit(*text)) {
+			int explicitExponent = 0;
+			for (; text < end && isDigit(*text); text++)
+				explicitExponent = std::min(explicitExponent * 10 + (*text - '0'), 100000);
+			exponent += negativeExponent ? -explicitExponent : explicitExponent;
+		}
+		else {
+			text = exponentStart;
+		}
+	}
+
+	// Clinger's fast path: the mantissa and the power of ten are both exact doubles,
+	// so a single multiply or divide is correctly rounded
+	double result;
+	if (!truncated && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+		result = double(mantissa);
+		result = exponent < 0 ? result / powersOfTen[-exponent] : result * powersOfTen[exponent];
+	}
+	else {
+		char buffer[128];
+		size_t length = std::min<size_t>(text - start, sizeof buffer - 1);
+		memcpy(buffer, start, length);
+		buffer[length] = '\0';
+		result = strtod(buffer, nullptr);
+		negative = false;
+	}
+
+	value = static_cast<float>(negative ? -result : result);
+	return text;
+}
+
+static const char * parseInt(const char * text, const char * end, int64_t & value)
+{
+	bool negative = false;
+	if (text < end && (*text == '-' || *text == '+')) negative = *text++ == '-';
+	if (text >= end || !isDigit(*text)) return nullptr;
+
+	value = 0;
+	for (; text < end && isDigit(*text); text++)
+		value = std::min<int64_t>(value * 10 + (*text - '0'), INT_MAX);
+
+	if (negative) value = -value;
+	return text;
+}
+
+static string restOfLine(const char * text, const char * end)
+{
+	text = skipSpaces(text, end);
+	while (end > text && isSpace(end[-1])) end--;
+	return string(text, end);
+}
+
+static bool keyword(const char * text, const char * end, const char * name)
+{
+	size_t length = strlen(name);
+	return size_t(end - text) > length && memcmp(text, name, length) == 0 && isSpace(text[length]);
+}
+
+enum ObjEventType { OBJ_EVENT_OBJECT, OBJ_EVENT_GROUP, OBJ_EVENT_MATERIAL };
+
+// o / g / usemtl lines, triangle is the number of triangles the chunk had emitted when the line was read
+struct ObjEvent
+{
+	uint32_t triangle;
+	ObjEventType type;
+	string name;
+};
+
+const int32_t ABSENT_INDEX = INT32_MIN;
+
+struct ObjChunk
+{
+	const char * begin;
+	const char * end;
+
+	vector<float> positions;
+	vector<float> uvs;
+	vector<float> normals;
+	vector<int32_t> corners; // position, uv, normal per triangle corner, 0 based
+	vector<uint32_t> relativeCorners; // entries of corners that are still relative to this chunk's first attribute
+	vector<ObjEvent> events;
+	vector<string> materialLibraries;
+
+	uint32_t positionBase;
+	uint32_t uvBase;
+	uint32_t normalBase;
+	string error;
+};
+
+// one polygon corner while its face line is read, negative obj indices count back from the last attribute read
+// so far and are kept relative to the chunk until the chunk bases are known
+struct ObjCorner
+{
+	int32_t index[3];
+	bool relative[3];
+};
+
+static void resolveCornerIndex(ObjCorner & corner, int component, int64_t index, size_t localCount)
+{
+	corner.relative[component] = index < 0;
+	if (index > 0) corner.index[component] = static_cast<int32_t>(index - 1);
+	else if (index < 0) corner.index[component] = static_cast<int32_t>(int64_t(localCount) + index);
+	else corner.index[component] = ABSENT_INDEX;
+}
+
+static void emitCorner(ObjChunk & chunk, const ObjCorner & corner)
+{
+	for (int c = 0; c < 3; c++)
+	{
+		if (corner.relative[c]) chunk.relativeCorners.push_back(static_cast<uint32_t>(chunk.corners.size()));
+		chunk.corners.push_back(corner.index[c]);
+	}
+}
+
+static void parseChunk(ObjChunk & chunk)
+{
+	const char * line = chunk.begin;
+	vector<ObjCorner> polygon;
+
+	while (line < chunk.end)
+	{
+		const char * lineEnd = reinterpret_cast<const char*>(memchr(line, '\n', chunk.end - line));
+		if (!lineEnd) lineEnd = chunk.end;
+		const char * text = skipSpaces(line, lineEnd);
+		line = lineEnd + 1;
+
+		if (text >= lineEnd) continue;
+
+		// the last line of the file has no terminator, never look past it
+		auto charAt = [&](size_t i) { return text + i < lineEnd ? text[i] : ' '; };
+
+		if (text[0] == 'v') {
+			std::vector<float> * target;
+			int components;
+			if (isSpace(charAt(1))) { target = &chunk.positions; components = 3; }
+			else if (charAt(1) == 't' && isSpace(charAt(2))) { target = &chunk.uvs; components = 2; }
+			else if (charAt(1) == 'n' && isSpace(charAt(2))) { target = &chunk.normals; components = 3; }
+			else continue;
+
+			text += target == &chunk.positions ? 1 : 2;
+			for (int c = 0; c < components; c++)
+			{
+				float value = 0.0f;
+				text = skipSpaces(text, lineEnd);
+				const char * next = parseFloat(text, lineEnd, value);
+				if (next) text = next;
+				target->push_back(value);
+			}
+		}
+		else if (text[0] == 'f' && isSpace(charAt(1))) {
+			polygon.clear();
+			const char * faceStart = text;
+			text++;
+
+			for (;;)
+			{
+				text = skipSpaces(text, lineEnd);
+				if (text >= lineEnd) break;
+
+				int64_t index[3] = { 0, 0, 0 };
+				const char * next = parseInt(text, lineEnd, index[0]);
+				if (!next || index[0] == 0) {
+					chunk.error = "bad face \"" + restOfLine(faceStart, lineEnd) + "\"";
+					return;
+				}
+				text = next;
+				for (int c = 1; c < 3 && text < lineEnd && *text == '/'; c++)
+				{
+					text++;
+					next = parseInt(text, lineEnd, index[c]);
+					if (next) text = next;
+				}
+
+				ObjCorner corner;
+				resolveCornerIndex(corner, 0, index[0], chunk.positions.size() / 3);
+				resolveCornerIndex(corner, 1, index[1], chunk.uvs.size() / 2);
+				resolveCornerIndex(corner, 2, index[2], chunk.normals.size() / 3);
+				polygon.push_back(corner);
+			}
+
+			// fan around the first corner, points and lines have no area so Assimp drops them from triangle meshes too
+			for (size_t i = 1; i + 1 < polygon.size(); i++)
+			{
+				emitCorner(chunk, polygon[0]);
+				emitCorner(chunk, polygon[i]);
+				emitCorner(chunk, polygon[i + 1]);
+			}
+		}
+		else if (text[0] == 'o' && isSpace(charAt(1))) {
+			chunk.events.push_back({ static_cast<uint32_t>(chunk.corners.size() / 9), OBJ_EVENT_OBJECT, restOfLine(text + 1, lineEnd) });
+		}
+		else if (text[0] == 'g' && isSpace(charAt(1))) {
+			string name = restOfLine(text + 1, lineEnd);
+			chunk.events.push_back({ static_cast<uint32_t>(chunk.corners.size() / 9), OBJ_EVENT_GROUP, name.empty() ? "default" : name });
+		}
+		else if (keyword(text, lineEnd, "usemtl")) {
+			chunk.events.push_back({ static_cast<uint32_t>(chunk.corners.size() / 9), OBJ_EVENT_MATERIAL, restOfLine(text + 6, lineEnd) });
+		}
+		else if (keyword(text, lineEnd, "mtllib")) {
+			chunk.materialLibraries.push_back(restOfLine(text + 6, lineEnd));
+		}
+	}
+}
+
+// part of a chunk's triangles that all land in the same mesh
+struct ObjRange
+{
+	uint32_t chunk;
+	uint32_t firstTriangle;
+	uint32_t lastTriangle;
+	uint32_t mesh;
+	uint32_t meshTriangle;
+};
+
+static string directoryOf(const string & path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == string::npos ? string() : path.substr(0, slash + 1);
+}
+
+// a benchmark parses the same file hundreds of times, say once that its material library is missing
+static void warnMissingLibrary(const char * path, const string & libraryPath)
+{
+	static std::mutex mutex;
+	static std::set<string> warned;
+	std::lock_guard<std::mutex> lock(mutex);
+	if (warned.insert(libraryPath).second)
+		std::cout << path << ": could not read material library " << libraryPath << std::endl;
+}
+
+bool parseObj(const char * path, ObjModel & model, ThreadPool * pool)
+{
+	model.meshes.clear();
+	model.materials.clear();
+
+	MappedFile file;
+	if (!file.open(path)) {
+		std::cout << "Could not open " << path << std::endl;
+		return false;
+	}
+
+	auto text = reinterpret_cast<const char*>(file.data());
+	const char * textEnd = text + file.size();
+
+	// line aligned chunks, a few per thread so one slow chunk does not hold everybody up
+	const size_t minimumChunkSize = 64 * 1024;
+	size_t threadCount = pool ? pool->size() + 1 : 1;
+	size_t chunkCount = std::max<size_t>(1, std::min(file.size() / minimumChunkSize, threadCount * 4));
+
+	vector<ObjChunk> chunks(chunkCount);
+	const char * chunkStart = text;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const char * chunkEnd = i + 1 == chunkCount ? textEnd : text + file.size() * (i + 1) / chunkCount;
+		if (chunkEnd < chunkStart) chunkEnd = chunkStart;
+		const char * newline = reinterpret_cast<const char*>(memchr(chunkEnd, '\n', textEnd - chunkEnd));
+		chunkEnd = newline ? newline + 1 : textEnd;
+
+		chunks[i].begin = chunkStart;
+		chunks[i].end = chunkEnd;
+		chunkStart = chunkEnd;
+	}
+
+	ThreadPool::forEach(pool, chunkCount, [&](size_t i) { parseChunk(chunks[i]); });
+
+	uint32_t positionCount = 0;
+	uint32_t uvCount = 0;
+	uint32_t normalCount = 0;
+	for (auto & chunk : chunks)
+	{
+		if (!chunk.error.empty()) {
+			std::cout << path << ": " << chunk.error << std::endl;
+			return false;
+		}
+
+		chunk.positionBase = positionCount;
+		chunk.uvBase = uvCount;
+		chunk.normalBase = normalCount;
+		positionCount += static_cast<uint32_t>(chunk.positions.size() / 3);
+		uvCount += static_cast<uint32_t>(chunk.uvs.size() / 2);
+		normalCount += static_cast<uint32_t>(chunk.normals.size() / 3);
+	}
+
+	// the attribute arrays every face indexes into, stitched together from the chunks
+	vector<float> positions(positionCount * 3);
+	vector<float> uvs(uvCount * 2);
+	vector<float> normals(normalCount * 3);
+	vector<uint8_t> badIndex(chunkCount, 0);
+
+	ThreadPool::forEach(pool, chunkCount, [&](size_t i) {
+		ObjChunk & chunk = chunks[i];
+		std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase * 3);
+		std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.uvBase * 2);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase * 3);
+
+		const uint32_t bases[3] = { chunk.positionBase, chunk.uvBase, chunk.normalBase };
+		for (uint32_t corner : chunk.relativeCorners) chunk.corners[corner] += bases[corner % 3];
+
+		const uint32_t counts[3] = { positionCount, uvCount, normalCount };
+		for (size_t c = 0; c < chunk.corners.size(); c++)
+		{
+			int32_t index = chunk.corners[c];
+			if (index != ABSENT_INDEX && (index < 0 || uint32_t(index) >= counts[c % 3])) badIndex[i] = 1;
+		}
+	});
+
+	if (std::find(badIndex.begin(), badIndex.end(), 1) != badIndex.end()) {
+		std::cout << path << ": face references a vertex that does not exist" << std::endl;
+		return false;
+	}
+
+	vector<string> materialNames;
+	for (const auto & chunk : chunks)
+	{
+		for (const auto & library : chunk.materialLibraries)
+		{
+			// a missing material library is not fatal, Assimp falls back to a default material as well
+			const string libraryPath = directoryOf(path) + library;
+			if (!parseMtl(libraryPath.c_str(), model.materials)) warnMissingLibrary(path, libraryPath);
+		}
+	}
+
+	// walk the o / g / usemtl events in file order to decide which mesh every triangle belongs to
+	vector<ObjRange> ranges;
+	vector<uint32_t> meshTriangles;
+	string activeGroup;
+	string activeMaterial;
+	int activeMaterialIndex = -1;
+	uint32_t currentMesh = 0;
+	meshTriangles.push_back(0);
+	model.meshes.emplace_back();
+	model.meshes.back().material = -1;
+
+	auto findMaterial = [&](const string & name) {
+		for (size_t m = 0; m < model.materials.size(); m++)
+			if (model.materials[m].name == name) return static_cast<int>(m);
+		return -1;
+	};
+
+	auto startMesh = [&](string name) {
+		currentMesh = static_cast<uint32_t>(model.meshes.size());
+		meshTriangles.push_back(0);
+		model.meshes.emplace_back();
+		model.meshes.back().name = name;
+		model.meshes.back().material = activeMaterialIndex;
+	};
+
+	for (uint32_t c = 0; c < chunkCount; c++)
+	{
+		const ObjChunk & chunk = chunks[c];
+		uint32_t triangleCount = static_cast<uint32_t>(chunk.corners.size() / 9);
+		uint32_t rangeStart = 0;
+
+		for (size_t e = 0; e <= chunk.events.size(); e++)
+		{
+			uint32_t rangeEnd = e < chunk.events.size() ? chunk.events[e].triangle : triangleCount;
+			if (rangeEnd > rangeStart) {
+				ranges.push_back({ c, rangeStart, rangeEnd, currentMesh, meshTriangles[currentMesh] });
+				meshTriangles[currentMesh] += rangeEnd - rangeStart;
+			}
+			rangeStart = rangeEnd;
+			if (e == chunk.events.size()) break;
+
+			const ObjEvent & event = chunk.events[e];
+			if (event.type == OBJ_EVENT_OBJECT) {
+				startMesh(event.name);
+			}
+			else if (event.type == OBJ_EVENT_GROUP) {
+				if (event.name != activeGroup) startMesh(event.name);
+				activeGroup = event.name;
+			}
+			else if (event.name != activeMaterial) {
+				activeMaterial = event.name;
+				activeMaterialIndex = findMaterial(event.name);
+				if (meshTriangles[currentMesh] > 0) startMesh(model.meshes[currentMesh].name);
+				model.meshes[currentMesh].material = activeMaterialIndex;
+			}
+		}
+	}
+
+	for (size_t m = 0; m < model.meshes.size(); m++)
+	{
+		ObjMesh & mesh = model.meshes[m];
+		size_t vertexCount = meshTriangles[m] * 3;
+		mesh.positions.resize(vertexCount * 3);
+		if (normalCount) mesh.normals.resize(vertexCount * 3, 0.0f);
+		if (uvCount) mesh.uvs.resize(vertexCount * 2, 0.0f);
+		mesh.indices.resize(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++) mesh.indices[i] = static_cast<uint32_t>(i);
+	}
+
+	// de-index every corner into its mesh, ranges never overlap so they can all be written at once
+	ThreadPool::forEach(pool, ranges.size(), [&](size_t r) {
+		const ObjRange & range = ranges[r];
+		const ObjChunk & chunk = chunks[range.chunk];
+		ObjMesh & mesh = model.meshes[range.mesh];
+
+		size_t vertex = size_t(range.meshTriangle) * 3;
+		for (size_t corner = size_t(range.firstTriangle) * 3; corner < size_t(range.lastTriangle) * 3; corner++, vertex++)
+		{
+			const int32_t * indices = &chunk.corners[corner * 3];
+			memcpy(&mesh.positions[vertex * 3], &positions[indices[0] * 3], sizeof(float) * 3);
+			if (indices[1] != ABSENT_INDEX && uvCount) memcpy(&mesh.uvs[vertex * 2], &uvs[indices[1] * 2], sizeof(float) * 2);
+			if (indices[2] != ABSENT_INDEX && normalCount) memcpy(&mesh.normals[vertex * 3], &normals[indices[2] * 3], sizeof(float) * 3);
+		}
+	});
+
+	model.meshes.erase(std::remove_if(model.meshes.begin(), model.meshes.end(),
+		[](const ObjMesh & mesh) { return mesh.indices.empty(); }), model.meshes.end());
+
+	return true;
+}
+
+bool parseMtl(const char * path, vector<ObjMaterial> & materials)
+{
+	MappedFile file;
+	if (!file.open(path)) return false;
+
+	auto line = reinterpret_cast<const char*>(file.data());
+	const char * end = line + file.size();
+	ObjMaterial * material = nullptr;
+
+	auto readColor = [](const char * text, const char * lineEnd, float * color) {
+		for (int c = 0; c < 3; c++)
+		{
+			text = skipSpaces(text, lineEnd);
+			const char * next = parseFloat(text, lineEnd, color[c]);
+			if (!next) {
+				// a single value means grey
+				color[c] = c > 0 ? color[0] : 0.0f;
+				continue;
+			}
+			text = next;
+		}
+	};
+
+	while (line < end)
+	{
+		const char * lineEnd = reinterpret_cast<const char*>(memchr(line, '\n', end - line));
+		if (!lineEnd) lineEnd = end;
+		const char * text = skipSpaces(line, lineEnd);
+		line = lineEnd + 1;
+
+		if (keyword(text, lineEnd, "newmtl")) {
+			materials.push_back(ObjMaterial());
+			material = &materials.back();
+			material->name = restOfLine(text + 6, lineEnd);
+			for (int c = 0; c < 3; c++)
+			{
+				material->ambient[c] = 0.0f;
+				material->diffuse[c] = 0.6f;
+				material->specular[c] = 0.0f;
+			}
+			material->shininess = 0.0f;
+			material->opacity = 1.0f;
+			continue;
+		}
+
+		if (!material) continue;
+
+		if (keyword(text, lineEnd, "Ka")) readColor(text + 2, lineEnd, material->ambient);
+		else if (keyword(text, lineEnd, "Kd")) readColor(text + 2, lineEnd, material->diffuse);
+		else if (keyword(text, lineEnd, "Ks")) readColor(text + 2, lineEnd, material->specular);
+		else if (keyword(text, lineEnd, "Ns")) parseFloat(skipSpaces(text + 2, lineEnd), lineEnd, material->shininess);
+		else if (keyword(text, lineEnd, "d")) parseFloat(skipSpaces(text + 1, lineEnd), lineEnd, material->opacity);
+		else if (keyword(text, lineEnd, "Tr")) {
+			float transparency = 0.0f;
+			if (parseFloat(skipSpaces(text + 2, lineEnd), lineEnd, transparency)) material->opacity = 1.0f - transparency;
+		}
+		else if (keyword(text, lineEnd, "map_Kd")) material->diffuseMap = restOfLine(text + 6, lineEnd);
+		else if (keyword(text, lineEnd, "map_d")) material->alphaMap = restOfLine(text + 5, lineEnd);
+		else if (keyword(text, lineEnd, "map_Ks")) material->specularMap = restOfLine(text + 6, lineEnd);
+		else if (keyword(text, lineEnd, "map_Bump")) material->normalMap = restOfLine(text + 8, lineEnd);
+		else if (keyword(text, lineEnd, "bump")) material->normalMap = restOfLine(text + 4, lineEnd);
+		else if (keyword(text, lineEnd, "norm")) material->normalMap = restOfLine(text + 4, lineEnd);
+	}
+
+	return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/*Wavefront .obj / .mtl reader written for the handful of models in Models/, a lot faster than going through Assimp.
+
+The file is memory mapped and cut into line aligned chunks that are parsed in parallel, numbers are read with the
+fast path of the fast_float / Clinger algorithm (exact for the short decimals exporters write) instead of strtod.
+Output follows what Assimp produces with aiProcess_Triangulate so the two are interchangeable:
+
+	- one mesh per object / group / material change, in file order, empty ones dropped
+	- polygons are fanned from their first corner
+	- every face corner is its own vertex (the mesh cache welds them afterwards), indices are 0..n-1*/
+
+struct ObjMaterial
+{
+	std::string name;
+	float ambient[3];
+	float diffuse[3];
+	float specular[3];
+	float shininess;
+	float opacity;
+	std::string diffuseMap; // paths as written in the .mtl, relative to it
+	std::string alphaMap;
+	std::string specularMap;
+	std::string normalMap;
+};
+
+struct ObjMesh
+{
+	std::string name;
+	int material; // index into ObjModel::materials, -1 when the file has none
+	std::vector<float> positions; // xyz per vertex
+	std::vector<float> normals; // xyz per vertex, empty when the file has no normals
+	std::vector<float> uvs; // uv per vertex, empty when the file has no texture coordinates
+	std::vector<uint32_t> indices;
+
+	size_t vertexCount() const { return positions.size() / 3; }
+};
+
+struct ObjModel
+{
+	std::vector<ObjMesh> meshes;
+	std::vector<ObjMaterial> materials;
+};
+
+// pool may be null to parse on the calling thread only
+bool parseObj(const char * path, ObjModel & model, ThreadPool * pool = nullptr);
+
+bool parseMtl(const char * path, std::vector<ObjMaterial> & materials);
+
+// Decimal text to float, returns the character after the number or nullptr if there is none.
+const char * parseFloat(const char * text, const char * end, float & value);
@@ -0,0 +1,310 @@
+#include "PathTracer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// hits closer than this to the origin, in units of the ray direction, are the surface the ray starts on
+static const float PATH_EPSILON = 1e-4f;
+static const float PI = 3.14159265358979f;
+
+static uint32_t hash(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+namespace {
+
+// a counter through the hash, good enough for a few dozen numbers per sample
+struct PathRandom
+{
+	uint32_t state;
+
+	float next()
+	{
+		state = state * 747796405u + 2891336453u;
+		return (hash(state) >> 8) * (1.0f / 16777216.0f);
+	}
+};
+
+}
+
+static float luminance(const glm::vec3 & color)
+{
+	return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+static glm::vec3 onSphere(PathRandom & random)
+{
+	float z = 1.0f - 2.0f * random.next();
+	float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+	float phi = 2.0f * PI * random.next();
+	return glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+// cosine weighted around the normal, which cancels the cosine of the Lambert term
+static glm::vec3 onHemisphere(const glm::vec3 & normal, PathRandom & random)
+{
+	// tangent frame without a branch on the normal's direction (Duff et al. 2017)
+	float sign = std::copysign(1.0f, normal.z);
+	float a = -1.0f / (sign + normal.z);
+	float b = normal.x * normal.y * a;
+	glm::vec3 tangent(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+	glm::vec3 bitangent(b, sign + normal.y * normal.y * a, -normal.y);
+
+	float u = random.next();
+	float r = std::sqrt(u);
+	float phi = 2.0f * PI * random.next();
+	return tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + normal * std::sqrt(std::max(0.0f, 1.0f - u));
+}
+
+int traceSpheres(const std::vector<RaySphere> & spheres, const glm::vec3 & origin, const glm::vec3 & direction,
+	float maxDistance, float & distance, bool anyHit)
+{
+	float a = glm::dot(direction, direction);
+	int nearest = -1;
+	distance = maxDistance;
+	for (size_t i = 0; i < spheres.size(); i++)
+	{
+		glm::vec3 offset = origin - spheres[i].center;
+		float b = glm::dot(direction, offset);
+		float c = glm::dot(offset, offset) - spheres[i].radius * spheres[i].radius;
+		float discriminant = b * b - a * c;
+		if (discriminant <= 0.0f) continue;
+
+		float root = std::sqrt(discriminant);
+		float t = (-b - root) / a;
+		if (t <= PATH_EPSILON) t = (-b + root) / a;
+		if (t <= PATH_EPSILON || t >= distance) continue;
+
+		distance = t;
+		nearest = static_cast<int>(i);
+		if (anyHit) break;
+	}
+	return nearest;
+}
+
+namespace {
+
+struct PathTracer
+{
+	const SphereScene & scene;
+	const PathTraceOptions & options;
+	uint64_t rays;
+
+	glm::vec3 background(const glm::vec3 & direction, bool camera) const
+	{
+		if (scene.backgroundMode == RAY_BACKGROUND_COLOR) return camera ? scene.background : scene.background * options.skyIntensity;
+		// the shader's sky is the camera direction as it is, a bounce direction has no such scale
+		if (camera) return direction;
+		return glm::max(glm::normalize(direction), glm::vec3(0.0f)) * options.skyIntensity;
+	}
+
+	glm::vec3 trace(glm::vec3 origin, glm::vec3 direction, PathRandom & random)
+	{
+		glm::vec3 color(0.0f), throughput(1.0f);
+		for (uint32_t bounce = 0; ; bounce++)
+		{
+			rays++;
+			float distance;
+			int sphere = traceSpheres(scene.spheres, origin, direction, FLT_MAX, distance, false);
+			if (sphere < 0)
+			{
+				color += throughput * background(direction, bounce == 0);
+				break;
+			}
+
+			const RaySphere & hit = scene.spheres[sphere];
+			glm::vec3 position = origin + direction * distance;
+			glm::vec3 normal = (position - hit.center) / hit.radius;
+
+			// the Lambert term of renderSpheres towards one point of the light, visible or not
+			glm::vec3 toLight = scene.light + onSphere(random) * options.lightRadius - position;
+			float cosine = glm::dot(normal, toLight);
+			if (cosine > 0.0f)
+			{
+				rays++;
+				float blocker;
+				if (traceSpheres(scene.spheres, position, toLight, 1.0f, blocker, true) < 0)
+					color += throughput * scene.diffuse * (cosine / std::max(glm::length(toLight), FLT_MIN));
+			}
+
+			if (bounce == options.bounces) break;
+			throughput *= scene.diffuse;
+			origin = position;
+			direction = onHemisphere(normal, random);
+		}
+		return color;
+	}
+};
+
+}
+
+void ProgressiveRenderer::reset(const SphereScene & scene, uint32_t width, uint32_t height, const PathTraceOptions & options)
+{
+	this->scene = scene;
+	config = options;
+	config.samplesPerPass = std::max(config.samplesPerPass, 1u);
+	config.maxSamples = std::max(config.maxSamples, 1u);
+	this->width = width;
+	this->height = height;
+	accumulation.assign(size_t(width) * height, glm::vec4(0.0f));
+	passes = 0;
+	samples = 0;
+
+	uint32_t tileSize = std::max(config.tileSize, 1u);
+	tiles.clear();
+	runningTiles.clear();
+	for (uint32_t y = 0; y < height; y += tileSize)
+	{
+		for (uint32_t x = 0; x < width; x += tileSize)
+		{
+			Tile tile;
+			tile.x0 = x;
+			tile.y0 = y;
+			tile.x1 = std::min(x + tileSize, width);
+			tile.y1 = std::min(y + tileSize, height);
+			tile.error = FLT_MAX;
+			runningTiles.push_back(static_cast<uint32_t>(tiles.size()));
+			tiles.push_back(tile);
+		}
+	}
+}
+
+void ProgressiveRenderer::sampleTile(Tile & tile)
+{
+	PathTracer tracer = { scene, config, 0 };
+	const RayCamera & camera = scene.camera;
+	uint32_t first = tile.samples;
+	uint32_t last = std::min(first + config.samplesPerPass, config.maxSamples);
+	float inverseWidth = 1.0f / width, inverseHeight = 1.0f / height;
+
+	for (uint32_t y = tile.y0; y < tile.y1; y++)
+	{
+		for (uint32_t x = tile.x0; x < tile.x1; x++)
+		{
+			uint32_t pixel = y * width + x;
+			glm::vec4 & sum = accumulation[pixel];
+			for (uint32_t sample = first; sample < last; sample++)
+			{
+				PathRandom random = { hash(hash(pixel) ^ (sample * 0x9e3779b9u + config.seed * 0x85ebca6bu)) };
+
+				// anywhere inside the pixel instead of the camera's fixed offset
+				float u = (x + random.next()) * inverseWidth;
+				float v = (y + random.next()) * inverseHeight;
+				glm::vec3 origin = camera.origin + camera.originU * u + camera.originV * v;
+				glm::vec3 direction = camera.direction + camera.directionU * u + camera.directionV * v;
+
+				glm::vec3 color = tracer.trace(origin, direction, random);
+				float brightness = luminance(color);
+				sum += glm::vec4(color, brightness * brightness);
+			}
+		}
+	}
+	tile.samples = last;
+	tile.rays = tracer.rays;
+
+	// variance of each pixel's mean from its two sums, averaged over the tile
+	float n = static_cast<float>(tile.samples);
+	if (tile.samples < 2)
+	{
+		tile.error = FLT_MAX;
+		return;
+	}
+	double total = 0.0;
+	for (uint32_t y = tile.y0; y < tile.y1; y++)
+	{
+		for (uint32_t x = tile.x0; x < tile.x1; x++)
+		{
+			const glm::vec4 & sum = accumulation[y * width + x];
+			float mean = luminance(glm::vec3(sum)) / n;
+			float variance = std::max(sum.w / n - mean * mean, 0.0f) * n / (n - 1.0f);
+			total += variance / n;
+		}
+	}
+	tile.error = static_cast<float>(std::sqrt(total / ((tile.x1 - tile.x0) * (tile.y1 - tile.y0))));
+}
+
+uint64_t ProgressiveRenderer::pass(ThreadPool * pool)
+{
+	if (runningTiles.empty()) return 0;
+
+	for (uint32_t index : runningTiles)
+	{
+		const Tile & tile = tiles[index];
+		uint32_t added = std::min(tile.samples + config.samplesPerPass, config.maxSamples) - tile.samples;
+		samples += uint64_t(tile.x1 - tile.x0) * (tile.y1 - tile.y0) * added;
+	}
+
+	// tiles only write their own pixels, the pool hands them out as threads come free
+	auto run = [&](size_t i) { sampleTile(tiles[runningTiles[i]]); };
+	ThreadPool::forEach(pool, runningTiles.size(), run);
+	passes++;
+
+	uint64_t rays = 0;
+	for (uint32_t index : runningTiles) rays += tiles[index].rays;
+
+	auto done = [&](uint32_t index) {
+		const Tile & tile = tiles[index];
+		return tile.samples >= config.maxSamples || (tile.samples >= config.minSamples && tile.error <= config.threshold);
+	};
+	// uniform sampling runs everything for as long as anything is still noisy
+	if (config.adaptive)
+		runningTiles.erase(std::remove_if(runningTiles.begin(), runningTiles.end(), done), runningTiles.end());
+	else if (std::all_of(runningTiles.begin(), runningTiles.end(), done))
+		runningTiles.clear();
+	return rays;
+}
+
+uint32_t ProgressiveRenderer::maxTileSamples() const
+{
+	uint32_t most = 0;
+	for (const auto & tile : tiles) most = std::max(most, tile.samples);
+	return most;
+}
+
+float ProgressiveRenderer::maxError() const
+{
+	float error = 0.0f;
+	for (uint32_t index : runningTiles) error = std::max(error, tiles[index].error);
+	return error;
+}
+
+void ProgressiveRenderer::resolve(RayImage & image) const
+{
+	image.width = width;
+	image.height = height;
+	image.pixels.assign(size_t(width) * height, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	for (const auto & tile : tiles)
+	{
+		if (!tile.samples) continue;
+		float scale = 1.0f / tile.samples;
+		for (uint32_t y = tile.y0; y < tile.y1; y++)
+		{
+			for (uint32_t x = tile.x0; x < tile.x1; x++)
+				image.pixels[y * width + x] = glm::vec4(glm::vec3(accumulation[y * width + x]) * scale, 1.0f);
+		}
+	}
+}
+
+void ProgressiveRenderer::resolveSampleCounts(RayImage & image) const
+{
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(size_t(width) * height);
+	float scale = 1.0f / std::max(maxTileSamples(), 1u);
+	for (const auto & tile : tiles)
+	{
+		float gray = tile.samples * scale;
+		for (uint32_t y = tile.y0; y < tile.y1; y++)
+		{
+			for (uint32_t x = tile.x0; x < tile.x1; x++)
+				image.pixels[y * width + x] = glm::vec4(gray, gray, gray, 1.0f);
+		}
+	}
+}
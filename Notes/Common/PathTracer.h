@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm\glm.hpp>
+#include "RayTracer.h"
+
+class ThreadPool;
+
+/*Progressive path tracer for the sphere scenes of RayTracer.h, for effects one ray per pixel cannot show: the light
+becomes a sphere, so shadows get soft edges, and a diffuse bounce picks up the background as a sky, and every pixel's
+samples are jittered across it, which smooths the edges of the spheres.
+
+Each pass adds a few samples to every pixel of the tiles still running and sums them into a float buffer, so the image
+gets better the longer it runs and resolve() can show it at any point. Besides the color sum a pixel keeps the sum of
+its squared luminance, from which the variance of its mean follows. A tile's error is the root mean square of those
+over its pixels, the expected distance of the displayed values from the converged ones. Once it is below threshold
+(and the tile has minSamples, below which the estimate is mostly luck) the tile stops, and later passes go only to the
+ones that are still noisy: the background and flat lit surfaces finish after a few samples, soft shadow edges and
+silhouettes take the rest. With adaptive off every tile keeps sampling until the last one converges, which is what a
+uniform sample count needs to reach the same quality and what the adaptive one is measured against.
+
+Every sample draws its random numbers from a hash of the pixel, the sample index and the seed, so the image is the same
+whatever thread rendered which tile and however the passes were cut. Both demos run one pass a frame with P: the
+ComputeShader one shows resolve() in place of its dispatch, starting over whenever the light moves, and the Raytracing
+one draws it over the window in place of its fragment shader.
+
+	ProgressiveRenderer renderer;
+	renderer.reset(scene, width, height);
+	while (!renderer.converged())
+		renderer.pass(&pool);
+	renderer.resolve(image);*/
+
+struct PathTraceOptions
+{
+	float lightRadius = 0.5f; // the scene's light becomes a sphere of this radius, 0 for the hard shadows of a point
+	uint32_t bounces = 1; // diffuse bounces after the camera ray's hit, 0 for direct light only
+	float skyIntensity = 0.25f; // the background as a light for bounce rays that escape
+	uint32_t tileSize = 16; // pixels along a tile side, the unit that converges
+	uint32_t samplesPerPass = 4; // added to every pixel of a running tile by one pass
+	uint32_t minSamples = 16; // per pixel before a tile's error is trusted
+	uint32_t maxSamples = 4096; // per pixel, a tile stops here converged or not
+	float threshold = 0.004f; // tile error that counts as converged, in display units of 0..1 (1/255 is one step)
+	bool adaptive = true; // false keeps every tile sampling until the last one converges
+	uint32_t seed = 0;
+};
+
+// nearest sphere hit along origin + t direction for t in (1e-4, maxDistance), -1 for none; with anyHit the first one
+// found. distance is t of the hit, maxDistance when there is none.
+int traceSpheres(const std::vector<RaySphere> & spheres, const glm::vec3 & origin, const glm::vec3 & direction,
+	float maxDistance, float & distance, bool anyHit);
+
+class ProgressiveRenderer
+{
+public:
+	// Starts over on the scene at any size, the camera only sees u, v like renderSpheres.
+	void reset(const SphereScene & scene, uint32_t width, uint32_t height,
+		const PathTraceOptions & options = PathTraceOptions());
+
+	// Samples the running tiles, spread over the pool if given, then updates their error. Returns the rays traced,
+	// camera, bounce and shadow rays all counting.
+	uint64_t pass(ThreadPool * pool = nullptr);
+
+	bool converged() const { return runningTiles.empty(); }
+	uint32_t passCount() const { return passes; }
+	size_t tileCount() const { return tiles.size(); }
+	size_t runningTileCount() const { return runningTiles.size(); }
+	uint64_t sampleCount() const { return samples; } // camera samples over all pixels
+	uint32_t maxTileSamples() const; // per pixel, of the most sampled tile
+	float maxError() const; // of the tiles still running, 0 once converged
+
+	// the mean of every pixel's samples so far
+	void resolve(RayImage & image) const;
+
+	// each tile's samples per pixel as a gray level, white for the most sampled one
+	void resolveSampleCounts(RayImage & image) const;
+
+private:
+	struct Tile
+	{
+		uint32_t x0, y0, x1, y1;
+		uint32_t samples = 0; // per pixel
+		float error = 0.0f;
+		uint64_t rays = 0; // in the last pass
+	};
+
+	void sampleTile(Tile & tile);
+
+	SphereScene scene;
+	PathTraceOptions config;
+	uint32_t width = 0, height = 0;
+	std::vector<glm::vec4> accumulation; // color sums in rgb, sum of the squared luminance in a
+	std::vector<Tile> tiles;
+	std::vector<uint32_t> runningTiles;
+	uint32_t passes = 0;
+	uint64_t samples = 0;
+};
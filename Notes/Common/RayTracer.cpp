@@ -0,0 +1,183 @@
+#include "RayTracer.h"
+#include "CpuFeatures.h"
+#include "RayTracerKernel.h"
+#include "ThreadPool.h"
+#include <SOIL.h>
+#include <algorithm>
+#include <random>
+
+const char * raySimdName(RaySimd simd)
+{
+	switch (simd)
+	{
+	case RAY_SIMD_SCALAR: return "scalar";
+	case RAY_SIMD_SSE2: return "sse2";
+	case RAY_SIMD_AVX2: return "avx2";
+	default: return "best";
+	}
+}
+
+RaySimd raySimdSupported()
+{
+	return cpuHasAvx2() ? RAY_SIMD_AVX2 : RAY_SIMD_SSE2;
+}
+
+uint32_t raySimdWidth(RaySimd simd)
+{
+	if (simd == RAY_SIMD_BEST) simd = raySimdSupported();
+	return simd == RAY_SIMD_AVX2 ? 8 : simd == RAY_SIMD_SSE2 ? 4 : 1;
+}
+
+SphereScene raytracingScene()
+{
+	SphereScene scene;
+	scene.spheres.push_back({ glm::vec3(-2.0f, -2.0f, -4.0f), 2.0f });
+
+	// direction = lower left corner + u * horizontal + v * vertical, u and v from gl_FragCoord (pixel centers)
+	scene.camera.origin = glm::vec3(1.0f);
+	scene.camera.originU = scene.camera.originV = glm::vec3(0.0f);
+	scene.camera.direction = glm::vec3(-2.0f, -1.0f, -1.0f);
+	scene.camera.directionU = glm::vec3(4.0f, 0.0f, 0.0f);
+	scene.camera.directionV = glm::vec3(0.0f, 2.0f, 0.0f);
+	scene.camera.pixelOffset = 0.5f;
+
+	scene.light = glm::vec3(-0.5f, 0.0f, 0.0f);
+	scene.diffuse = glm::vec3(0.5f, 0.3f, 0.7f);
+	scene.background = glm::vec3(1.0f);
+	scene.backgroundMode = RAY_BACKGROUND_DIRECTION;
+	scene.width = 800;
+	scene.height = 400;
+	return scene;
+}
+
+SphereScene computeShaderScene(uint32_t sphereCount, uint32_t seed, float spread)
+{
+	SphereScene scene;
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(-spread, spread);
+	for (uint32_t i = 0; i < sphereCount; i++)
+	{
+		float x = position(random);
+		float y = position(random);
+		scene.spheres.push_back({ glm::vec3(x, y, -10.0f), 1.0f });
+	}
+
+	// origin = ((2 x - width) / width * 5, (2 y - height) / height * 5, 0) from the integer invocation ids
+	scene.camera.origin = glm::vec3(-5.0f, -5.0f, 0.0f);
+	scene.camera.originU = glm::vec3(10.0f, 0.0f, 0.0f);
+	scene.camera.originV = glm::vec3(0.0f, 10.0f, 0.0f);
+	scene.camera.direction = glm::vec3(0.0f, 0.0f, -1.0f);
+	scene.camera.directionU = scene.camera.directionV = glm::vec3(0.0f);
+	scene.camera.pixelOffset = 0.0f;
+
+	// where the demo's light starts its sweep
+	scene.light = glm::vec3(-2.5f, 2.0f, -6.0f);
+	scene.diffuse = glm::vec3(0.5f, 0.3f, 0.7f);
+	scene.background = glm::vec3(1.0f, 0.4f, 0.6f);
+	scene.backgroundMode = RAY_BACKGROUND_COLOR;
+	scene.width = 1024;
+	scene.height = 768;
+	return scene;
+}
+
+void rayTileSse2(const RayTraceSetup & setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1)
+{
+	RayKernel<Sse2RayLanes>::tile(setup, x0, x1, y0, y1);
+}
+
+static void copy3(float destination[3], const glm::vec3 & source)
+{
+	destination[0] = source.x;
+	destination[1] = source.y;
+	destination[2] = source.z;
+}
+
+uint64_t renderSpheres(const SphereScene & scene, uint32_t width, uint32_t height, RayImage & image,
+	const RayRenderOptions & options, ThreadPool * pool)
+{
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(size_t(width) * height);
+	if (!width || !height) return 0;
+
+	size_t count = scene.spheres.size();
+	std::vector<float> spheres(count * 5);
+	float * centerX = spheres.data(), * centerY = centerX + count, * centerZ = centerY + count;
+	float * radiusSquared = centerZ + count, * inverseRadius = radiusSquared + count;
+	for (size_t i = 0; i < count; i++)
+	{
+		const RaySphere & sphere = scene.spheres[i];
+		centerX[i] = sphere.center.x;
+		centerY[i] = sphere.center.y;
+		centerZ[i] = sphere.center.z;
+		radiusSquared[i] = sphere.radius * sphere.radius;
+		inverseRadius[i] = 1.0f / sphere.radius;
+	}
+
+	RayTraceSetup setup;
+	setup.centerX = centerX;
+	setup.centerY = centerY;
+	setup.centerZ = centerZ;
+	setup.radiusSquared = radiusSquared;
+	setup.inverseRadius = inverseRadius;
+	setup.sphereCount = static_cast<uint32_t>(count);
+	copy3(setup.origin, scene.camera.origin);
+	copy3(setup.originU, scene.camera.originU);
+	copy3(setup.originV, scene.camera.originV);
+	copy3(setup.direction, scene.camera.direction);
+	copy3(setup.directionU, scene.camera.directionU);
+	copy3(setup.directionV, scene.camera.directionV);
+	setup.pixelOffset = scene.camera.pixelOffset;
+	setup.inverseWidth = 1.0f / width;
+	setup.inverseHeight = 1.0f / height;
+	copy3(setup.light, scene.light);
+	copy3(setup.diffuse, scene.diffuse);
+	copy3(setup.background, scene.background);
+	setup.directionBackground = scene.backgroundMode == RAY_BACKGROUND_DIRECTION;
+	setup.pixels = &image.pixels[0].x;
+	setup.width = width;
+
+	RaySimd simd = options.simd;
+	if (simd == RAY_SIMD_BEST || (simd == RAY_SIMD_AVX2 && raySimdSupported() != RAY_SIMD_AVX2))
+		simd = raySimdSupported();
+
+	uint32_t tileSize = std::max(options.tileSize, 1u);
+	uint32_t tilesX = (width + tileSize - 1) / tileSize;
+	uint32_t tilesY = (height + tileSize - 1) / tileSize;
+	auto runTile = [&](size_t tile) {
+		uint32_t x0 = static_cast<uint32_t>(tile % tilesX) * tileSize;
+		uint32_t y0 = static_cast<uint32_t>(tile / tilesX) * tileSize;
+		uint32_t x1 = std::min(x0 + tileSize, width);
+		uint32_t y1 = std::min(y0 + tileSize, height);
+
+		if (simd == RAY_SIMD_AVX2) rayTileAvx2(setup, x0, x1, y0, y1);
+		else if (simd == RAY_SIMD_SSE2) rayTileSse2(setup, x0, x1, y0, y1);
+		else RayKernel<ScalarRayLanes>::tile(setup, x0, x1, y0, y1);
+	};
+
+	// the pool hands the tiles out one at a time as threads come free
+	size_t tiles = size_t(tilesX) * tilesY;
+	ThreadPool::forEach(pool, tiles, runTile);
+
+	return uint64_t(width) * height;
+}
+
+bool saveRayImage(const char * path, const RayImage & image)
+{
+	// top row first for the file
+	std::vector<unsigned char> bytes(size_t(image.width) * image.height * 3);
+	for (uint32_t y = 0; y < image.height; y++)
+	{
+		const glm::vec4 * row = image.pixels.data() + size_t(image.height - 1 - y) * image.width;
+		unsigned char * destination = bytes.data() + size_t(y) * image.width * 3;
+		for (uint32_t x = 0; x < image.width; x++)
+		{
+			for (int channel = 0; channel < 3; channel++)
+			{
+				float value = std::min(std::max(row[x][channel], 0.0f), 1.0f);
+				destination[x * 3 + channel] = static_cast<unsigned char>(value * 255.0f + 0.5f);
+			}
+		}
+	}
+	return SOIL_save_image(path, SOIL_SAVE_TYPE_BMP, image.width, image.height, 3, bytes.data()) != 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm\glm.hpp>
+
+class ThreadPool;
+
+/*CPU ray tracer for the sphere scenes of the Raytracing and ComputeShader demos, so they can be rendered and timed on
+machines without a GPU.
+
+Rays are traced in packets of adjacent pixels along a row: 4 per SSE2 instruction or 8 per AVX2 one (picked at runtime
+when the CPU has it, like the noise kernels), the pixels past the last full packet of a row one at a time through the
+same template. Every sphere is tested against a whole packet at once and skipped as soon as none of its rays can reach
+it. The image is cut into square tiles handed out to the pool in turn, so a thread that finishes a cheap tile of
+background takes the next one instead of idling.
+
+Both shaders define a camera by how the ray of a pixel is built, the Raytracing one a pinhole (one origin, directions
+across a rectangle in front of it) and the ComputeShader one orthographic (origins across a rectangle, one
+direction). RayCamera covers both: origin and direction are each linear in the pixel's position u, v in 0..1.
+
+The Raytracing shader's intersectRaySphere halves the distance of the hit and lights the side facing away from the
+light. Here, as in the ComputeShader one, the nearest hit in front of the origin is taken and shaded with the Lambert
+term towards the light, so the images show the same spheres, camera and colors, lit the right way round.*/
+
+enum RaySimd
+{
+	RAY_SIMD_SCALAR,
+	RAY_SIMD_SSE2,
+	RAY_SIMD_AVX2,
+	RAY_SIMD_BEST, // the widest the CPU supports
+};
+
+const char * raySimdName(RaySimd simd);
+
+// what RAY_SIMD_BEST resolves to on this CPU
+RaySimd raySimdSupported();
+
+// rays per packet
+uint32_t raySimdWidth(RaySimd simd);
+
+struct RaySphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+// the ray through pixel (x, y), u = (x + pixelOffset) / width and v = (y + pixelOffset) / height, y going up
+struct RayCamera
+{
+	glm::vec3 origin;
+	glm::vec3 originU, originV; // origin moves by these over the image
+	glm::vec3 direction;
+	glm::vec3 directionU, directionV;
+	float pixelOffset = 0.5f;
+};
+
+enum RayBackground
+{
+	RAY_BACKGROUND_COLOR,
+	RAY_BACKGROUND_DIRECTION, // the ray direction as a color, the Raytracing shader's sky
+};
+
+struct SphereScene
+{
+	std::vector<RaySphere> spheres;
+	RayCamera camera;
+	glm::vec3 light;
+	glm::vec3 diffuse;
+	glm::vec3 background;
+	RayBackground backgroundMode = RAY_BACKGROUND_COLOR;
+	uint32_t width, height; // what the demo renders it at
+};
+
+// the Raytracing fragment shader: a pinhole at (1, 1, 1), one sphere, 800 x 400
+SphereScene raytracingScene();
+
+// the ComputeShader demo: orthographic rays down -z over 10 x 10 units, spheres of radius 1 at random across
+// [-spread, spread] on z = -10, 1024 x 768. The demo places 3 within 2 units.
+SphereScene computeShaderScene(uint32_t sphereCount = 3, uint32_t seed = 0, float spread = 2.0f);
+
+// RGBA floats like the compute shader's output image, rows bottom up like GL
+struct RayImage
+{
+	uint32_t width = 0, height = 0;
+	std::vector<glm::vec4> pixels;
+};
+
+struct RayRenderOptions
+{
+	RaySimd simd = RAY_SIMD_BEST;
+	uint32_t tileSize = 32; // pixels along a tile side, the compute shader's work group
+};
+
+// Renders the scene at any size (the camera only sees u, v), tiles spread over the pool if given. Returns the number
+// of rays traced.
+uint64_t renderSpheres(const SphereScene & scene, uint32_t width, uint32_t height, RayImage & image,
+	const RayRenderOptions & options = RayRenderOptions(), ThreadPool * pool = nullptr);
+
+// 24 bit BMP, colors clamped to 0..1 like a unorm framebuffer
+bool saveRayImage(const char * path, const RayImage & image);
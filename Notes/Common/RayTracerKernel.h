@@ -0,0 +1,189 @@
+#pragma once
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <emmintrin.h>
+
+/*The packet kernel shared by RayTracer.cpp (scalar and SSE2) and RayTracerAvx2.cpp (compiled for AVX2), only for
+those two. Written once against a lane type S for 1, 4 or 8 rays, in an unnamed namespace for the same reason as
+NoiseKernel.h: the AVX2 file must not hand the linker AVX encoded copies of templates the SSE2 file also uses.*/
+
+// the scene flattened for the kernel, spheres as structure of arrays
+struct RayTraceSetup
+{
+	const float * centerX;
+	const float * centerY;
+	const float * centerZ;
+	const float * radiusSquared;
+	const float * inverseRadius;
+	uint32_t sphereCount;
+
+	float origin[3], originU[3], originV[3];
+	float direction[3], directionU[3], directionV[3];
+	float pixelOffset;
+	float inverseWidth, inverseHeight;
+
+	float light[3];
+	float diffuse[3];
+	float background[3];
+	bool directionBackground;
+
+	float * pixels; // RGBA, rows bottom up
+	uint32_t width;
+};
+
+// pixels [x0, x1) of rows [y0, y1)
+void rayTileSse2(const RayTraceSetup & setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1);
+void rayTileAvx2(const RayTraceSetup & setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1);
+
+namespace {
+
+struct ScalarRayLanes
+{
+	typedef float V;
+	typedef bool M;
+	static const int WIDTH = 1;
+
+	static V set(float a) { return a; }
+	static V ramp(uint32_t first) { return static_cast<float>(first); }
+	static void store(float * p, V a) { *p = a; }
+	static V add(V a, V b) { return a + b; }
+	static V sub(V a, V b) { return a - b; }
+	static V mul(V a, V b) { return a * b; }
+	static V div(V a, V b) { return a / b; }
+	static V sqrt(V a) { return std::sqrt(a); }
+	static V max(V a, V b) { return a > b ? a : b; }
+	static V min(V a, V b) { return a < b ? a : b; }
+	static M greater(V a, V b) { return a > b; }
+	static M less(V a, V b) { return a < b; }
+	static M both(M a, M b) { return a && b; }
+	static bool any(M m) { return m; }
+	static V select(M m, V a, V b) { return m ? a : b; } // a where m is set
+};
+
+struct Sse2RayLanes
+{
+	typedef __m128 V;
+	typedef __m128 M;
+	static const int WIDTH = 4;
+
+	static V set(float a) { return _mm_set1_ps(a); }
+	static V ramp(uint32_t first) { return _mm_add_ps(_mm_set1_ps(static_cast<float>(first)), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)); }
+	static void store(float * p, V a) { _mm_storeu_ps(p, a); }
+	static V add(V a, V b) { return _mm_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+	static V div(V a, V b) { return _mm_div_ps(a, b); }
+	static V sqrt(V a) { return _mm_sqrt_ps(a); }
+	static V max(V a, V b) { return _mm_max_ps(a, b); }
+	static V min(V a, V b) { return _mm_min_ps(a, b); }
+	static M greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+	static M less(V a, V b) { return _mm_cmplt_ps(a, b); }
+	static M both(M a, M b) { return _mm_and_ps(a, b); }
+	static bool any(M m) { return _mm_movemask_ps(m) != 0; }
+	static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+
+// hits closer than this to the origin are the surface the ray starts on
+const float RAY_EPSILON = 1e-4f;
+
+template <class S>
+struct RayKernel
+{
+	typedef typename S::V V;
+	typedef typename S::M M;
+
+	// the S::WIDTH rays of pixels x .. x + WIDTH - 1 of row y, nearest hit, shading, written to the image
+	static void packet(const RayTraceSetup & setup, uint32_t x, uint32_t y)
+	{
+		V u = S::mul(S::add(S::ramp(x), S::set(setup.pixelOffset)), S::set(setup.inverseWidth));
+		V v = S::set((y + setup.pixelOffset) * setup.inverseHeight);
+
+		V origin[3], direction[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			origin[axis] = S::add(S::set(setup.origin[axis]),
+				S::add(S::mul(u, S::set(setup.originU[axis])), S::mul(v, S::set(setup.originV[axis]))));
+			direction[axis] = S::add(S::set(setup.direction[axis]),
+				S::add(S::mul(u, S::set(setup.directionU[axis])), S::mul(v, S::set(setup.directionV[axis]))));
+		}
+		V a = dot(direction, direction);
+		V inverseA = S::div(S::set(1.0f), a);
+
+		// t = (-b -+ sqrt(b^2 - a c)) / a with b = d . (o - c), the near root unless it is behind the origin
+		V nearest = S::set(FLT_MAX);
+		V hitCenter[3] = { S::set(0.0f), S::set(0.0f), S::set(0.0f) };
+		V hitInverseRadius = S::set(0.0f);
+		for (uint32_t i = 0; i < setup.sphereCount; i++)
+		{
+			V offset[3] = {
+				S::sub(origin[0], S::set(setup.centerX[i])),
+				S::sub(origin[1], S::set(setup.centerY[i])),
+				S::sub(origin[2], S::set(setup.centerZ[i])),
+			};
+			V b = dot(direction, offset);
+			V c = S::sub(dot(offset, offset), S::set(setup.radiusSquared[i]));
+			V discriminant = S::sub(S::mul(b, b), S::mul(a, c));
+			M crosses = S::greater(discriminant, S::set(0.0f));
+			if (!S::any(crosses)) continue;
+
+			V root = S::sqrt(S::max(discriminant, S::set(0.0f)));
+			V nearT = S::mul(S::sub(S::sub(S::set(0.0f), b), root), inverseA);
+			V farT = S::mul(S::add(S::sub(S::set(0.0f), b), root), inverseA);
+			V t = S::select(S::greater(nearT, S::set(RAY_EPSILON)), nearT, farT);
+			M closer = S::both(S::both(crosses, S::greater(t, S::set(RAY_EPSILON))), S::less(t, nearest));
+			if (!S::any(closer)) continue;
+
+			nearest = S::select(closer, t, nearest);
+			hitCenter[0] = S::select(closer, S::set(setup.centerX[i]), hitCenter[0]);
+			hitCenter[1] = S::select(closer, S::set(setup.centerY[i]), hitCenter[1]);
+			hitCenter[2] = S::select(closer, S::set(setup.centerZ[i]), hitCenter[2]);
+			hitInverseRadius = S::select(closer, S::set(setup.inverseRadius[i]), hitInverseRadius);
+		}
+		M hit = S::less(nearest, S::set(FLT_MAX));
+
+		// the lanes that missed shade their origin with a zero normal, the select below drops that
+		V position[3], normal[3], toLight[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			position[axis] = S::add(origin[axis], S::mul(S::select(hit, nearest, S::set(0.0f)), direction[axis]));
+			normal[axis] = S::mul(S::sub(position[axis], hitCenter[axis]), hitInverseRadius);
+			toLight[axis] = S::sub(S::set(setup.light[axis]), position[axis]);
+		}
+		V lightDistance = S::sqrt(S::max(dot(toLight, toLight), S::set(FLT_MIN)));
+		V lambert = S::max(S::set(0.0f), S::div(dot(normal, toLight), lightDistance));
+
+		float color[3][S::WIDTH];
+		for (int channel = 0; channel < 3; channel++)
+		{
+			V sky = setup.directionBackground ? direction[channel] : S::set(setup.background[channel]);
+			S::store(color[channel], S::select(hit, S::mul(S::set(setup.diffuse[channel]), lambert), sky));
+		}
+
+		float * pixel = setup.pixels + (size_t(y) * setup.width + x) * 4;
+		for (int lane = 0; lane < S::WIDTH; lane++, pixel += 4)
+		{
+			pixel[0] = color[0][lane];
+			pixel[1] = color[1][lane];
+			pixel[2] = color[2][lane];
+			pixel[3] = 1.0f;
+		}
+	}
+
+	static V dot(const V a[3], const V b[3])
+	{
+		return S::add(S::add(S::mul(a[0], b[0]), S::mul(a[1], b[1])), S::mul(a[2], b[2]));
+	}
+
+	static void tile(const RayTraceSetup & setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1)
+	{
+		for (uint32_t y = y0; y < y1; y++)
+		{
+			uint32_t x = x0;
+			for (; x + S::WIDTH <= x1; x += S::WIDTH) packet(setup, x, y);
+			for (; x < x1; x++) RayKernel<ScalarRayLanes>::packet(setup, x, y);
+		}
+	}
+};
+
+}
@@ -0,0 +1,144 @@
+#include "StagingUploader.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "Timer.h"
+
+StagingUploader::StagingUploader(size_t capacity)
+{
+	regionBytes = std::max<size_t>(capacity / REGION_COUNT, 1024);
+	GLsizeiptr totalBytes = static_cast<GLsizeiptr>(regionBytes * REGION_COUNT);
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glBufferStorage(GL_COPY_READ_BUFFER, totalBytes, nullptr, flags);
+	mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, totalBytes, flags));
+}
+
+StagingUploader::~StagingUploader()
+{
+	release();
+}
+
+uint8_t * StagingUploader::reserve(GLuint destination, GLintptr offset, size_t size)
+{
+	if (regionUsed + size > regionBytes)
+		submit();
+
+	GLintptr sourceOffset = static_cast<GLintptr>(region * regionBytes + regionUsed);
+	uint8_t * data = mapped + sourceOffset;
+	regionUsed += size;
+	uploadedBytes += size;
+
+	// element by element uploads into one buffer collapse into a single copy
+	if (!pending.empty()) {
+		Copy & last = pending.back();
+		if (last.destination == destination
+			&& last.destinationOffset + static_cast<GLintptr>(last.size) == offset
+			&& last.sourceOffset + static_cast<GLintptr>(last.size) == sourceOffset) {
+			last.size += size;
+			return data;
+		}
+	}
+
+	pending.push_back({ destination, offset, sourceOffset, size });
+	return data;
+}
+
+void StagingUploader::upload(GLuint destination, GLintptr offset, const void * data, size_t size)
+{
+	Timer timer;
+	auto source = static_cast<const uint8_t*>(data);
+	while (size > 0)
+	{
+		// fill what is left of the region before moving on to the next one
+		size_t space = regionBytes - regionUsed;
+		size_t chunk = std::min(size, space > 0 ? space : regionBytes);
+
+		memcpy(reserve(destination, offset, chunk), source, chunk);
+		source += chunk;
+		offset += chunk;
+		size -= chunk;
+	}
+	milliseconds += timer.elapsedMilliseconds();
+}
+
+void * StagingUploader::allocate(GLuint destination, GLintptr offset, size_t size)
+{
+	if (size > regionBytes) {
+		std::cout << "Staging allocation of " << size << " bytes is larger than a region" << std::endl;
+		return nullptr;
+	}
+	return reserve(destination, offset, size);
+}
+
+void StagingUploader::flush()
+{
+	Timer timer;
+	submit();
+	milliseconds += timer.elapsedMilliseconds();
+}
+
+void StagingUploader::submit()
+{
+	if (pending.empty())
+		return;
+
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	for (auto & copy : pending)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, copy.destination);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copy.sourceOffset, copy.destinationOffset, copy.size);
+	}
+	copies += pending.size();
+	pending.clear();
+
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	nextRegion();
+}
+
+void StagingUploader::nextRegion()
+{
+	region = (region + 1) % REGION_COUNT;
+	regionUsed = 0;
+
+	if (fences[region]) {
+		Timer timer;
+		GLenum result;
+		do {
+			result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fences[region]);
+		fences[region] = nullptr;
+		waitedMilliseconds += timer.elapsedMilliseconds();
+	}
+}
+
+void StagingUploader::release()
+{
+	if (!buffer)
+		return;
+
+	submit();
+	for (auto & fence : fences)
+	{
+		if (fence) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glUnmapBuffer(GL_COPY_READ_BUFFER);
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+	mapped = nullptr;
+}
+
+void StagingUploader::printStatistics() const
+{
+	std::cout << "Staging: " << uploadedBytes / 1024 << " KB in " << copies << " copies, "
+		<< milliseconds << " ms (" << bytesPerSecond() / (1024.0 * 1024.0) << " MB/s), "
+		<< waitedMilliseconds << " ms waiting on the GPU" << std::endl;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <glad\glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*Staging upload service for static buffer data.
+
+The older demos filled their buffers by mapping them with GL_MAP_FLUSH_EXPLICIT_BIT, copying one element at a time,
+flushing every element and then calling glFinish so the unsynchronized map was safe. That is one driver call per
+vertex and a full pipeline drain per buffer.
+
+The uploader owns one persistently and coherently mapped ring (glBufferStorage with GL_MAP_PERSISTENT_BIT) split into
+a few regions. Data is written straight into the current region and the copies into the destination buffers are
+recorded. flush() issues them as glCopyBufferSubData calls, puts a fence behind them and moves on to the next region.
+A region is only waited on when the ring wraps back around to it while the GPU is still reading from it, so nothing
+here ever needs a glFinish.
+
+Destination buffers need storage already (glBufferData with nullptr or glBufferStorage without any map bits), the
+copies go through the GL_COPY_READ_BUFFER / GL_COPY_WRITE_BUFFER bindings and leave the other bindings alone.*/
+class StagingUploader
+{
+public:
+	static const size_t DEFAULT_CAPACITY = 32 * 1024 * 1024;
+	static const int REGION_COUNT = 4;
+
+	// needs a current context, capacity is split evenly between the regions
+	explicit StagingUploader(size_t capacity = DEFAULT_CAPACITY);
+	~StagingUploader();
+
+	StagingUploader(const StagingUploader &) = delete;
+	StagingUploader & operator=(const StagingUploader &) = delete;
+
+	// Copies size bytes to destination at offset, uploads bigger than a region are split over several.
+	void upload(GLuint destination, GLintptr offset, const void * data, size_t size);
+
+	// Ring memory for size bytes that end up in destination at offset, for data that is generated in place instead of
+	// copied. Valid until the next call on the uploader, size can be at most regionSize().
+	void * allocate(GLuint destination, GLintptr offset, size_t size);
+
+	// Issues the recorded copies and fences the region they read from.
+	void flush();
+
+	// Deletes the ring, the demos tear their GL objects down before the context goes away. Does nothing the second
+	// time, the destructor calls it for owners that did not.
+	void release();
+
+	size_t regionSize() const { return regionBytes; }
+
+	// counters since construction, time covers the writes into the ring, the copies and any wait on a region
+	uint64_t bytesUploaded() const { return uploadedBytes; }
+	uint64_t copyCount() const { return copies; }
+	double uploadMilliseconds() const { return milliseconds; }
+	double bytesPerSecond() const { return milliseconds > 0.0 ? uploadedBytes / (milliseconds / 1000.0) : 0.0; }
+	double waitMilliseconds() const { return waitedMilliseconds; }
+	void printStatistics() const;
+
+private:
+	struct Copy
+	{
+		GLuint destination;
+		GLintptr destinationOffset;
+		GLintptr sourceOffset;
+		size_t size;
+	};
+
+	// flush without the timing, also used when a region fills up in the middle of an upload
+	void submit();
+
+	// moves to the next region, waiting for the GPU if it still reads from it
+	void nextRegion();
+	uint8_t * reserve(GLuint destination, GLintptr offset, size_t size);
+
+	GLuint buffer = 0;
+	uint8_t * mapped = nullptr;
+	size_t regionBytes = 0;
+	int region = 0;
+	size_t regionUsed = 0;
+	GLsync fences[REGION_COUNT] = {};
+	std::vector<Copy> pending;
+
+	uint64_t uploadedBytes = 0;
+	uint64_t copies = 0;
+	double milliseconds = 0.0;
+	double waitedMilliseconds = 0.0;
+};
@@ -0,0 +1,224 @@
+#include "TangentSpace.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+#include <glm\glm.hpp>
+#include "ThreadPool.h"
+
+using std::vector;
+
+// triangles or vertices handed to a worker at a time, small enough to balance and large enough to not feel the queue
+static const size_t ITEMS_PER_JOB = 4096;
+
+// below this the uvs of a triangle are degenerate (a sliver in uv space or a triangle mapped to a point)
+static const float MIN_UV_AREA = 1e-12f;
+
+static void forRanges(ThreadPool * pool, size_t count, const std::function<void(size_t, size_t)> & body)
+{
+	size_t jobs = (count + ITEMS_PER_JOB - 1) / ITEMS_PER_JOB;
+	auto runJob = [&](size_t job) {
+		size_t first = job * ITEMS_PER_JOB;
+		body(first, std::min(first + ITEMS_PER_JOB, count));
+	};
+
+	ThreadPool::forEach(pool, jobs, runJob);
+}
+
+static glm::vec3 load3(const float * base, size_t stride, size_t index)
+{
+	const float * p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(base) + stride * index);
+	return glm::vec3(p[0], p[1], p[2]);
+}
+
+static glm::vec2 load2(const float * base, size_t stride, size_t index)
+{
+	const float * p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(base) + stride * index);
+	return glm::vec2(p[0], p[1]);
+}
+
+// any unit vector perpendicular to normal, built off the axis it is least aligned with
+static glm::vec3 perpendicular(const glm::vec3 & normal)
+{
+	glm::vec3 n = glm::abs(normal);
+	glm::vec3 axis = n.x <= n.y && n.x <= n.z ? glm::vec3(1, 0, 0) : n.y <= n.z ? glm::vec3(0, 1, 0) : glm::vec3(0, 0, 1);
+	return glm::normalize(glm::cross(normal, axis));
+}
+
+static float cornerAngle(const glm::vec3 & corner, const glm::vec3 & a, const glm::vec3 & b)
+{
+	glm::vec3 edgeA = a - corner, edgeB = b - corner;
+	float lengths = glm::length(edgeA) * glm::length(edgeB);
+	if (lengths <= 0.0f) return 0.0f;
+	return std::acos(glm::clamp(glm::dot(edgeA, edgeB) / lengths, -1.0f, 1.0f));
+}
+
+void generateTangents(float * tangents, const uint32_t * indices, size_t indexCount,
+	const float * positions, size_t positionStride, const float * normals, size_t normalStride,
+	const float * uvs, size_t uvStride, size_t vertexCount, ThreadPool * pool)
+{
+	size_t triangleCount = indexCount / 3;
+
+	// xyz is the projected tangent times the corner angle, w the angle with the sign of the handedness
+	vector<glm::vec4> corners(triangleCount * 3);
+
+	forRanges(pool, triangleCount, [&](size_t first, size_t last) {
+		for (size_t triangle = first; triangle < last; triangle++)
+		{
+			const uint32_t * corner = &indices[triangle * 3];
+			glm::vec3 p[3] = { load3(positions, positionStride, corner[0]), load3(positions, positionStride, corner[1]), load3(positions, positionStride, corner[2]) };
+			glm::vec2 t[3] = { load2(uvs, uvStride, corner[0]), load2(uvs, uvStride, corner[1]), load2(uvs, uvStride, corner[2]) };
+
+			glm::vec3 edge1 = p[1] - p[0], edge2 = p[2] - p[0];
+			glm::vec2 uv1 = t[1] - t[0], uv2 = t[2] - t[0];
+			float area = uv1.x * uv2.y - uv2.x * uv1.y; // twice the signed area in uv space
+
+			for (int i = 0; i < 3; i++) corners[triangle * 3 + i] = glm::vec4(0.0f);
+			if (std::fabs(area) < MIN_UV_AREA) continue;
+
+			// only the directions matter, the sign of the area keeps them pointing along +u and +v for mirrored uvs
+			float orientation = area > 0.0f ? 1.0f : -1.0f;
+			glm::vec3 faceTangent = (edge1 * uv2.y - edge2 * uv1.y) * orientation;
+			glm::vec3 faceBitangent = (edge2 * uv1.x - edge1 * uv2.x) * orientation;
+
+			for (int i = 0; i < 3; i++)
+			{
+				glm::vec3 normal = load3(normals, normalStride, corner[i]);
+				glm::vec3 tangent = faceTangent - normal * glm::dot(normal, faceTangent);
+				float length = glm::length(tangent);
+				if (length <= 0.0f) continue;
+				tangent /= length;
+
+				float weight = cornerAngle(p[i], p[(i + 1) % 3], p[(i + 2) % 3]);
+				float handedness = glm::dot(glm::cross(normal, tangent), faceBitangent) < 0.0f ? -1.0f : 1.0f;
+				corners[triangle * 3 + i] = glm::vec4(tangent * weight, weight * handedness);
+			}
+		}
+	});
+
+	// corners of every vertex, counting sort into one array so the second pass only reads
+	vector<uint32_t> firstCorner(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++) firstCorner[indices[i] + 1]++;
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) firstCorner[vertex + 1] += firstCorner[vertex];
+
+	vector<uint32_t> vertexCorners(triangleCount * 3);
+	{
+		vector<uint32_t> cursor(firstCorner.begin(), firstCorner.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++) vertexCorners[cursor[indices[i]]++] = static_cast<uint32_t>(i);
+	}
+
+	forRanges(pool, vertexCount, [&](size_t first, size_t last) {
+		for (size_t vertex = first; vertex < last; vertex++)
+		{
+			glm::vec3 sums[2] = { glm::vec3(0.0f), glm::vec3(0.0f) }; // right handed, mirrored
+			float weights[2] = { 0.0f, 0.0f };
+			for (uint32_t i = firstCorner[vertex]; i < firstCorner[vertex + 1]; i++)
+			{
+				const glm::vec4 & corner = corners[vertexCorners[i]];
+				int side = corner.w < 0.0f ? 1 : 0;
+				sums[side] += glm::vec3(corner);
+				weights[side] += std::fabs(corner.w);
+			}
+
+			int side = weights[1] > weights[0] ? 1 : 0;
+			glm::vec3 tangent = sums[side];
+			float length = glm::length(tangent);
+			if (length > 0.0f) tangent /= length;
+			else {
+				// no uv area around this vertex, or the corner tangents cancelled out
+				glm::vec3 normal = load3(normals, normalStride, vertex);
+				tangent = glm::length(normal) > 0.0f ? perpendicular(glm::normalize(normal)) : glm::vec3(1.0f, 0.0f, 0.0f);
+			}
+
+			float * target = &tangents[vertex * 4];
+			target[0] = tangent.x;
+			target[1] = tangent.y;
+			target[2] = tangent.z;
+			target[3] = side == 1 ? -1.0f : 1.0f;
+		}
+	});
+}
+
+// quaternion (xyzw) of the rotation with columns x, y and z (Shepperd's method, branch on the largest component)
+static glm::vec4 rotationToQuaternion(const glm::vec3 & x, const glm::vec3 & y, const glm::vec3 & z)
+{
+	float trace = x.x + y.y + z.z;
+	glm::vec4 q;
+	if (trace > 0.0f) {
+		float s = std::sqrt(trace + 1.0f) * 2.0f;
+		q = glm::vec4(y.z - z.y, z.x - x.z, x.y - y.x, s * s * 0.25f) / s;
+	}
+	else if (x.x > y.y && x.x > z.z) {
+		float s = std::sqrt(1.0f + x.x - y.y - z.z) * 2.0f;
+		q = glm::vec4(s * s * 0.25f, y.x + x.y, z.x + x.z, y.z - z.y) / s;
+	}
+	else if (y.y > z.z) {
+		float s = std::sqrt(1.0f + y.y - x.x - z.z) * 2.0f;
+		q = glm::vec4(y.x + x.y, s * s * 0.25f, z.y + y.z, z.x - x.z) / s;
+	}
+	else {
+		float s = std::sqrt(1.0f + z.z - x.x - y.y) * 2.0f;
+		q = glm::vec4(z.x + x.z, z.y + y.z, s * s * 0.25f, x.y - y.x) / s;
+	}
+	return glm::normalize(q);
+}
+
+static int16_t toSnorm16(float value)
+{
+	return int16_t(std::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+void encodeQTangent(const float normal[3], const float tangent[4], int16_t encoded[4])
+{
+	glm::vec3 n(normal[0], normal[1], normal[2]);
+	glm::vec3 t(tangent[0], tangent[1], tangent[2]);
+	if (glm::length(n) <= 0.0f) {
+		// meshes without normals are zero filled, the identity is as good as anything
+		encoded[0] = encoded[1] = encoded[2] = 0;
+		encoded[3] = 32767;
+		return;
+	}
+
+	// the rotation only holds an orthonormal frame, so tangent is made exactly perpendicular first
+	n = glm::normalize(n);
+	t -= n * glm::dot(n, t);
+	t = glm::length(t) > 0.0f ? glm::normalize(t) : perpendicular(n);
+	glm::vec3 b = glm::cross(n, t);
+
+	glm::vec4 q = rotationToQuaternion(t, b, n);
+	if (q.w < 0.0f) q = -q;
+
+	// w has to survive the rounding to tell the handedness apart, the smallest snorm16 step is enough
+	const float bias = 1.0f / 32767.0f;
+	if (q.w < bias) {
+		float scale = std::sqrt(1.0f - bias * bias) / std::max(glm::length(glm::vec3(q.x, q.y, q.z)), 1e-20f);
+		q = glm::vec4(q.x * scale, q.y * scale, q.z * scale, bias);
+	}
+
+	if (tangent[3] < 0.0f) q = -q;
+
+	encoded[0] = toSnorm16(q.x);
+	encoded[1] = toSnorm16(q.y);
+	encoded[2] = toSnorm16(q.z);
+	encoded[3] = toSnorm16(q.w);
+}
+
+void decodeQTangent(const int16_t encoded[4], float normal[3], float tangent[4])
+{
+	// the same steps as decodeTangentFrame in the vertex shader
+	glm::vec4 q;
+	for (int i = 0; i < 4; i++) q[i] = std::max(encoded[i] / 32767.0f, -1.0f);
+	float sign = q.w < 0.0f ? -1.0f : 1.0f;
+	q = glm::normalize(q);
+
+	glm::vec3 t(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y));
+	glm::vec3 n(2.0f * (q.x * q.z + q.w * q.y), 2.0f * (q.y * q.z - q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+
+	normal[0] = n.x;
+	normal[1] = n.y;
+	normal[2] = n.z;
+	tangent[0] = t.x;
+	tangent[1] = t.y;
+	tangent[2] = t.z;
+	tangent[3] = sign;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+/*Per vertex tangent frames for normal mapping, generated at bake time.
+
+Follows the MikkTSpace recipe closely enough that normal maps baked against it shade without seams:
+
+	1. every triangle gets the direction of increasing u (tangent) and v (bitangent) from its uv derivatives
+	2. at every corner that tangent is projected into the plane of the corner's vertex normal and weighted by the
+	   corner angle, so a vertex is not pulled towards whichever side happens to be cut into more triangles
+	3. the corners of a vertex are summed and normalized. The handedness (is the uv map mirrored here) is the sign of
+	   the bitangent against cross(normal, tangent), the angle weighted majority wins.
+
+Mikk splits a vertex whose corners disagree on handedness. The meshes here are welded on position, normal and uv, so
+a mirrored seam already has two vertices (different uvs) and the split would almost never happen, it is skipped to
+keep the vertex count the index buffer was optimized for. Triangles without uv area add nothing, and a vertex left
+with no tangent at all gets an arbitrary one perpendicular to its normal.
+
+Both passes, over triangles and then over vertices, split their work over the pool.
+
+The frame is stored as a QTangent (Frey 2011): the rotation taking tangent, bitangent and normal to the axes, as a
+quaternion of four snorm16. The quaternion is kept with w >= 1/32767 so its sign never rounds away, and the whole
+quaternion is negated for a mirrored frame (q and -q are the same rotation), leaving the handedness in the sign of w.
+That is 8 bytes for what takes 28 as float normal and tangent, and the vertex shader rebuilds all three vectors with
+a handful of multiply adds (see decodeTangentFrame in VertexFormat).*/
+
+// tangents gets xyz and the bitangent sign in w for every vertex: bitangent = w * cross(normal, tangent).
+// Positions and normals are float3, uvs float2, the strides are in bytes so interleaved and planar arrays both work.
+void generateTangents(float * tangents, const uint32_t * indices, size_t indexCount,
+	const float * positions, size_t positionStride, const float * normals, size_t normalStride,
+	const float * uvs, size_t uvStride, size_t vertexCount, ThreadPool * pool = nullptr);
+
+// normal and tangent (xyz and sign, as generateTangents writes it) to the snorm16 quaternion
+void encodeQTangent(const float normal[3], const float tangent[4], int16_t encoded[4]);
+
+// the reverse, for checking the error of the encoding on the CPU
+void decodeQTangent(const int16_t encoded[4], float normal[3], float tangent[4]);
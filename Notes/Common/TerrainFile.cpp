@@ -0,0 +1,355 @@
+#include "TerrainFile.h"
+#include "Noise.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <emmintrin.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+// rows per job when building the pyramid
+static const uint32_t DOWNSAMPLE_ROWS = 64;
+
+static uint64_t alignPage(uint64_t offset)
+{
+	return (offset + TERRAIN_FILE_PAGE - 1) & ~uint64_t(TERRAIN_FILE_PAGE - 1);
+}
+
+static size_t sampleBytes(TerrainFileFormat format)
+{
+	return format == TERRAIN_FILE_UINT16 ? sizeof(uint16_t) : sizeof(float);
+}
+
+static uint16_t quantize(float height, float offset, float inverseScale)
+{
+	float value = std::min(std::max((height - offset) * inverseScale, 0.0f), 65535.0f);
+	return static_cast<uint16_t>(std::lrint(value));
+}
+
+// count samples of a tile row, starting at sample start of the tile
+static void decodeRow(const TerrainFileHeader & header, const void * tile, size_t start, uint32_t count, float * destination)
+{
+	if (header.format == TERRAIN_FILE_FLOAT) {
+		memcpy(destination, static_cast<const float*>(tile) + start, sizeof(float) * count);
+		return;
+	}
+
+	const uint16_t * values = static_cast<const uint16_t*>(tile) + start;
+	float offset = header.heightOffset, scale = header.heightScale;
+	__m128 offsets = _mm_set1_ps(offset), scales = _mm_set1_ps(scale);
+	__m128i zero = _mm_setzero_si128();
+
+	// 8 values per load, widened to two sets of 4 floats, same operations as the tail so every sample decodes alike
+	uint32_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+		__m128 low = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+		__m128 high = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+		_mm_storeu_ps(destination + i, _mm_add_ps(offsets, _mm_mul_ps(low, scales)));
+		_mm_storeu_ps(destination + i + 4, _mm_add_ps(offsets, _mm_mul_ps(high, scales)));
+	}
+
+	for (; i < count; i++) destination[i] = offset + values[i] * scale;
+}
+
+// 2 x 2 box filter, the last row or column of an odd sized level is repeated
+static void downsample(const float * source, uint32_t sourceWidth, uint32_t sourceDepth, vector<float> & destination,
+	uint32_t width, uint32_t depth, ThreadPool * pool)
+{
+	destination.resize(size_t(width) * depth);
+	size_t jobs = (depth + DOWNSAMPLE_ROWS - 1) / DOWNSAMPLE_ROWS;
+	ThreadPool::forEach(pool, jobs, [&](size_t job) {
+		uint32_t z0 = static_cast<uint32_t>(job) * DOWNSAMPLE_ROWS;
+		uint32_t z1 = std::min(z0 + DOWNSAMPLE_ROWS, depth);
+		for (uint32_t z = z0; z < z1; z++)
+		{
+			const float * row0 = source + size_t(2 * z) * sourceWidth;
+			const float * row1 = source + size_t(std::min(2 * z + 1, sourceDepth - 1)) * sourceWidth;
+			float * row = destination.data() + size_t(z) * width;
+			for (uint32_t x = 0; x < width; x++)
+			{
+				uint32_t x0 = 2 * x, x1 = std::min(2 * x + 1, sourceWidth - 1);
+				row[x] = (row0[x0] + row0[x1] + row1[x0] + row1[x1]) * 0.25f;
+			}
+		}
+	});
+}
+
+bool bakeTerrainFile(const char * path, const float * heights, uint32_t width, uint32_t depth, uint64_t sourceKey,
+	const TerrainFileOptions & options, ThreadPool * pool)
+{
+	uint32_t tileSize = options.tileSize;
+	if (width == 0 || depth == 0 || tileSize < 64 || (tileSize & (tileSize - 1)) != 0) {
+		std::cout << "Baking " << path << " failed: " << width << " x " << depth << " samples in tiles of " << tileSize << std::endl;
+		return false;
+	}
+
+	vector<TerrainFileLevel> levels;
+	uint32_t tileCount = 0;
+	for (uint32_t levelWidth = width, levelDepth = depth;; levelWidth = (levelWidth + 1) / 2, levelDepth = (levelDepth + 1) / 2)
+	{
+		TerrainFileLevel level = {};
+		level.width = levelWidth;
+		level.depth = levelDepth;
+		level.tilesX = (levelWidth + tileSize - 1) / tileSize;
+		level.tilesZ = (levelDepth + tileSize - 1) / tileSize;
+		level.firstTile = tileCount;
+		levels.push_back(level);
+		tileCount += level.tilesX * level.tilesZ;
+		if (level.tilesX == 1 && level.tilesZ == 1) break;
+	}
+
+	// level 0 is the input itself, the pyramid is built below it in full before anything is written
+	vector<vector<float>> pyramid(levels.size());
+	vector<const float*> levelHeights(levels.size());
+	levelHeights[0] = heights;
+	for (size_t level = 1; level < levels.size(); level++)
+	{
+		downsample(levelHeights[level - 1], levels[level - 1].width, levels[level - 1].depth, pyramid[level],
+			levels[level].width, levels[level].depth, pool);
+		levelHeights[level] = pyramid[level].data();
+	}
+
+	// min / max of the level 0 tiles from the samples, every level above from the tiles under it
+	const TerrainFileLevel & base = levels[0];
+	vector<TerrainFileTile> tiles(tileCount);
+	ThreadPool::forEach(pool, size_t(base.tilesX) * base.tilesZ, [&](size_t index) {
+		uint32_t x0 = static_cast<uint32_t>(index % base.tilesX) * tileSize;
+		uint32_t z0 = static_cast<uint32_t>(index / base.tilesX) * tileSize;
+		uint32_t x1 = std::min(x0 + tileSize, width), z1 = std::min(z0 + tileSize, depth);
+		float low = FLT_MAX, high = -FLT_MAX;
+		for (uint32_t z = z0; z < z1; z++)
+		{
+			const float * row = heights + size_t(z) * width;
+			for (uint32_t x = x0; x < x1; x++)
+			{
+				low = std::min(low, row[x]);
+				high = std::max(high, row[x]);
+			}
+		}
+		tiles[index] = { low, high };
+	});
+
+	for (size_t level = 1; level < levels.size(); level++)
+	{
+		const TerrainFileLevel & below = levels[level - 1];
+		for (uint32_t tileZ = 0; tileZ < levels[level].tilesZ; tileZ++)
+		{
+			for (uint32_t tileX = 0; tileX < levels[level].tilesX; tileX++)
+			{
+				TerrainFileTile bounds = { FLT_MAX, -FLT_MAX };
+				for (uint32_t z = 2 * tileZ; z < std::min(2 * tileZ + 2, below.tilesZ); z++)
+				{
+					for (uint32_t x = 2 * tileX; x < std::min(2 * tileX + 2, below.tilesX); x++)
+					{
+						const TerrainFileTile & child = tiles[below.firstTile + z * below.tilesX + x];
+						bounds.minHeight = std::min(bounds.minHeight, child.minHeight);
+						bounds.maxHeight = std::max(bounds.maxHeight, child.maxHeight);
+					}
+				}
+				tiles[levels[level].firstTile + tileZ * levels[level].tilesX + tileX] = bounds;
+			}
+		}
+	}
+
+	TerrainFileHeader header = {};
+	header.magic = TERRAIN_FILE_MAGIC;
+	header.version = TERRAIN_FILE_VERSION;
+	header.sourceKey = sourceKey;
+	header.width = width;
+	header.depth = depth;
+	header.tileSize = tileSize;
+	header.format = options.format;
+	header.levelCount = static_cast<uint32_t>(levels.size());
+	header.tileCount = tileCount;
+	header.minHeight = tiles.back().minHeight;
+	header.maxHeight = tiles.back().maxHeight;
+	header.sampleSpacing = options.sampleSpacing;
+	header.heightOffset = 0.0f;
+	header.heightScale = 1.0f;
+
+	float inverseScale = 1.0f;
+	if (options.format == TERRAIN_FILE_UINT16) {
+		float low = options.minHeight, high = options.maxHeight;
+		if (low >= high) {
+			low = header.minHeight;
+			high = header.maxHeight;
+		}
+		header.heightOffset = low;
+		header.heightScale = high > low ? (high - low) / 65535.0f : 1.0f;
+		inverseScale = 1.0f / header.heightScale;
+
+		// rounding keeps the order of the heights, so the bounds of the stored values are the bounds rounded the same way
+		for (auto & tile : tiles)
+		{
+			tile.minHeight = header.heightOffset + quantize(tile.minHeight, header.heightOffset, inverseScale) * header.heightScale;
+			tile.maxHeight = header.heightOffset + quantize(tile.maxHeight, header.heightOffset, inverseScale) * header.heightScale;
+		}
+		header.minHeight = tiles.back().minHeight;
+		header.maxHeight = tiles.back().maxHeight;
+	}
+
+	size_t bytesPerSample = sampleBytes(options.format);
+	header.tileBytes = alignPage(uint64_t(tileSize) * tileSize * bytesPerSample);
+	header.tileTableOffset = sizeof(TerrainFileHeader) + sizeof(TerrainFileLevel) * levels.size();
+	header.dataOffset = alignPage(header.tileTableOffset + sizeof(TerrainFileTile) * tiles.size());
+
+	// write to a temporary name first so a crash mid bake never leaves a truncated file behind
+	std::string temporaryPath = std::string(path) + ".tmp";
+	{
+		std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) {
+			std::cout << "Could not write " << temporaryPath << std::endl;
+			return false;
+		}
+
+		output.write(reinterpret_cast<const char*>(&header), sizeof header);
+		output.write(reinterpret_cast<const char*>(levels.data()), sizeof(TerrainFileLevel) * levels.size());
+		output.write(reinterpret_cast<const char*>(tiles.data()), sizeof(TerrainFileTile) * tiles.size());
+		vector<char> padding(static_cast<size_t>(header.dataOffset - header.tileTableOffset - sizeof(TerrainFileTile) * tiles.size()));
+		output.write(padding.data(), padding.size());
+
+		// one row of tiles at a time, encoded in parallel
+		size_t tileBytes = static_cast<size_t>(header.tileBytes);
+		vector<uint8_t> tileRow;
+		for (size_t level = 0; level < levels.size(); level++)
+		{
+			const TerrainFileLevel & info = levels[level];
+			const float * source = levelHeights[level];
+			tileRow.assign(tileBytes * info.tilesX, 0);
+			for (uint32_t tileZ = 0; tileZ < info.tilesZ; tileZ++)
+			{
+				ThreadPool::forEach(pool, info.tilesX, [&](size_t tileX) {
+					uint8_t * tile = tileRow.data() + tileBytes * tileX;
+					for (uint32_t z = 0; z < tileSize; z++)
+					{
+						// padding repeats the last row and column
+						uint32_t sourceZ = std::min(tileZ * tileSize + z, info.depth - 1);
+						const float * row = source + size_t(sourceZ) * info.width;
+						for (uint32_t x = 0; x < tileSize; x++)
+						{
+							float height = row[std::min(static_cast<uint32_t>(tileX) * tileSize + x, info.width - 1)];
+							size_t sample = size_t(z) * tileSize + x;
+							if (options.format == TERRAIN_FILE_UINT16)
+								reinterpret_cast<uint16_t*>(tile)[sample] = quantize(height, header.heightOffset, inverseScale);
+							else reinterpret_cast<float*>(tile)[sample] = height;
+						}
+					}
+				});
+				output.write(reinterpret_cast<const char*>(tileRow.data()), tileRow.size());
+			}
+		}
+
+		if (!output.good()) {
+			std::cout << "Could not write " << temporaryPath << std::endl;
+			return false;
+		}
+	}
+
+	std::remove(path);
+	return std::rename(temporaryPath.c_str(), path) == 0;
+}
+
+bool openTerrainFile(const char * path, uint64_t sourceKey, TerrainFile & terrain)
+{
+	terrain.header = nullptr;
+	terrain.levels = nullptr;
+	terrain.tiles = nullptr;
+	if (!terrain.file.open(path, MAPPED_FILE_RANDOM)) return false;
+
+	auto header = reinterpret_cast<const TerrainFileHeader*>(terrain.file.data());
+	if (terrain.file.size() < sizeof(TerrainFileHeader)
+		|| header->magic != TERRAIN_FILE_MAGIC
+		|| header->version != TERRAIN_FILE_VERSION
+		|| header->sourceKey != sourceKey
+		|| header->levelCount == 0
+		|| header->tileSize == 0
+		|| header->format > TERRAIN_FILE_FLOAT
+		|| header->tileTableOffset < sizeof(TerrainFileHeader) + sizeof(TerrainFileLevel) * header->levelCount
+		|| header->tileTableOffset + sizeof(TerrainFileTile) * header->tileCount > header->dataOffset
+		|| header->dataOffset + header->tileBytes * header->tileCount > terrain.file.size()) {
+		terrain.file.close();
+		return false;
+	}
+
+	// the tables are all that is read, the tile data stays on disk until it is touched
+	auto levels = reinterpret_cast<const TerrainFileLevel*>(terrain.file.data() + sizeof(TerrainFileHeader));
+	const TerrainFileLevel & last = levels[header->levelCount - 1];
+	if (last.firstTile + last.tilesX * last.tilesZ != header->tileCount) {
+		terrain.file.close();
+		return false;
+	}
+
+	terrain.header = header;
+	terrain.levels = levels;
+	terrain.tiles = reinterpret_cast<const TerrainFileTile*>(terrain.file.data() + header->tileTableOffset);
+	return true;
+}
+
+void TerrainFile::prefetchTile(uint32_t level, uint32_t tileX, uint32_t tileZ) const
+{
+	file.prefetch(static_cast<size_t>(header->dataOffset + header->tileBytes * tileIndex(level, tileX, tileZ)),
+		static_cast<size_t>(header->tileBytes));
+}
+
+void TerrainFile::readTile(uint32_t level, uint32_t tileX, uint32_t tileZ, float * destination) const
+{
+	decodeRow(*header, tileData(level, tileX, tileZ), 0, header->tileSize * header->tileSize, destination);
+}
+
+void TerrainFile::readRegion(uint32_t level, uint32_t x, uint32_t z, uint32_t width, uint32_t depth, float * destination,
+	size_t rowPitch, ThreadPool * pool) const
+{
+	if (width == 0 || depth == 0) return;
+
+	uint32_t size = header->tileSize;
+	uint32_t firstX = x / size, lastX = (x + width - 1) / size;
+	uint32_t firstZ = z / size, lastZ = (z + depth - 1) / size;
+	uint32_t columns = lastX - firstX + 1;
+
+	// every tile the region touches fills its own rectangle of the destination
+	ThreadPool::forEach(pool, size_t(columns) * (lastZ - firstZ + 1), [&](size_t index) {
+		uint32_t tileX = firstX + static_cast<uint32_t>(index % columns);
+		uint32_t tileZ = firstZ + static_cast<uint32_t>(index / columns);
+		uint32_t x0 = std::max(x, tileX * size), x1 = std::min(x + width, (tileX + 1) * size);
+		uint32_t z0 = std::max(z, tileZ * size), z1 = std::min(z + depth, (tileZ + 1) * size);
+
+		const void * tile = tileData(level, tileX, tileZ);
+		for (uint32_t row = z0; row < z1; row++)
+		{
+			size_t start = size_t(row - tileZ * size) * size + (x0 - tileX * size);
+			decodeRow(*header, tile, start, x1 - x0, destination + (row - z) * rowPitch + (x0 - x));
+		}
+	});
+}
+
+float TerrainFile::sample(uint32_t level, int x, int z) const
+{
+	const TerrainFileLevel & info = levels[level];
+	uint32_t sampleX = static_cast<uint32_t>(std::min(std::max(x, 0), int(info.width) - 1));
+	uint32_t sampleZ = static_cast<uint32_t>(std::min(std::max(z, 0), int(info.depth) - 1));
+
+	uint32_t size = header->tileSize;
+	float height;
+	decodeRow(*header, tileData(level, sampleX / size, sampleZ / size), size_t(sampleZ % size) * size + sampleX % size, 1, &height);
+	return height;
+}
+
+uint64_t terrainNoiseKey(uint32_t width, uint32_t depth, const NoiseOptions & noise, std::initializer_list<float> parameters)
+{
+	// over the fields one by one so padding never gets in
+	uint32_t fields[] = { width, depth, uint32_t(noise.basis), uint32_t(noise.fractal), uint32_t(noise.octaves), noise.seed };
+	float scales[] = { noise.frequency, noise.lacunarity, noise.gain };
+	uint64_t hash = hashBytes(fields, sizeof fields);
+	hash = hashBytes(scales, sizeof scales, hash);
+	for (float parameter : parameters) hash = hashBytes(&parameter, sizeof parameter, hash);
+	return hash;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include "MappedFile.h"
+
+/*Tiled heightmap pyramid format (.rwterrain)
+
+The terrain demos used to generate their heightmap on every launch and the only thing they kept was an 8 bit BMP
+nobody read back. A terrain file holds the heights at 16 bit or float precision, cut into fixed size square tiles, with
+a mip pyramid and the min / max height under every tile:
+
+	TerrainFileHeader
+	TerrainFileLevel[levelCount]
+	TerrainFileTile[tileCount]   min / max per tile, every level after the other
+	tile data                    from dataOffset, level 0 first, tiles row by row, tileBytes each
+
+Every tile starts on a TERRAIN_FILE_PAGE boundary and takes whole pages, so reading one tile never pages in part of
+another. Tiles along the right and bottom edge are padded by repeating the last sample. Level L + 1 is the 2 x 2 box
+filter of level L, rounded up in size, down to the first level that fits a single tile. A tile of level L covers the
+2 x 2 tiles of level L - 1 under it, and its min / max is taken over theirs, so it bounds every full resolution sample
+it covers and not only its own filtered ones (what culling and ray marching against the pyramid need).
+
+16 bit heights are heightOffset + value * heightScale, float tiles hold the heights as they are.
+
+openTerrainFile maps the file for random access and only checks the tables, so opening takes the same time whatever
+the size of the heightfield. Tile pages are read when they are first touched, or ahead of time with prefetchTile.
+A 32 bit build can only map files that fit its address space.*/
+
+const uint32_t TERRAIN_FILE_MAGIC = 0x52545752; // "RWTR"
+const uint32_t TERRAIN_FILE_VERSION = 1;
+const uint32_t TERRAIN_FILE_PAGE = 4096;
+
+enum TerrainFileFormat
+{
+	TERRAIN_FILE_UINT16,
+	TERRAIN_FILE_FLOAT,
+};
+
+struct TerrainFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceKey; // whatever identifies what the heights were made from, see openTerrainFile
+
+	uint32_t width; // samples of level 0
+	uint32_t depth;
+	uint32_t tileSize; // samples along a tile side, a power of two of at least 64
+	uint32_t format; // TerrainFileFormat
+	uint32_t levelCount;
+	uint32_t tileCount; // over every level
+
+	float heightOffset; // 16 bit decoding, 0 and 1 for float tiles
+	float heightScale;
+	float minHeight; // over the whole heightfield
+	float maxHeight;
+	float sampleSpacing; // world units between samples of level 0
+	uint32_t reserved;
+
+	uint64_t tileTableOffset; // from the start of the file
+	uint64_t dataOffset;
+	uint64_t tileBytes;
+};
+
+struct TerrainFileLevel
+{
+	uint32_t width;
+	uint32_t depth;
+	uint32_t tilesX;
+	uint32_t tilesZ;
+	uint32_t firstTile; // index into the tile table and the tile data
+	uint32_t reserved;
+};
+
+struct TerrainFileTile
+{
+	float minHeight;
+	float maxHeight;
+};
+
+class ThreadPool;
+
+struct TerrainFile
+{
+	MappedFile file;
+	const TerrainFileHeader * header = nullptr;
+	const TerrainFileLevel * levels = nullptr;
+	const TerrainFileTile * tiles = nullptr;
+
+	TerrainFileFormat format() const { return static_cast<TerrainFileFormat>(header->format); }
+	uint32_t tileSize() const { return header->tileSize; }
+	uint32_t levelCount() const { return header->levelCount; }
+	const TerrainFileLevel & level(uint32_t index) const { return levels[index]; }
+
+	uint32_t tileIndex(uint32_t level, uint32_t tileX, uint32_t tileZ) const { return levels[level].firstTile + tileZ * levels[level].tilesX + tileX; }
+	const TerrainFileTile & tile(uint32_t level, uint32_t tileX, uint32_t tileZ) const { return tiles[tileIndex(level, tileX, tileZ)]; }
+
+	// tileSize x tileSize samples in the stored format, touching them pages the tile in
+	const void * tileData(uint32_t level, uint32_t tileX, uint32_t tileZ) const
+	{
+		return file.data() + header->dataOffset + header->tileBytes * tileIndex(level, tileX, tileZ);
+	}
+
+	// asks the OS to start reading the tile, returns right away
+	void prefetchTile(uint32_t level, uint32_t tileX, uint32_t tileZ) const;
+
+	// decoded heights of one tile, padding included, tileSize x tileSize floats
+	void readTile(uint32_t level, uint32_t tileX, uint32_t tileZ, float * destination) const;
+
+	// decoded heights of any rectangle within the level, destination rowPitch is in floats. Spread over the pool by
+	// rows of tiles if given.
+	void readRegion(uint32_t level, uint32_t x, uint32_t z, uint32_t width, uint32_t depth, float * destination, size_t rowPitch,
+		ThreadPool * pool = nullptr) const;
+
+	// one decoded sample, coordinates are clamped to the level
+	float sample(uint32_t level, int x, int z) const;
+};
+
+struct TerrainFileOptions
+{
+	TerrainFileFormat format = TERRAIN_FILE_UINT16;
+	uint32_t tileSize = 256;
+	float sampleSpacing = 1.0f;
+
+	// the range 16 bit heights cover, taken from the heights when they are equal
+	float minHeight = 0.0f;
+	float maxHeight = 0.0f;
+};
+
+// Builds the pyramid from width x depth float heights (row by row) and writes the file. The levels are built and the
+// tiles encoded in parallel if a pool is given, one row of tiles is held in memory at a time for writing.
+bool bakeTerrainFile(const char * path, const float * heights, uint32_t width, uint32_t depth, uint64_t sourceKey,
+	const TerrainFileOptions & options = TerrainFileOptions(), ThreadPool * pool = nullptr);
+
+// Maps an existing file. Fails if it is missing, corrupt, from another version or was baked with a different sourceKey.
+bool openTerrainFile(const char * path, uint64_t sourceKey, TerrainFile & terrain);
+
+struct NoiseOptions;
+
+// A sourceKey for heights from generateNoise: the size, the options (all but the SIMD width, every instruction set gives
+// the same heights) and whatever else went into them, like the sample steps and the height scale.
+uint64_t terrainNoiseKey(uint32_t width, uint32_t depth, const NoiseOptions & noise, std::initializer_list<float> parameters);
@@ -0,0 +1,316 @@
+#include "TerrainLod.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cfloat>
+#include <xmmintrin.h>
+
+// planes of the clip volume in world space, normalized so distances are in world units
+static void extractPlanes(const glm::mat4 & viewProjection, glm::vec4 planes[6])
+{
+	glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+
+	for (int i = 0; i < 6; i++)
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+static int popCount4(int mask)
+{
+	return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+}
+
+TerrainLod::TerrainLod(const float * heights, uint32_t width, uint32_t depth, const TerrainLodSettings & settings, ThreadPool * pool)
+	: config(settings)
+{
+	// even, so the grid splits into quadrants and odd vertices have an even neighbour to morph onto, and small enough
+	// for 16 bit indices
+	uint32_t resolution = 2;
+	while (resolution * 2 <= std::min(config.gridResolution, 128u)) resolution *= 2;
+	config.gridResolution = resolution;
+	config.levels = std::max(1u, std::min(config.levels, TERRAIN_LOD_MAX_LEVELS));
+
+	cellsX = std::max(width, 2u) - 1;
+	cellsZ = std::max(depth, 2u) - 1;
+
+	// level L covers the band from range(L - 1) to range(L) and morphs into level L + 1 over the far end of it
+	float lower = 0.0f;
+	for (uint32_t level = 0; level < TERRAIN_LOD_MAX_LEVELS; level++)
+	{
+		ranges[level] = config.lodDistance * static_cast<float>(1u << level);
+		float start = lower + (ranges[level] - lower) * config.morphStart;
+		morphs[level] = glm::vec2(start, 1.0f / std::max(ranges[level] - start, 1e-4f));
+		lower = ranges[level];
+	}
+
+	levels.resize(config.levels);
+	for (uint32_t level = 0; level < config.levels; level++)
+	{
+		uint32_t nodeCells = resolution << level;
+		Level & current = levels[level];
+		current.nodesX = (cellsX + nodeCells - 1) / nodeCells;
+		current.nodesZ = (cellsZ + nodeCells - 1) / nodeCells;
+		current.minHeight.resize(size_t(current.nodesX) * current.nodesZ);
+		current.maxHeight.resize(current.minHeight.size());
+	}
+
+	// the leaves read the samples they span, edges included since the neighbours share them
+	Level & leaves = levels[0];
+	auto leafRow = [&](size_t row) {
+		uint32_t z = static_cast<uint32_t>(row);
+		uint32_t z0 = z * resolution, z1 = std::min(z0 + resolution, cellsZ);
+		for (uint32_t x = 0; x < leaves.nodesX; x++)
+		{
+			uint32_t x0 = x * resolution, x1 = std::min(x0 + resolution, cellsX);
+			float low = heights[size_t(z0) * width + x0], high = low;
+			for (uint32_t sz = z0; sz <= z1; sz++)
+			{
+				const float * sample = heights + size_t(sz) * width;
+				for (uint32_t sx = x0; sx <= x1; sx++)
+				{
+					low = std::min(low, sample[sx]);
+					high = std::max(high, sample[sx]);
+				}
+			}
+			leaves.minHeight[size_t(z) * leaves.nodesX + x] = low;
+			leaves.maxHeight[size_t(z) * leaves.nodesX + x] = high;
+		}
+	};
+	ThreadPool::forEach(pool, leaves.nodesZ, leafRow);
+
+	for (uint32_t level = 1; level < config.levels; level++)
+	{
+		const Level & children = levels[level - 1];
+		Level & parents = levels[level];
+		for (uint32_t z = 0; z < parents.nodesZ; z++)
+		{
+			for (uint32_t x = 0; x < parents.nodesX; x++)
+			{
+				float low = FLT_MAX, high = -FLT_MAX;
+				for (uint32_t child = 0; child < 4; child++)
+				{
+					uint32_t cx = x * 2 + (child & 1), cz = z * 2 + (child >> 1);
+					if (cx >= children.nodesX || cz >= children.nodesZ) continue;
+					low = std::min(low, children.minHeight[size_t(cz) * children.nodesX + cx]);
+					high = std::max(high, children.maxHeight[size_t(cz) * children.nodesX + cx]);
+				}
+				parents.minHeight[size_t(z) * parents.nodesX + x] = low;
+				parents.maxHeight[size_t(z) * parents.nodesX + x] = high;
+			}
+		}
+	}
+
+	uint32_t side = resolution + 1;
+	vertices.resize(size_t(side) * side);
+	for (uint32_t z = 0; z < side; z++)
+		for (uint32_t x = 0; x < side; x++)
+			vertices[size_t(z) * side + x] = glm::vec2(static_cast<float>(x), static_cast<float>(z));
+
+	// quadrant by quadrant, so a node can draw any one of them on its own
+	uint32_t half = resolution / 2;
+	quadrantIndices = half * half * 6;
+	indices.reserve(quadrantIndices * 4);
+	for (uint32_t quadrant = 0; quadrant < 4; quadrant++)
+	{
+		uint32_t x0 = (quadrant & 1) * half, z0 = (quadrant >> 1) * half;
+		for (uint32_t z = z0; z < z0 + half; z++)
+		{
+			for (uint32_t x = x0; x < x0 + half; x++)
+			{
+				uint16_t v00 = static_cast<uint16_t>(z * side + x);
+				uint16_t v01 = static_cast<uint16_t>(v00 + 1);
+				uint16_t v10 = static_cast<uint16_t>(v00 + side);
+				uint16_t v11 = static_cast<uint16_t>(v10 + 1);
+
+				// counter clockwise seen from above
+				indices.push_back(v00);
+				indices.push_back(v10);
+				indices.push_back(v01);
+				indices.push_back(v01);
+				indices.push_back(v10);
+				indices.push_back(v11);
+			}
+		}
+	}
+}
+
+size_t TerrainLod::nodeCount() const
+{
+	size_t count = 0;
+	for (auto & level : levels) count += size_t(level.nodesX) * level.nodesZ;
+	return count;
+}
+
+int TerrainLod::classify(uint32_t level, const uint32_t * x, const uint32_t * z, int valid, float range, const glm::vec4 * planes,
+	const glm::vec3 & eye, bool culling, int & visible) const
+{
+	const Level & nodes = levels[level];
+	float nodeSize = static_cast<float>(config.gridResolution << level) * config.sampleSpacing;
+	float endX = cellsX * config.sampleSpacing, endZ = cellsZ * config.sampleSpacing;
+
+	// boxes into lanes, the invalid lanes read node 0 and are masked out at the end
+	alignas(16) float minX[4], maxX[4], minY[4], maxY[4], minZ[4], maxZ[4];
+	for (int lane = 0; lane < 4; lane++)
+	{
+		uint32_t nx = (valid & (1 << lane)) ? x[lane] : 0;
+		uint32_t nz = (valid & (1 << lane)) ? z[lane] : 0;
+		size_t node = size_t(nz) * nodes.nodesX + nx;
+		minX[lane] = nx * nodeSize;
+		maxX[lane] = std::min(minX[lane] + nodeSize, endX);
+		minZ[lane] = nz * nodeSize;
+		maxZ[lane] = std::min(minZ[lane] + nodeSize, endZ);
+		minY[lane] = nodes.minHeight[node];
+		maxY[lane] = nodes.maxHeight[node];
+	}
+	__m128 boxMinX = _mm_load_ps(minX), boxMaxX = _mm_load_ps(maxX);
+	__m128 boxMinY = _mm_load_ps(minY), boxMaxY = _mm_load_ps(maxY);
+	__m128 boxMinZ = _mm_load_ps(minZ), boxMaxZ = _mm_load_ps(maxZ);
+
+	// squared distance from the eye to the closest point of each box
+	__m128 zero = _mm_setzero_ps();
+	__m128 eyeX = _mm_set1_ps(eye.x), eyeY = _mm_set1_ps(eye.y), eyeZ = _mm_set1_ps(eye.z);
+	__m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(boxMinX, eyeX), _mm_sub_ps(eyeX, boxMaxX)), zero);
+	__m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(boxMinY, eyeY), _mm_sub_ps(eyeY, boxMaxY)), zero);
+	__m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(boxMinZ, eyeZ), _mm_sub_ps(eyeZ, boxMaxZ)), zero);
+	__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+	int inRange = _mm_movemask_ps(_mm_cmple_ps(distance, _mm_set1_ps(range * range))) & valid;
+
+	if (!culling) {
+		visible = valid;
+		return inRange;
+	}
+
+	// a box is outside when the corner furthest along a plane's normal is still behind it
+	__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	for (int p = 0; p < 6; p++)
+	{
+		__m128 px = planes[p].x > 0.0f ? boxMaxX : boxMinX;
+		__m128 py = planes[p].y > 0.0f ? boxMaxY : boxMinY;
+		__m128 pz = planes[p].z > 0.0f ? boxMaxZ : boxMinZ;
+		__m128 side = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), px), _mm_mul_ps(_mm_set1_ps(planes[p].y), py)),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].z), pz), _mm_set1_ps(planes[p].w)));
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(side, zero));
+	}
+	visible = _mm_movemask_ps(inside) & valid;
+	return inRange;
+}
+
+void TerrainLod::emit(uint32_t level, uint32_t x, uint32_t z, uint32_t part, TerrainLodSelection & selection) const
+{
+	float nodeSize = static_cast<float>(config.gridResolution << level) * config.sampleSpacing;
+	selection.selected.push_back({ x * nodeSize, z * nodeSize, nodeSize, static_cast<float>(level) });
+	selection.buckets.push_back(static_cast<uint8_t>(level * TERRAIN_LOD_PARTS + part));
+}
+
+void TerrainLod::selectNode(uint32_t level, uint32_t x, uint32_t z, const glm::vec4 * planes, const glm::vec3 & eye, bool culling,
+	TerrainLodSelection & selection) const
+{
+	// in range of its own level and visible, both checked by the caller
+	if (level == 0) {
+		emit(level, x, z, 0, selection);
+		return;
+	}
+
+	const Level & children = levels[level - 1];
+	uint32_t childX[4], childZ[4];
+	int valid = 0;
+	for (int child = 0; child < 4; child++)
+	{
+		childX[child] = x * 2 + (child & 1);
+		childZ[child] = z * 2 + (child >> 1);
+		if (childX[child] < children.nodesX && childZ[child] < children.nodesZ) valid |= 1 << child;
+	}
+
+	int visible;
+	int inRange = classify(level - 1, childX, childZ, valid, ranges[level - 1], planes, eye, culling, visible);
+	selection.visited += popCount4(valid);
+
+	// nothing close enough for the finer level: the whole node at this one
+	if (valid == 0xf && inRange == 0) {
+		emit(level, x, z, 0, selection);
+		return;
+	}
+
+	for (int child = 0; child < 4; child++)
+	{
+		if (!(valid & (1 << child))) continue;
+		if (!(visible & (1 << child))) {
+			selection.culled++;
+			continue;
+		}
+
+		if (inRange & (1 << child)) selectNode(level - 1, childX[child], childZ[child], planes, eye, culling, selection);
+		else emit(level, x, z, 1 + child, selection);
+	}
+}
+
+void TerrainLod::select(const glm::mat4 & viewProjection, const glm::vec3 & eye, TerrainLodSelection & selection, bool culling) const
+{
+	Timer timer;
+	selection.selected.clear();
+	selection.buckets.clear();
+	selection.visited = 0;
+	selection.culled = 0;
+
+	glm::vec4 planes[6];
+	extractPlanes(viewProjection, planes);
+
+	// the roots four at a time, those beyond the top range are past the view distance
+	uint32_t top = config.levels - 1;
+	const Level & roots = levels[top];
+	size_t rootCount = size_t(roots.nodesX) * roots.nodesZ;
+	for (size_t first = 0; first < rootCount; first += 4)
+	{
+		uint32_t x[4], z[4];
+		int valid = 0;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			size_t root = first + lane;
+			x[lane] = static_cast<uint32_t>(root % roots.nodesX);
+			z[lane] = static_cast<uint32_t>(root / roots.nodesX);
+			if (root < rootCount) valid |= 1 << lane;
+		}
+
+		int visible;
+		int inRange = classify(top, x, z, valid, ranges[top], planes, eye, culling, visible);
+		selection.visited += popCount4(valid);
+		selection.culled += popCount4(inRange & ~visible);
+
+		for (int lane = 0; lane < 4; lane++)
+			if (inRange & visible & (1 << lane)) selectNode(top, x[lane], z[lane], planes, eye, culling, selection);
+	}
+
+	// counting sort into the buckets, each bucket is one instanced draw
+	uint32_t bucketCount[TERRAIN_LOD_MAX_LEVELS * TERRAIN_LOD_PARTS] = {};
+	for (auto bucket : selection.buckets) bucketCount[bucket]++;
+
+	uint32_t offset = 0;
+	uint32_t cursor[TERRAIN_LOD_MAX_LEVELS * TERRAIN_LOD_PARTS];
+	selection.triangles = 0;
+	for (uint32_t level = 0; level < TERRAIN_LOD_MAX_LEVELS; level++)
+	{
+		for (uint32_t part = 0; part < TERRAIN_LOD_PARTS; part++)
+		{
+			uint32_t bucket = level * TERRAIN_LOD_PARTS + part;
+			selection.first[level][part] = cursor[bucket] = offset;
+			selection.count[level][part] = bucketCount[bucket];
+			offset += bucketCount[bucket];
+			selection.triangles += uint64_t(bucketCount[bucket]) * (partIndexCount(part) / 3);
+		}
+	}
+
+	selection.nodes.resize(selection.selected.size());
+	for (size_t i = 0; i < selection.selected.size(); i++)
+		selection.nodes[cursor[selection.buckets[i]]++] = selection.selected[i];
+
+	selection.milliseconds = timer.elapsedMilliseconds();
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm\glm.hpp>
+
+class ThreadPool;
+
+/*Continuous distance dependent level of detail (CDLOD) for a heightmap terrain.
+
+The heightmap is covered by a quadtree. A node at level L spans gridResolution << L cells, and every node, whatever its
+level, is drawn with the same gridResolution x gridResolution grid mesh, scaled to the node and displaced by sampling
+the heightmap in the vertex shader. Level L is used out to range(L) from the eye, every range twice the one below, so
+the number of nodes (and triangles) on screen depends on the view distance and the ranges, not on how large the
+terrain is.
+
+select() walks the tree from the roots down. A node within the range of its own level that has children within the
+next lower range is split, quadrants whose child is out of that range are drawn by the node itself with a quarter of
+the grid's indices (the grid's index buffer is ordered by quadrant for that). The four children of a node are tested
+together, one SSE lane each: their boxes (min/max heights per node are built once up front) against the lower range
+sphere and against the six frustum planes.
+
+Towards the end of its range every level morphs into the next coarser one: odd grid vertices slide onto their even
+neighbours, so at the edge of the range a node has exactly the shape of its parent and there are no cracks or pops
+between levels. The shader gets the morph start and end of every level from morphRanges().
+
+The selected nodes come out as instance data grouped into one bucket per level and part (whole node or one quadrant),
+each bucket is one glDrawElementsInstancedBaseInstance of the grid (see partIndexOffset / partIndexCount).*/
+
+const uint32_t TERRAIN_LOD_MAX_LEVELS = 12;
+
+// whole node, then its four quadrants: -x -z, +x -z, -x +z, +x +z
+const uint32_t TERRAIN_LOD_PARTS = 5;
+
+struct TerrainLodSettings
+{
+	uint32_t gridResolution = 32; // quads along a side of the shared grid, a power of two
+	uint32_t levels = 6;
+	float sampleSpacing = 1.0f; // world units between heightmap samples
+	float lodDistance = 96.0f; // range of level 0 in world units, every level doubles it
+	float morphStart = 0.7f; // where in its band between the lower and its own range a level starts to morph
+};
+
+// one instance, per instance vertex attribute (divisor 1)
+struct TerrainLodNode
+{
+	float x, z; // world space corner with the smallest coordinates
+	float size; // world units along a side
+	float level;
+};
+
+struct TerrainLodSelection
+{
+	std::vector<TerrainLodNode> nodes; // grouped by level and part
+	uint32_t first[TERRAIN_LOD_MAX_LEVELS][TERRAIN_LOD_PARTS];
+	uint32_t count[TERRAIN_LOD_MAX_LEVELS][TERRAIN_LOD_PARTS];
+
+	uint64_t triangles = 0; // submitted by drawing every bucket
+	uint32_t visited = 0; // nodes tested
+	uint32_t culled = 0; // nodes (or quadrants) outside the frustum
+	double milliseconds = 0.0; // CPU time of the last select()
+
+	// scratch, kept so selecting every frame does not allocate
+	std::vector<TerrainLodNode> selected;
+	std::vector<uint8_t> buckets;
+};
+
+class TerrainLod
+{
+public:
+	// heights in world units, width x depth samples row by row. Builds the min/max tree, spread over the pool if given.
+	TerrainLod(const float * heights, uint32_t width, uint32_t depth, const TerrainLodSettings & settings = TerrainLodSettings(),
+		ThreadPool * pool = nullptr);
+
+	// Fills selection for the eye, with culling off every node in range is kept.
+	void select(const glm::mat4 & viewProjection, const glm::vec3 & eye, TerrainLodSelection & selection, bool culling = true) const;
+
+	const TerrainLodSettings & settings() const { return config; }
+	uint32_t levelCount() const { return config.levels; }
+	float range(uint32_t level) const { return ranges[level]; }
+	float viewDistance() const { return ranges[config.levels - 1]; }
+	glm::vec2 extent() const { return glm::vec2(cellsX * config.sampleSpacing, cellsZ * config.sampleSpacing); }
+
+	// per level: x = distance where the morph starts, y = 1 / (range - start)
+	const glm::vec2 * morphRanges() const { return morphs; }
+
+	// the shared grid: (gridResolution + 1)^2 vertices holding their grid coordinates 0 .. gridResolution, and 16 bit
+	// triangle list indices ordered by quadrant
+	const std::vector<glm::vec2> & gridVertices() const { return vertices; }
+	const std::vector<uint16_t> & gridIndices() const { return indices; }
+	uint32_t partIndexOffset(uint32_t part) const { return part == 0 ? 0 : (part - 1) * quadrantIndices; }
+	uint32_t partIndexCount(uint32_t part) const { return part == 0 ? 4 * quadrantIndices : quadrantIndices; }
+
+	// nodes in the tree, summed over every level
+	size_t nodeCount() const;
+
+private:
+	struct Level
+	{
+		uint32_t nodesX, nodesZ;
+		std::vector<float> minHeight, maxHeight;
+	};
+
+	void selectNode(uint32_t level, uint32_t x, uint32_t z, const glm::vec4 * planes, const glm::vec3 & eye, bool culling,
+		TerrainLodSelection & selection) const;
+	int classify(uint32_t level, const uint32_t * x, const uint32_t * z, int valid, float range, const glm::vec4 * planes,
+		const glm::vec3 & eye, bool culling, int & visible) const;
+	void emit(uint32_t level, uint32_t x, uint32_t z, uint32_t part, TerrainLodSelection & selection) const;
+
+	TerrainLodSettings config;
+	uint32_t cellsX, cellsZ;
+	float ranges[TERRAIN_LOD_MAX_LEVELS];
+	glm::vec2 morphs[TERRAIN_LOD_MAX_LEVELS];
+	std::vector<Level> levels;
+	std::vector<glm::vec2> vertices;
+	std::vector<uint16_t> indices;
+	uint32_t quadrantIndices;
+};
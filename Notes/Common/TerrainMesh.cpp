@@ -0,0 +1,123 @@
+#include "TerrainMesh.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+// rows per job, a 64 cell chunk is a couple of jobs and a 4k heightmap still spreads over every worker
+static const uint32_t TILE_ROWS = 32;
+
+static const float HEIGHT_SCALE = 32767.5f;
+static const float NORMAL_SCALE = 127.0f;
+
+uint32_t terrainStripIndexCount(uint32_t cells)
+{
+	return cells * 2 * (cells + 1) + (cells - 1);
+}
+
+void buildTerrainStrips(std::vector<uint16_t> & indices, uint32_t cells)
+{
+	uint32_t side = cells + 1;
+	indices.resize(terrainStripIndexCount(cells));
+
+	size_t k = 0;
+	for (uint32_t z = 0; z < cells; z++)
+	{
+		if (z > 0) indices[k++] = TERRAIN_RESTART_INDEX;
+
+		// (x, z) then (x, z + 1): the first triangle is v00 v10 v01, the second (odd, so flipped) v01 v10 v11
+		for (uint32_t x = 0; x < side; x++)
+		{
+			indices[k++] = static_cast<uint16_t>(z * side + x);
+			indices[k++] = static_cast<uint16_t>((z + 1) * side + x);
+		}
+	}
+}
+
+// The scalar version of one lane below, same operations in the same order. lrint rounds to nearest even like
+// _mm_cvtps_epi32 does under the default rounding mode.
+static TerrainMeshVertex encodeVertex(float height, float dx, float dz)
+{
+	float inverseLength = 1.0f / std::sqrt(dx * dx + dz * dz + 1.0f);
+	float encoded = std::min(std::max(height * HEIGHT_SCALE + HEIGHT_SCALE, 0.0f), 65535.0f);
+
+	TerrainMeshVertex vertex;
+	vertex.height = static_cast<uint16_t>(std::lrint(encoded));
+	vertex.normalX = static_cast<int8_t>(std::lrint(-dx * inverseLength * NORMAL_SCALE));
+	vertex.normalZ = static_cast<int8_t>(std::lrint(-dz * inverseLength * NORMAL_SCALE));
+	return vertex;
+}
+
+static void buildRows(TerrainMeshVertex * vertices, const float * heights, uint32_t width, uint32_t z0, uint32_t z1, float slopeScale)
+{
+	size_t pitch = size_t(width) + 2;
+	__m128 slopes = _mm_set1_ps(slopeScale);
+	__m128 heightScales = _mm_set1_ps(HEIGHT_SCALE);
+	__m128 normalScales = _mm_set1_ps(-NORMAL_SCALE);
+	__m128 ones = _mm_set1_ps(1.0f);
+	__m128 low = _mm_setzero_ps(), high = _mm_set1_ps(65535.0f);
+	__m128i byteMask = _mm_set1_epi32(0xff);
+
+	for (uint32_t z = z0; z < z1; z++)
+	{
+		const float * row = heights + (z + 1) * pitch + 1;
+		const float * above = row - pitch;
+		const float * below = row + pitch;
+		TerrainMeshVertex * destination = vertices + size_t(z) * width;
+
+		uint32_t x = 0;
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128 height = _mm_loadu_ps(row + x);
+			__m128 dx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(row + x + 1), _mm_loadu_ps(row + x - 1)), slopes);
+			__m128 dz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(below + x), _mm_loadu_ps(above + x)), slopes);
+
+			__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)), ones);
+			__m128 inverseLength = _mm_div_ps(ones, _mm_sqrt_ps(lengthSquared));
+			__m128 encoded = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(height, heightScales), heightScales), low), high);
+
+			// -dx * inverseLength * 127 with the sign folded into the scale, which leaves the product bit identical
+			__m128i heightBits = _mm_cvtps_epi32(encoded);
+			__m128i normalX = _mm_cvtps_epi32(_mm_mul_ps(_mm_mul_ps(dx, inverseLength), normalScales));
+			__m128i normalZ = _mm_cvtps_epi32(_mm_mul_ps(_mm_mul_ps(dz, inverseLength), normalScales));
+
+			// one 32 bit word per vertex: height in the low half, then the two normal bytes
+			__m128i packed = _mm_or_si128(heightBits, _mm_slli_epi32(_mm_and_si128(normalX, byteMask), 16));
+			packed = _mm_or_si128(packed, _mm_slli_epi32(normalZ, 24));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), packed);
+		}
+
+		for (; x < width; x++)
+		{
+			const float * sample = row + x;
+			destination[x] = encodeVertex(sample[0], (sample[1] - sample[-1]) * slopeScale, (below[x] - above[x]) * slopeScale);
+		}
+	}
+}
+
+void buildTerrainVertices(TerrainMeshVertex * vertices, const float * heights, uint32_t width, uint32_t depth,
+	float heightScale, float cellSize, ThreadPool * pool)
+{
+	float slopeScale = heightScale / (2.0f * cellSize);
+
+	size_t tiles = (depth + TILE_ROWS - 1) / TILE_ROWS;
+	auto runTile = [&](size_t tile) {
+		uint32_t z0 = static_cast<uint32_t>(tile) * TILE_ROWS;
+		buildRows(vertices, heights, width, z0, std::min(z0 + TILE_ROWS, depth), slopeScale);
+	};
+
+	ThreadPool::forEach(pool, tiles, runTile);
+}
+
+float decodeTerrainHeight(const TerrainMeshVertex & vertex, float heightScale)
+{
+	return (vertex.height / 65535.0f * 2.0f - 1.0f) * heightScale;
+}
+
+void decodeTerrainNormal(const TerrainMeshVertex & vertex, float normal[3])
+{
+	// the shader's normalized attribute conversion, max(c / 127, -1)
+	normal[0] = std::max(vertex.normalX / NORMAL_SCALE, -1.0f);
+	normal[2] = std::max(vertex.normalZ / NORMAL_SCALE, -1.0f);
+	normal[1] = std::sqrt(std::max(1.0f - normal[0] * normal[0] - normal[2] * normal[2], 0.0f));
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+/*Compact vertex and index data for regular terrain grids.
+
+A grid vertex only needs what the grid does not already know: its height and its normal. x and z follow from where the
+vertex sits in the grid, which the vertex shader gets back from gl_VertexID (see the Terrain demo). That leaves 4 bytes
+per vertex: the height as a 16 bit unorm over [-heightScale, heightScale] (60 units come out at about 2 mm steps) and
+the normal's x and z as 8 bit snorms. A heightfield normal always points up, so the shader recovers y as
+sqrt(1 - x^2 - z^2).
+
+buildTerrainVertices is the central difference kernel: it takes the heights with a one sample border, so the normals
+along an edge see the same neighbours as the grid next to it, and encodes the vertices 4 at a time with SSE2, in row
+tiles spread over the pool. The SIMD lanes and the scalar tail round the same way, a vertex shared by two grids comes
+out the same bits in both.
+
+buildTerrainStrips indexes a grid as one triangle strip per row of quads, rows separated by TERRAIN_RESTART_INDEX
+(glPrimitiveRestartIndex, see the PrimitiveRestart demo). A strip takes 2 indices per quad plus 2 per row against the 6
+per quad of a triangle list, and the winding matches the list the terrain used before: counter clockwise seen from
+above, rows running towards +z.*/
+
+const uint16_t TERRAIN_RESTART_INDEX = 0xffff;
+
+struct TerrainMeshVertex
+{
+	uint16_t height; // unorm, 0 is -heightScale and 65535 is +heightScale
+	int8_t normalX, normalZ; // snorm
+};
+
+// indices for a cells x cells grid of (cells + 1)^2 vertices, cells + 1 squared must stay below the restart index
+uint32_t terrainStripIndexCount(uint32_t cells);
+void buildTerrainStrips(std::vector<uint16_t> & indices, uint32_t cells);
+
+// heights holds (width + 2) x (depth + 2) samples row by row, the grid plus a one sample border, in units of heightScale
+// (so about [-1, 1] for noise). Writes width x depth vertices row by row, cellSize is the world distance between samples.
+void buildTerrainVertices(TerrainMeshVertex * vertices, const float * heights, uint32_t width, uint32_t depth,
+	float heightScale, float cellSize, ThreadPool * pool = nullptr);
+
+// back to world units, what the vertex shader computes
+float decodeTerrainHeight(const TerrainMeshVertex & vertex, float heightScale);
+void decodeTerrainNormal(const TerrainMeshVertex & vertex, float normal[3]);
@@ -0,0 +1,321 @@
+#include "TerrainStreamer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static size_t chunkBytes(const TerrainSettings & settings)
+{
+	size_t side = settings.chunkCells + 1;
+	return side * side * sizeof(TerrainMeshVertex);
+}
+
+// one frame of uploads per ring region, and a region always fits a whole chunk
+static size_t uploaderCapacity(const TerrainSettings & settings)
+{
+	return StagingUploader::REGION_COUNT * std::max(settings.frameBudget, chunkBytes(settings));
+}
+
+TerrainStreamer::TerrainStreamer(ThreadPool & pool, const TerrainSettings & settings)
+	: pool(pool), config(settings), uploader(uploaderCapacity(settings))
+{
+	config.chunkCells = std::max(1u, std::min(config.chunkCells, 254u));
+	config.viewRadius = std::max(config.viewRadius, 1);
+	config.keepMargin = std::max(config.keepMargin, 0);
+
+	uint32_t side = config.chunkCells + 1;
+	vertexCount = side * side;
+	indexCount = terrainStripIndexCount(config.chunkCells);
+	slotBytes = chunkBytes(config);
+
+	for (int z = -config.viewRadius; z <= config.viewRadius; z++)
+		for (int x = -config.viewRadius; x <= config.viewRadius; x++)
+			if (x * x + z * z <= config.viewRadius * config.viewRadius) offsets.push_back(glm::ivec2(x, z));
+	std::stable_sort(offsets.begin(), offsets.end(), [](const glm::ivec2 & a, const glm::ivec2 & b) {
+		return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+	});
+
+	// the vertices waiting on the CPU come out of the same budget as the slots
+	maxPending = std::max(8u, pool.size() * 4);
+	size_t budgetChunks = config.memoryBudget / slotBytes;
+	slots = budgetChunks > maxPending ? budgetChunks - maxPending : 1;
+	if (slots < offsets.size()) {
+		std::cout << "Terrain: the memory budget holds " << slots << " chunks, the view range needs " << offsets.size()
+			<< ", the farthest ones will not be drawn" << std::endl;
+	}
+
+	freeSlots.resize(slots);
+	for (size_t i = 0; i < slots; i++) freeSlots[i] = static_cast<uint32_t>(slots - 1 - i);
+
+	// every chunk is the same grid, so one index buffer serves all of them with a base vertex per slot. The restart
+	// index is compared before the base vertex is added, so it still splits the rows of every slot.
+	std::vector<uint16_t> indices;
+	buildTerrainStrips(indices, config.chunkCells);
+
+	glGenVertexArrays(1, &vertexArray);
+	glBindVertexArray(vertexArray);
+
+	glGenBuffers(1, &vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferStorage(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(slots * slotBytes), nullptr, 0);
+
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+	glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * indices.size(), indices.data(), 0);
+
+	glVertexAttribPointer(0, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(TerrainMeshVertex), reinterpret_cast<void*>(offsetof(TerrainMeshVertex, height)));
+	glVertexAttribPointer(1, 2, GL_BYTE, GL_TRUE, sizeof(TerrainMeshVertex), reinterpret_cast<void*>(offsetof(TerrainMeshVertex, normalX)));
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+
+	// chunk coordinates per slot, the vertex shader turns them and gl_VertexID into x and z
+	glGenBuffers(1, &originBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, originBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(slots * sizeof(glm::ivec2)), nullptr, 0);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void TerrainStreamer::generate(Chunk & chunk, const TerrainSettings & settings)
+{
+	Timer timer;
+	uint32_t cells = settings.chunkCells;
+	uint32_t side = cells + 1;
+	uint32_t bordered = side + 2;
+
+	// Whole sample indices as coordinates, the frequency takes the cell size. The neighbour computes the same floats
+	// for the samples along the shared edge, so the heights there agree to the bit.
+	NoiseOptions noise = settings.noise;
+	noise.frequency *= settings.cellSize;
+	float originX = static_cast<float>(chunk.x * int(cells) - 1);
+	float originZ = static_cast<float>(chunk.z * int(cells) - 1);
+
+	// one chunk is a single noise tile, the chunks themselves are what runs in parallel
+	std::vector<float> heights(size_t(bordered) * bordered);
+	generateNoise(heights.data(), bordered, bordered, bordered, originX, originZ, 1.0f, 1.0f, noise);
+
+	// normals from the border samples, the same neighbours the chunk next door sees along the shared edge
+	chunk.vertices.resize(size_t(side) * side);
+	buildTerrainVertices(chunk.vertices.data(), heights.data(), side, side, settings.heightScale, settings.cellSize);
+	chunk.generationMilliseconds = timer.elapsedMilliseconds();
+}
+
+bool TerrainStreamer::request(int x, int z)
+{
+	if (freeSlots.empty() && !evictLeastRecent()) return false;
+
+	auto chunk = std::make_shared<Chunk>();
+	chunk->x = x;
+	chunk->z = z;
+	chunk->slot = freeSlots.back();
+	chunk->state = CHUNK_QUEUED;
+	chunk->cancelled = false;
+	chunk->wantedFrame = frameIndex;
+	freeSlots.pop_back();
+
+	uint64_t chunkKey = key(x, z);
+	lru.push_front(chunkKey);
+	chunks[chunkKey] = Entry{ chunk, lru.begin() };
+
+	// the job holds on to its chunk, an eviction only marks it and lets the last reference free it
+	TerrainSettings settings = config;
+	pool.submit([chunk, settings] {
+		if (chunk->cancelled) return;
+		generate(*chunk, settings);
+		chunk->state = CHUNK_READY;
+	});
+	return true;
+}
+
+bool TerrainStreamer::evictLeastRecent()
+{
+	if (lru.empty()) return false;
+
+	auto it = chunks.find(lru.back());
+	if (it->second.chunk->wantedFrame == frameIndex) return false;
+
+	evict(it);
+	stats.evictedCapacity++;
+	return true;
+}
+
+TerrainStreamer::ChunkTable::iterator TerrainStreamer::evict(ChunkTable::iterator it)
+{
+	Chunk & chunk = *it->second.chunk;
+	if (chunk.state == CHUNK_QUEUED) {
+		chunk.cancelled = true;
+		stats.cancelled++;
+	}
+	freeSlots.push_back(chunk.slot);
+	lru.erase(it->second.lru);
+	return chunks.erase(it);
+}
+
+void TerrainStreamer::upload(Chunk & chunk, size_t & remaining)
+{
+	// whole chunks only, the first one of a frame goes up even when it is over the budget
+	size_t bytes = chunk.vertices.size() * sizeof(TerrainMeshVertex);
+	if (frame.uploads > 0 && bytes > remaining) {
+		remaining = 0;
+		return;
+	}
+
+	uploader.upload(vertexBuffer, static_cast<GLintptr>(chunk.slot * slotBytes), chunk.vertices.data(), bytes);
+	std::vector<TerrainMeshVertex>().swap(chunk.vertices);
+	glm::ivec2 origin(chunk.x, chunk.z);
+	uploader.upload(originBuffer, static_cast<GLintptr>(chunk.slot * sizeof(glm::ivec2)), &origin, sizeof(origin));
+	chunk.state = CHUNK_RESIDENT;
+
+	remaining -= std::min(remaining, bytes);
+	frame.uploads++;
+	frame.bytes += bytes;
+
+	double latency = chunk.requested.elapsedMilliseconds();
+	stats.generated++;
+	stats.generationMilliseconds += chunk.generationMilliseconds;
+	stats.worstGenerationMilliseconds = std::max(stats.worstGenerationMilliseconds, chunk.generationMilliseconds);
+	stats.latencyMilliseconds += latency;
+	stats.worstLatencyMilliseconds = std::max(stats.worstLatencyMilliseconds, latency);
+	stats.uploaded++;
+	stats.uploadedBytes += bytes;
+}
+
+void TerrainStreamer::update(const glm::vec3 & camera)
+{
+	Timer timer;
+
+	frame = TerrainFrameStats();
+	frame.frameMilliseconds = firstUpdate ? 0.0 : frameTimer.elapsedMilliseconds();
+	frameTimer.reset();
+	if (!firstUpdate) {
+		if (averageFrameMilliseconds > 0.0 && frame.frameMilliseconds > averageFrameMilliseconds * spikeFactor) stats.spikes++;
+		stats.worstFrameMilliseconds = std::max(stats.worstFrameMilliseconds, frame.frameMilliseconds);
+		averageFrameMilliseconds = averageFrameMilliseconds > 0.0
+			? averageFrameMilliseconds * 0.9 + frame.frameMilliseconds * 0.1 : frame.frameMilliseconds;
+		stats.frames++;
+	}
+	firstUpdate = false;
+	frameIndex++;
+
+	float size = chunkSize();
+	int cameraX = static_cast<int>(std::floor(camera.x / size));
+	int cameraZ = static_cast<int>(std::floor(camera.z / size));
+
+	// drop what drifted out of range and count the chunks that still hold vertices on the CPU
+	int keep = config.viewRadius + config.keepMargin;
+	unsigned pending = 0;
+	for (auto it = chunks.begin(); it != chunks.end();)
+	{
+		Chunk & chunk = *it->second.chunk;
+		int dx = chunk.x - cameraX, dz = chunk.z - cameraZ;
+		if (dx * dx + dz * dz > keep * keep) {
+			it = evict(it);
+			stats.evictedRange++;
+			continue;
+		}
+
+		if (chunk.state != CHUNK_RESIDENT) pending++;
+		++it;
+	}
+
+	drawCounts.clear();
+	drawOffsets.clear();
+	drawBaseVertices.clear();
+
+	// nearest first: requests, uploads and the draw list in one pass over the view range
+	size_t remaining = config.frameBudget;
+	for (const auto & offset : offsets)
+	{
+		int x = cameraX + offset.x, z = cameraZ + offset.y;
+		auto it = chunks.find(key(x, z));
+		if (it == chunks.end()) {
+			// misses wait for a free pending place, later frames pick up whatever is still in range
+			if (pending >= maxPending || !request(x, z)) continue;
+			pending++;
+			stats.requests++;
+			frame.requested++;
+			continue;
+		}
+
+		Chunk & chunk = *it->second.chunk;
+		if (chunk.wantedFrame + 1 != frameIndex) {
+			stats.requests++;
+			stats.hits++;
+		}
+		chunk.wantedFrame = frameIndex;
+		lru.splice(lru.begin(), lru, it->second.lru);
+
+		if (chunk.state == CHUNK_READY && remaining > 0) upload(chunk, remaining);
+
+		if (chunk.state == CHUNK_RESIDENT) {
+			drawCounts.push_back(static_cast<GLsizei>(indexCount));
+			drawOffsets.push_back(nullptr);
+			drawBaseVertices.push_back(static_cast<GLint>(chunk.slot * vertexCount));
+		}
+	}
+
+	// chunks that were generated and then left the view range still go up with what is left of the budget, rather
+	// than holding their pending place until they are evicted
+	for (auto & entry : chunks)
+	{
+		if (remaining == 0) break;
+		Chunk & chunk = *entry.second.chunk;
+		if (chunk.state != CHUNK_READY) continue;
+		upload(chunk, remaining);
+	}
+
+	if (frame.uploads > 0) uploader.flush();
+
+	// workers keep finishing chunks during the frame, so the count for residentBytes() is taken at the end of it
+	readyChunks = 0;
+	for (auto & entry : chunks)
+		if (entry.second.chunk->state == CHUNK_READY) readyChunks++;
+
+	frame.drawn = static_cast<unsigned>(drawCounts.size());
+	frame.updateMilliseconds = timer.elapsedMilliseconds();
+	stats.worstUpdateMilliseconds = std::max(stats.worstUpdateMilliseconds, frame.updateMilliseconds);
+	stats.peakResidentBytes = std::max(stats.peakResidentBytes, residentBytes());
+}
+
+void TerrainStreamer::draw()
+{
+	glBindVertexArray(vertexArray);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TERRAIN_ORIGIN_BINDING, originBuffer);
+	if (drawCounts.empty()) return;
+
+	glEnable(GL_PRIMITIVE_RESTART);
+	glPrimitiveRestartIndex(TERRAIN_RESTART_INDEX);
+	glMultiDrawElementsBaseVertex(GL_TRIANGLE_STRIP, drawCounts.data(), GL_UNSIGNED_SHORT, drawOffsets.data(),
+		static_cast<GLsizei>(drawCounts.size()), drawBaseVertices.data());
+	glDisable(GL_PRIMITIVE_RESTART);
+}
+
+void TerrainStreamer::printStatistics() const
+{
+	double generated = stats.generated ? double(stats.generated) : 1.0;
+	std::cout << "Terrain: " << stats.generated << " chunks generated, " << stats.generationMilliseconds / generated
+		<< " ms each (worst " << stats.worstGenerationMilliseconds << " ms), request to resident "
+		<< stats.latencyMilliseconds / generated << " ms (worst " << stats.worstLatencyMilliseconds << " ms), hit rate "
+		<< stats.hitRate() * 100.0 << "% of " << stats.requests << " requests, " << stats.evictedRange << " evicted by range, "
+		<< stats.evictedCapacity << " by capacity, " << stats.cancelled << " cancelled, resident " << residentBytes() / 1024
+		<< " KB (peak " << stats.peakResidentBytes / 1024 << " KB of " << config.memoryBudget / 1024 << " KB), worst update "
+		<< stats.worstUpdateMilliseconds << " ms, worst frame " << stats.worstFrameMilliseconds << " ms, " << stats.spikes
+		<< " spikes in " << stats.frames << " frames" << std::endl;
+}
+
+void TerrainStreamer::release()
+{
+	// queued jobs see the flag and skip their chunk, running ones finish into memory nobody reads anymore
+	for (auto & entry : chunks) entry.second.chunk->cancelled = true;
+	chunks.clear();
+	lru.clear();
+	drawCounts.clear();
+	drawOffsets.clear();
+	drawBaseVertices.clear();
+
+	uploader.release();
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteBuffers(1, &indexBuffer);
+	glDeleteBuffers(1, &originBuffer);
+	glDeleteVertexArrays(1, &vertexArray);
+	vertexBuffer = indexBuffer = originBuffer = vertexArray = 0;
+}
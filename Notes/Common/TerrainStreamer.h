@@ -0,0 +1,201 @@
+#pragma once
+#include <glad\glad.h>
+#include <glm\glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Noise.h"
+#include "StagingUploader.h"
+#include "TerrainMesh.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+/*Chunked terrain that is generated around the camera while it moves, so the world no longer ends at the edge of one
+heightmap.
+
+The ground is cut into square chunks of chunkCells x chunkCells quads. update() walks the chunks within viewRadius of
+the camera nearest first and hands every one it does not have to the pool. A worker samples the noise for the chunk plus
+a one sample border, takes the normals from central differences over that border (so they match the neighbours' along
+the shared edge) and encodes 4 byte height and normal vertices (TerrainMesh.h). Samples are addressed by whole sample
+indices, which keeps the heights along a shared edge bit identical and the chunks free of cracks.
+
+Every chunk owns a fixed size slot of one vertex buffer, all chunks share one index buffer of row strips and draw()
+submits the resident ones with a single glMultiDrawElementsBaseVertex. The vertices carry no x and z: with the base
+vertex gl_VertexID is slot * chunkVertices() + the vertex within the chunk, and the chunk coordinates of every slot sit
+in a shader storage buffer bound at TERRAIN_ORIGIN_BINDING, so the vertex shader rebuilds the position as
+
+	ivec2 cell = chunkOrigins[slot] * chunkCells + ivec2(vertex % (chunkCells + 1), vertex / (chunkCells + 1));
+	position = vec3(cell.x * cellSize, height, cell.y * cellSize);
+
+The number of slots follows from the memory budget, which makes the chunk table an LRU cache with a hard cap: chunks that
+drift past viewRadius + keepMargin are dropped, the ones in between stay around in case the camera turns back, and when
+the slots run out the least recently wanted chunk goes.
+Finished chunks are copied into their slots through a StagingUploader, nearest first, until the frame's upload budget is
+spent. Only a few chunks per worker are pending (queued or waiting for upload) at a time, so a fast camera never leaves a
+backlog of chunks it has already flown past, and evicting a chunk that is still queued just marks it for the worker to
+skip.
+
+	TerrainStreamer terrain(pool, settings);
+	while (...) {
+		terrain.update(cameraPosition);
+		terrain.draw();
+	}
+	terrain.release();*/
+
+struct TerrainSettings
+{
+	uint32_t chunkCells = 64; // quads along a chunk side, (chunkCells + 1)^2 vertices must fit 16 bit indices
+	float cellSize = 1.0f; // world units per quad
+	float heightScale = 60.0f; // world units for a noise value of 1
+	int viewRadius = 10; // in chunks, everything within is requested and drawn
+	int keepMargin = 2; // chunks out to viewRadius + keepMargin stay cached
+	size_t memoryBudget = 48 * 1024 * 1024; // vertex slots plus the generated chunks waiting for upload
+	size_t frameBudget = 1024 * 1024; // upload bytes per update(), at least one chunk always goes up
+	NoiseOptions noise; // frequency in lattice cells per world unit
+};
+
+// shader storage binding of the ivec2 chunk coordinates per slot
+const GLuint TERRAIN_ORIGIN_BINDING = 0;
+
+struct TerrainFrameStats
+{
+	unsigned requested = 0; // chunks handed to the pool this frame
+	unsigned uploads = 0;
+	uint64_t bytes = 0;
+	unsigned drawn = 0;
+	double updateMilliseconds = 0.0;
+	double frameMilliseconds = 0.0; // since the previous update()
+};
+
+struct TerrainStats
+{
+	uint64_t requests = 0; // chunks entering the view range
+	uint64_t hits = 0; // ... that were still cached
+	uint64_t generated = 0;
+	uint64_t cancelled = 0; // evicted before a worker got to them
+	uint64_t evictedRange = 0;
+	uint64_t evictedCapacity = 0;
+	double generationMilliseconds = 0.0; // worker time
+	double worstGenerationMilliseconds = 0.0;
+	double latencyMilliseconds = 0.0; // request until the chunk is resident
+	double worstLatencyMilliseconds = 0.0;
+	unsigned uploaded = 0;
+	uint64_t uploadedBytes = 0;
+	double worstUpdateMilliseconds = 0.0;
+	double worstFrameMilliseconds = 0.0;
+	unsigned frames = 0;
+	unsigned spikes = 0; // frames over spikeFactor times the running average
+	size_t peakResidentBytes = 0;
+
+	double hitRate() const { return requests ? double(hits) / requests : 0.0; }
+};
+
+class TerrainStreamer
+{
+public:
+	// needs a current context
+	TerrainStreamer(ThreadPool & pool, const TerrainSettings & settings = TerrainSettings());
+
+	TerrainStreamer(const TerrainStreamer &) = delete;
+	TerrainStreamer & operator=(const TerrainStreamer &) = delete;
+
+	// GL thread, once per frame. Requests, evicts and uploads chunks around the camera.
+	void update(const glm::vec3 & camera);
+
+	// Binds the terrain's vertex array and chunk origins and draws every resident chunk in range, leaves both bound.
+	void draw();
+
+	const TerrainSettings & settings() const { return config; }
+	float chunkSize() const { return config.chunkCells * config.cellSize; }
+	uint32_t chunkVertices() const { return vertexCount; }
+	uint32_t chunkIndices() const { return indexCount; }
+
+	size_t slotCount() const { return slots; }
+	size_t residentChunks() const { return slots - freeSlots.size(); }
+	// slots in use plus the vertices of generated chunks that have not gone up yet
+	size_t residentBytes() const { return (slots - freeSlots.size() + readyChunks) * slotBytes; }
+	size_t capacityBytes() const { return slots * slotBytes; }
+
+	// a frame counts as a spike when it takes this many times the running average
+	void setSpikeFactor(double factor) { spikeFactor = factor; }
+
+	const TerrainFrameStats & lastFrame() const { return frame; }
+	const TerrainStats & statistics() const { return stats; }
+	void printStatistics() const;
+
+	// Deletes the buffers before the context goes away. Jobs still in the pool only touch their own chunk.
+	void release();
+
+private:
+	enum ChunkState
+	{
+		CHUNK_QUEUED,
+		CHUNK_READY, // generated, waiting for upload
+		CHUNK_RESIDENT,
+	};
+
+	struct Chunk
+	{
+		int x, z;
+		uint32_t slot;
+		std::atomic<int> state;
+		std::atomic<bool> cancelled;
+		std::vector<TerrainMeshVertex> vertices; // freed once uploaded
+		Timer requested;
+		double generationMilliseconds = 0.0;
+		uint64_t wantedFrame = 0;
+	};
+
+	struct Entry
+	{
+		std::shared_ptr<Chunk> chunk;
+		std::list<uint64_t>::iterator lru;
+	};
+
+	typedef std::unordered_map<uint64_t, Entry> ChunkTable;
+
+	static uint64_t key(int x, int z) { return (uint64_t(uint32_t(x)) << 32) | uint32_t(z); }
+	static void generate(Chunk & chunk, const TerrainSettings & settings);
+
+	bool request(int x, int z);
+	bool evictLeastRecent();
+	ChunkTable::iterator evict(ChunkTable::iterator it);
+	void upload(Chunk & chunk, size_t & remaining);
+
+	ThreadPool & pool;
+	TerrainSettings config;
+	uint32_t vertexCount, indexCount;
+	size_t slotBytes;
+	size_t slots;
+	std::vector<uint32_t> freeSlots;
+
+	// chunk offsets within viewRadius, nearest first
+	std::vector<glm::ivec2> offsets;
+	ChunkTable chunks;
+	std::list<uint64_t> lru; // most recently wanted at the front
+	unsigned maxPending; // queued plus generated but not uploaded, each holds a slot's worth of vertices
+	unsigned readyChunks = 0; // counted at the end of update()
+	uint64_t frameIndex = 0;
+
+	GLuint vertexArray = 0;
+	GLuint vertexBuffer = 0;
+	GLuint indexBuffer = 0;
+	GLuint originBuffer = 0;
+	StagingUploader uploader;
+
+	// scratch for draw(), rebuilt by update()
+	std::vector<GLsizei> drawCounts;
+	std::vector<const void*> drawOffsets;
+	std::vector<GLint> drawBaseVertices;
+
+	double spikeFactor = 2.0;
+	double averageFrameMilliseconds = 0.0;
+	bool firstUpdate = true;
+	Timer frameTimer;
+	TerrainFrameStats frame;
+	TerrainStats stats;
+};
@@ -0,0 +1,181 @@
+#include "TextureCache.h"
+#include "MappedFile.h"
+#include "MipGenerator.h"
+#include "ThreadPool.h"
+#include <SOIL.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + 15) & ~uint64_t(15);
+}
+
+size_t TextureCache::compressedBytes() const
+{
+	size_t bytes = 0;
+	for (uint32_t level = 0; level < header->levelCount; level++) bytes += static_cast<size_t>(levels[level].size);
+	return bytes;
+}
+
+size_t TextureCache::uncompressedBytes() const
+{
+	size_t bytes = 0;
+	for (uint32_t level = 0; level < header->levelCount; level++) bytes += size_t(levels[level].width) * levels[level].height * 4;
+	return bytes;
+}
+
+static uint32_t cacheFlags(bool normalMap)
+{
+	return normalMap ? static_cast<uint32_t>(TEXTURE_CACHE_NORMAL_MAP) : 0u;
+}
+
+bool bakeTextureCache(const char * sourcePath, const char * cachePath, TextureFormat format, bool normalMap, ThreadPool * pool)
+{
+	int width, height, channels;
+	unsigned char * image = SOIL_load_image(sourcePath, &width, &height, &channels, SOIL_LOAD_RGBA);
+	if (!image) {
+		std::cout << "Baking " << sourcePath << " failed: " << SOIL_last_result() << std::endl;
+		return false;
+	}
+
+	TextureCacheHeader header = {};
+	header.magic = TEXTURE_CACHE_MAGIC;
+	header.version = TEXTURE_CACHE_VERSION;
+	header.width = width;
+	header.height = height;
+	header.format = format;
+	header.sourceChannels = channels;
+	header.flags = cacheFlags(normalMap);
+	fileStamp(sourcePath, header.sourceSize, header.sourceTime);
+	header.sourceHash = hashFile(sourcePath);
+
+	// color maps are filtered in linear space, see MipGenerator
+	MipChainOptions mipOptions;
+	mipOptions.srgb = !normalMap;
+	mipOptions.normalMap = normalMap;
+	vector<MipLevel> mips;
+	buildMipChain(mips, image, header.width, header.height, mipOptions, pool);
+	SOIL_free_image_data(image);
+
+	vector<TextureCacheLevel> levels;
+	for (const auto & mip : mips)
+		levels.push_back({ mip.width, mip.height, 0, compressedImageBytes(format, mip.width, mip.height) });
+	header.levelCount = static_cast<uint32_t>(levels.size());
+
+	uint64_t offset = alignOffset(sizeof(TextureCacheHeader) + sizeof(TextureCacheLevel) * levels.size());
+	for (auto & level : levels)
+	{
+		level.offset = offset;
+		offset = alignOffset(offset + level.size);
+	}
+
+	vector<uint8_t> data(static_cast<size_t>(offset - levels[0].offset));
+	for (size_t level = 0; level < levels.size(); level++)
+	{
+		compressImage(data.data() + (levels[level].offset - levels[0].offset), mips[level].pixels.data(),
+			levels[level].width, levels[level].height, format, pool);
+	}
+
+	// write to a temporary name first so a crash mid bake never leaves a truncated cache behind
+	std::string temporaryPath = std::string(cachePath) + ".tmp";
+	{
+		std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) {
+			std::cout << "Could not write " << temporaryPath << std::endl;
+			return false;
+		}
+
+		static const char padding[16] = {};
+		output.write(reinterpret_cast<const char*>(&header), sizeof header);
+		output.write(reinterpret_cast<const char*>(levels.data()), sizeof(TextureCacheLevel) * levels.size());
+		output.write(padding, levels[0].offset - (sizeof header + sizeof(TextureCacheLevel) * levels.size()));
+		output.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+		if (!output.good()) {
+			std::cout << "Could not write " << temporaryPath << std::endl;
+			return false;
+		}
+	}
+
+	std::remove(cachePath);
+	return std::rename(temporaryPath.c_str(), cachePath) == 0;
+}
+
+static bool validTextureCache(const MappedFile & file, TextureFormat format, bool normalMap)
+{
+	auto header = reinterpret_cast<const TextureCacheHeader*>(file.data());
+	if (file.size() < sizeof(TextureCacheHeader)
+		|| header->magic != TEXTURE_CACHE_MAGIC
+		|| header->version != TEXTURE_CACHE_VERSION
+		|| header->format != static_cast<uint32_t>(format)
+		|| header->flags != cacheFlags(normalMap)
+		|| header->levelCount == 0
+		|| sizeof(TextureCacheHeader) + sizeof(TextureCacheLevel) * header->levelCount > file.size())
+		return false;
+
+	auto levels = reinterpret_cast<const TextureCacheLevel*>(file.data() + sizeof(TextureCacheHeader));
+	const TextureCacheLevel & last = levels[header->levelCount - 1];
+	return last.offset + last.size <= file.size();
+}
+
+bool openTextureCache(const char * cachePath, const char * sourcePath, TextureFormat format, TextureCache & cache, bool normalMap)
+{
+	cache.header = nullptr;
+	cache.levels = nullptr;
+	if (!cache.file.open(cachePath)) return false;
+	if (!validTextureCache(cache.file, format, normalMap)) {
+		cache.file.close();
+		return false;
+	}
+
+	// the mesh cache's stale check: only hash the source when its stamp moved, and take a new time over when the
+	// contents are the same
+	auto header = reinterpret_cast<const TextureCacheHeader*>(cache.file.data());
+	uint64_t sourceSize;
+	int64_t sourceTime;
+	if (sourcePath && fileStamp(sourcePath, sourceSize, sourceTime)) {
+		if (sourceSize != header->sourceSize) {
+			cache.file.close();
+			return false;
+		}
+
+		if (sourceTime != header->sourceTime) {
+			if (hashFile(sourcePath) != header->sourceHash) {
+				cache.file.close();
+				return false;
+			}
+
+			cache.file.close();
+			restampFile(cachePath, offsetof(TextureCacheHeader, sourceTime), sourceTime);
+			if (!cache.file.open(cachePath) || !validTextureCache(cache.file, format, normalMap)) {
+				cache.file.close();
+				return false;
+			}
+			header = reinterpret_cast<const TextureCacheHeader*>(cache.file.data());
+		}
+	}
+
+	cache.header = header;
+	cache.levels = reinterpret_cast<const TextureCacheLevel*>(cache.file.data() + sizeof(TextureCacheHeader));
+	return true;
+}
+
+bool loadTextureCache(const char * sourcePath, TextureFormat format, TextureCache & cache, bool normalMap, ThreadPool * pool)
+{
+	std::string cachePath = std::string(sourcePath) + "." + textureFormatName(format) + ".rwtex";
+
+	if (openTextureCache(cachePath.c_str(), sourcePath, format, cache, normalMap)) return true;
+
+	std::cout << "Baking " << sourcePath << " into " << cachePath << std::endl;
+	if (!bakeTextureCache(sourcePath, cachePath.c_str(), format, normalMap, pool)) return false;
+
+	return openTextureCache(cachePath.c_str(), sourcePath, format, cache, normalMap);
+}
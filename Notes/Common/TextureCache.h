@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "MappedFile.h"
+#include "TextureCompressor.h"
+
+/*Baked block compressed texture format (.rwtex)
+
+Decoding the png / jpg / tga sources with SOIL costs tens of milliseconds per image on every launch and the result
+goes up as uncompressed RGB8, 4 bytes per texel once the driver pads it, with the mip chain built on the GPU.
+A texture cache holds the whole mip chain already compressed, so loading is mapping the file and handing each level
+straight to glCompressedTexSubImage2D:
+
+	TextureCacheHeader
+	TextureCacheLevel[levelCount]
+	level data, largest first, every level on a 16 byte boundary
+
+The cache sits next to the source as source + ".bc7.rwtex" (one file per format) and is rebaked when the source
+changes, with the same size / time / hash checks as the mesh cache. A normal map is baked differently from a color
+texture of the same file, the header's flags say which one a cache holds and a load of the other kind rebakes it.
+Texels are stored in the order SOIL returns them, first row at the top, like the demos have always uploaded them.*/
+
+const uint32_t TEXTURE_CACHE_MAGIC = 0x58545752; // "RWTX"
+const uint32_t TEXTURE_CACHE_VERSION = 3; // 2: mips filtered in linear space with a kaiser kernel, 3: flags
+
+enum TextureCacheFlag
+{
+	TEXTURE_CACHE_NORMAL_MAP = 1 << 0, // mips renormalized instead of filtered as sRGB color
+};
+
+struct TextureCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceHash;
+	uint64_t sourceSize;
+	int64_t sourceTime;
+
+	uint32_t width;
+	uint32_t height;
+	uint32_t format; // TextureFormat
+	uint32_t levelCount;
+	uint32_t sourceChannels; // what the source file had, 3 for rgb
+	uint32_t flags; // TextureCacheFlag bits
+};
+
+struct TextureCacheLevel
+{
+	uint32_t width;
+	uint32_t height;
+	uint64_t offset; // from the start of the file
+	uint64_t size;
+};
+
+struct TextureCache
+{
+	MappedFile file;
+	const TextureCacheHeader * header = nullptr;
+	const TextureCacheLevel * levels = nullptr;
+
+	TextureFormat format() const { return static_cast<TextureFormat>(header->format); }
+	const uint8_t * levelData(uint32_t level) const { return file.data() + levels[level].offset; }
+
+	// the whole chain on the GPU, and what the same chain takes as uncompressed RGBA8
+	size_t compressedBytes() const;
+	size_t uncompressedBytes() const;
+};
+
+class ThreadPool;
+
+// Decodes the source with SOIL, builds the mip chain and compresses every level. The source is taken as sRGB color,
+// unless normalMap is set, which renormalizes the mips instead.
+bool bakeTextureCache(const char * sourcePath, const char * cachePath, TextureFormat format, bool normalMap = false, ThreadPool * pool = nullptr);
+
+// Maps an existing cache file. Fails if it is missing, corrupt, from another version, format or kind (normalMap or
+// color), or older than sourcePath.
+bool openTextureCache(const char * cachePath, const char * sourcePath, TextureFormat format, TextureCache & cache, bool normalMap = false);
+
+// Maps the cache of sourcePath in format, baking it first if it does not exist or is out of date.
+bool loadTextureCache(const char * sourcePath, TextureFormat format, TextureCache & cache, bool normalMap = false, ThreadPool * pool = nullptr);
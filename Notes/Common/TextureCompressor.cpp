@@ -0,0 +1,535 @@
+#include "TextureCompressor.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// 4x4 texels, rgba8, edges clamped
+	void loadBlock(uint8_t * block, const uint8_t * pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY)
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				memcpy(block + (y * 4 + x) * 4, pixels + (sourceY * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	// mean and dominant direction of the first channels of the block, by power iteration on the covariance
+	void principalAxis(const uint8_t * block, int channels, float * mean, float * axis)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			mean[c] = 0.0f;
+			for (int i = 0; i < 16; i++) mean[c] += block[i * 4 + c];
+			mean[c] /= 16.0f;
+		}
+
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			for (int a = 0; a < channels; a++)
+			{
+				float da = block[i * 4 + a] - mean[a];
+				for (int b = a; b < channels; b++) covariance[a][b] += da * (block[i * 4 + b] - mean[b]);
+			}
+		}
+		for (int a = 0; a < channels; a++)
+			for (int b = 0; b < a; b++) covariance[a][b] = covariance[b][a];
+
+		for (int c = 0; c < channels; c++) axis[c] = 1.0f;
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float length = 0.0f;
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+				length = std::max(length, std::fabs(next[a]));
+			}
+			// a flat block has no direction, any axis does
+			if (length < 1e-6f) break;
+			for (int c = 0; c < channels; c++) axis[c] = next[c] / length;
+		}
+
+		float length = 0.0f;
+		for (int c = 0; c < channels; c++) length += axis[c] * axis[c];
+		length = std::sqrt(length);
+		for (int c = 0; c < channels; c++) axis[c] /= length;
+	}
+
+	// endpoints at the extremes of the block projected on its principal axis
+	void axisEndpoints(const uint8_t * block, int channels, float * low, float * high)
+	{
+		float mean[4], axis[4];
+		principalAxis(block, channels, mean, axis);
+
+		float minimum = FLT_MAX, maximum = -FLT_MAX;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = 0.0f;
+			for (int c = 0; c < channels; c++) t += (block[i * 4 + c] - mean[c]) * axis[c];
+			minimum = std::min(minimum, t);
+			maximum = std::max(maximum, t);
+		}
+
+		for (int c = 0; c < channels; c++)
+		{
+			low[c] = std::min(std::max(mean[c] + axis[c] * minimum, 0.0f), 255.0f);
+			high[c] = std::min(std::max(mean[c] + axis[c] * maximum, 0.0f), 255.0f);
+		}
+	}
+
+	int squaredDistance(const uint8_t * a, const uint8_t * b, int channels)
+	{
+		int distance = 0;
+		for (int c = 0; c < channels; c++) distance += (a[c] - b[c]) * (a[c] - b[c]);
+		return distance;
+	}
+
+	// BC1
+
+	uint16_t pack565(const float * color)
+	{
+		int r = static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f);
+		int g = static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f);
+		int b = static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f);
+		return static_cast<uint16_t>((std::min(r, 31) << 11) | (std::min(g, 63) << 5) | std::min(b, 31));
+	}
+
+	void unpack565(uint16_t packed, uint8_t * color)
+	{
+		int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+		color[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+		color[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+		color[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+		color[3] = 255;
+	}
+
+	void bc1Palette(uint16_t color0, uint16_t color1, uint8_t palette[4][4])
+	{
+		unpack565(color0, palette[0]);
+		unpack565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			if (color0 > color1) {
+				palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+				palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+			}
+			else {
+				palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = color0 > color1 ? 255 : 0;
+	}
+
+	// quantizes the endpoints, picks the indices and returns the error. Always four color mode, BC3 requires it.
+	int encodeBC1Endpoints(const uint8_t * block, const float * low, const float * high, uint8_t * destination, uint8_t * indices)
+	{
+		uint16_t color0 = pack565(high), color1 = pack565(low);
+		if (color0 < color1) std::swap(color0, color1);
+
+		if (color0 == color1) {
+			// both round to the same color, nothing to interpolate
+			memcpy(destination, &color0, 2);
+			memcpy(destination + 2, &color1, 2);
+			memset(destination + 4, 0, 4);
+			memset(indices, 0, 16);
+			uint8_t palette[4][4];
+			bc1Palette(color0, color1, palette);
+			int error = 0;
+			for (int i = 0; i < 16; i++) error += squaredDistance(block + i * 4, palette[0], 3);
+			return error;
+		}
+
+		uint8_t palette[4][4];
+		bc1Palette(color0, color1, palette);
+
+		uint32_t bits = 0;
+		int error = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestDistance = INT32_MAX;
+			for (int p = 0; p < 4; p++)
+			{
+				int distance = squaredDistance(block + i * 4, palette[p], 3);
+				if (distance < bestDistance) {
+					bestDistance = distance;
+					best = p;
+				}
+			}
+			indices[i] = static_cast<uint8_t>(best);
+			bits |= best << (i * 2);
+			error += bestDistance;
+		}
+
+		memcpy(destination, &color0, 2);
+		memcpy(destination + 2, &color1, 2);
+		memcpy(destination + 4, &bits, 4);
+		return error;
+	}
+
+	void encodeBC1(const uint8_t * block, uint8_t * destination)
+	{
+		float low[3], high[3];
+		axisEndpoints(block, 3, low, high);
+
+		uint8_t indices[16];
+		int error = encodeBC1Endpoints(block, low, high, destination, indices);
+
+		// one least squares refit of the endpoints to the chosen indices, kept when it helps
+		static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[3] = {}, bx[3] = {};
+		for (int i = 0; i < 16; i++)
+		{
+			float a = weights[indices[i]], b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < 3; c++)
+			{
+				ax[c] += a * block[i * 4 + c];
+				bx[c] += b * block[i * 4 + c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f) return;
+
+		float refitHigh[3], refitLow[3];
+		for (int c = 0; c < 3; c++)
+		{
+			refitHigh[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) / determinant, 0.0f), 255.0f);
+			refitLow[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / determinant, 0.0f), 255.0f);
+		}
+
+		uint8_t refit[8];
+		if (encodeBC1Endpoints(block, refitLow, refitHigh, refit, indices) < error) memcpy(destination, refit, 8);
+	}
+
+	void decodeBC1(const uint8_t * source, uint8_t * block)
+	{
+		uint16_t color0, color1;
+		uint32_t bits;
+		memcpy(&color0, source, 2);
+		memcpy(&color1, source + 2, 2);
+		memcpy(&bits, source + 4, 4);
+
+		uint8_t palette[4][4];
+		bc1Palette(color0, color1, palette);
+		for (int i = 0; i < 16; i++) memcpy(block + i * 4, palette[(bits >> (i * 2)) & 3], 4);
+	}
+
+	// BC4, one channel (alpha of BC3, each half of BC5)
+
+	void bc4Palette(uint8_t value0, uint8_t value1, uint8_t palette[8])
+	{
+		palette[0] = value0;
+		palette[1] = value1;
+		if (value0 > value1) {
+			for (int i = 2; i < 8; i++) palette[i] = static_cast<uint8_t>(((8 - i) * value0 + (i - 1) * value1) / 7);
+		}
+		else {
+			for (int i = 2; i < 6; i++) palette[i] = static_cast<uint8_t>(((6 - i) * value0 + (i - 1) * value1) / 5);
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void encodeBC4(const uint8_t * block, int channel, uint8_t * destination)
+	{
+		uint8_t minimum = 255, maximum = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minimum = std::min(minimum, block[i * 4 + channel]);
+			maximum = std::max(maximum, block[i * 4 + channel]);
+		}
+
+		destination[0] = maximum;
+		destination[1] = minimum;
+		uint64_t bits = 0;
+		if (maximum > minimum) {
+			uint8_t palette[8];
+			bc4Palette(maximum, minimum, palette);
+			for (int i = 0; i < 16; i++)
+			{
+				int value = block[i * 4 + channel];
+				int best = 0, bestDistance = 256;
+				for (int p = 0; p < 8; p++)
+				{
+					int distance = std::abs(value - palette[p]);
+					if (distance < bestDistance) {
+						bestDistance = distance;
+						best = p;
+					}
+				}
+				bits |= uint64_t(best) << (i * 3);
+			}
+		}
+
+		for (int i = 0; i < 6; i++) destination[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+	}
+
+	void decodeBC4(const uint8_t * source, int channel, uint8_t * block)
+	{
+		uint8_t palette[8];
+		bc4Palette(source[0], source[1], palette);
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++) bits |= uint64_t(source[2 + i]) << (i * 8);
+		for (int i = 0; i < 16; i++) block[i * 4 + channel] = palette[(bits >> (i * 3)) & 7];
+	}
+
+	// BC7 mode 6
+
+	const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BitWriter
+	{
+		uint8_t * destination;
+		int position;
+
+		void write(uint32_t value, int count)
+		{
+			for (int i = 0; i < count; i++, position++)
+				if ((value >> i) & 1) destination[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+		}
+	};
+
+	uint32_t readBits(const uint8_t * source, int & position, int count)
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < count; i++, position++)
+			value |= ((source[position >> 3] >> (position & 7)) & 1u) << i;
+		return value;
+	}
+
+	void bc7Palette(const int endpoint0[4], const int endpoint1[4], uint8_t palette[16][4])
+	{
+		for (int i = 0; i < 16; i++)
+			for (int c = 0; c < 4; c++)
+				palette[i][c] = static_cast<uint8_t>(((64 - bc7Weights[i]) * endpoint0[c] + bc7Weights[i] * endpoint1[c] + 32) >> 6);
+	}
+
+	void encodeBC7(const uint8_t * block, uint8_t * destination)
+	{
+		float low[4], high[4];
+		axisEndpoints(block, 4, low, high);
+
+		// every endpoint has its own p bit shared by its four channels, try all four combinations
+		int bestError = INT32_MAX;
+		int bestQuantized[2][4] = {}, bestP[2] = {};
+		uint8_t bestIndices[16] = {};
+		for (int combination = 0; combination < 4; combination++)
+		{
+			int p[2] = { combination & 1, combination >> 1 };
+			int quantized[2][4], endpoints[2][4];
+			for (int c = 0; c < 4; c++)
+			{
+				quantized[0][c] = std::min(std::max(static_cast<int>((low[c] - p[0]) / 2.0f + 0.5f), 0), 127);
+				quantized[1][c] = std::min(std::max(static_cast<int>((high[c] - p[1]) / 2.0f + 0.5f), 0), 127);
+				endpoints[0][c] = (quantized[0][c] << 1) | p[0];
+				endpoints[1][c] = (quantized[1][c] << 1) | p[1];
+			}
+
+			uint8_t palette[16][4];
+			bc7Palette(endpoints[0], endpoints[1], palette);
+
+			// the projection on the endpoint line lands next to the best index, only its neighbours need checking
+			int direction[4], lengthSquared = 0;
+			for (int c = 0; c < 4; c++)
+			{
+				direction[c] = endpoints[1][c] - endpoints[0][c];
+				lengthSquared += direction[c] * direction[c];
+			}
+
+			int error = 0;
+			uint8_t indices[16];
+			for (int i = 0; i < 16 && error < bestError; i++)
+			{
+				int projection = 0;
+				for (int c = 0; c < 4; c++) projection += (block[i * 4 + c] - endpoints[0][c]) * direction[c];
+				int guess = lengthSquared ? static_cast<int>(15.0f * projection / lengthSquared + 0.5f) : 0;
+				guess = std::min(std::max(guess, 0), 15);
+
+				int best = 0, bestDistance = INT32_MAX;
+				for (int x = std::max(guess - 1, 0); x <= std::min(guess + 1, 15); x++)
+				{
+					int distance = squaredDistance(block + i * 4, palette[x], 4);
+					if (distance < bestDistance) {
+						bestDistance = distance;
+						best = x;
+					}
+				}
+				indices[i] = static_cast<uint8_t>(best);
+				error += bestDistance;
+			}
+
+			if (error < bestError) {
+				bestError = error;
+				memcpy(bestQuantized, quantized, sizeof quantized);
+				memcpy(bestP, p, sizeof p);
+				memcpy(bestIndices, indices, sizeof indices);
+			}
+		}
+
+		// the first index has its top bit implied to be 0, swapping the endpoints makes that true
+		if (bestIndices[0] & 8) {
+			for (int c = 0; c < 4; c++) std::swap(bestQuantized[0][c], bestQuantized[1][c]);
+			std::swap(bestP[0], bestP[1]);
+			for (int i = 0; i < 16; i++) bestIndices[i] = static_cast<uint8_t>(15 - bestIndices[i]);
+		}
+
+		memset(destination, 0, 16);
+		BitWriter writer = { destination, 0 };
+		writer.write(1 << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			writer.write(bestQuantized[0][c], 7);
+			writer.write(bestQuantized[1][c], 7);
+		}
+		writer.write(bestP[0], 1);
+		writer.write(bestP[1], 1);
+		writer.write(bestIndices[0], 3);
+		for (int i = 1; i < 16; i++) writer.write(bestIndices[i], 4);
+	}
+
+	void decodeBC7(const uint8_t * source, uint8_t * block)
+	{
+		// only mode 6 is ever written, anything else shows up magenta
+		if ((source[0] & 0x7f) != (1 << 6)) {
+			for (int i = 0; i < 16; i++)
+			{
+				block[i * 4 + 0] = 255;
+				block[i * 4 + 1] = 0;
+				block[i * 4 + 2] = 255;
+				block[i * 4 + 3] = 255;
+			}
+			return;
+		}
+
+		int position = 7;
+		int endpoints[2][4];
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = readBits(source, position, 7) << 1;
+			endpoints[1][c] = readBits(source, position, 7) << 1;
+		}
+		int p0 = readBits(source, position, 1), p1 = readBits(source, position, 1);
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] |= p0;
+			endpoints[1][c] |= p1;
+		}
+
+		uint8_t palette[16][4];
+		bc7Palette(endpoints[0], endpoints[1], palette);
+		for (int i = 0; i < 16; i++) memcpy(block + i * 4, palette[readBits(source, position, i == 0 ? 3 : 4)], 4);
+	}
+
+	void encodeBlock(const uint8_t * block, TextureFormat format, uint8_t * destination)
+	{
+		switch (format)
+		{
+		case TEXTURE_FORMAT_BC1:
+			encodeBC1(block, destination);
+			break;
+		case TEXTURE_FORMAT_BC3:
+			encodeBC4(block, 3, destination);
+			encodeBC1(block, destination + 8);
+			break;
+		case TEXTURE_FORMAT_BC5:
+			encodeBC4(block, 0, destination);
+			encodeBC4(block, 1, destination + 8);
+			break;
+		default:
+			encodeBC7(block, destination);
+			break;
+		}
+	}
+
+	void decodeBlock(const uint8_t * source, TextureFormat format, uint8_t * block)
+	{
+		switch (format)
+		{
+		case TEXTURE_FORMAT_BC1:
+			decodeBC1(source, block);
+			break;
+		case TEXTURE_FORMAT_BC3:
+			decodeBC1(source + 8, block);
+			decodeBC4(source, 3, block);
+			break;
+		case TEXTURE_FORMAT_BC5:
+			for (int i = 0; i < 16; i++)
+			{
+				block[i * 4 + 2] = 0;
+				block[i * 4 + 3] = 255;
+			}
+			decodeBC4(source, 0, block);
+			decodeBC4(source + 8, 1, block);
+			break;
+		default:
+			decodeBC7(source, block);
+			break;
+		}
+	}
+}
+
+size_t blockBytes(TextureFormat format)
+{
+	return format == TEXTURE_FORMAT_BC1 ? 8 : 16;
+}
+
+const char * textureFormatName(TextureFormat format)
+{
+	static const char * names[] = { "bc1", "bc3", "bc5", "bc7" };
+	return format < TEXTURE_FORMAT_COUNT ? names[format] : "unknown";
+}
+
+size_t compressedImageBytes(TextureFormat format, uint32_t width, uint32_t height)
+{
+	return size_t((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+void compressImage(uint8_t * destination, const uint8_t * pixels, uint32_t width, uint32_t height, TextureFormat format, ThreadPool * pool)
+{
+	uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	size_t bytes = blockBytes(format);
+
+	auto compressRow = [&](size_t blockY) {
+		uint8_t block[64];
+		for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+		{
+			loadBlock(block, pixels, width, height, blockX, static_cast<uint32_t>(blockY));
+			encodeBlock(block, format, destination + (blockY * blocksX + blockX) * bytes);
+		}
+	};
+
+	ThreadPool::forEach(pool, blocksY, compressRow);
+}
+
+void decompressImage(uint8_t * destination, const uint8_t * blocks, uint32_t width, uint32_t height, TextureFormat format)
+{
+	uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	size_t bytes = blockBytes(format);
+	uint8_t block[64];
+
+	for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+	{
+		for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+		{
+			decodeBlock(blocks + (blockY * blocksX + blockX) * bytes, format, block);
+			for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++)
+				for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++)
+					memcpy(destination + ((blockY * 4 + y) * width + blockX * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+/*CPU block compression for the texture cache.
+
+Every format works on 4x4 blocks of RGBA8 texels, blocks on the right and bottom edge of images that are not a
+multiple of 4 repeat their last row / column. Endpoints come from the principal axis of the block colors, which is
+a lot better than the bounding box corners for the smooth gradients in photos and still cheap enough to compress the
+2048x2048 cube map faces in well under a second on a few threads.
+
+	BC1  rgb,  8 bytes per block (4 bits per texel), no alpha, for opaque color maps
+	BC3  rgba, 16 bytes per block, BC1 color plus a separately interpolated alpha
+	BC5  rg,   16 bytes per block, two independent channels, for tangent space normal maps (z is rebuilt in the shader)
+	BC7  rgba, 16 bytes per block, only mode 6 (one subset, 7 bit endpoints, 16 levels) is written, which alone is
+	     clearly better than BC1 on color maps
+
+The decoders are only there to measure the error of the encoders, the GPU decodes the real thing.*/
+
+enum TextureFormat
+{
+	TEXTURE_FORMAT_BC1,
+	TEXTURE_FORMAT_BC3,
+	TEXTURE_FORMAT_BC5,
+	TEXTURE_FORMAT_BC7,
+	TEXTURE_FORMAT_COUNT,
+};
+
+size_t blockBytes(TextureFormat format);
+const char * textureFormatName(TextureFormat format);
+
+// size of a width x height level in format, in bytes
+size_t compressedImageBytes(TextureFormat format, uint32_t width, uint32_t height);
+
+// rgba8 texels, width * height * 4 bytes. pool is optional and spreads the rows of blocks over the workers.
+void compressImage(uint8_t * destination, const uint8_t * pixels, uint32_t width, uint32_t height, TextureFormat format, ThreadPool * pool = nullptr);
+
+// back to rgba8, for error measurements. BC5 writes its channels to red and green, blue 0 and alpha 255.
+void decompressImage(uint8_t * destination, const uint8_t * blocks, uint32_t width, uint32_t height, TextureFormat format);
+
@@ -0,0 +1,359 @@
+#include "TextureStreamer.h"
+#include "TextureUpload.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+static size_t alignStripe(size_t offset)
+{
+	return (offset + 15) & ~size_t(15);
+}
+
+TextureStreamer::TextureStreamer(ThreadPool & pool, size_t frameBudget) : pool(pool), budget(frameBudget)
+{
+	// mid grey, so a streaming texture reads as "not here yet" instead of black
+	static const uint8_t grey[4] = { 128, 128, 128, 255 };
+
+	glGenTextures(1, &placeholder2D);
+	glBindTexture(GL_TEXTURE_2D, placeholder2D);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 1, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+
+	glGenTextures(1, &placeholderCube);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, placeholderCube);
+	glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_RGBA8, 1, 1);
+	for (GLenum face = 0; face < 6; face++)
+		glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+
+	// one region per frame in flight, a frame never uploads more than a region
+	regionBytes = alignStripe(std::max<size_t>(frameBudget, 256 * 1024));
+	GLsizeiptr totalBytes = static_cast<GLsizeiptr>(regionBytes * REGION_COUNT);
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &ring);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, totalBytes, nullptr, flags);
+	mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalBytes, flags));
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	// the jobs point into the faces, nothing may be freed while a worker can still write to it
+	pool.wait();
+}
+
+TextureStreamer::Handle TextureStreamer::stream2D(const std::string & path, TextureFormat format, bool normalMap)
+{
+	return add(GL_TEXTURE_2D, { path }, format, normalMap);
+}
+
+TextureStreamer::Handle TextureStreamer::streamCubeMap(const std::vector<std::string> & facePaths, TextureFormat format)
+{
+	return add(GL_TEXTURE_CUBE_MAP, facePaths, format, false);
+}
+
+TextureStreamer::Handle TextureStreamer::add(GLenum target, const std::vector<std::string> & paths, TextureFormat format, bool normalMap)
+{
+	auto streamed = std::unique_ptr<StreamedTexture>(new StreamedTexture());
+	streamed->target = target;
+	streamed->format = format;
+	streamed->normalMap = normalMap;
+
+	for (const auto & path : paths)
+	{
+		Face * face = new Face();
+		face->path = path;
+		face->readyLevel = UINT32_MAX;
+		face->mapped = false;
+		face->failed = false;
+		streamed->faces.emplace_back(face);
+
+		pool.submit([this, face, format, normalMap] { prepare(*face, format, normalMap); });
+	}
+
+	textures.push_back(std::move(streamed));
+	return static_cast<Handle>(textures.size() - 1);
+}
+
+void TextureStreamer::prepare(Face & face, TextureFormat format, bool normalMap)
+{
+	if (!loadTextureCache(face.path.c_str(), format, face.cache, normalMap, &pool)) {
+		face.failed = true;
+		return;
+	}
+
+	uint32_t levels = face.cache.header->levelCount;
+	face.readyLevel = levels;
+	face.mapped = true;
+
+	// the same order update() uploads in. Reading a byte of every page faults the level in here rather than in the
+	// middle of a frame on the GL thread.
+	volatile uint8_t sink = 0;
+	for (uint32_t level = levels; level-- > 0;)
+	{
+		const uint8_t * data = face.cache.levelData(level);
+		size_t size = static_cast<size_t>(face.cache.levels[level].size);
+		for (size_t offset = 0; offset < size; offset += 4096) sink += data[offset];
+		face.readyLevel = level;
+	}
+}
+
+bool TextureStreamer::allocate(StreamedTexture & streamed)
+{
+	for (auto & face : streamed.faces)
+	{
+		if (face->failed) {
+			std::cout << "Streaming " << face->path << " failed" << std::endl;
+			streamed.failed = true;
+			return false;
+		}
+		if (!face->mapped) return false;
+	}
+
+	const TextureCacheHeader & first = *streamed.faces[0]->cache.header;
+	for (auto & face : streamed.faces)
+	{
+		const TextureCacheHeader & header = *face->cache.header;
+		if (header.width != first.width || header.height != first.height || header.levelCount != first.levelCount) {
+			std::cout << "Streaming " << face->path << " failed: the faces differ in size" << std::endl;
+			streamed.failed = true;
+			return false;
+		}
+	}
+
+	glGenTextures(1, &streamed.texture);
+	glBindTexture(streamed.target, streamed.texture);
+	glTexStorage2D(streamed.target, first.levelCount, compressedInternalFormat(streamed.format), first.width, first.height);
+	glTexParameteri(streamed.target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(streamed.target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(streamed.target, GL_TEXTURE_MAX_LEVEL, first.levelCount - 1);
+	streamed.levels = first.levelCount;
+	streamed.resident = first.levelCount;
+	return true;
+}
+
+TextureStreamer::StreamedTexture * TextureStreamer::nextUpload()
+{
+	// the smallest missing level of any texture, so everything gets a blurry version before anything gets a sharp one
+	StreamedTexture * best = nullptr;
+	for (auto & streamed : textures)
+	{
+		if (!streamed->texture || streamed->failed || streamed->resident == 0) continue;
+
+		uint32_t level = streamed->resident - 1;
+		bool ready = true;
+		for (auto & face : streamed->faces) ready = ready && face->readyLevel <= level;
+
+		if (ready && (!best || level > best->resident - 1)) best = streamed.get();
+	}
+	return best;
+}
+
+void TextureStreamer::uploadStripe(StreamedTexture & streamed, size_t & remaining)
+{
+	uint32_t level = streamed.resident - 1;
+
+	size_t faceIndex = 0;
+	while (streamed.faces[faceIndex]->uploadedRows == (streamed.faces[faceIndex]->cache.levels[level].height + 3) / 4) faceIndex++;
+	Face & face = *streamed.faces[faceIndex];
+
+	const TextureCacheLevel & info = face.cache.levels[level];
+	uint32_t blockRows = (info.height + 3) / 4;
+	size_t rowBytes = compressedImageBytes(streamed.format, info.width, 4);
+
+	// whole block rows, as many as the budget and the region allow. A frame always makes some progress, so a single
+	// row over the budget still goes up when it is the first upload of the frame.
+	size_t space = regionBytes - regionUsed;
+	uint32_t rows = static_cast<uint32_t>(std::min<size_t>(blockRows - face.uploadedRows, std::min(remaining, space) / rowBytes));
+	if (rows == 0) {
+		if (frame.bytes > 0 || rowBytes > space) {
+			remaining = 0;
+			return;
+		}
+		rows = 1;
+	}
+
+	size_t bytes = rows * rowBytes;
+	size_t ringOffset = region * regionBytes + regionUsed;
+	memcpy(mapped + ringOffset, face.cache.levelData(level) + face.uploadedRows * rowBytes, bytes);
+
+	uint32_t y = face.uploadedRows * 4;
+	uint32_t height = std::min(rows * 4, info.height - y);
+	GLenum faceTarget = streamed.target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(faceIndex) : streamed.target;
+	glBindTexture(streamed.target, streamed.texture);
+	glCompressedTexSubImage2D(faceTarget, level, 0, y, info.width, height, compressedInternalFormat(streamed.format),
+		static_cast<GLsizei>(bytes), reinterpret_cast<void*>(ringOffset));
+
+	regionUsed = std::min(alignStripe(regionUsed + bytes), regionBytes);
+	remaining -= std::min(remaining, bytes);
+	frame.bytes += bytes;
+	frame.uploads++;
+	face.uploadedRows += rows;
+
+	for (auto & other : streamed.faces)
+		if (other->uploadedRows < blockRows) return;
+
+	// the level is in on every face, sampling may use it from the next draw on
+	streamed.resident = level;
+	glTexParameteri(streamed.target, GL_TEXTURE_BASE_LEVEL, level);
+	for (auto & other : streamed.faces)
+	{
+		other->uploadedRows = 0;
+		// everything is on the GPU, the mapping is not needed anymore
+		if (level == 0) {
+			other->cache.file.close();
+			other->cache.header = nullptr;
+			other->cache.levels = nullptr;
+		}
+	}
+}
+
+void TextureStreamer::update()
+{
+	Timer timer;
+	bool streaming = !finished();
+
+	frame = StreamingFrameStats();
+	frame.frameMilliseconds = firstUpdate ? 0.0 : frameTimer.elapsedMilliseconds();
+	frameTimer.reset();
+
+	if (!firstUpdate && streaming) {
+		if (averageFrameMilliseconds > 0.0 && frame.frameMilliseconds > averageFrameMilliseconds * spikeFactor) stats.spikes++;
+		stats.worstFrameMilliseconds = std::max(stats.worstFrameMilliseconds, frame.frameMilliseconds);
+	}
+	if (!firstUpdate) {
+		averageFrameMilliseconds = averageFrameMilliseconds > 0.0
+			? averageFrameMilliseconds * 0.9 + frame.frameMilliseconds * 0.1 : frame.frameMilliseconds;
+	}
+	firstUpdate = false;
+
+	for (auto & streamed : textures)
+		if (!streamed->texture && !streamed->failed) allocate(*streamed);
+
+	size_t remaining = budget;
+	bool bound = false;
+	while (remaining > 0)
+	{
+		StreamedTexture * next = nextUpload();
+		if (!next) break;
+
+		if (!bound) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring);
+			bound = true;
+		}
+		uploadStripe(*next, remaining);
+	}
+
+	if (bound) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		endFrame();
+	}
+
+	frame.updateMilliseconds = timer.elapsedMilliseconds();
+	if (frame.bytes > 0) {
+		stats.bytes += frame.bytes;
+		stats.uploads += frame.uploads;
+		stats.frames++;
+		stats.peakFrameBytes = std::max(stats.peakFrameBytes, frame.bytes);
+		stats.updateMilliseconds += frame.updateMilliseconds;
+		stats.worstUpdateMilliseconds = std::max(stats.worstUpdateMilliseconds, frame.updateMilliseconds);
+	}
+}
+
+void TextureStreamer::endFrame()
+{
+	// fence the region this frame read from and move on, waiting only if the GPU still reads the next one
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	region = (region + 1) % REGION_COUNT;
+	regionUsed = 0;
+
+	if (fences[region]) {
+		Timer timer;
+		GLenum result;
+		do {
+			result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fences[region]);
+		fences[region] = nullptr;
+		stats.waitMilliseconds += timer.elapsedMilliseconds();
+	}
+}
+
+GLuint TextureStreamer::texture(Handle handle) const
+{
+	const StreamedTexture & streamed = *textures[handle];
+	if (streamed.texture && streamed.resident < streamed.levels) return streamed.texture;
+	return streamed.target == GL_TEXTURE_CUBE_MAP ? placeholderCube : placeholder2D;
+}
+
+GLenum TextureStreamer::target(Handle handle) const
+{
+	return textures[handle]->target;
+}
+
+uint32_t TextureStreamer::residentLevel(Handle handle) const
+{
+	return textures[handle]->resident;
+}
+
+uint32_t TextureStreamer::levelCount(Handle handle) const
+{
+	return textures[handle]->levels;
+}
+
+bool TextureStreamer::failed(Handle handle) const
+{
+	return textures[handle]->failed;
+}
+
+bool TextureStreamer::finished() const
+{
+	for (auto & streamed : textures)
+		if (!streamed->failed && (!streamed->texture || streamed->resident > 0)) return false;
+	return true;
+}
+
+void TextureStreamer::setFrameBudget(size_t bytes)
+{
+	budget = std::min(bytes, regionBytes);
+}
+
+void TextureStreamer::printStatistics() const
+{
+	std::cout << "Streaming: " << stats.bytes / 1024 << " KB in " << stats.uploads << " uploads over " << stats.frames
+		<< " frames (budget " << budget / 1024 << " KB, peak " << stats.peakFrameBytes / 1024 << " KB), "
+		<< stats.updateMilliseconds << " ms updating (worst " << stats.worstUpdateMilliseconds << " ms), worst frame "
+		<< stats.worstFrameMilliseconds << " ms, " << stats.spikes << " spikes, "
+		<< stats.waitMilliseconds << " ms waiting on the GPU" << std::endl;
+}
+
+void TextureStreamer::release()
+{
+	pool.wait();
+
+	for (auto & fence : fences)
+	{
+		if (fence) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	if (ring) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &ring);
+		ring = 0;
+		mapped = nullptr;
+	}
+
+	for (auto & streamed : textures)
+	{
+		if (streamed->texture) glDeleteTextures(1, &streamed->texture);
+		streamed->texture = 0;
+	}
+	glDeleteTextures(1, &placeholder2D);
+	glDeleteTextures(1, &placeholderCube);
+	placeholder2D = placeholderCube = 0;
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <glad\glad.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+/*Streams texture caches in over several frames instead of blocking startup until every level is on the GPU.
+
+stream2D() and streamCubeMap() return straight away. A worker maps (or bakes, on the first run) the cache of every face, then walks the
+levels from the smallest up and touches their pages so the copies on the GL thread never wait on the disk. Until the
+smallest level is in, texture() hands out a 1x1 grey placeholder of the same target.
+
+update() runs once per frame on the GL thread. It copies level data into a persistently mapped pixel unpack ring and
+issues glCompressedTexSubImage2D from it, the smallest missing level of any texture first, until the frame budget is
+spent. Levels larger than what is left of the budget go up in stripes of block rows over several frames. Once every
+face of a level is in, GL_TEXTURE_BASE_LEVEL drops to it, so sampling never touches a level that is not resident.
+Each frame's uploads read from their own region of the ring, fenced like the StagingUploader regions.
+
+	TextureStreamer streamer(pool, 2 * 1024 * 1024);
+	auto sky = streamer.streamCubeMap(facePaths, TEXTURE_FORMAT_BC1);
+	while (...) {
+		streamer.update();
+		glBindTexture(GL_TEXTURE_CUBE_MAP, streamer.texture(sky));
+	}
+	streamer.release();*/
+
+struct StreamingFrameStats
+{
+	uint64_t bytes = 0; // copied into the ring and uploaded this frame
+	unsigned uploads = 0; // glCompressedTexSubImage2D calls
+	double updateMilliseconds = 0.0; // time spent inside update()
+	double frameMilliseconds = 0.0; // since the previous update()
+};
+
+struct StreamingStats
+{
+	uint64_t bytes = 0;
+	unsigned uploads = 0;
+	unsigned frames = 0; // frames that uploaded anything
+	uint64_t peakFrameBytes = 0;
+	double updateMilliseconds = 0.0;
+	double worstUpdateMilliseconds = 0.0;
+	double worstFrameMilliseconds = 0.0;
+	unsigned spikes = 0; // frames over spikeFactor times the running average while streaming
+	double waitMilliseconds = 0.0; // on ring regions the GPU was still reading from
+};
+
+class TextureStreamer
+{
+public:
+	static const size_t DEFAULT_FRAME_BUDGET = 2 * 1024 * 1024;
+	static const int REGION_COUNT = 3;
+
+	typedef int Handle;
+
+	// needs a current context. frameBudget is the upload bytes allowed per update(), each ring region holds one frame.
+	TextureStreamer(ThreadPool & pool, size_t frameBudget = DEFAULT_FRAME_BUDGET);
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer &) = delete;
+	TextureStreamer & operator=(const TextureStreamer &) = delete;
+
+	Handle stream2D(const std::string & path, TextureFormat format, bool normalMap = false);
+
+	// faces in GL_TEXTURE_CUBE_MAP_POSITIVE_X order, all the same size
+	Handle streamCubeMap(const std::vector<std::string> & facePaths, TextureFormat format);
+
+	// GL thread, once per frame. Leaves GL_PIXEL_UNPACK_BUFFER unbound and the texture it last uploaded to bound.
+	void update();
+
+	// the streamed texture once its smallest level is resident, the placeholder of its target until then
+	GLuint texture(Handle handle) const;
+	GLenum target(Handle handle) const;
+
+	// lowest resident level, equal to levelCount() while nothing is in. levelCount() is 0 until every face is mapped.
+	uint32_t residentLevel(Handle handle) const;
+	uint32_t levelCount(Handle handle) const;
+	bool failed(Handle handle) const;
+
+	// true when every texture is fully resident or failed
+	bool finished() const;
+
+	// bytes per frame, at most a ring region
+	void setFrameBudget(size_t bytes);
+	size_t frameBudget() const { return budget; }
+
+	// a frame counts as a spike when it takes this many times the running average
+	void setSpikeFactor(double factor) { spikeFactor = factor; }
+
+	const StreamingFrameStats & lastFrame() const { return frame; }
+	const StreamingStats & statistics() const { return stats; }
+	void printStatistics() const;
+
+	// Waits for the workers and deletes the ring and every texture, before the context goes away.
+	void release();
+
+private:
+	struct Face
+	{
+		std::string path;
+		TextureCache cache;
+		// lowest level whose pages have been touched, written by the worker once the cache is mapped
+		std::atomic<uint32_t> readyLevel;
+		std::atomic<bool> mapped;
+		std::atomic<bool> failed;
+		uint32_t uploadedRows = 0; // block rows of the level being streamed
+	};
+
+	struct StreamedTexture
+	{
+		GLenum target;
+		TextureFormat format;
+		bool normalMap;
+		std::vector<std::unique_ptr<Face>> faces;
+		GLuint texture = 0;
+		uint32_t levels = 0; // known once every face is mapped
+		uint32_t resident = 0; // lowest level on the GPU for every face, levels when none
+		bool failed = false;
+	};
+
+	Handle add(GLenum target, const std::vector<std::string> & paths, TextureFormat format, bool normalMap);
+	void prepare(Face & face, TextureFormat format, bool normalMap);
+	bool allocate(StreamedTexture & streamed);
+	StreamedTexture * nextUpload();
+	void uploadStripe(StreamedTexture & streamed, size_t & remaining);
+	void endFrame();
+
+	ThreadPool & pool;
+	std::vector<std::unique_ptr<StreamedTexture>> textures;
+	GLuint placeholder2D = 0;
+	GLuint placeholderCube = 0;
+
+	GLuint ring = 0;
+	uint8_t * mapped = nullptr;
+	size_t regionBytes = 0;
+	int region = 0;
+	size_t regionUsed = 0;
+	GLsync fences[REGION_COUNT] = {};
+
+	size_t budget;
+	double spikeFactor = 2.0;
+	double averageFrameMilliseconds = 0.0;
+	bool firstUpdate = true;
+	Timer frameTimer;
+	StreamingFrameStats frame;
+	StreamingStats stats;
+};
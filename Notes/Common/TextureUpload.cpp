@@ -0,0 +1,40 @@
+#include "TextureUpload.h"
+
+GLenum compressedInternalFormat(TextureFormat format)
+{
+	switch (format)
+	{
+	case TEXTURE_FORMAT_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case TEXTURE_FORMAT_BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case TEXTURE_FORMAT_BC5: return GL_COMPRESSED_RG_RGTC2;
+	default: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+}
+
+void allocateTextureStorage(GLenum target, const TextureCache & cache)
+{
+	glTexStorage2D(target, cache.header->levelCount, compressedInternalFormat(cache.format()), cache.header->width, cache.header->height);
+}
+
+void uploadTextureLevels(GLenum target, const TextureCache & cache)
+{
+	GLenum internalFormat = compressedInternalFormat(cache.format());
+	for (uint32_t level = 0; level < cache.header->levelCount; level++)
+	{
+		const TextureCacheLevel & info = cache.levels[level];
+		glCompressedTexSubImage2D(target, level, 0, 0, info.width, info.height, internalFormat,
+			static_cast<GLsizei>(info.size), cache.levelData(level));
+	}
+}
+
+GLuint createTexture(const TextureCache & cache)
+{
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	allocateTextureStorage(GL_TEXTURE_2D, cache);
+	uploadTextureLevels(GL_TEXTURE_2D, cache);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	return texture;
+}
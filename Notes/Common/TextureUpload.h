@@ -0,0 +1,25 @@
+#pragma once
+#include <glad\glad.h>
+#include "TextureCache.h"
+
+/*GL side of the texture cache, kept apart from it so the headless benchmarks can bake and inspect caches without
+linking GL. BC1 and BC3 are S3TC, which every desktop driver has but is not part of core GL, so glad does not know
+the enums.*/
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+GLenum compressedInternalFormat(TextureFormat format);
+
+// glTexStorage2D for the whole chain of cache on the bound texture of target (GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP)
+void allocateTextureStorage(GLenum target, const TextureCache & cache);
+
+// Every level straight from the mapped file, target is GL_TEXTURE_2D or one cube map face. Storage has to exist.
+void uploadTextureLevels(GLenum target, const TextureCache & cache);
+
+// A new trilinear filtered GL_TEXTURE_2D holding the whole chain, left bound to the active unit.
+GLuint createTexture(const TextureCache & cache);
@@ -0,0 +1,116 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount) : activeJobs(0), stopping(false)
+{
+	if (threadCount == 0) {
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	workers.reserve(threadCount);
+	for (unsigned i = 0; i < threadCount; i++)
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+
+	for (auto & worker : workers) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	jobsFinished.wait(lock, [this] { return jobs.empty() && activeJobs == 0; });
+}
+
+// shared with the helper jobs, which can still be sitting in the queue after parallelFor has returned
+struct ParallelBatch
+{
+	std::function<void(size_t)> body;
+	size_t count;
+	std::atomic<size_t> next;
+	std::atomic<size_t> completed;
+	std::mutex mutex;
+	std::condition_variable done;
+
+	void run()
+	{
+		for (size_t i = next++; i < count; i = next++)
+		{
+			body(i);
+			if (++completed == count) {
+				std::lock_guard<std::mutex> lock(mutex);
+				done.notify_all();
+			}
+		}
+	}
+};
+
+void ThreadPool::parallelFor(size_t count, std::function<void(size_t)> body)
+{
+	if (count == 0) return;
+
+	auto batch = std::make_shared<ParallelBatch>();
+	batch->body = std::move(body);
+	batch->count = count;
+	batch->next = 0;
+	batch->completed = 0;
+
+	size_t helpers = std::min(count - 1, workers.size());
+	for (size_t i = 0; i < helpers; i++)
+		submit([batch] { batch->run(); });
+
+	batch->run();
+
+	std::unique_lock<std::mutex> lock(batch->mutex);
+	batch->done.wait(lock, [&] { return batch->completed == batch->count; });
+}
+
+void ThreadPool::forEach(ThreadPool * pool, size_t count, const std::function<void(size_t)> & body)
+{
+	if (pool && count > 1) pool->parallelFor(count, body);
+	else for (size_t i = 0; i < count; i++) body(i);
+}
+
+void ThreadPool::workerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (stopping && jobs.empty()) return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			activeJobs++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			activeJobs--;
+			if (jobs.empty() && activeJobs == 0) jobsFinished.notify_all();
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*Fixed set of worker threads pulling jobs off one shared queue. Jobs must not touch GL, the context only
+lives on the thread that created the window, so anything that ends in a GL call is handed back (see AssetLoader).*/
+class ThreadPool
+{
+public:
+	// 0 threads means one per hardware thread, minus the one the demo renders on
+	explicit ThreadPool(unsigned threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool & operator=(const ThreadPool &) = delete;
+
+	void submit(std::function<void()> job);
+
+	// Blocks until the queue is empty and every worker is idle.
+	void wait();
+
+	// Runs body(0) .. body(count - 1) spread over the workers and the calling thread, returns when all are done.
+	// The caller works through the items itself, so this is safe to call from inside a job.
+	void parallelFor(size_t count, std::function<void(size_t)> body);
+
+	// parallelFor on pool, or a plain loop on the calling thread when there is no pool or only one item
+	static void forEach(ThreadPool * pool, size_t count, const std::function<void(size_t)> & body);
+
+	unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+	void workerLoop();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobsFinished;
+	unsigned activeJobs;
+	bool stopping;
+};
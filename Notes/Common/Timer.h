@@ -0,0 +1,21 @@
+#pragma once
+#include <chrono>
+
+// Small wall clock stopwatch used by the loaders and benchmarks to report where startup time goes.
+class Timer
+{
+public:
+	Timer() : start(std::chrono::high_resolution_clock::now()) {}
+
+	void reset() { start = std::chrono::high_resolution_clock::now(); }
+
+	double elapsedMilliseconds() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	double elapsedSeconds() const { return elapsedMilliseconds() / 1000.0; }
+
+private:
+	std::chrono::high_resolution_clock::time_point start;
+};
@@ -0,0 +1,273 @@
+#include "VertexFormat.h"
+#include "TangentSpace.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+static const char * decodeSource = R"(
+layout (location = 0) in vec4 vPosition;
+layout (location = 1) in vec4 vNormal; // the tangent frame quaternion for the qtangent layout
+layout (location = 2) in vec2 vTexCoord;
+layout (location = 3) in vec4 vTangent;
+
+uniform int vertexEncoding; // 0 float, 1 packed, 2 qtangent
+uniform vec3 positionScale; // 1 and 0 for the float layout so positions need no branch
+uniform vec3 positionOffset;
+
+vec4 decodePosition()
+{
+	return vec4(positionOffset + positionScale * vPosition.xyz, 1.0);
+}
+
+// columns 2 and 0 of the rotation matrix of the quaternion, the handedness is the sign of w
+void decodeTangentFrame(out vec3 normal, out vec4 tangent)
+{
+	vec4 q = normalize(vNormal);
+	normal = vec3(2.0 * (q.x * q.z + q.w * q.y), 2.0 * (q.y * q.z - q.w * q.x), 1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+	tangent.xyz = vec3(1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.w * q.z), 2.0 * (q.x * q.z - q.w * q.y));
+	tangent.w = vNormal.w < 0.0 ? -1.0 : 1.0;
+}
+
+vec3 decodeNormal()
+{
+	if (vertexEncoding == 0)
+		return vNormal.xyz;
+
+	if (vertexEncoding == 2) {
+		vec3 normal;
+		vec4 tangent;
+		decodeTangentFrame(normal, tangent);
+		return normal;
+	}
+
+	// octahedral, the lower hemisphere is folded over the diagonals
+	vec3 n = vec3(vNormal.xy, 1.0 - abs(vNormal.x) - abs(vNormal.y));
+	if (n.z < 0.0)
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
+// xyz and the bitangent sign, bitangent = w * cross(normal, tangent). Zero for the packed layout.
+vec4 decodeTangent()
+{
+	if (vertexEncoding == 0)
+		return vTangent;
+
+	if (vertexEncoding == 2) {
+		vec3 normal;
+		vec4 tangent;
+		decodeTangentFrame(normal, tangent);
+		return tangent;
+	}
+
+	return vec4(0.0);
+}
+
+vec2 decodeTexCoord()
+{
+	return vTexCoord; // half floats are widened by the vertex fetch
+}
+)";
+
+const char * vertexDecodeSource()
+{
+	return decodeSource;
+}
+
+const char * vertexEncodingName(VertexEncoding encoding)
+{
+	switch (encoding)
+	{
+	case VERTEX_ENCODING_FLOAT: return "float";
+	case VERTEX_ENCODING_PACKED: return "packed";
+	case VERTEX_ENCODING_QTANGENT: return "qtangent";
+	default: return "unknown";
+	}
+}
+
+size_t vertexEncodingSize(VertexEncoding encoding)
+{
+	switch (encoding)
+	{
+	case VERTEX_ENCODING_FLOAT: return sizeof(float) * 12;
+	case VERTEX_ENCODING_PACKED: return sizeof(PackedVertex);
+	case VERTEX_ENCODING_QTANGENT: return sizeof(QTangentVertex);
+	default: return 0;
+	}
+}
+
+uint16_t floatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t mantissa = bits & 0x7fffff;
+	int32_t exponent = int32_t((bits >> 23) & 0xff) - 127 + 15;
+
+	if (((bits >> 23) & 0xff) == 0xff) // inf and nan
+		return uint16_t(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+	if (exponent >= 31)
+		return uint16_t(sign | 0x7c00);
+
+	uint32_t half, rest, halfway;
+	if (exponent <= 0) {
+		// denormal, or zero when even the implicit bit is shifted out
+		if (exponent < -10)
+			return uint16_t(sign);
+		mantissa |= 0x800000;
+		uint32_t shift = 14 - exponent;
+		half = mantissa >> shift;
+		rest = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+	}
+	else {
+		half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+		rest = mantissa & 0x1fff;
+		halfway = 0x1000;
+	}
+
+	// round to nearest even, a carry into the exponent is still the right answer
+	if (rest > halfway || (rest == halfway && (half & 1)))
+		half++;
+	return uint16_t(sign | half);
+}
+
+static int16_t toSnorm16(float value)
+{
+	return int16_t(std::round(std::max(-1.0f, std::min(1.0f, value)) * 32767.0f));
+}
+
+void encodeOctahedral(const float normal[3], int16_t encoded[2])
+{
+	float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+	if (length == 0.0f) {
+		// meshes without normals are zero filled, any direction will do
+		encoded[0] = encoded[1] = 0;
+		return;
+	}
+
+	float u = normal[0] / length;
+	float v = normal[1] / length;
+	if (normal[2] < 0.0f) {
+		float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+		float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+		u = foldedU;
+		v = foldedV;
+	}
+
+	encoded[0] = toSnorm16(u);
+	encoded[1] = toSnorm16(v);
+}
+
+void encodeVertices(const MeshCache & cache, VertexEncoding encoding, EncodedVertices & encoded)
+{
+	size_t vertexCount = cache.header->vertexCount;
+	const float * positions = reinterpret_cast<const float*>(static_cast<const uint8_t*>(cache.vertexData()) + cache.positionOffset());
+	const float * normals = reinterpret_cast<const float*>(static_cast<const uint8_t*>(cache.vertexData()) + cache.normalOffset());
+	const float * uvs = reinterpret_cast<const float*>(static_cast<const uint8_t*>(cache.vertexData()) + cache.uvOffset());
+	const float * tangents = reinterpret_cast<const float*>(static_cast<const uint8_t*>(cache.vertexData()) + cache.tangentOffset());
+
+	encoded = EncodedVertices();
+	encoded.encoding = encoding;
+	encoded.vertexCount = vertexCount;
+	encoded.normalOffset = cache.normalOffset();
+	encoded.uvOffset = cache.uvOffset();
+	encoded.tangentOffset = cache.tangentOffset();
+
+	if (encoding == VERTEX_ENCODING_FLOAT)
+		return;
+
+	// the header bounds cover the whole cache so every submesh shares one dequantize transform
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = cache.header->boundsMax[axis] - cache.header->boundsMin[axis];
+		encoded.positionOffset[axis] = cache.header->boundsMin[axis];
+		encoded.positionScale[axis] = extent > 0.0f ? extent : 0.0f;
+	}
+
+	auto quantizePosition = [&](size_t i, uint16_t position[4]) {
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float scale = encoded.positionScale[axis];
+			float t = scale > 0.0f ? (positions[i * 3 + axis] - encoded.positionOffset[axis]) / scale : 0.0f;
+			position[axis] = uint16_t(std::round(std::max(0.0f, std::min(1.0f, t)) * 65535.0f));
+		}
+		position[3] = 0;
+	};
+
+	if (encoding == VERTEX_ENCODING_QTANGENT) {
+		encoded.data.resize(vertexCount * sizeof(QTangentVertex));
+		QTangentVertex * vertices = reinterpret_cast<QTangentVertex*>(encoded.data.data());
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			quantizePosition(i, vertices[i].position);
+			encodeQTangent(&normals[i * 3], &tangents[i * 4], vertices[i].tangentFrame);
+			vertices[i].uv[0] = floatToHalf(uvs[i * 2 + 0]);
+			vertices[i].uv[1] = floatToHalf(uvs[i * 2 + 1]);
+		}
+		return;
+	}
+
+	encoded.data.resize(vertexCount * sizeof(PackedVertex));
+	PackedVertex * packed = reinterpret_cast<PackedVertex*>(encoded.data.data());
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		quantizePosition(i, packed[i].position);
+		encodeOctahedral(&normals[i * 3], packed[i].normal);
+
+		packed[i].uv[0] = floatToHalf(uvs[i * 2 + 0]);
+		packed[i].uv[1] = floatToHalf(uvs[i * 2 + 1]);
+	}
+}
+
+const void * encodedVertexData(const MeshCache & cache, const EncodedVertices & encoded)
+{
+	return encoded.encoding == VERTEX_ENCODING_FLOAT ? cache.vertexData() : encoded.data.data();
+}
+
+size_t encodedVertexBytes(const MeshCache & cache, const EncodedVertices & encoded)
+{
+	return encoded.encoding == VERTEX_ENCODING_FLOAT ? cache.vertexBytes() : encoded.data.size();
+}
+
+void setupVertexAttributes(const EncodedVertices & encoded)
+{
+	if (encoded.encoding == VERTEX_ENCODING_FLOAT) {
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(0));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(encoded.normalOffset));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(encoded.uvOffset));
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(encoded.tangentOffset));
+	}
+	else if (encoded.encoding == VERTEX_ENCODING_QTANGENT) {
+		GLsizei stride = sizeof(QTangentVertex);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, reinterpret_cast<void*>(offsetof(QTangentVertex, position)));
+		glVertexAttribPointer(1, 4, GL_SHORT, GL_TRUE, stride, reinterpret_cast<void*>(offsetof(QTangentVertex, tangentFrame)));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(QTangentVertex, uv)));
+	}
+	else {
+		GLsizei stride = sizeof(PackedVertex);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, reinterpret_cast<void*>(offsetof(PackedVertex, position)));
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, reinterpret_cast<void*>(offsetof(PackedVertex, normal)));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(PackedVertex, uv)));
+	}
+
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+
+	// only the float layout streams a separate tangent, the others leave location 3 at its constant default
+	if (encoded.encoding == VERTEX_ENCODING_FLOAT) glEnableVertexAttribArray(3);
+	else glDisableVertexAttribArray(3);
+}
+
+void setVertexDecodeUniforms(GLuint program, const EncodedVertices & encoded)
+{
+	glUniform1i(glGetUniformLocation(program, "vertexEncoding"), static_cast<GLint>(encoded.encoding));
+	glUniform3fv(glGetUniformLocation(program, "positionScale"), 1, encoded.positionScale);
+	glUniform3fv(glGetUniformLocation(program, "positionOffset"), 1, encoded.positionOffset);
+}
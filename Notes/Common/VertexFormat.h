@@ -0,0 +1,88 @@
+#pragma once
+#include <glad\glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MeshCache.h"
+
+/*Vertex encodings for the cached meshes
+
+The cache stores 48 bytes per vertex (float3 position, float3 normal, float2 uv, float4 tangent and bitangent sign).
+Most of that precision is never seen on screen, so the packed encoding cuts it to 16 bytes per vertex, interleaved:
+
+	uint16 x 4 : position, unorm over the mesh bounding box (w is padding)
+	int16  x 2 : normal, octahedral mapped snorm
+	half   x 2 : uv
+
+It has no room for a tangent, so normal mapping needs the qtangent encoding, 20 bytes per vertex:
+
+	uint16 x 4 : position, as above
+	int16  x 4 : the whole tangent frame as one quaternion (encodeQTangent in TangentSpace)
+	half   x 2 : uv
+
+Positions are dequantized in the vertex shader as positionOffset + positionScale * p, so a shader prepended with
+vertexDecodeSource() calls decodePosition(), decodeNormal(), decodeTangent() and decodeTexCoord() instead of declaring
+the inputs itself. The vertexEncoding uniform picks the decode at runtime so a single program draws every layout.
+decodeTangent() returns zero for the packed layout, shaders fall back to the vertex normal on that.*/
+
+enum VertexEncoding
+{
+	VERTEX_ENCODING_FLOAT,
+	VERTEX_ENCODING_PACKED,
+	VERTEX_ENCODING_QTANGENT,
+	VERTEX_ENCODING_COUNT,
+};
+
+const char * vertexEncodingName(VertexEncoding encoding);
+
+// bytes fetched per vertex, the sum of the planar attributes for VERTEX_ENCODING_FLOAT
+size_t vertexEncodingSize(VertexEncoding encoding);
+
+struct PackedVertex
+{
+	uint16_t position[4];
+	int16_t normal[2];
+	uint16_t uv[2];
+};
+
+struct QTangentVertex
+{
+	uint16_t position[4];
+	int16_t tangentFrame[4];
+	uint16_t uv[2];
+};
+
+struct EncodedVertices
+{
+	VertexEncoding encoding = VERTEX_ENCODING_FLOAT;
+	std::vector<uint8_t> data; // empty for VERTEX_ENCODING_FLOAT, the cache is uploaded as it is
+	float positionScale[3] = { 1.0f, 1.0f, 1.0f };
+	float positionOffset[3] = { 0.0f, 0.0f, 0.0f };
+	size_t vertexCount = 0;
+
+	// planar offsets inside the cache's vertex block, only used by VERTEX_ENCODING_FLOAT
+	size_t normalOffset = 0;
+	size_t uvOffset = 0;
+	size_t tangentOffset = 0;
+};
+
+// Converts every vertex of the cache so the submesh vertex offsets stay valid for either encoding.
+void encodeVertices(const MeshCache & cache, VertexEncoding encoding, EncodedVertices & encoded);
+
+// The bytes to hand to glBufferData, points into the mapped cache for VERTEX_ENCODING_FLOAT.
+const void * encodedVertexData(const MeshCache & cache, const EncodedVertices & encoded);
+size_t encodedVertexBytes(const MeshCache & cache, const EncodedVertices & encoded);
+
+// Attribute pointers for locations 0 (position), 1 (normal or tangent frame), 2 (uv) and 3 (tangent, float only) on the
+// bound vertex array and array buffer.
+void setupVertexAttributes(const EncodedVertices & encoded);
+
+// Sets the uniforms declared by vertexDecodeSource(), the program must be in use.
+void setVertexDecodeUniforms(GLuint program, const EncodedVertices & encoded);
+
+// GLSL declaring the vertex inputs and the decode functions, goes right after the #version line.
+const char * vertexDecodeSource();
+
+// Octahedral normal mapping to two snorm16 and round to nearest float to half conversion.
+void encodeOctahedral(const float normal[3], int16_t encoded[2]);
+uint16_t floatToHalf(float value);
@@ -0,0 +1,732 @@
+#include "Wavefront.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <emmintrin.h>
+#include <functional>
+
+// pixels along the side of the tiles camera rays are generated in
+static const uint32_t GENERATE_TILE = 8;
+
+// bits per axis of the origin cells, 3 * 7 of them below the 3 octant bits make a sort key of three bytes
+static const uint32_t CELL_BITS = 7;
+
+static const float PI = 3.14159265358979f;
+
+// the low ten bits of x two bits apart, for the Morton code of a cell
+static uint32_t spreadBits(uint32_t x)
+{
+	x &= 0x3ff;
+	x = (x | x << 16) & 0x030000ff;
+	x = (x | x << 8) & 0x0300f00f;
+	x = (x | x << 4) & 0x030c30c3;
+	x = (x | x << 2) & 0x09249249;
+	return x;
+}
+
+static uint32_t hash(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+// the same number for a path's pixel, bounce and dimension whichever renderer asks and in whatever order
+static float pathRandom(uint32_t pixel, uint32_t bounce, uint32_t dimension, uint32_t seed)
+{
+	uint32_t bits = hash(hash(pixel ^ seed * 0x85ebca6bu) ^ ((bounce * 2 + dimension) * 0x9e3779b9u));
+	return (bits >> 8) * (1.0f / 16777216.0f);
+}
+
+static bool traceNearest(const WavefrontScene & scene, const BvhRay & ray, BvhHit & hit)
+{
+	return scene.instances ? scene.instances->intersect(ray, hit) : scene.mesh->intersect(ray, hit, nullptr, true);
+}
+
+static bool traceAny(const WavefrontScene & scene, const BvhRay & ray)
+{
+	return scene.instances ? scene.instances->occluded(ray) : scene.mesh->occluded(ray, nullptr, true);
+}
+
+static uint32_t traceNearest(const WavefrontScene & scene, const BvhPacket & packet, BvhPacketHit & hits)
+{
+	return scene.instances ? scene.instances->intersect(packet, hits) : scene.mesh->intersect(packet, hits);
+}
+
+static uint32_t traceAny(const WavefrontScene & scene, const BvhPacket & packet)
+{
+	return scene.instances ? scene.instances->occluded(packet) : scene.mesh->occluded(packet);
+}
+
+static void cameraRay(const RayCamera & camera, uint32_t x, uint32_t y, float inverseWidth, float inverseHeight,
+	glm::vec3 & origin, glm::vec3 & direction)
+{
+	float u = (x + camera.pixelOffset) * inverseWidth;
+	float v = (y + camera.pixelOffset) * inverseHeight;
+	origin = camera.origin + camera.originU * u + camera.originV * v;
+	direction = camera.direction + camera.directionU * u + camera.directionV * v;
+}
+
+static glm::vec3 missColor(const WavefrontScene & scene, const WavefrontOptions & options, uint32_t bounce)
+{
+	return bounce ? scene.background * options.skyIntensity : scene.background;
+}
+
+namespace {
+
+// what a path does at a hit: the light a shadow ray from there would bring, and where it bounces. The wavefront shades
+// four hits at a time in SSE2 lanes with the same arithmetic.
+struct PathHit
+{
+	glm::vec3 start; // the hit, moved off the surface
+	bool lit; // the light is in front of the surface
+	glm::vec3 toLight;
+	glm::vec3 light;
+	glm::vec3 direction;
+	glm::vec3 throughput;
+};
+
+}
+
+static PathHit shadeHit(const WavefrontScene & scene, const glm::vec3 & origin, const glm::vec3 & direction,
+	const BvhHit & hit, const glm::vec3 & throughput, uint32_t pixel, uint32_t bounce, uint32_t seed)
+{
+	// geometric normal of the triangle, turned to face the ray
+	const uint32_t * corner = scene.indices + size_t(hit.triangle) * 3;
+	glm::vec3 p0 = scene.positions[corner[0]], p1 = scene.positions[corner[1]], p2 = scene.positions[corner[2]];
+	glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+	if (scene.instances && scene.normalMatrices) normal = scene.normalMatrices[hit.instance] * normal;
+	normal = glm::normalize(normal);
+	if (glm::dot(normal, direction) > 0.0f) normal = -normal;
+
+	PathHit path;
+	path.start = origin + direction * hit.distance + normal * scene.offset;
+	path.toLight = scene.light - path.start;
+	float cosine = glm::dot(normal, path.toLight);
+	path.lit = cosine > 0.0f;
+	path.light = throughput * scene.diffuse * (cosine / std::max(glm::length(path.toLight), FLT_MIN));
+
+	// cosine distributed around the normal, which cancels the Lambert term of the bounce
+	glm::vec3 tangent = glm::normalize(glm::cross(std::fabs(normal.x) > 0.5f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f), normal));
+	glm::vec3 bitangent = glm::cross(normal, tangent);
+	float r = std::sqrt(pathRandom(pixel, bounce, 0, seed));
+	float phi = 2.0f * PI * pathRandom(pixel, bounce, 1, seed);
+	path.direction = tangent * (r * std::cos(phi)) + bitangent * (r * std::sin(phi)) + normal * std::sqrt(std::max(0.0f, 1.0f - r * r));
+	path.throughput = throughput * scene.diffuse;
+	return path;
+}
+
+static BvhRay shadowRay(const PathHit & path)
+{
+	BvhRay ray;
+	ray.origin = path.start;
+	ray.direction = path.toLight;
+	ray.maxDistance = 1.0f;
+	return ray;
+}
+
+namespace {
+
+uint32_t bitCount(uint32_t mask)
+{
+	uint32_t count = 0;
+	for (; mask; mask &= mask - 1) count++;
+	return count;
+}
+
+// a glm::vec3 in each of four SSE2 lanes, with the operators shadeHit uses in the order glm does them
+struct LaneVec3
+{
+	__m128 x, y, z;
+};
+
+LaneVec3 laneVec3(const glm::vec3 & v)
+{
+	return { _mm_set1_ps(v.x), _mm_set1_ps(v.y), _mm_set1_ps(v.z) };
+}
+
+LaneVec3 operator+(const LaneVec3 & a, const LaneVec3 & b)
+{
+	return { _mm_add_ps(a.x, b.x), _mm_add_ps(a.y, b.y), _mm_add_ps(a.z, b.z) };
+}
+
+LaneVec3 operator-(const LaneVec3 & a, const LaneVec3 & b)
+{
+	return { _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) };
+}
+
+LaneVec3 operator*(const LaneVec3 & a, const LaneVec3 & b)
+{
+	return { _mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y), _mm_mul_ps(a.z, b.z) };
+}
+
+LaneVec3 operator*(const LaneVec3 & a, __m128 s)
+{
+	return { _mm_mul_ps(a.x, s), _mm_mul_ps(a.y, s), _mm_mul_ps(a.z, s) };
+}
+
+__m128 dot(const LaneVec3 & a, const LaneVec3 & b)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+LaneVec3 cross(const LaneVec3 & a, const LaneVec3 & b)
+{
+	return {
+		_mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(b.y, a.z)),
+		_mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(b.z, a.x)),
+		_mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(b.x, a.y)) };
+}
+
+LaneVec3 normalize(const LaneVec3 & v)
+{
+	return v * _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(dot(v, v)));
+}
+
+// one wavefront of rays as structure of arrays
+struct RayQueue
+{
+	std::vector<float> originX, originY, originZ;
+	std::vector<float> directionX, directionY, directionZ;
+	std::vector<float> weightR, weightG, weightB; // throughput of a path, the light a shadow ray brings
+	std::vector<uint32_t> pixel;
+	size_t count = 0;
+
+	void resize(size_t size)
+	{
+		for (auto array : { &originX, &originY, &originZ, &directionX, &directionY, &directionZ, &weightR, &weightG, &weightB })
+			array->resize(size);
+		pixel.resize(size);
+		count = size;
+	}
+
+	glm::vec3 origin(size_t i) const { return glm::vec3(originX[i], originY[i], originZ[i]); }
+	glm::vec3 direction(size_t i) const { return glm::vec3(directionX[i], directionY[i], directionZ[i]); }
+	glm::vec3 weight(size_t i) const { return glm::vec3(weightR[i], weightG[i], weightB[i]); }
+
+	void set(size_t i, const glm::vec3 & origin, const glm::vec3 & direction, const glm::vec3 & weight, uint32_t target)
+	{
+		originX[i] = origin.x;
+		originY[i] = origin.y;
+		originZ[i] = origin.z;
+		directionX[i] = direction.x;
+		directionY[i] = direction.y;
+		directionZ[i] = direction.z;
+		weightR[i] = weight.x;
+		weightG[i] = weight.y;
+		weightB[i] = weight.z;
+		pixel[i] = target;
+	}
+
+	void copy(size_t i, const RayQueue & from, size_t j)
+	{
+		set(i, from.origin(j), from.direction(j), from.weight(j), from.pixel[j]);
+	}
+
+	// rays [i, i + lanes) as a packet, the lanes past them repeating the last one
+	void packet(size_t i, uint32_t lanes, float maxDistance, BvhPacket & packet) const
+	{
+		for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+		{
+			size_t j = i + std::min(lane, lanes - 1);
+			packet.originX[lane] = originX[j];
+			packet.originY[lane] = originY[j];
+			packet.originZ[lane] = originZ[j];
+			packet.directionX[lane] = directionX[j];
+			packet.directionY[lane] = directionY[j];
+			packet.directionZ[lane] = directionZ[j];
+			packet.minDistance[lane] = 0.0f;
+			packet.maxDistance[lane] = maxDistance;
+		}
+		packet.mask = (1u << lanes) - 1;
+	}
+};
+
+struct HitQueue
+{
+	std::vector<float> distance;
+	std::vector<uint32_t> triangle;
+	std::vector<uint32_t> instance;
+	std::vector<char> hit;
+
+	void resize(size_t size)
+	{
+		distance.resize(size);
+		triangle.resize(size);
+		instance.resize(size);
+		hit.resize(size);
+	}
+};
+
+// Every stage works on the queues in blocks over the pool, the renderer keeps them between bounces so later bounces
+// reuse the memory of the first. Blocks are traced and shaded four rays at a time, and whatever a stage packs or
+// reorders is counted per block first, so that a prefix sum over the counts gives each block where its rays go.
+struct Wavefront
+{
+	const WavefrontScene & scene;
+	const WavefrontOptions & options;
+	ThreadPool * pool;
+	uint32_t width, height;
+	std::vector<glm::vec3> & colors;
+
+	RayQueue rays, shadows, spare;
+	HitQueue hits;
+	std::vector<size_t> shadowOffsets, nextOffsets; // per block and one past the last
+	std::vector<uint32_t> keys, sortedKeys, order, sortedOrder;
+	std::vector<size_t> digitOffsets; // per block and digit
+
+	Wavefront(const WavefrontScene & scene, const WavefrontOptions & options, ThreadPool * pool, uint32_t width,
+		uint32_t height, std::vector<glm::vec3> & colors)
+		: scene(scene), options(options), pool(pool), width(width), height(height), colors(colors) {}
+
+	size_t blockSize() const { return std::max(options.blockSize, 1u); }
+	size_t blockCount(size_t count) const { return (count + blockSize() - 1) / blockSize(); }
+
+	void blocks(size_t count, const std::function<void(size_t, size_t)> & body)
+	{
+		size_t size = blockSize();
+		ThreadPool::forEach(pool, blockCount(count), [&](size_t block) {
+			body(block * size, std::min((block + 1) * size, count));
+		});
+	}
+
+	// camera rays for every pixel, tile after tile, so neighbouring rays in the queue are neighbours on screen
+	void generate()
+	{
+		rays.resize(size_t(width) * height);
+		float inverseWidth = 1.0f / width, inverseHeight = 1.0f / height;
+		const RayCamera & camera = scene.camera;
+		uint32_t tileRows = (height + GENERATE_TILE - 1) / GENERATE_TILE;
+
+		ThreadPool::forEach(pool, tileRows, [&](size_t tileRow) {
+			uint32_t y0 = static_cast<uint32_t>(tileRow) * GENERATE_TILE, y1 = std::min(y0 + GENERATE_TILE, height);
+			size_t slot = size_t(y0) * width;
+			__m128 origin[3], originU[3], direction[3], directionU[3];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				origin[axis] = _mm_set1_ps(camera.origin[axis]);
+				originU[axis] = _mm_set1_ps(camera.originU[axis]);
+				direction[axis] = _mm_set1_ps(camera.direction[axis]);
+				directionU[axis] = _mm_set1_ps(camera.directionU[axis]);
+			}
+			for (uint32_t x0 = 0; x0 < width; x0 += GENERATE_TILE)
+			{
+				uint32_t x1 = std::min(x0 + GENERATE_TILE, width);
+				for (uint32_t y = y0; y < y1; y++)
+				{
+					float v = (y + camera.pixelOffset) * inverseHeight;
+					__m128 originV[3], directionV[3];
+					for (int axis = 0; axis < 3; axis++)
+					{
+						originV[axis] = _mm_set1_ps(camera.originV[axis] * v);
+						directionV[axis] = _mm_set1_ps(camera.directionV[axis] * v);
+					}
+
+					// four pixels of the row at a time, the same arithmetic as cameraRay in the same order
+					uint32_t x = x0;
+					for (; x + 4 <= x1; x += 4, slot += 4)
+					{
+						__m128 column = _mm_add_ps(_mm_setr_ps(float(x), float(x + 1), float(x + 2), float(x + 3)), _mm_set1_ps(camera.pixelOffset));
+						__m128 u = _mm_mul_ps(column, _mm_set1_ps(inverseWidth));
+						float * origins[3] = { &rays.originX[slot], &rays.originY[slot], &rays.originZ[slot] };
+						float * directions[3] = { &rays.directionX[slot], &rays.directionY[slot], &rays.directionZ[slot] };
+						for (int axis = 0; axis < 3; axis++)
+						{
+							_mm_storeu_ps(origins[axis], _mm_add_ps(_mm_add_ps(origin[axis], _mm_mul_ps(originU[axis], u)), originV[axis]));
+							_mm_storeu_ps(directions[axis], _mm_add_ps(_mm_add_ps(direction[axis], _mm_mul_ps(directionU[axis], u)), directionV[axis]));
+						}
+						for (uint32_t lane = 0; lane < 4; lane++)
+						{
+							rays.weightR[slot + lane] = rays.weightG[slot + lane] = rays.weightB[slot + lane] = 1.0f;
+							rays.pixel[slot + lane] = y * width + x + lane;
+						}
+					}
+					for (; x < x1; x++, slot++)
+					{
+						glm::vec3 rayOrigin, rayDirection;
+						cameraRay(camera, x, y, inverseWidth, inverseHeight, rayOrigin, rayDirection);
+						rays.set(slot, rayOrigin, rayDirection, glm::vec3(1.0f), y * width + x);
+					}
+				}
+			}
+		});
+	}
+
+	// octant of the direction, then the Morton code of the origin's cell, radix sorted a byte at a time
+	void sort(RayQueue & queue)
+	{
+		size_t count = queue.count;
+		keys.resize(count);
+		order.resize(count);
+		glm::vec3 low = scene.boundsMin;
+		glm::vec3 scale = float(1u << CELL_BITS) / glm::max(scene.boundsMax - scene.boundsMin, glm::vec3(1e-20f));
+
+		blocks(count, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				uint32_t octant = (queue.directionX[i] < 0.0f ? 1 : 0) | (queue.directionY[i] < 0.0f ? 2 : 0) | (queue.directionZ[i] < 0.0f ? 4 : 0);
+				glm::vec3 cell = glm::clamp((queue.origin(i) - low) * scale, glm::vec3(0.0f), glm::vec3(float((1u << CELL_BITS) - 1)));
+				uint32_t morton = spreadBits(static_cast<uint32_t>(cell.x)) | spreadBits(static_cast<uint32_t>(cell.y)) << 1
+					| spreadBits(static_cast<uint32_t>(cell.z)) << 2;
+				keys[i] = octant << (3 * CELL_BITS) | morton;
+				order[i] = static_cast<uint32_t>(i);
+			}
+		});
+
+		// Every pass counts each block's digits, then a block's keys of a digit go after those of the smaller digits
+		// and of the same digit in earlier blocks, which keeps the sort stable.
+		size_t blockTotal = blockCount(count);
+		sortedKeys.resize(count);
+		sortedOrder.resize(count);
+		digitOffsets.resize(blockTotal * 256);
+		for (uint32_t shift = 0; shift < 3 * CELL_BITS + 3; shift += 8)
+		{
+			blocks(count, [&](size_t begin, size_t end) {
+				size_t * offsets = &digitOffsets[begin / blockSize() * 256];
+				std::fill_n(offsets, 256, size_t(0));
+				for (size_t i = begin; i < end; i++) offsets[(keys[i] >> shift) & 255]++;
+			});
+			size_t sum = 0;
+			for (uint32_t digit = 0; digit < 256; digit++)
+			{
+				for (size_t block = 0; block < blockTotal; block++)
+				{
+					size_t bucket = digitOffsets[block * 256 + digit];
+					digitOffsets[block * 256 + digit] = sum;
+					sum += bucket;
+				}
+			}
+			blocks(count, [&](size_t begin, size_t end) {
+				size_t * offsets = &digitOffsets[begin / blockSize() * 256];
+				for (size_t i = begin; i < end; i++)
+				{
+					size_t at = offsets[(keys[i] >> shift) & 255]++;
+					sortedKeys[at] = keys[i];
+					sortedOrder[at] = order[i];
+				}
+			});
+			keys.swap(sortedKeys);
+			order.swap(sortedOrder);
+		}
+
+		spare.resize(count);
+		blocks(count, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) spare.copy(i, queue, order[i]);
+		});
+		std::swap(queue, spare);
+	}
+
+	void intersect()
+	{
+		hits.resize(rays.count);
+		blocks(rays.count, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i += BVH_PACKET)
+			{
+				uint32_t lanes = static_cast<uint32_t>(std::min<size_t>(end - i, BVH_PACKET));
+				BvhPacket packet;
+				rays.packet(i, lanes, FLT_MAX, packet);
+				BvhPacketHit found;
+				traceNearest(scene, packet, found);
+				for (uint32_t lane = 0; lane < lanes; lane++)
+				{
+					hits.hit[i + lane] = found.mask & (1u << lane) ? 1 : 0;
+					hits.distance[i + lane] = found.distance[lane];
+					hits.triangle[i + lane] = found.triangle[lane];
+					hits.instance[i + lane] = found.instance[lane];
+				}
+			}
+		});
+	}
+
+	// shadeHit for the hits in mask among rays [i, i + BVH_PACKET), returning the lit ones. With write their shadow rays
+	// and the next rays of all of them go to the slots of the packed queues, which move past them.
+	uint32_t shadePacket(size_t i, uint32_t mask, uint32_t bounce, bool write, size_t & shadowSlot, size_t & nextSlot)
+	{
+		// corners and normal matrices gathered lane by lane, a lane without a hit repeats the first one that has
+		uint32_t first = 0;
+		while (!(mask & (1u << first))) first++;
+		size_t ray[BVH_PACKET];
+		float corners[3][3][BVH_PACKET], matrix[3][3][BVH_PACKET];
+		bool instanced = scene.instances && scene.normalMatrices;
+		for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+		{
+			ray[lane] = i + (mask & (1u << lane) ? lane : first);
+			const uint32_t * corner = scene.indices + size_t(hits.triangle[ray[lane]]) * 3;
+			for (int c = 0; c < 3; c++)
+			{
+				for (int axis = 0; axis < 3; axis++) corners[c][axis][lane] = scene.positions[corner[c]][axis];
+			}
+			if (!instanced) continue;
+			const glm::mat3 & normalMatrix = scene.normalMatrices[hits.instance[ray[lane]]];
+			for (int column = 0; column < 3; column++)
+			{
+				for (int row = 0; row < 3; row++) matrix[column][row][lane] = normalMatrix[column][row];
+			}
+		}
+		auto gather = [&](const std::vector<float> & array) {
+			return _mm_setr_ps(array[ray[0]], array[ray[1]], array[ray[2]], array[ray[3]]);
+		};
+		auto load = [](const float (&v)[3][BVH_PACKET]) {
+			return LaneVec3{ _mm_loadu_ps(v[0]), _mm_loadu_ps(v[1]), _mm_loadu_ps(v[2]) };
+		};
+
+		// geometric normal of the triangle, turned to face the ray
+		LaneVec3 p0 = load(corners[0]), p1 = load(corners[1]), p2 = load(corners[2]);
+		LaneVec3 normal = cross(p1 - p0, p2 - p0);
+		if (instanced)
+		{
+			__m128 m[3][3];
+			for (int column = 0; column < 3; column++)
+			{
+				for (int row = 0; row < 3; row++) m[column][row] = _mm_loadu_ps(matrix[column][row]);
+			}
+			LaneVec3 n = normal;
+			__m128 * out[3] = { &normal.x, &normal.y, &normal.z };
+			for (int row = 0; row < 3; row++)
+				*out[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][row], n.x), _mm_mul_ps(m[1][row], n.y)), _mm_mul_ps(m[2][row], n.z));
+		}
+		normal = normalize(normal);
+		LaneVec3 origin = { gather(rays.originX), gather(rays.originY), gather(rays.originZ) };
+		LaneVec3 direction = { gather(rays.directionX), gather(rays.directionY), gather(rays.directionZ) };
+		__m128 sign = _mm_set1_ps(-0.0f), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+		__m128 flip = _mm_and_ps(_mm_cmpgt_ps(dot(normal, direction), zero), sign);
+		normal = { _mm_xor_ps(normal.x, flip), _mm_xor_ps(normal.y, flip), _mm_xor_ps(normal.z, flip) };
+
+		LaneVec3 start = origin + direction * gather(hits.distance) + normal * _mm_set1_ps(scene.offset);
+		LaneVec3 toLight = laneVec3(scene.light) - start;
+		__m128 cosine = dot(normal, toLight);
+		uint32_t lit = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmpgt_ps(cosine, zero))) & mask;
+		if (!write) return lit;
+		LaneVec3 weight = { gather(rays.weightR), gather(rays.weightG), gather(rays.weightB) };
+		LaneVec3 light = weight * laneVec3(scene.diffuse) * _mm_div_ps(cosine, _mm_max_ps(_mm_sqrt_ps(dot(toLight, toLight)), _mm_set1_ps(FLT_MIN)));
+
+		// cosine distributed around the normal, the random numbers and their angle's sine and cosine lane by lane
+		__m128 axisX = _mm_cmpgt_ps(_mm_andnot_ps(sign, normal.x), _mm_set1_ps(0.5f));
+		LaneVec3 axis = { _mm_andnot_ps(axisX, one), _mm_and_ps(axisX, one), zero };
+		LaneVec3 tangent = normalize(cross(axis, normal));
+		LaneVec3 bitangent = cross(normal, tangent);
+		float random[BVH_PACKET], cosines[BVH_PACKET], sines[BVH_PACKET];
+		for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+		{
+			uint32_t pixel = rays.pixel[ray[lane]];
+			random[lane] = pathRandom(pixel, bounce, 0, options.seed);
+			float phi = 2.0f * PI * pathRandom(pixel, bounce, 1, options.seed);
+			cosines[lane] = std::cos(phi);
+			sines[lane] = std::sin(phi);
+		}
+		__m128 r = _mm_sqrt_ps(_mm_loadu_ps(random));
+		__m128 up = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(r, r)), zero));
+		LaneVec3 next = tangent * _mm_mul_ps(r, _mm_loadu_ps(cosines)) + bitangent * _mm_mul_ps(r, _mm_loadu_ps(sines)) + normal * up;
+		LaneVec3 throughput = weight * laneVec3(scene.diffuse);
+
+		// back out of the lanes into the packed rays, in queue order
+		float out[5][3][BVH_PACKET];
+		const LaneVec3 * results[5] = { &start, &toLight, &light, &next, &throughput };
+		for (int k = 0; k < 5; k++)
+		{
+			_mm_storeu_ps(out[k][0], results[k]->x);
+			_mm_storeu_ps(out[k][1], results[k]->y);
+			_mm_storeu_ps(out[k][2], results[k]->z);
+		}
+		auto lane3 = [&](int k, uint32_t lane) { return glm::vec3(out[k][0][lane], out[k][1][lane], out[k][2][lane]); };
+		bool bounces = bounce < options.bounces;
+		for (uint32_t lane = 0; lane < BVH_PACKET; lane++)
+		{
+			if (!(mask & (1u << lane))) continue;
+			uint32_t pixel = rays.pixel[i + lane];
+			if (lit & (1u << lane)) shadows.set(shadowSlot++, lane3(0, lane), lane3(1, lane), lane3(2, lane), pixel);
+			if (bounces) spare.set(nextSlot++, lane3(0, lane), lane3(3, lane), lane3(4, lane), pixel);
+		}
+		return lit;
+	}
+
+	// The background for the misses, a shadow ray and the next bounce for the hits. Every pixel has one ray in the
+	// queue, so the blocks never add to the same color.
+	void shade(uint32_t bounce)
+	{
+		size_t count = rays.count, blockTotal = blockCount(count);
+		bool bounces = bounce < options.bounces;
+		shadowOffsets.resize(blockTotal + 1);
+		nextOffsets.resize(blockTotal + 1);
+		glm::vec3 miss = missColor(scene, options, bounce);
+		auto hitLanes = [&](size_t i, size_t end) {
+			uint32_t lanes = static_cast<uint32_t>(std::min<size_t>(end - i, BVH_PACKET)), mask = 0;
+			for (uint32_t lane = 0; lane < lanes; lane++) mask |= hits.hit[i + lane] ? 1u << lane : 0;
+			return mask;
+		};
+
+		// first the misses take the background, and each block counts its lit hits and its hits
+		blocks(count, [&](size_t begin, size_t end) {
+			size_t lit = 0, next = 0, unused = 0;
+			for (size_t i = begin; i < end; i += BVH_PACKET)
+			{
+				uint32_t mask = hitLanes(i, end);
+				for (size_t j = i; j < std::min(i + BVH_PACKET, end); j++)
+				{
+					if (!hits.hit[j]) colors[rays.pixel[j]] += rays.weight(j) * miss;
+				}
+				if (!mask) continue;
+				lit += bitCount(shadePacket(i, mask, bounce, false, unused, unused));
+				next += bitCount(mask);
+			}
+			size_t block = begin / blockSize();
+			shadowOffsets[block] = lit;
+			nextOffsets[block] = bounces ? next : 0;
+		});
+
+		// Then where every block's rays start in the packed queues, which keep the order of the queue they came from, so
+		// without sorting the rays stay in the order of their pixels. The blocks shade their hits again and write there.
+		size_t shadowCount = 0, nextCount = 0;
+		for (size_t block = 0; block <= blockTotal; block++)
+		{
+			size_t shadowBlock = block < blockTotal ? shadowOffsets[block] : 0, nextBlock = block < blockTotal ? nextOffsets[block] : 0;
+			shadowOffsets[block] = shadowCount;
+			nextOffsets[block] = nextCount;
+			shadowCount += shadowBlock;
+			nextCount += nextBlock;
+		}
+		shadows.resize(shadowCount);
+		spare.resize(nextCount);
+		blocks(count, [&](size_t begin, size_t end) {
+			size_t block = begin / blockSize();
+			size_t shadowSlot = shadowOffsets[block], nextSlot = nextOffsets[block];
+			for (size_t i = begin; i < end; i += BVH_PACKET)
+			{
+				uint32_t mask = hitLanes(i, end);
+				if (mask) shadePacket(i, mask, bounce, true, shadowSlot, nextSlot);
+			}
+		});
+		std::swap(rays, spare);
+	}
+
+	void shadow()
+	{
+		blocks(shadows.count, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i += BVH_PACKET)
+			{
+				uint32_t lanes = static_cast<uint32_t>(std::min<size_t>(end - i, BVH_PACKET));
+				BvhPacket packet;
+				shadows.packet(i, lanes, 1.0f, packet);
+				uint32_t blocked = traceAny(scene, packet);
+				for (uint32_t lane = 0; lane < lanes; lane++)
+				{
+					if (!(blocked & (1u << lane))) colors[shadows.pixel[i + lane]] += shadows.weight(i + lane);
+				}
+			}
+		});
+	}
+};
+
+}
+
+static void resolve(const std::vector<glm::vec3> & colors, uint32_t width, uint32_t height, RayImage & image)
+{
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(colors.size());
+	for (size_t i = 0; i < colors.size(); i++) image.pixels[i] = glm::vec4(colors[i], 1.0f);
+}
+
+uint64_t renderWavefront(const WavefrontScene & scene, uint32_t width, uint32_t height, RayImage & image,
+	const WavefrontOptions & options, ThreadPool * pool, WavefrontStats * stats)
+{
+	std::vector<glm::vec3> colors(size_t(width) * height, glm::vec3(0.0f));
+	Wavefront wavefront(scene, options, pool, width, height, colors);
+	WavefrontStats local;
+
+	Timer generateTimer;
+	wavefront.generate();
+	local.generateMilliseconds = generateTimer.elapsedMilliseconds();
+
+	for (uint32_t bounce = 0; bounce <= options.bounces && wavefront.rays.count; bounce++)
+	{
+		local.rays += wavefront.rays.count;
+
+		// the camera rays are already in screen tiles, sorting them would only undo that
+		Timer sortTimer;
+		if (options.sort && bounce) wavefront.sort(wavefront.rays);
+		local.sortMilliseconds += sortTimer.elapsedMilliseconds();
+
+		Timer intersectTimer;
+		wavefront.intersect();
+		local.intersectMilliseconds += intersectTimer.elapsedMilliseconds();
+
+		Timer shadeTimer;
+		wavefront.shade(bounce);
+		local.shadeMilliseconds += shadeTimer.elapsedMilliseconds();
+
+		local.shadowRays += wavefront.shadows.count;
+		Timer shadowSortTimer;
+		if (options.sort) wavefront.sort(wavefront.shadows);
+		local.sortMilliseconds += shadowSortTimer.elapsedMilliseconds();
+
+		Timer shadowTimer;
+		wavefront.shadow();
+		local.shadowMilliseconds += shadowTimer.elapsedMilliseconds();
+	}
+
+	resolve(colors, width, height, image);
+	if (stats) *stats = local;
+	return local.rays + local.shadowRays;
+}
+
+uint64_t renderPerPixel(const WavefrontScene & scene, uint32_t width, uint32_t height, RayImage & image,
+	const WavefrontOptions & options, ThreadPool * pool, WavefrontStats * stats)
+{
+	std::vector<glm::vec3> colors(size_t(width) * height, glm::vec3(0.0f));
+	std::vector<WavefrontStats> rowStats(height);
+	float inverseWidth = 1.0f / width, inverseHeight = 1.0f / height;
+
+	ThreadPool::forEach(pool, height, [&](size_t row) {
+		uint32_t y = static_cast<uint32_t>(row);
+		WavefrontStats & counts = rowStats[row];
+		for (uint32_t x = 0; x < width; x++)
+		{
+			uint32_t pixel = y * width + x;
+			glm::vec3 origin, direction, throughput(1.0f), color(0.0f);
+			cameraRay(scene.camera, x, y, inverseWidth, inverseHeight, origin, direction);
+
+			// camera ray, shadow ray, bounce, shadow ray ... to the end of the path before the next pixel
+			for (uint32_t bounce = 0; ; bounce++)
+			{
+				BvhRay ray;
+				ray.origin = origin;
+				ray.direction = direction;
+				BvhHit hit;
+				counts.rays++;
+				if (!traceNearest(scene, ray, hit))
+				{
+					color += throughput * missColor(scene, options, bounce);
+					break;
+				}
+
+				PathHit path = shadeHit(scene, origin, direction, hit, throughput, pixel, bounce, options.seed);
+				if (path.lit)
+				{
+					counts.shadowRays++;
+					if (!traceAny(scene, shadowRay(path))) color += path.light;
+				}
+				if (bounce == options.bounces) break;
+				origin = path.start;
+				direction = path.direction;
+				throughput = path.throughput;
+			}
+			colors[pixel] = color;
+		}
+	});
+
+	WavefrontStats local;
+	for (const auto & counts : rowStats)
+	{
+		local.rays += counts.rays;
+		local.shadowRays += counts.shadowRays;
+	}
+	resolve(colors, width, height, image);
+	if (stats) *stats = local;
+	return local.rays + local.shadowRays;
+}
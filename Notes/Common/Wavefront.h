@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm\glm.hpp>
+#include "Bvh.h"
+#include "RayTracer.h"
+
+class ThreadPool;
+
+/*Wavefront path tracing of triangle scenes: instead of following one pixel's path to the end before starting the next,
+every stage runs over all the rays of a bounce at once.
+
+	generate   camera rays for every pixel, in 8 x 8 pixel tiles, four at a time with SSE2
+	sort       rays by direction octant, then by the Morton order of the cell their origin is in
+	intersect  nearest hit of every ray through the BVH, four neighbouring rays as one packet
+	shade      direct light and the next bounce for every hit, a shadow ray towards the light for each, four hits at a
+	           time with SSE2
+	shadow     any hit for the shadow rays as packets, the light added where nothing is in the way
+
+Rays live in queues as structure of arrays, and every stage cuts its queue into blocks handed out to the pool. Where a
+stage writes a new queue, shade and the radix passes of sort, each block first counts what it writes, a prefix sum over
+the counts gives every block its place, and the blocks then write in parallel, in the order one thread would have. The
+per-pixel loop (renderPerPixel) is what the Raytracing shader does: camera ray, shadow ray, bounce, and on to the
+next pixel. Its camera rays are as coherent as the wavefront's, but after the first bounce neighbouring pixels send
+their rays anywhere, and every ray walks a different part of the tree and touches different triangles. Sorting the
+bounce and shadow rays puts the ones that leave the same region in the same direction next to each other again, so
+consecutive traversals share most of their nodes while those are still in cache.
+
+Both renderers draw a path's random numbers from a hash of its pixel, bounce and dimension, so they trace the same
+rays and make the same image; only the order differs.*/
+
+// what the rays are traced against, owned by the caller
+struct WavefrontScene
+{
+	const Bvh * mesh = nullptr; // world space triangles, traced when instances is not given
+	const BvhInstances * instances = nullptr; // instances of the mesh
+	const glm::vec3 * positions = nullptr; // the mesh's vertices and indices, for the normals of its triangles
+	const uint32_t * indices = nullptr;
+	const glm::mat3 * normalMatrices = nullptr; // per instance, object to world for normals
+
+	RayCamera camera;
+	glm::vec3 light; // a point light, Lambert shading as in renderSpheres
+	glm::vec3 diffuse = glm::vec3(0.5f, 0.3f, 0.7f);
+	glm::vec3 background = glm::vec3(1.0f, 0.4f, 0.6f);
+	glm::vec3 boundsMin, boundsMax; // of everything, the grid the origins are sorted on
+	float offset = 1e-4f; // secondary rays start this far off the surface
+};
+
+struct WavefrontOptions
+{
+	uint32_t bounces = 2; // diffuse bounces after the camera ray's hit
+	float skyIntensity = 0.5f; // the background as a light for bounce rays that escape
+	bool sort = true; // bin the bounce and shadow rays before tracing them
+	uint32_t blockSize = 1024; // rays per job of a stage
+	uint32_t seed = 0;
+};
+
+// time in milliseconds and rays of every stage, summed over the bounces
+struct WavefrontStats
+{
+	uint64_t rays = 0; // camera and bounce rays
+	uint64_t shadowRays = 0;
+	double generateMilliseconds = 0.0;
+	double sortMilliseconds = 0.0;
+	double intersectMilliseconds = 0.0;
+	double shadeMilliseconds = 0.0;
+	double shadowMilliseconds = 0.0;
+};
+
+// one path per pixel, stage by stage. Returns the rays traced, shadow rays included.
+uint64_t renderWavefront(const WavefrontScene & scene, uint32_t width, uint32_t height, RayImage & image,
+	const WavefrontOptions & options = WavefrontOptions(), ThreadPool * pool = nullptr, WavefrontStats * stats = nullptr);
+
+// The same paths one pixel at a time, rows spread over the pool. Only the ray counts of stats are filled in.
+uint64_t renderPerPixel(const WavefrontScene & scene, uint32_t width, uint32_t height, RayImage & image,
+	const WavefrontOptions & options = WavefrontOptions(), ThreadPool * pool = nullptr, WavefrontStats * stats = nullptr);
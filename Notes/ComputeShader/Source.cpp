@@ -8,19 +8,72 @@
 #include <SOIL.h>
 #include <glm\gtc\random.hpp>
 #include <glm\gtx\compatibility.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include "Bvh.h"
+#include "PathTracer.h"
+#include "RayTracer.h"
+#include "ThreadPool.h"
+#include "GpuTimer.h"
+#include "Timer.h"
+
+using std::vector;
 
 void error_callback(int error, const char* description)
 {
 	fprintf(stderr, "Error: %s\n", description);
 }
 
+// the demo's three spheres, then scenes big enough that a loop over every sphere per pixel stops being interactive
+static const GLuint sceneSizes[] = { 3, 1000, 10000, 100000 };
+static const int sceneCount = sizeof sceneSizes / sizeof sceneSizes[0];
+
+// the benchmark leaves the loop out above this, on a software renderer it would take minutes a dispatch
+static const GLuint loopLimit = 10000;
+static const int benchmarkDispatches = 8;
+
+// the path tracer tests every sphere for every ray on the CPU, past the demo's three it stops being interactive
+static const GLuint progressiveLimit = 3;
+static const float lightStep = 0.05f;
+
+int scene = 0;
+bool sceneChanged = true;
+bool useHierarchy = true;
+bool progressive = false;
+bool progressiveChanged = false;
+float lightMove = 0.0f;
+
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+	// 1 - 4 pick the sphere count
+	if (key >= GLFW_KEY_1 && key < GLFW_KEY_1 + sceneCount && action == GLFW_PRESS) {
+		scene = key - GLFW_KEY_1;
+		sceneChanged = true;
+	}
+
+	// the loop over every sphere to compare against
+	if (key == GLFW_KEY_H && action == GLFW_PRESS) {
+		useHierarchy = !useHierarchy;
+		std::cout << "Hierarchy " << (useHierarchy ? "on" : "off") << std::endl;
+	}
+
+	// P path traces the spheres on the CPU with soft shadows and a bounce, adding samples every frame until the image
+	// converges. The light stops its sweep, the arrow keys move it along instead.
+	if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+		progressive = !progressive;
+		progressiveChanged = true;
+	}
+	if ((key == GLFW_KEY_LEFT || key == GLFW_KEY_RIGHT) && action != GLFW_RELEASE)
+		lightMove += key == GLFW_KEY_LEFT ? -lightStep : lightStep;
 }
 
-void init();
+void init(bool visible);
 
 GLFWwindow* window;
 int width, height;
@@ -95,8 +148,55 @@ GLfloat uvs[6][2]{
 
 };
 
-int main() {
-	init();
+// Spheres at z = -10 across the 10 x 10 units the rays cover, smaller the more there are so the screen stays about as
+// full. The first scene is the original three within 2 units of the middle.
+static void makeSpheres(GLuint count, vector<glm::vec4> & spheres)
+{
+	float spread = count <= 3 ? 2.0f : 5.0f;
+	float radius = std::min(1.0f, 3.0f / std::sqrt(static_cast<float>(count)));
+	spheres.resize(count);
+	for (auto & sphere : spheres)
+		sphere = glm::vec4(glm::linearRand(-spread, spread), glm::linearRand(-spread, spread), -10.0f, radius);
+}
+
+// Builds the hierarchy over the spheres' boxes and uploads both, the spheres in the order of its leaves. Returns the
+// build time in milliseconds.
+static double uploadScene(GLuint count, ThreadPool & pool, GLuint sphereBuffer, GLuint nodeBuffer, vector<glm::vec4> & spheres)
+{
+	makeSpheres(count, spheres);
+
+	Timer timer;
+	vector<glm::vec3> low(count), high(count);
+	for (GLuint i = 0; i < count; i++)
+	{
+		low[i] = glm::vec3(spheres[i]) - spheres[i].w;
+		high[i] = glm::vec3(spheres[i]) + spheres[i].w;
+	}
+	BvhOptions options;
+	options.wide = false;
+	Bvh bvh;
+	bvh.buildFromBounds(low.data(), high.data(), count, options, &pool);
+
+	vector<glm::vec4> ordered(count);
+	for (GLuint i = 0; i < count; i++) ordered[i] = spheres[bvh.primitives()[i]];
+	double milliseconds = timer.elapsedMilliseconds();
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, sphereBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(glm::vec4) * count, ordered.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, nodeBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(BvhNode) * bvh.nodes().size(), bvh.nodes().data(), GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sphereBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, nodeBuffer);
+	return milliseconds;
+}
+
+int main(int argc, char ** argv) {
+	/*
+	ComputeShader [benchmark]
+	benchmark times the dispatch for every scene with and without the hierarchy, prints a table and exits.
+	*/
+	bool benchmark = argc > 1 && strcmp(argv[1], "benchmark") == 0;
+	init(!benchmark);
 
 	/*
 	Any OpenGL program consists of the following steps...
@@ -178,60 +278,170 @@ int main() {
 	glBindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
 
 
-	GLuint sphereBuffer;
-	GLuint sphereTexture;
-	const GLuint sphereCount = 3;
-
-	glm::vec4 spheres[sphereCount];
-	for (int i = 0; i < sphereCount; i++)
-	{
-		spheres[i] = glm::vec4(glm::vec3(glm::linearRand(-2,2), glm::linearRand(-2, 2),-10), 1.0f);
-	}
-
+	// the spheres and the hierarchy over them in shader storage buffers, any number of them
+	GLuint sphereBuffer, nodeBuffer;
 	glGenBuffers(1, &sphereBuffer);
-	glBindBuffer(GL_TEXTURE_BUFFER, sphereBuffer);
-	glBufferData(GL_TEXTURE_BUFFER, sizeof glm::vec4 * sphereCount, spheres, GL_DYNAMIC_READ);
-
-	glGenTextures(1, &sphereTexture);
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_BUFFER, sphereTexture);
-	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, sphereBuffer);
-	glBindImageTexture(1, sphereTexture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+	glGenBuffers(1, &nodeBuffer);
 
 	auto lightPositionLocation = glGetUniformLocation(rayTraceProgram, "lightPosition");
 	auto sphereCountLocation = glGetUniformLocation(rayTraceProgram, "sphereCount");
-
-	glUniform1i(sphereCountLocation, sphereCount);
+	auto useHierarchyLocation = glGetUniformLocation(rayTraceProgram, "useHierarchy");
+
+	ThreadPool pool;
+	GLuint groupsX = (imageWidth + workGroupSize[0] - 1) / workGroupSize[0];
+	GLuint groupsY = (imageHeight + workGroupSize[1] - 1) / workGroupSize[1];
+
+	if (benchmark) {
+		std::cout << std::left << std::setw(10) << "spheres"
+			<< std::right << std::setw(10) << "build ms"
+			<< std::setw(10) << "loop ms"
+			<< std::setw(10) << "bvh ms"
+			<< std::setw(10) << "speedup" << std::endl;
+
+		vector<glm::vec4> spheres;
+		for (auto count : sceneSizes) {
+			double buildTime = uploadScene(count, pool, sphereBuffer, nodeBuffer, spheres);
+			glUniform1i(sphereCountLocation, count);
+
+			double times[2] = { 0.0, 0.0 };
+			for (int hierarchy = 0; hierarchy < 2; hierarchy++) {
+				if (!hierarchy && count > loopLimit) continue;
+				glUniform1i(useHierarchyLocation, hierarchy);
+
+				// the first dispatch compiles the shader variant on some drivers, it is not timed
+				glDispatchCompute(groupsX, groupsY, 1);
+				glFinish();
+				Timer timer;
+				for (int i = 0; i < benchmarkDispatches; i++) {
+					glDispatchCompute(groupsX, groupsY, 1);
+					glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+				}
+				glFinish();
+				times[hierarchy] = timer.elapsedMilliseconds() / benchmarkDispatches;
+			}
+
+			std::cout << std::left << std::setw(10) << count
+				<< std::right << std::fixed << std::setprecision(2)
+				<< std::setw(10) << buildTime;
+			if (times[0] > 0.0) std::cout << std::setw(10) << times[0];
+			else std::cout << std::setw(10) << "-";
+			std::cout << std::setw(10) << times[1];
+			if (times[0] > 0.0) std::cout << std::setw(9) << times[0] / times[1] << "x";
+			std::cout << std::endl;
+		}
+		std::cout << imageWidth << " x " << imageHeight << " rays, milliseconds per dispatch averaged over "
+			<< benchmarkDispatches << " with glFinish around them, on " << glGetString(GL_RENDERER)
+			<< ". The loop tests every sphere for every pixel and is left out above " << loopLimit << " spheres" << std::endl;
+	}
 
 	auto lightStart = glm::vec3(-2.5, 2, -6);
 	auto lightEnd = glm::vec3(20.5, -2, -6);
 
-	
+	// the progressive image, the same spheres and light on the CPU, resolved into the output texture every frame
+	vector<glm::vec4> spheres;
+	ProgressiveRenderer renderer;
+	RayImage progressiveImage;
+	PathTraceOptions progressiveOptions;
+	progressiveOptions.samplesPerPass = 1; // one sample a pixel per frame keeps the window responsive
+	bool progressiveReset = false;
+	Timer progressiveTimer;
+	uint64_t progressiveRays = 0;
+
+	GpuTimer dispatchTimer;
+	int frame = 0;
 	auto lerpAmount = 0.0f;
-	while (!glfwWindowShouldClose(window))
+	while (!benchmark && !glfwWindowShouldClose(window))
 	{
-		/*Compute shaders execute in work groups, and a call to the below function will cause a sinlge global work group to be sent
-		to opengl the work group will then be divided into a number of local work groups.
-		A work group is a 3D block of work items where ech work item is processed by an invocation of a compute shader running your code.
-		//glDispatchCompute(32, 32, 1);
-		*/
-
-		//find out how to update data
-		//glBindBuffer(GL_TEXTURE_BUFFER, sphereBuffer);
-		//auto buffer = glMapBuffer(GL_TEXTURE_BUFFER, GL_WRITE_ONLY);
-		//memcpy(buffer, spheres, sizeof glm::vec4 * sphereCount);
-		//glUnmapBuffer(GL_TEXTURE_BUFFER);
-		//glActiveTexture(GL_TEXTURE1);
-		//glBindTexture(GL_TEXTURE_BUFFER, sphereTexture);
-		//glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, sphereBuffer);
-		//glBindImageTexture(1, sphereTexture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-		lerpAmount += 0.05f;
-		if (lerpAmount >= 1.0f) lerpAmount = 0.0f;
+		if (sceneChanged) {
+			double buildTime = uploadScene(sceneSizes[scene], pool, sphereBuffer, nodeBuffer, spheres);
+			glUseProgram(rayTraceProgram);
+			glUniform1i(sphereCountLocation, sceneSizes[scene]);
+			std::cout << sceneSizes[scene] << " spheres, hierarchy built in " << buildTime << " ms" << std::endl;
+			sceneChanged = false;
+			progressiveReset = true;
+			dispatchTimer.reset();
+		}
+
+		// turned on or off, or a scene picked that is too big for it
+		if (progressiveChanged || (progressive && sceneSizes[scene] > progressiveLimit)) {
+			if (progressive && sceneSizes[scene] > progressiveLimit) {
+				std::cout << "Progressive mode traces every sphere for every ray, it only runs with up to "
+					<< progressiveLimit << " spheres" << std::endl;
+				progressive = false;
+			}
+			else {
+				std::cout << "Progressive " << (progressive ? "on, the arrow keys move the light" : "off") << std::endl;
+			}
+			progressiveChanged = false;
+			progressiveReset = true;
+		}
+
+		// the sweep runs on its own in the shader's mode, in progressive mode the light only moves on a key and every
+		// move starts the image over
+		if (progressive) {
+			if (lightMove != 0.0f) progressiveReset = true;
+			lerpAmount += lightMove;
+		}
+		else {
+			lerpAmount += lightStep;
+		}
+		lightMove = 0.0f;
+		lerpAmount -= std::floor(lerpAmount);
 		auto lightPosition = glm::lerp(lightStart, lightEnd, lerpAmount);
-		glUseProgram(rayTraceProgram);
-		glUniform3fv(lightPositionLocation, 1, &lightPosition[0]);
-		glDispatchCompute(imageWidth / workGroupSize[0], imageHeight / workGroupSize[1], 1);
-		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		if (progressive) {
+			if (progressiveReset) {
+				SphereScene sphereScene = computeShaderScene(0);
+				for (auto & sphere : spheres) sphereScene.spheres.push_back({ glm::vec3(sphere), sphere.w });
+				sphereScene.light = lightPosition;
+				renderer.reset(sphereScene, imageWidth, imageHeight, progressiveOptions);
+				progressiveTimer.reset();
+				progressiveRays = 0;
+				progressiveReset = false;
+			}
+
+			if (!renderer.converged()) {
+				progressiveRays += renderer.pass(&pool);
+				renderer.resolve(progressiveImage);
+				glBindTexture(GL_TEXTURE_2D, outputTexture);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, imageWidth, imageHeight, GL_RGBA, GL_FLOAT, progressiveImage.pixels.data());
+				if (renderer.converged()) {
+					std::cout << "Converged after " << renderer.passCount() << " passes, " << renderer.maxTileSamples()
+						<< " samples per pixel at most, " << progressiveRays << " rays in "
+						<< progressiveTimer.elapsedMilliseconds() << " ms" << std::endl;
+				}
+			}
+		}
+		else {
+			/*Compute shaders execute in work groups, and a call to the below function will cause a sinlge global work group to be sent
+			to opengl the work group will then be divided into a number of local work groups.
+			A work group is a 3D block of work items where ech work item is processed by an invocation of a compute shader running your code.
+			//glDispatchCompute(32, 32, 1);
+			*/
+
+			//find out how to update data
+			//glBindBuffer(GL_TEXTURE_BUFFER, sphereBuffer);
+			//auto buffer = glMapBuffer(GL_TEXTURE_BUFFER, GL_WRITE_ONLY);
+			//memcpy(buffer, spheres, sizeof glm::vec4 * sphereCount);
+			//glUnmapBuffer(GL_TEXTURE_BUFFER);
+			//glActiveTexture(GL_TEXTURE1);
+			//glBindTexture(GL_TEXTURE_BUFFER, sphereTexture);
+			//glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, sphereBuffer);
+			//glBindImageTexture(1, sphereTexture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+			glUseProgram(rayTraceProgram);
+			glUniform3fv(lightPositionLocation, 1, &lightPosition[0]);
+			glUniform1i(useHierarchyLocation, useHierarchy);
+			dispatchTimer.begin();
+			glDispatchCompute(groupsX, groupsY, 1);
+			dispatchTimer.end();
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		}
+
+		if (!progressive && ++frame % 60 == 0) {
+			std::cout << sceneSizes[scene] << " spheres, " << (useHierarchy ? "hierarchy" : "loop")
+				<< ", dispatch " << dispatchTimer.averageMilliseconds() << " ms" << std::endl;
+			dispatchTimer.reset();
+		}
 		glUseProgram(quadProgram);
 		glViewport(0, 0, width, height);
 		glClear(GL_COLOR_BUFFER_BIT);
@@ -243,6 +453,9 @@ int main() {
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
+	dispatchTimer.release();
+	glDeleteBuffers(1, &nodeBuffer);
+	glDeleteBuffers(1, &sphereBuffer);
 	glDeleteShader(computeShader);
 	glDeleteProgram(rayTraceProgram);
 	glDeleteProgram(quadProgram);
@@ -265,7 +478,7 @@ void APIENTRY openglCallbackFunction(GLenum source,
 }
 
 
-void init() {
+void init(bool visible) {
 	if (!glfwInit()) {
 		//failed
 		glfwTerminate();
@@ -277,7 +490,10 @@ void init() {
 
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+	// Mesa only exposes 4.x in a core profile, and the software renderer is how this runs on machines without a GPU
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+	glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 	window = glfwCreateWindow(640, 480, "Hello GLFW", nullptr, nullptr);
 	if (!window)
 	{
@@ -291,6 +507,7 @@ void init() {
 	glfwSwapInterval(1);
 	glfwGetFramebufferSize(window, &width, &height);
 	glfwSetWindowSizeCallback(window, resize_callback);
+	glfwSetKeyCallback(window, key_callback);
 	std::cout << "OpenGL Version: " << GLVersion.major << "." << GLVersion.minor << " loaded" << std::endl;
 
 
@@ -4,14 +4,13 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
-#include <assimp\Importer.hpp>
-#include <assimp\scene.h>
-#include <assimp\postprocess.h>
 #include <glm\glm.hpp>
 #include <glm\gtx\transform.hpp>
 #include <vector>
 #include <string>
-#include <SOIL.h>
+#include "MeshCache.h"
+#include "AssetLoader.h"
+#include "TextureStreamer.h"
 
 using std::vector;
 
@@ -66,7 +65,8 @@ struct MeshInfo
 	GLuint vertexCount;
 	GLuint indexCount;
 	GLuint vertexOffset;
-	GLuint indexOffset;
+	GLuint indexOffset; // in bytes, the meshes can have different index sizes
+	GLenum indexType;
 };
 
 struct MeshBuffer
@@ -76,22 +76,25 @@ struct MeshBuffer
 	vector<MeshInfo> meshInfos;
 };
 
-MeshBuffer addMeshes(vector<aiMesh*> meshes)
+// Packs the first submesh of every cache into one planar position | normal | uv buffer and one index buffer
+MeshBuffer addMeshes(const vector<const MeshCache*> & meshes)
 {
-	GLuint indexCount = 0;
+	GLuint indexBytes = 0;
 	GLuint vertexCount = 0;
 
 	vector<MeshInfo> meshInfos;
 
 	for(const auto mesh : meshes)
 	{
+		const MeshCacheSubmesh & submesh = mesh->submeshes[0];
 		MeshInfo info;
 		info.vertexOffset = vertexCount;
-		info.indexOffset = indexCount;
-		indexCount += mesh->mNumFaces * 3;
-		vertexCount += mesh->mNumVertices;
-		info.indexCount = mesh->mNumFaces * 3;
-		info.vertexCount = mesh->mNumVertices;
+		info.indexOffset = indexBytes;
+		info.indexType = mesh->indexSize() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		indexBytes += (mesh->indexSize() * submesh.indexCount + 3) & ~3u;
+		vertexCount += submesh.vertexCount;
+		info.indexCount = submesh.indexCount;
+		info.vertexCount = submesh.vertexCount;
 
 		meshInfos.push_back(info);
 	}
@@ -112,23 +115,18 @@ MeshBuffer addMeshes(vector<aiMesh*> meshes)
 
 	for (GLuint meshIndex = 0; meshIndex < meshes.size(); meshIndex++)
 	{
+		const MeshCache & cache = *meshes[meshIndex];
+		const MeshCacheSubmesh & submesh = cache.submeshes[0];
+		auto vertexData = reinterpret_cast<const char*>(cache.vertexData());
+
 		GLuint meshPositionOffset = meshInfos[meshIndex].vertexOffset * positionSize;
 		GLuint meshNormalOffset = positionOffset + meshInfos[meshIndex].vertexOffset * normalSize;
 		GLuint meshUvOffset = normalOffset + meshInfos[meshIndex].vertexOffset * uvSize;
 
-		glBufferSubData(GL_ARRAY_BUFFER, meshPositionOffset, positionSize * meshInfos[meshIndex].vertexCount, meshes[meshIndex]->mVertices);
-		glBufferSubData(GL_ARRAY_BUFFER, meshNormalOffset, normalSize * meshInfos[meshIndex].vertexCount, meshes[meshIndex]->mNormals);
-
-		auto uvData = reinterpret_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, meshUvOffset, uvSize * meshInfos[meshIndex].vertexCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-		for (GLuint i = 0; i < meshInfos[meshIndex].vertexCount; i++)
-		{
-			auto offset = uvSize * i;
-			memcpy(uvData + offset, &meshes[meshIndex]->mTextureCoords[0][i], uvSize);
-			glFlushMappedBufferRange(GL_ARRAY_BUFFER, offset, uvSize);
-		}
-
-		glFinish();
-		glUnmapBuffer(GL_ARRAY_BUFFER);
+		// each attribute array is contiguous in the cache, so every block is a single copy
+		glBufferSubData(GL_ARRAY_BUFFER, meshPositionOffset, positionSize * submesh.vertexCount, vertexData + cache.positionOffset() + positionSize * submesh.vertexOffset);
+		glBufferSubData(GL_ARRAY_BUFFER, meshNormalOffset, normalSize * submesh.vertexCount, vertexData + cache.normalOffset() + normalSize * submesh.vertexOffset);
+		glBufferSubData(GL_ARRAY_BUFFER, meshUvOffset, uvSize * submesh.vertexCount, vertexData + cache.uvOffset() + uvSize * submesh.vertexOffset);
 	}
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
@@ -141,35 +139,17 @@ MeshBuffer addMeshes(vector<aiMesh*> meshes)
 	GLuint indexBuffer;
 	glGenBuffers(1, &indexBuffer);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * indexCount, nullptr, GL_STATIC_DRAW);
-	auto indexData = reinterpret_cast<char*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(GLuint) * indexCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-
-	GLuint currentIndex = 0;
-	GLuint face[3];
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, GL_STATIC_DRAW);
 
 	for (GLuint meshIndex = 0; meshIndex < meshes.size(); meshIndex++)
 	{
-		for (GLuint i = 0; i < meshInfos[meshIndex].indexCount/3; i++)
-		{
-			auto offset = sizeof(GLuint) * 3 * currentIndex;
-			auto copySize = sizeof(GLuint) * 3;
-			face[0] = meshes[meshIndex]->mFaces[i].mIndices[0];
-			face[1] = meshes[meshIndex]->mFaces[i].mIndices[1];
-			face[2] = meshes[meshIndex]->mFaces[i].mIndices[2];
-
-			memcpy(indexData + offset, face, copySize);
-			glFlushMappedBufferRange(GL_ELEMENT_ARRAY_BUFFER, offset, copySize);
-			currentIndex++;
-		}
-	}
-	glFinish();
-	glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+		const MeshCache & cache = *meshes[meshIndex];
+		const MeshCacheSubmesh & submesh = cache.submeshes[0];
+		auto indexData = reinterpret_cast<const char*>(cache.indexData()) + cache.indexSize() * submesh.indexOffset;
 
-	auto data = reinterpret_cast<GLuint*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(GLuint) * indexCount, GL_MAP_READ_BIT));
-	/*for (GLuint i = 0; i < indexCount; i++) 
-		std::cout << data[i] << std::endl;*/
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, meshInfos[meshIndex].indexOffset, cache.indexSize() * submesh.indexCount, indexData);
+	}
 
-	glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
 	return {buffer,indexBuffer,meshInfos};
 }
 
@@ -184,53 +164,36 @@ int main() {
 	4. Perform additional per-fragment operations.
 	*/
 
-	Assimp::Importer importer;
-	const aiScene * scene = importer.ReadFile("../../Models/Cube/cube.obj",
-		aiProcess_Triangulate
-	);
-
-	if (!scene) {
-		std::cout << "Loading scene failed" << std::endl;
-		exit(-1);
-	}
-
-
-	//int vertexCount = 0;
-	Assimp::Importer bearImporter;
-	const aiScene * bear = bearImporter.ReadFile("../../Models/Bear/bear-obj.obj", aiProcess_Triangulate);
-	GLuint cubeVertexArray;
-	glGenVertexArrays(1, &cubeVertexArray);
-	glBindVertexArray(cubeVertexArray);
-
+	// the meshes are loaded on the worker threads and waited for, they are needed for the first frame. The six faces
+	// stream in behind them from their BC1 texture caches (decoded and compressed once, on the first run), a few
+	// megabytes per frame, so the window is up straight away with a grey sky that sharpens as the levels arrive.
+	ThreadPool pool;
+	AssetLoader loader(pool);
 
-	aiMesh* mesh = scene->mMeshes[0];
-	aiMesh* bearMesh = bear->mMeshes[0];
-	auto meshBuffer = addMeshes({ mesh,bearMesh });
-
-	int imageWidth, imageHeight, channels;
+	MeshCache cubeCache;
+	MeshCache bearCache;
+	loader.loadMesh("../../Models/Cube/cube.obj", cubeCache);
+	loader.loadMesh("../../Models/Bear/bear-obj.obj", bearCache);
 
 	std::string cubeMapPath = "../../Models/Cube/Outdoors/";
 	std::vector<std::string> cubeMapFiles = { "posx.jpg","negx.jpg" ,"posy.jpg" ,"negy.jpg" ,"posz.jpg" ,"negz.jpg" };
+	for (auto & file : cubeMapFiles) file = cubeMapPath + file;
 
+	TextureStreamer streamer(pool, 4 * 1024 * 1024);
+	auto cubeMap = streamer.streamCubeMap(cubeMapFiles, TEXTURE_FORMAT_BC1);
+	bool cubeMapStreamed = false;
 
-
-	GLuint cubeTexture;
-	glGenTextures(1, &cubeTexture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, cubeTexture);
-	glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_RGB8, 2048, 2048);
-
-	GLuint mapIndex = 0;
-	for (auto fileName : cubeMapFiles)
-	{
-		auto newPath = cubeMapPath + fileName;
-		int mapWidth, mapHeight, channels;
-		GLubyte * imageData = SOIL_load_image(newPath.c_str(), &mapWidth, &mapHeight, &channels, SOIL_LOAD_AUTO);
-		GLenum target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + mapIndex;
-		glTexSubImage2D(target, 0, 0, 0, mapWidth, mapHeight, GL_RGB, GL_UNSIGNED_BYTE, imageData);
-		mapIndex++;
+	if (!loader.finish()) {
+		std::cout << "Loading scene failed" << std::endl;
+		exit(-1);
 	}
+	loader.printTimings();
 
+	GLuint cubeVertexArray;
+	glGenVertexArrays(1, &cubeVertexArray);
+	glBindVertexArray(cubeVertexArray);
 
+	auto meshBuffer = addMeshes({ &cubeCache, &bearCache });
 
 	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
 	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
@@ -269,6 +232,13 @@ int main() {
 	glEnable(GL_DEPTH_TEST);
 	while (!glfwWindowShouldClose(window))
 	{
+		streamer.update();
+		glBindTexture(GL_TEXTURE_CUBE_MAP, streamer.texture(cubeMap));
+		if (!cubeMapStreamed && streamer.finished()) {
+			streamer.printStatistics();
+			cubeMapStreamed = true;
+		}
+
 		glUniform1i(envLocation, GL_FALSE);
 
 		glViewport(0, 0, width, height);
@@ -279,7 +249,7 @@ int main() {
 		glUniformMatrix4fv(modelIndex, 1, GL_FALSE, &model[0][0]);
 
 		auto cubeInfo = meshBuffer.meshInfos[0];
-		glDrawElements(GL_TRIANGLES, cubeInfo.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(cubeInfo.indexOffset));
+		glDrawElements(GL_TRIANGLES, cubeInfo.indexCount, cubeInfo.indexType, reinterpret_cast<void*>(cubeInfo.indexOffset));
 		
 		glUniform1i(envLocation, GL_TRUE);
 		model = glm::translate(glm::vec3{ 0.0f,-0.5f,-5.0f })
@@ -288,8 +258,7 @@ int main() {
 		glUniformMatrix4fv(modelIndex, 1, GL_FALSE, &model[0][0]);
 
 		auto bearInfo = meshBuffer.meshInfos[1];
-		//glDrawElements(GL_TRIANGLES, bearInfo.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(bearInfo.indexOffset * sizeof(GLuint)));
-		glDrawElementsBaseVertex(GL_TRIANGLES, bearInfo.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(bearInfo.indexOffset * sizeof GLuint), bearInfo.vertexOffset);
+		glDrawElementsBaseVertex(GL_TRIANGLES, bearInfo.indexCount, bearInfo.indexType, reinterpret_cast<void*>(bearInfo.indexOffset), bearInfo.vertexOffset);
 
 
 #ifndef NDEBUG 
@@ -299,7 +268,7 @@ int main() {
 		glfwPollEvents();
 	}
 
-	glDeleteTextures(1, &cubeTexture);
+	streamer.release();
 	glDeleteBuffers(1, &meshBuffer.indexBuffer);
 	//glDeleteBuffers(1, &unpackBuffer);
 	glDeleteBuffers(1, &meshBuffer.vertexBuffer);
@@ -4,14 +4,16 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
-#include <assimp\Importer.hpp>
-#include <assimp\scene.h>
-#include <assimp\postprocess.h>
 #include <glm\glm.hpp>
 #include <glm\gtx\transform.hpp>
 #include <glm\gtc\random.hpp>
 #include <vector>
-#include <SOIL.h>
+#include "MeshCache.h"
+#include "AssetLoader.h"
+#include "VertexFormat.h"
+#include "GpuTimer.h"
+#include "StagingUploader.h"
+#include "TextureUpload.h"
 
 using std::vector;
 
@@ -20,10 +22,18 @@ void error_callback(int error, const char* description)
 	fprintf(stderr, "Error: %s\n", description);
 }
 
+VertexEncoding drawEncoding = VERTEX_ENCODING_FLOAT;
+
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+	// cycle through the float, packed and qtangent copies of the dog to compare them
+	if (key == GLFW_KEY_V && action == GLFW_PRESS) {
+		drawEncoding = static_cast<VertexEncoding>((drawEncoding + 1) % VERTEX_ENCODING_COUNT);
+		std::cout << "Drawing the " << vertexEncodingName(drawEncoding) << " vertices" << std::endl;
+	}
 }
 
 void init();
@@ -31,7 +41,8 @@ void init();
 GLFWwindow* window;
 int width, height;
 
-GLuint createShader(const char * filename, GLuint shaderType) {
+// prelude is inserted after the #version line, used for the vertex decode functions
+GLuint createShader(const char * filename, GLuint shaderType, const char * prelude = nullptr) {
 
 	std::ifstream shaderCodeStream(filename);
 	if (!shaderCodeStream.is_open()) {
@@ -40,6 +51,10 @@ GLuint createShader(const char * filename, GLuint shaderType) {
 	}
 
 	auto shaderCode = std::string((std::istreambuf_iterator<char>(shaderCodeStream)), std::istreambuf_iterator<char>());
+	if (prelude) {
+		auto lineEnd = shaderCode.find('\n');
+		shaderCode.insert(lineEnd == std::string::npos ? shaderCode.size() : lineEnd + 1, prelude);
+	}
 	auto shaderCharArray = shaderCode.c_str();
 
 	GLuint shader = glCreateShader(shaderType);
@@ -108,74 +123,77 @@ int main() {
 	4. Perform additional per-fragment operations.
 	*/
 
-	Assimp::Importer importer;
-	const aiScene * scene = importer.ReadFile("../../Models/Dog/dog.obj",
-		aiProcess_Triangulate
-	);
-
-	if (!scene) {
-		std::cout << "Loading scene failed" << std::endl;
-		exit(-1);
-	}
-
-	GLuint dogVertexArray;
-	glGenVertexArrays(1, &dogVertexArray);
-	glBindVertexArray(dogVertexArray);
-
-	aiMesh* mesh = scene->mMeshes[0];
-
-	GLuint faceCount = mesh->mNumFaces;
-	GLuint indexCount = faceCount * 3;
-	GLuint vertexCount = mesh->mNumVertices;
+	// the dog mesh and its texture are decoded on worker threads side by side, the texture upload
+	// is handed back to this thread since it is the one that owns the context
+	ThreadPool pool;
+	AssetLoader loader(pool);
 
-	GLuint positionSize = sizeof(float) * 3;
-	GLuint normalSize = sizeof(float) * 3;
-	GLuint uvSize = sizeof(float) * 2;
+	MeshCache dogCache;
+	loader.loadMesh("../../Models/Dog/dog.obj", dogCache);
 
-	GLuint positionOffset = positionSize * vertexCount;
-	GLuint normalOffset = positionOffset + normalSize * vertexCount;
-	GLuint uvOffset = normalOffset + uvSize * vertexCount;
+	// the color map comes from its BC7 texture cache with the mip chain already built, only the first run decodes
+	// and compresses the png
+	GLuint dogTexture = 0;
+	TextureCache dogColorCache;
+	loader.loadTexture("../../Models/Dog/dogColor.png", TEXTURE_FORMAT_BC7, dogColorCache, [&](const TextureCache & cache) {
+		glActiveTexture(GL_TEXTURE0);
+		dogTexture = createTexture(cache);
+	});
 
-	GLuint dogBuffer; // position, normal, texture
-	glGenBuffers(1, &dogBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, dogBuffer);
-	glBufferData(GL_ARRAY_BUFFER, uvOffset, nullptr, GL_STATIC_DRAW);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, positionOffset, mesh->mVertices);
-	glBufferSubData(GL_ARRAY_BUFFER, positionOffset, normalSize * vertexCount, mesh->mNormals);
+	// tangent space normal map, two channel BC5 with the mips renormalized
+	GLuint dogNormalTexture = 0;
+	TextureCache dogNormalCache;
+	loader.loadTexture("../../Models/Dog/dogNormal.png", TEXTURE_FORMAT_BC5, dogNormalCache, [&](const TextureCache & cache) {
+		glActiveTexture(GL_TEXTURE1);
+		dogNormalTexture = createTexture(cache);
+		glActiveTexture(GL_TEXTURE0);
+	}, true);
 
-	auto uvData = reinterpret_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, normalOffset, uvSize * vertexCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-	for (GLuint i = 0; i < vertexCount; i++)
-	{
-		auto offset = uvSize * i;
-		memcpy(uvData + offset, &mesh->mTextureCoords[0][i], uvSize);
-		glFlushMappedBufferRange(GL_ARRAY_BUFFER, offset, uvSize);
+	if (!loader.finish()) {
+		std::cout << "Loading scene failed" << std::endl;
+		exit(-1);
 	}
+	loader.printTimings();
 
-	glFinish();
-	glUnmapBuffer(GL_ARRAY_BUFFER);
+	const MeshCacheSubmesh & mesh = dogCache.submeshes[0];
+	GLenum indexType = dogCache.indexSize() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(positionOffset));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(normalOffset));
-	glEnableVertexAttribArray(2);
-
-	GLuint indexSize = sizeof(mesh->mFaces[0].mIndices[0]);
 	GLuint indexBuffer;
 	glGenBuffers(1, &indexBuffer);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * indexCount, nullptr, GL_STATIC_DRAW);
-	auto indexData = reinterpret_cast<char*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexSize * indexCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-	for (GLuint i = 0; i < faceCount; i++)
+
+	// the dog is uploaded once per encoding: the planar float layout of the cache, packed (no tangents, so no normal
+	// mapping) and qtangent. V cycles through them. All go through the staging ring into immutable buffers the CPU
+	// never touches again
+	StagingUploader uploader;
+	EncodedVertices dogVertices[VERTEX_ENCODING_COUNT];
+	GLuint dogVertexArrays[VERTEX_ENCODING_COUNT];
+	GLuint dogBuffers[VERTEX_ENCODING_COUNT];
+	glGenVertexArrays(VERTEX_ENCODING_COUNT, dogVertexArrays);
+	glGenBuffers(VERTEX_ENCODING_COUNT, dogBuffers);
+
+	for (int encoding = VERTEX_ENCODING_FLOAT; encoding < VERTEX_ENCODING_COUNT; encoding++)
 	{
-		auto offset = indexSize * 3 * i;
-		auto copySize = indexSize * 3;
-		memcpy(indexData + offset, mesh->mFaces[i].mIndices, copySize);
-		glFlushMappedBufferRange(GL_ELEMENT_ARRAY_BUFFER, offset, copySize);
+		encodeVertices(dogCache, static_cast<VertexEncoding>(encoding), dogVertices[encoding]);
+
+		glBindVertexArray(dogVertexArrays[encoding]);
+		glBindBuffer(GL_ARRAY_BUFFER, dogBuffers[encoding]);
+		glBufferStorage(GL_ARRAY_BUFFER, encodedVertexBytes(dogCache, dogVertices[encoding]), nullptr, 0);
+		uploader.upload(dogBuffers[encoding], 0, encodedVertexData(dogCache, dogVertices[encoding]), encodedVertexBytes(dogCache, dogVertices[encoding]));
+		setupVertexAttributes(dogVertices[encoding]);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
 	}
-	glFinish();
-	glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+	glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, dogCache.indexBytes(), nullptr, 0);
+	uploader.upload(indexBuffer, 0, dogCache.indexData(), dogCache.indexBytes());
+	uploader.flush();
+	uploader.printStatistics();
+	uploader.release();
+
+	std::cout << "Dog vertices:";
+	for (int encoding = VERTEX_ENCODING_FLOAT; encoding < VERTEX_ENCODING_COUNT; encoding++)
+		std::cout << " " << vertexEncodingName(static_cast<VertexEncoding>(encoding)) << " " << vertexEncodingSize(static_cast<VertexEncoding>(encoding))
+			<< " B/vertex " << encodedVertexBytes(dogCache, dogVertices[encoding]) / 1024 << " KB" << (encoding + 1 < VERTEX_ENCODING_COUNT ? "," : "");
+	std::cout << std::endl;
 
 
 	GLuint quadVertexArray;
@@ -191,24 +209,6 @@ int main() {
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
 	glEnableVertexAttribArray(0);
 
-	int imageWidth, imageHeight, channels;
-	GLubyte * imageBytes = SOIL_load_image("../../Models/Dog/dogColor.png", &imageWidth, &imageHeight, &channels, SOIL_LOAD_AUTO);
-
-	GLuint imageSize = sizeof(GLubyte) * imageWidth * imageHeight * channels;
-	GLuint dogTexture;
-	glGenTextures(1, &dogTexture);
-
-	////common way of setting up textures
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, dogTexture);
-	glTexStorage2D(GL_TEXTURE_2D, 1, (channels == 4) ? GL_RGBA8 : GL_RGB8, imageWidth, imageHeight);
-	glGenerateMipmap(GL_TEXTURE_2D);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, imageWidth, imageHeight,
-		(channels == 4) ? GL_RGBA : GL_RGB,
-		GL_UNSIGNED_BYTE, 
-		imageBytes);
-
-	delete[] imageBytes;
 
 	GLuint gbuffer;
 	GLuint textureBuffers[4];
@@ -260,7 +260,7 @@ int main() {
 	glDetachShader(program, fragmentShader);
 	glUseProgram(program);
 
-	GLuint deferredVertexShader = createShader("deferredVertexShader.vert", GL_VERTEX_SHADER);
+	GLuint deferredVertexShader = createShader("deferredVertexShader.vert", GL_VERTEX_SHADER, vertexDecodeSource());
 	GLuint deferredFragShader = createShader("deferredFragShader.frag", GL_FRAGMENT_SHADER);
 
 	GLuint deferredProgram = glCreateProgram();
@@ -316,6 +316,8 @@ int main() {
 
 	glEnable(GL_DEPTH_TEST);
 	//glClearColor(1, 1, 0, 1);
+	GpuTimer drawTimers[VERTEX_ENCODING_COUNT];
+	int frame = 0;
 
 	while (!glfwWindowShouldClose(window))
 	{
@@ -328,8 +330,10 @@ int main() {
 		glUseProgram(deferredProgram);
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, dogTexture);
-		glBindVertexArray(dogVertexArray);
-		glBindBuffer(GL_ARRAY_BUFFER, dogBuffer);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, dogNormalTexture);
+		glBindVertexArray(dogVertexArrays[drawEncoding]);
+		setVertexDecodeUniforms(deferredProgram, dogVertices[drawEncoding]);
 
 		model = glm::translate(glm::vec3{ 0.0f,-8.0f,-250.0f })
 			* glm::rotate((float)sin(glfwGetTime()), glm::vec3(1.0f, 0.0f, 1.0f))  // model
@@ -337,7 +341,17 @@ int main() {
 		glUniformMatrix4fv(modelIndex, 1, GL_FALSE, &model[0][0]);
 		glUniformMatrix4fv(viewLocation, 1, GL_FALSE, &view[0][0]);
 		glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, &projection[0][0]);
-		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
+		drawTimers[drawEncoding].begin();
+		glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, indexType, reinterpret_cast<void*>(dogCache.indexSize() * mesh.indexOffset), mesh.vertexOffset);
+		drawTimers[drawEncoding].end();
+
+		if (++frame % 300 == 0) {
+			std::cout << "Dog g-buffer pass:";
+			for (int encoding = VERTEX_ENCODING_FLOAT; encoding < VERTEX_ENCODING_COUNT; encoding++)
+				std::cout << " " << vertexEncodingName(static_cast<VertexEncoding>(encoding)) << " " << drawTimers[encoding].averageMilliseconds()
+					<< " ms" << (encoding + 1 < VERTEX_ENCODING_COUNT ? "," : "");
+			std::cout << std::endl;
+		}
 		
 		glUseProgram(program);
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -363,13 +377,15 @@ int main() {
 	}
 
 	glDeleteTextures(1, &dogTexture);
+	glDeleteTextures(1, &dogNormalTexture);
 	glDeleteTextures(4, textureBuffers);
 	glDeleteFramebuffers(1, &gbuffer);
-	glDeleteBuffers(1, &dogBuffer);
+	for (auto & timer : drawTimers) timer.release();
+	glDeleteBuffers(VERTEX_ENCODING_COUNT, dogBuffers);
 	glDeleteBuffers(1, &quadBuffer);
 	//glDeleteBuffers(1, &unpackBuffer);
 	glDeleteBuffers(1, &indexBuffer);
-	glDeleteVertexArrays(1, &dogVertexArray);
+	glDeleteVertexArrays(VERTEX_ENCODING_COUNT, dogVertexArrays);
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 	glDeleteProgram(program);
@@ -8,15 +8,33 @@ in VS_OUT
 {
 	vec4 position;
 	vec4 normal;
+	vec4 tangent;
 	vec2 texCoords;
 }fs_in;
 
 uniform sampler2D tex;
+layout(binding = 1) uniform sampler2D normalMap; // BC5, only x and y are stored
+
+// The flip in main keeps mesh v pointing up the image, so green is +bitangent like the OpenGL convention the map uses
+vec3 perturbNormal(vec2 uv)
+{
+	vec3 n = normalize(fs_in.normal.xyz);
+	if (dot(fs_in.tangent.xyz, fs_in.tangent.xyz) == 0.0)
+		return n;
+
+	// interpolation leaves the tangent a little off perpendicular, straighten it before building the basis
+	vec3 t = normalize(fs_in.tangent.xyz - n * dot(n, fs_in.tangent.xyz));
+	vec3 b = (fs_in.tangent.w < 0.0 ? -1.0 : 1.0) * cross(n, t);
+
+	vec2 xy = texture(normalMap, uv).rg * 2.0 - 1.0;
+	vec3 mapped = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+	return normalize(mat3(t, b, n) * mapped);
+}
 
 void main() {
 	vec2 flippedTexCoord = vec2(fs_in.texCoords.x, 1.0-fs_in.texCoords.y);
 
 	color0 = texture(tex,flippedTexCoord);
-	color1 = fs_in.normal;
+	color1 = vec4(perturbNormal(flippedTexCoord), 1.0);
 	color2 = fs_in.position;
 }
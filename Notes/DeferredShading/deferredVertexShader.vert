@@ -1,13 +1,12 @@
 #version 440 core
 
-layout (location = 0) in vec4 vPosition;
-layout (location = 1) in vec4 vNormal;
-layout (location = 2) in vec2 vTexCoord;
+// the vertex inputs and decodePosition / decodeNormal / decodeTangent / decodeTexCoord are prepended by VertexFormat
 
 out VS_OUT
 {
 	vec4 position;
 	vec4 normal;
+	vec4 tangent; // zero when the layout has no tangents
 	vec2 texCoords;
 }vs_out;
 
@@ -16,8 +15,9 @@ uniform mat4 projection;
 uniform mat4 model;
 
 void main(){
-	vs_out.position = view * model * vPosition;
-	vs_out.normal = vNormal;
-	vs_out.texCoords = vTexCoord; 
+	vs_out.position = view * model * decodePosition();
+	vs_out.normal = vec4(decodeNormal(), 1.0);
+	vs_out.tangent = decodeTangent();
+	vs_out.texCoords = decodeTexCoord(); 
     gl_Position = projection * vs_out.position;
 }
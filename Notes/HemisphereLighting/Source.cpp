@@ -4,13 +4,11 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
-#include <assimp\Importer.hpp>
-#include <assimp\scene.h>
-#include <assimp\postprocess.h>
 #include <glm\glm.hpp>
 #include <glm\gtx\transform.hpp>
 #include <vector>
 #include <SOIL.h>
+#include "MeshCache.h"
 
 using std::vector;
 
@@ -74,72 +72,30 @@ int main() {
 	4. Perform additional per-fragment operations.
 	*/
 
-	Assimp::Importer importer;
-	const aiScene * scene = importer.ReadFile("../../Models/Bear/bear-obj.obj",
-		aiProcess_Triangulate
-	);
-
-	if (!scene) {
+	// the baked cache is mapped straight from disk, Assimp only runs the first time (or when the .obj changes)
+	MeshCache bearCache;
+	if (!loadMeshCache("../../Models/Bear/bear-obj.obj", bearCache)) {
 		std::cout << "Loading scene failed" << std::endl;
 		exit(-1);
 	}
 
-	aiMesh* mesh = scene->mMeshes[0];
-	GLuint faceCount = mesh->mNumFaces;
-
+	const MeshCacheSubmesh & mesh = bearCache.submeshes[0];
+	GLenum indexType = bearCache.indexSize() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
 	GLuint bearVertexArray;
 	glGenVertexArrays(1, &bearVertexArray);
 	glBindVertexArray(bearVertexArray);
 
-	GLuint vertexCount = mesh->mNumVertices;
-	GLuint positionSize = sizeof glm::vec3 * vertexCount;
-	GLuint normalSize = sizeof glm::vec3 * vertexCount;
-	GLuint uvSize = sizeof glm::vec2 * vertexCount;
-	GLuint bufferSize = positionSize + normalSize + uvSize;
-
+	// the cache is already in the planar position, normal, uv layout so both blocks go up in a single call
 	GLuint bearBuffer;
 	glGenBuffers(1, &bearBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, bearBuffer);
-	glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STATIC_DRAW);
-
-	auto bufferData = reinterpret_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-
-	memcpy(bufferData, mesh->mVertices, positionSize);
-	glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, positionSize);
-	memcpy(bufferData + positionSize, mesh->mNormals, normalSize);
-	glFlushMappedBufferRange(GL_ARRAY_BUFFER, positionSize, normalSize);
-
-	auto uvOffset = normalSize + positionSize;
-	for (size_t i = 0; i < vertexCount; i++)
-	{
-		auto copySize = sizeof glm::vec2;
-		memcpy(bufferData + uvOffset + copySize * i, &mesh->mTextureCoords[0][i], copySize);
-	}
-	glFlushMappedBufferRange(GL_ARRAY_BUFFER, uvOffset, uvSize);
-
-	glUnmapBuffer(GL_ARRAY_BUFFER);
-	glFinish();
+	glBufferData(GL_ARRAY_BUFFER, bearCache.vertexBytes(), bearCache.vertexData(), GL_STATIC_DRAW);
 
 	GLuint indexBuffer;
-	GLuint indexCount = mesh->mNumFaces * 3;
-	GLuint indexBufferSize = sizeof GLuint * indexCount;
 	glGenBuffers(1, &indexBuffer);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, nullptr, GL_STATIC_DRAW);
-
-	auto indexBufferData = reinterpret_cast<char*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBufferSize, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-
-	for (GLuint i = 0; i < mesh->mNumFaces; i++)
-	{
-		auto indices = mesh->mFaces[i].mIndices;
-		auto copySize = sizeof GLuint * 3;
-		memcpy(indexBufferData + copySize * i, indices, copySize);
-	}
-
-	glFlushMappedBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexBufferSize);
-	glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
-	glFinish();
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, bearCache.indexBytes(), bearCache.indexData(), GL_STATIC_DRAW);
 
 	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
 	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
@@ -179,13 +135,13 @@ int main() {
 	glUniformMatrix4fv(mvpIndex, 1, GL_FALSE, &mvp[0][0]);
 	glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, &normalMatrix[0][0]);
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(bearCache.positionOffset()));
 	glEnableVertexAttribArray(0);
 
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(positionSize));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(bearCache.normalOffset()));
 	glEnableVertexAttribArray(1);
 
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(uvOffset));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(bearCache.uvOffset()));
 	glEnableVertexAttribArray(2);
 
 	int imageWidth, imageHeight, channels;
@@ -206,7 +162,7 @@ int main() {
 	{
 		glViewport(0, 0, width, height);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+		glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, indexType, reinterpret_cast<void*>(bearCache.indexSize() * mesh.indexOffset), mesh.vertexOffset);
 
 #ifndef NDEBUG 
 		glFinish();
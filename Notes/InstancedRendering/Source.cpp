@@ -4,13 +4,16 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
-#include <assimp\Importer.hpp>
-#include <assimp\scene.h>
-#include <assimp\postprocess.h>
 #include <glm\glm.hpp>
 #include <glm\gtx\transform.hpp>
 #include <glm\gtc\random.hpp>
 #include <vector>
+#include <cstring>
+#include "GpuTimer.h"
+#include "LodSelection.h"
+#include "MeshCache.h"
+#include "StagingUploader.h"
+#include "Timer.h"
 
 using std::vector;
 
@@ -19,10 +22,21 @@ void error_callback(int error, const char* description)
 	fprintf(stderr, "Error: %s\n", description);
 }
 
+// 1, 2 and 3 switch between 1k, 10k and 100k bears, L turns the level of detail selection on and off
+static const GLuint instanceCounts[] = { 1000, 10000, 100000 };
+static int instanceCountChoice = 0;
+static bool useLods = true;
+
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GLFW_TRUE);
+	if (key >= GLFW_KEY_1 && key <= GLFW_KEY_3 && action == GLFW_PRESS)
+		instanceCountChoice = key - GLFW_KEY_1;
+	if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+		useLods = !useLods;
+		std::cout << "Level of detail " << (useLods ? "on" : "off") << std::endl;
+	}
 }
 
 void init();
@@ -69,6 +83,28 @@ struct Vertex {
 	glm::vec3 position;
 };
 
+// one entry of the instance storage buffer, the vertex shader looks it up by the id in the per frame id buffer
+struct Instance {
+	glm::mat4 model;
+	glm::vec4 color;
+};
+
+// the field grows with the instance count so the bears stay as dense as the original 1000
+static void createInstances(GLuint count, vector<Instance> & instances, vector<glm::vec3> & centers)
+{
+	float spread = glm::pow(count / 1000.0f, 1.0f / 3.0f);
+	instances.resize(count);
+	centers.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		auto randomPosition = glm::linearRand(glm::vec3(-100.0f, -40.0f, -30.0f), glm::vec3(100.0f, 40.0f, -200.0f)) * spread;
+		auto randomRotation = glm::radians(glm::linearRand(0.0f, 360.0f));
+		instances[i].model = glm::translate(randomPosition) * glm::rotate(randomRotation, glm::vec3(1.0f));
+		instances[i].color = glm::vec4(glm::linearRand(glm::vec3(0.2f, 0.4f, 0.1f), glm::vec3(1.0f)), 1.0f);
+		centers[i] = randomPosition;
+	}
+}
+
 int main() {
 	init();
 
@@ -80,29 +116,23 @@ int main() {
 	4. Perform additional per-fragment operations.
 	*/
 
-	Assimp::Importer importer;
-	const aiScene * scene = importer.ReadFile("../../Models/Bear/bear-obj.obj",
-		aiProcess_Triangulate
-	);
-
-	if (!scene) {
+	// the baked cache is mapped straight from disk, Assimp only runs the first time (or when the .obj changes)
+	MeshCache bearCache;
+	if (!loadMeshCache("../../Models/Bear/bear-obj.obj", bearCache)) {
 		std::cout << "Loading scene failed" << std::endl;
 		exit(-1);
 	}
 
-	aiMesh* mesh = scene->mMeshes[0]; 
-	GLuint faceCount = mesh->mNumFaces;
-	vector<Vertex> vertices;
-	vector<GLuint> indices;
-	for (GLuint i = 0; i < faceCount; i++)
-	{
-		const aiFace & face = mesh->mFaces[i];
-		for (GLuint x = 0; x < 3; x++)
-		{
-			auto position = mesh->mVertices[face.mIndices[x]];
-			vertices.push_back({ { position.x, position.y, position.z } });
-		}
-	}
+	// the cache is welded and vertex cache ordered, so draw it indexed instead of expanding every triangle.
+	// The whole index block goes up, the simplified levels live behind the full mesh
+	const MeshCacheSubmesh & mesh = bearCache.submeshes[0];
+	auto positions = reinterpret_cast<const char*>(bearCache.vertexData()) + bearCache.positionOffset() + sizeof(glm::vec3) * mesh.vertexOffset;
+	GLenum indexType = bearCache.indexSize() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	std::cout << "Bear levels of detail:";
+	for (uint32_t level = 0; level < mesh.lodCount; level++)
+		std::cout << " " << mesh.lods[level].indexCount / 3 << " triangles (error " << mesh.lods[level].error << ")";
+	std::cout << std::endl;
 
 	glClearColor(1, 1, 1, 1);
 
@@ -113,65 +143,34 @@ int main() {
 	GLuint bearBuffer;
 	glGenBuffers(1, &bearBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, bearBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * mesh.vertexCount, positions, GL_STATIC_DRAW);
+
+	GLuint bearIndexBuffer;
+	glGenBuffers(1, &bearIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bearIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, bearCache.indexBytes(), bearCache.indexData(), GL_STATIC_DRAW);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 	glEnableVertexAttribArray(0);
 
-	GLuint instanceCount = 1000;
-	GLuint colorBuffer;
-
-	glGenBuffers(1, &colorBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, colorBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof glm::vec3 * instanceCount, nullptr, GL_STATIC_DRAW);
-
-	auto colorData = reinterpret_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof glm::vec3 * instanceCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-
-	for (size_t i = 0; i < instanceCount; i++)
-	{
-		glm::vec3 randomColor = glm::linearRand(glm::vec3(0.2f,0.4f,0.1f), glm::vec3(1.0f));
-		memcpy(colorData + sizeof glm::vec3 * i, &randomColor[0], sizeof glm::vec3);
-		glFlushMappedBufferRange(GL_ARRAY_BUFFER, sizeof glm::vec3 * i, sizeof glm::vec3);
-	}
-
-	glUnmapBuffer(GL_ARRAY_BUFFER);
-	glFinish();
-
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(0));
+	// the model matrices and colors only change with the instance count, every frame only the ids sorted by level
+	// are generated straight into the staging ring and copied over on the GPU
+	StagingUploader uploader(4 * 1024 * 1024);
+	GLuint maximumInstances = instanceCounts[2];
+
+	GLuint instanceBuffer;
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Instance) * maximumInstances, nullptr, GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+
+	GLuint idBuffer;
+	glGenBuffers(1, &idBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, idBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint) * maximumInstances, nullptr, GL_STREAM_DRAW);
+	glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, 0, reinterpret_cast<void*>(0));
 	glEnableVertexAttribArray(1);
 	glVertexAttribDivisor(1, 1);
 
-	GLuint mvpBuffer;
-	glGenBuffers(1, &mvpBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, mvpBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof glm::mat4 * instanceCount, nullptr, GL_STATIC_DRAW);
-
-	auto mvpData = reinterpret_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof glm::mat4 * instanceCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
-	glm::mat4 viewProjection = glm::perspective(glm::radians(90.0f), static_cast<float>(width)/height, 0.1f, 3000.f) // projection
-		* glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
-	
-	for (size_t i = 0; i < instanceCount; i++)
-	{
-		auto randomPosition = glm::linearRand(glm::vec3(-100.0f, -40.0f, -30.0f), glm::vec3(100.0f, 40.0f, -200.0f));
-		auto randomRotation = glm::radians(glm::linearRand(0.0f, 360.0f));
-		glm::mat4 mvp = viewProjection * glm::translate(randomPosition) * glm::rotate(randomRotation, glm::vec3(1.0f));
-		
-		memcpy(mvpData + sizeof glm::mat4 * i, &mvp[0][0], sizeof(glm::mat4));
-		glFlushMappedBufferRange(GL_ARRAY_BUFFER, sizeof glm::mat4 * i, sizeof glm::mat4);
-	}
-	glUnmapBuffer(GL_ARRAY_BUFFER);
-	glFinish();
-
-	GLuint matLocation = 2;
-	for (size_t i = 0; i < 4; i++)
-	{
-
-		glVertexAttribPointer(matLocation + i, 4, GL_FLOAT, GL_FALSE, sizeof glm::mat4, reinterpret_cast<void*>(sizeof glm::vec4 * i));
-		glEnableVertexAttribArray(matLocation + i);
-		glVertexAttribDivisor(matLocation + i, 1);
-	}
-
-
-
 	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
 	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
 
@@ -195,19 +194,83 @@ int main() {
 	glDetachShader(program, vertexShader);
 	glDetachShader(program, fragmentShader);
 	glUseProgram(program);
+	GLint viewProjectionLocation = glGetUniformLocation(program, "viewProjection");
+
+	// switch levels once their error would cover more than a pixel
+	const float fieldOfView = glm::radians(90.0f);
+	const float pixelThreshold = 1.0f;
+
+	vector<Instance> instances;
+	vector<glm::vec3> centers;
+	LodBuckets buckets;
+	int createdChoice = -1;
+
+	GpuTimer gpuTimer;
+	double selectMilliseconds = 0.0;
+	uint64_t trianglesSubmitted = 0;
+	unsigned frames = 0;
+	Timer clock;
 
 	while (!glfwWindowShouldClose(window))
 	{
+		if (createdChoice != instanceCountChoice) {
+			createdChoice = instanceCountChoice;
+			createInstances(instanceCounts[createdChoice], instances, centers);
+			uploader.upload(instanceBuffer, 0, instances.data(), sizeof(Instance) * instances.size());
+			std::cout << instances.size() << " bears" << std::endl;
+		}
+
+		// the camera flies into the field and back out so every level gets used
+		float depth = 115.0f * glm::pow(instances.size() / 1000.0f, 1.0f / 3.0f);
+		glm::vec3 eye(0.0f, 0.0f, -depth * (0.5f - 0.5f * glm::cos(static_cast<float>(clock.elapsedSeconds()) * 0.2f)));
+		glm::mat4 viewProjection = glm::perspective(fieldOfView, static_cast<float>(width) / height, 0.1f, 3000.f * depth / 115.0f)
+			* glm::lookAt(eye, eye + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		Timer selectTimer;
+		selectLods(mesh, centers.data(), centers.size(), 1.0f, eye, lodProjectionScale(fieldOfView, static_cast<float>(height)), pixelThreshold, buckets, useLods);
+		selectMilliseconds += selectTimer.elapsedMilliseconds();
+		trianglesSubmitted += buckets.triangles;
+
+		uploader.upload(idBuffer, 0, buckets.instances.data(), sizeof(GLuint) * buckets.instances.size());
+		uploader.flush();
+
 		glViewport(0, 0, width, height);
 		glClear(GL_COLOR_BUFFER_BIT);
-		//glDrawArrays(GL_TRIANGLES, 0, vertices.size());
-		glDrawArraysInstanced(GL_TRIANGLES, 0, vertices.size(), instanceCount);
+		glUniformMatrix4fv(viewProjectionLocation, 1, GL_FALSE, &viewProjection[0][0]);
+
+		// one instanced draw per level, the base instance picks its range of the id buffer
+		gpuTimer.begin();
+		for (uint32_t level = 0; level < mesh.lodCount; level++)
+		{
+			if (!buckets.count[level]) continue;
+			const MeshCacheLod & lod = mesh.lods[level];
+			glDrawElementsInstancedBaseInstance(GL_TRIANGLES, lod.indexCount, indexType,
+				reinterpret_cast<void*>(bearCache.indexSize() * lod.indexOffset), buckets.count[level], buckets.first[level]);
+		}
+		gpuTimer.end();
+
+		if (++frames == 300) {
+			std::cout << "Levels:";
+			for (uint32_t level = 0; level < mesh.lodCount; level++) std::cout << " " << buckets.count[level];
+			std::cout << " | " << trianglesSubmitted / frames << " triangles, selection " << selectMilliseconds / frames
+				<< " ms, GPU " << gpuTimer.averageMilliseconds() << " ms per frame" << std::endl;
+			gpuTimer.reset();
+			selectMilliseconds = 0.0;
+			trianglesSubmitted = 0;
+			frames = 0;
+		}
 #ifndef NDEBUG 
 		glFinish();
 #endif
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
+	uploader.printStatistics();
+	uploader.release();
+	gpuTimer.release();
+	glDeleteBuffers(1, &idBuffer);
+	glDeleteBuffers(1, &instanceBuffer);
+	glDeleteBuffers(1, &bearIndexBuffer);
 	glDeleteBuffers(1, &bearBuffer);
 	glDeleteVertexArrays(1, &bearVertexArray);
 	glDeleteShader(vertexShader);
@@ -231,7 +294,7 @@ void init() {
 
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
-	window = glfwCreateWindow(640, 480, "1000 Bears", NULL, NULL);
+	window = glfwCreateWindow(640, 480, "Bears", NULL, NULL);
 	if (!window)
 	{
 		// Window or OpenGL context creation failed
@@ -244,6 +307,7 @@ void init() {
 	glfwSwapInterval(1);
 	glfwGetFramebufferSize(window, &width, &height);
 	glfwSetWindowSizeCallback(window, resize_callback);
+	glfwSetKeyCallback(window, key_callback);
 
 	std::cout << "OpenGL Version: " << GLVersion.major << "." << GLVersion.minor << " loaded" << std::endl;
 }
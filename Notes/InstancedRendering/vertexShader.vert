@@ -1,12 +1,23 @@
 #version 440 core
 
 layout (location = 0) in vec4 vPosition;
-layout (location = 1) in vec3 vColor;
-layout (location = 2) in mat4 vMvp;
+layout (location = 1) in uint vInstance;
+
+struct Instance {
+	mat4 model;
+	vec4 color;
+};
+
+layout (std430, binding = 0) buffer Instances {
+	Instance instances[];
+};
+
+uniform mat4 viewProjection;
 
 out vec4 color; 
 
 void main(){
-	color = vec4(vColor,1.0);
-    gl_Position = vMvp * vPosition;
+	Instance instance = instances[vInstance];
+	color = instance.color;
+    gl_Position = viewProjection * instance.model * vPosition;
 }
@@ -4,12 +4,10 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
-#include <assimp\Importer.hpp>
-#include <assimp\scene.h>
-#include <assimp\postprocess.h>
 #include <glm\glm.hpp>
 #include <glm\gtx\transform.hpp>
 #include <vector>
+#include "MeshCache.h"
 
 using std::vector;
 
@@ -74,30 +72,18 @@ int main() {
 	4. Perform additional per-fragment operations.
 	*/
 
-	Assimp::Importer importer;
-	const aiScene * scene = importer.ReadFile("../../Models/Bear/bear-obj.obj",
-		aiProcess_Triangulate
-	);
-
-	if (!scene) {
+	// the baked cache is mapped straight from disk, Assimp only runs the first time (or when the .obj changes)
+	MeshCache bearCache;
+	if (!loadMeshCache("../../Models/Bear/bear-obj.obj", bearCache)) {
 		std::cout << "Loading scene failed" << std::endl;
 		exit(-1);
 	}
 
-	aiMesh* mesh = scene->mMeshes[0];
-	GLuint faceCount = mesh->mNumFaces;
-	vector<Vertex> vertices;//(mesh->mNumVertices);
-	//int vertexCount = 0;
-	for (GLuint i = 0; i < faceCount; i++)
-	{
-		const aiFace & face = mesh->mFaces[i];
-		for (GLuint x = 0; x < 3; x++)
-		{
-			auto position = mesh->mVertices[face.mIndices[x]];
-			vertices.push_back({ {position.x, position.y, position.z} });
-			//vertexCount++;
-		}
-	}
+	// the cache is welded and vertex cache ordered, so draw it indexed instead of expanding every triangle
+	const MeshCacheSubmesh & mesh = bearCache.submeshes[0];
+	auto positions = reinterpret_cast<const char*>(bearCache.vertexData()) + bearCache.positionOffset() + sizeof(glm::vec3) * mesh.vertexOffset;
+	auto meshIndices = reinterpret_cast<const char*>(bearCache.indexData()) + bearCache.indexSize() * mesh.indexOffset;
+	GLenum indexType = bearCache.indexSize() == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
 	GLuint bearVertexArray;
 	glGenVertexArrays(1, &bearVertexArray);
@@ -106,7 +92,12 @@ int main() {
 	GLuint bearBuffer;
 	glGenBuffers(1, &bearBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, bearBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * mesh.vertexCount, positions, GL_STATIC_DRAW);
+
+	GLuint bearIndexBuffer;
+	glGenBuffers(1, &bearIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bearIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, bearCache.indexSize() * mesh.indexCount, meshIndices, GL_STATIC_DRAW);
 
 	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
 	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
@@ -147,7 +138,7 @@ int main() {
 	{
 		glViewport(0, 0, width, height);
 		glClear(GL_COLOR_BUFFER_BIT);
-		glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+		glDrawElements(GL_TRIANGLES, mesh.indexCount, indexType, nullptr);
 
 #ifndef NDEBUG 
 		glFinish();
@@ -155,6 +146,7 @@ int main() {
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
+	glDeleteBuffers(1, &bearIndexBuffer);
 	glDeleteBuffers(1, &bearBuffer);
 	glDeleteVertexArrays(1, &bearVertexArray);
 	glDeleteShader(vertexShader);
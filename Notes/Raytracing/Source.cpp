@@ -4,6 +4,13 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
+#include "PathTracer.h"
+#include "RayTracer.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+bool progressive = false;
+bool progressiveChanged = false;
 
 void error_callback(int error, const char* description)
 {
@@ -14,6 +21,13 @@ static void key_callback(GLFWwindow* window, int key, int scancode, int action,
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+	// P path traces the sphere on the CPU with a soft shadow and a bounce, adding samples every frame until the image
+	// converges
+	if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+		progressive = !progressive;
+		progressiveChanged = true;
+	}
 }
 
 void init();
@@ -56,6 +70,29 @@ GLuint createShader(const char * filename, GLuint shaderType) {
 	return shader;
 }
 
+GLuint createProgram(GLuint vertexShader, GLuint fragmentShader) {
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+
+	GLint programStatus;
+	glGetProgramiv(program, GL_LINK_STATUS, &programStatus);
+	if (programStatus != GL_TRUE) {
+		GLint logLength;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+		char * log = new char[logLength];
+		glGetProgramInfoLog(program, logLength, nullptr, log);
+		std::cerr << "Program Error: " << log << std::endl;
+		delete[] log;
+		exit(-1);
+	}
+
+	glDetachShader(program, vertexShader);
+	glDetachShader(program, fragmentShader);
+	return program;
+}
+
 GLfloat vertices[6][2]{
 	{ -1.0f, -1.0f },
 	{ 1.0f, -1.0f },
@@ -87,25 +124,11 @@ int main() {
 	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
 	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
 
-	GLuint program = glCreateProgram();
-	glAttachShader(program, vertexShader);
-	glAttachShader(program, fragmentShader);
-	glLinkProgram(program);
-
-	GLint programStatus;
-	glGetProgramiv(program, GL_LINK_STATUS, &programStatus);
-	if (programStatus != GL_TRUE) {
-		GLint logLength;
-		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
-		char * log = new char[logLength];
-		glGetProgramInfoLog(program, logLength, nullptr, log);
-		std::cerr << "Program Error: " << log << std::endl;
-		delete[] log;
-		exit(-1);
-	}
+	GLuint progressiveShader = createShader("progressive.frag", GL_FRAGMENT_SHADER);
 
-	glDetachShader(program, vertexShader);
-	glDetachShader(program, fragmentShader);
+	GLuint program = createProgram(vertexShader, fragmentShader);
+	GLuint progressiveProgram = createProgram(vertexShader, progressiveShader);
+	GLint viewportSizeLocation = glGetUniformLocation(progressiveProgram, "viewportSize");
 	glUseProgram(program);
 
 	//static const char * uniformNames[2] = {
@@ -122,12 +145,60 @@ int main() {
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(0));
 	glEnableVertexAttribArray(0);
 
-
+	// the progressive image, the shader's sphere, camera and light traced on the CPU at the size the shader assumes
+	SphereScene scene = raytracingScene();
+	ThreadPool pool;
+	ProgressiveRenderer renderer;
+	RayImage progressiveImage;
+	PathTraceOptions progressiveOptions;
+	progressiveOptions.samplesPerPass = 1; // one sample a pixel per frame keeps the window responsive
+	Timer progressiveTimer;
+	uint64_t progressiveRays = 0;
+
+	GLuint progressiveTexture;
+	glGenTextures(1, &progressiveTexture);
+	glBindTexture(GL_TEXTURE_2D, progressiveTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, scene.width, scene.height, 0, GL_RGBA, GL_FLOAT, nullptr);
 
 	while (!glfwWindowShouldClose(window))
 	{
+		if (progressiveChanged) {
+			std::cout << "Progressive " << (progressive ? "on" : "off") << std::endl;
+			if (progressive) {
+				renderer.reset(scene, scene.width, scene.height, progressiveOptions);
+				progressiveTimer.reset();
+				progressiveRays = 0;
+			}
+			progressiveChanged = false;
+		}
+
+		if (progressive && !renderer.converged()) {
+			progressiveRays += renderer.pass(&pool);
+			renderer.resolve(progressiveImage);
+			glBindTexture(GL_TEXTURE_2D, progressiveTexture);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, scene.width, scene.height, GL_RGBA, GL_FLOAT, progressiveImage.pixels.data());
+			if (renderer.converged()) {
+				std::cout << "Converged after " << renderer.passCount() << " passes, " << renderer.maxTileSamples()
+					<< " samples per pixel at most, " << progressiveRays << " rays in "
+					<< progressiveTimer.elapsedMilliseconds() << " ms" << std::endl;
+			}
+		}
+
 		glViewport(0, 0, width, height);
 		glClear(GL_COLOR_BUFFER_BIT);
+		if (progressive) {
+			glUseProgram(progressiveProgram);
+			glUniform2f(viewportSizeLocation, static_cast<GLfloat>(width), static_cast<GLfloat>(height));
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, progressiveTexture);
+		}
+		else {
+			glUseProgram(program);
+		}
 		glDrawArrays(GL_TRIANGLES, 0, 6);
 		
 #ifndef NDEBUG 
@@ -136,11 +207,14 @@ int main() {
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
+	glDeleteTextures(1, &progressiveTexture);
 	glDeleteBuffers(1, &quadbuffer);
 	glDeleteVertexArrays(1, &fullScreenQuadVertexArray);
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
+	glDeleteShader(progressiveShader);
 	glDeleteProgram(program);
+	glDeleteProgram(progressiveProgram);
 	glfwDestroyWindow(window);
 	glfwTerminate();
 
@@ -172,6 +246,7 @@ void init() {
 	glfwSwapInterval(1);
 	glfwGetFramebufferSize(window, &width, &height);
 	glfwSetWindowSizeCallback(window, resize_callback);
+	glfwSetKeyCallback(window, key_callback);
 	std::cout << "OpenGL Version: " << GLVersion.major << "." << GLVersion.minor << " loaded" << std::endl;
 }
 
@@ -0,0 +1,11 @@
+#version 440 core
+
+out vec4 fColor;
+
+// the progressive mode's image, traced on the CPU and stretched over the window
+layout (binding = 0) uniform sampler2D image;
+uniform vec2 viewportSize;
+
+void main() {
+	fColor = texture(image, gl_FragCoord.xy / viewportSize);
+}
@@ -4,21 +4,28 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
-#include <glm\gtc\noise.hpp>
 #include <glm\gtx\transform.hpp>
 #include <glm\gtc\matrix_transform.hpp>
-#include <SOIL.h>
-#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "TerrainStreamer.h"
+#include "ThreadPool.h"
 
 void error_callback(int error, const char* description)
 {
 	fprintf(stderr, "Error: %s\n", description);
 }
 
+static float flySpeed = 150.0f;
+static bool wireframe = false;
+
 static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+	if (key == GLFW_KEY_F && action == GLFW_PRESS)
+		wireframe = !wireframe;
 }
 
 void init();
@@ -61,120 +68,20 @@ GLuint createShader(const char * filename, GLuint shaderType) {
 	return shader;
 }
 
-struct Vertex
-{
-	glm::vec3 position;
-	glm::vec3 normal;
-	glm::vec3 uv;
-};
-
-void createGrid(float width, float depth, uint32_t m, uint32_t n, std::vector<Vertex> & vertices, std::vector<GLuint> & indices) {
-	uint32_t vertexCount = m * n;
-	uint32_t faceCount = (m - 1) * (n - 1) * 2;
-
-	vertices.resize(vertexCount);
-	indices.resize(faceCount * 3);
-
-	float halfWidth = 0.5f*width;
-	float halfDepth = 0.5f*depth;
-
-	float dx = width / (n - 1);
-	float dz = depth / (m - 1);
-
-	float du = 1.0f / (n - 1);
-	float dv = 1.0f / (m - 1);
-
-	for (GLuint i = 0; i < m; ++i)
-	{
-		float z = halfDepth - i*dz;
-		for (GLuint j = 0; j < n; ++j)
-		{
-			float x = -halfWidth + j*dx;
-
-			vertices[i*n + j].position = glm::vec3(x, 0.0f, z);
-			vertices[i*n + j].normal = glm::vec3(0.0f, 1.0f, 0.0f);
-
-			// Stretch texture over grid.
-			vertices[i*n + j].uv.x = j*du;
-			vertices[i*n + j].uv.y = i*dv;
-		}
-	}
-
-	GLuint k = 0;
-	for (GLuint i = 0; i < m - 1; ++i)
-	{
-		for (GLuint j = 0; j < n - 1; ++j)
-		{
-			indices[k] = i*n + j;
-			indices[k + 1] = i*n + j + 1;
-			indices[k + 2] = (i + 1)*n + j;
-			
-			indices[k + 3] = (i + 1)*n + j;
-			indices[k + 4] = i*n + j + 1;
-			indices[k + 5] = (i + 1)*n + j + 1;
-
-			k += 6; // next quad
-		}
-	}
-}
-
 int main() {
 	init();
 
-	/*Tesselation is the process of breaking a large primitive into smaller ones before rendering it.
-	The most common use for the this stage is to add more detail to a low detail model.*/
+	/*The ground is generated in chunks around a camera that keeps flying, workers build the chunks ahead of it and
+	the ones left behind make room for them. Arrows steer and change speed, F toggles the wireframe.*/
 
-	GLubyte * heightMap = new GLubyte[width * height];
+	ThreadPool pool;
+	TerrainSettings settings;
+	settings.noise.octaves = 6;
+	settings.noise.frequency = 1.0f / 256.0f;
+	TerrainStreamer terrain(pool, settings);
 
-	GLfloat freqency = 6.0;
-	GLfloat scale = 1.5;
-	GLfloat xFactor = 1.0f / (width - 1);
-	GLfloat yFactor = 1.0f / (height - 1);
-	for (size_t x = 0; x < width; x++)
-	{
-		for (size_t y = 0; y < height; y++)
-		{
-			glm::vec2 p(x * xFactor * freqency, y * yFactor * freqency);
-			float value = glm::perlin(p) / scale;
-			float result = (value + 1.0f) / 2.0f;
-
-			heightMap[(x + width * y)] = static_cast<GLubyte>(result * 255.0f);
-		}
-	}
-
-	SOIL_save_image("heightMap.bmp", SOIL_SAVE_TYPE_BMP, width, height, 1, heightMap);
-
-	GLuint heightTexture;
-	glGenTextures(1, &heightTexture);
-	glBindTexture(GL_TEXTURE_2D, heightTexture);
-	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, heightMap);
-
-	delete[] heightMap;
-
-	GLint maxPatches;
-	glGetIntegerv(GL_MAX_PATCH_VERTICES, &maxPatches);
-
-	std::cout << "Max patches : " << maxPatches << std::endl;
-
-	GLuint gridVertexArray;
-	glGenVertexArrays(1, &gridVertexArray);
-	glBindVertexArray(gridVertexArray);
-
-	std::vector<Vertex> vertices;
-	std::vector<GLuint> indices;
-
-	createGrid(30.0f, 30.0f, 60, 60, vertices, indices);
-
-	GLuint gridBuffer;
-	glGenBuffers(1, &gridBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, gridBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof Vertex * vertices.size(), vertices.data(), GL_STATIC_DRAW);
-
-	GLuint gridIndexBuffer;
-	glGenBuffers(1, &gridIndexBuffer);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridIndexBuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof GLuint * indices.size(), indices.data(), GL_STATIC_DRAW);
+	std::cout << "Terrain chunks: " << terrain.chunkSize() << " units, " << terrain.chunkVertices() << " vertices, "
+		<< terrain.chunkIndices() << " strip indices, " << terrain.slotCount() << " slots (" << terrain.capacityBytes() / (1024 * 1024) << " MB)" << std::endl;
 
 	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
 	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
@@ -200,33 +107,56 @@ int main() {
 	glDetachShader(program, fragmentShader);
 	glUseProgram(program);
 
-
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof Vertex, reinterpret_cast<void*>(0));
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof Vertex, reinterpret_cast<void*>(sizeof glm::vec3));
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof Vertex, reinterpret_cast<void*>(sizeof glm::vec3 * 2));
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	glEnable(GL_DEPTH_TEST);
 
+	// fog ends where the view range does, so chunks fade in instead of popping up at the horizon
+	float viewDistance = settings.viewRadius * terrain.chunkSize();
 	auto mvpLocation = glGetUniformLocation(program, "mvp");
-	glClearColor(1, 1, 0, 1);
+	auto cameraLocation = glGetUniformLocation(program, "camera");
+	glUniform1f(glGetUniformLocation(program, "heightScale"), settings.heightScale);
+	glUniform1i(glGetUniformLocation(program, "chunkCells"), static_cast<GLint>(terrain.settings().chunkCells));
+	glUniform1f(glGetUniformLocation(program, "cellSize"), terrain.settings().cellSize);
+	glUniform1f(glGetUniformLocation(program, "fogEnd"), viewDistance);
+
+	glm::vec3 camera(0.0f, settings.heightScale + 20.0f, 0.0f);
+	float heading = 0.0f;
+	double lastTime = glfwGetTime(), lastReport = lastTime;
+	glClearColor(0.6f, 0.75f, 0.9f, 1);
 	while (!glfwWindowShouldClose(window))
 	{
+		double now = glfwGetTime();
+		float elapsed = static_cast<float>(now - lastTime);
+		lastTime = now;
+
+		if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) heading += elapsed;
+		if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) heading -= elapsed;
+		if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) flySpeed = std::min(flySpeed * (1.0f + elapsed), 2000.0f);
+		if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) flySpeed = std::max(flySpeed * (1.0f - elapsed), 10.0f);
+
+		glm::vec3 forward(std::sin(heading), 0.0f, -std::cos(heading));
+		camera += forward * flySpeed * elapsed;
+
+		terrain.update(camera);
+
 		glViewport(0, 0, width, height);
-		
-		auto mvp = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / static_cast<float>(height), 0.1f, 1000.0f)
-			//* glm::lookAt(glm::vec3(0, 0, 0), glm::vec3(0, 20, -100), glm::vec3(0, 1, 0))
-			* glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f))
-			* glm::translate(glm::vec3(0, -10, -50))
-			//* glm::rotate((float)glfwGetTime(), glm::vec3(1, 0, 0));
-		* glm::rotate(120.0f, glm::vec3(1,0,0));
+		auto mvp = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / static_cast<float>(height), 0.5f, viewDistance * 1.5f)
+			* glm::lookAt(camera, camera + forward + glm::vec3(0.0f, -0.25f, 0.0f), glm::vec3(0, 1, 0));
 
 		glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, &mvp[0][0]);
+		glUniform3fv(cameraLocation, 1, &camera[0]);
+		glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
+		terrain.draw();
+
+		if (now - lastReport > 5.0) {
+			const TerrainStats & stats = terrain.statistics();
+			const TerrainFrameStats & frame = terrain.lastFrame();
+			std::cout << "speed " << flySpeed << ", frame " << frame.frameMilliseconds << " ms (update " << frame.updateMilliseconds
+				<< " ms), " << frame.drawn << " chunks drawn, " << terrain.residentChunks() << " resident ("
+				<< terrain.residentBytes() / 1024 << " KB), hit rate " << stats.hitRate() * 100.0 << "%, latency "
+				<< (stats.generated ? stats.latencyMilliseconds / stats.generated : 0.0) << " ms" << std::endl;
+			lastReport = now;
+		}
 
 #ifndef NDEBUG 
 		glFinish();
@@ -235,9 +165,8 @@ int main() {
 		glfwPollEvents();
 	}
 
-	glDeleteTextures(1, &heightTexture);
-	glDeleteBuffers(1, &gridBuffer);
-	glDeleteVertexArrays(1, &gridVertexArray);
+	terrain.printStatistics();
+	terrain.release();
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 	glDeleteProgram(program);
@@ -272,6 +201,7 @@ void init() {
 	glfwSwapInterval(1);
 	glfwGetFramebufferSize(window, &width, &height);
 	glfwSetWindowSizeCallback(window, resize_callback);
+	glfwSetKeyCallback(window, key_callback);
 	std::cout << "OpenGL Version: " << GLVersion.major << "." << GLVersion.minor << " loaded" << std::endl;
 }
 
@@ -1,16 +1,24 @@
 #version 440 core
 
 out vec4 fColor;
-in vec2 uv;
-layout(binding=0) uniform sampler2D tex;
-void main() {
-	float height = texture(tex,uv).r;
+in vec3 normal;
+in float height;
+in float viewDistance;
+uniform float fogEnd = 640.0;
+uniform vec3 fogColor = vec3(0.6, 0.75, 0.9);
+const vec3 sun = normalize(vec3(0.4, 0.8, 0.3));
 
+void main() {
+	vec3 color;
 	if(height > .6) {
-		fColor = vec4(1);
+		color = vec3(1);
 	} else if (height > .4) {
-		fColor = vec4(0.0,0.7,0.2,1.0);
+		color = vec3(0.0,0.7,0.2);
 	} else {
-		fColor = vec4(0.0,0.2,0.8,1.0);
+		color = vec3(0.0,0.2,0.8);
 	}
+
+	color *= 0.3 + 0.7 * max(dot(normalize(normal), sun), 0.0);
+	float fog = smoothstep(fogEnd * 0.6, fogEnd, viewDistance);
+	fColor = vec4(mix(color, fogColor, fog), 1.0);
 }
@@ -1,23 +1,35 @@
 #version 440 core
 
-layout (location = 0) in vec4 vPosition;
-layout (location = 1) in vec3 vNormal;
-layout (location = 2) in vec2 vUv;
+// 16 bit height and 8 bit normal x and z, x and z of the position come from gl_VertexID (see TerrainStreamer.h)
+layout (location = 0) in float vHeight;
+layout (location = 1) in vec2 vNormal;
 
-layout(binding=0) uniform sampler2D heightMap;
+layout (std430, binding = 0) readonly buffer ChunkOrigins {
+	ivec2 chunkOrigins[];
+};
 
-out vec2 uv;
+out vec3 normal;
+out float height;
+out float viewDistance;
 uniform mat4 mvp;
-uniform float maxHeight =15.0f;
-uniform float minHeight = -5.0f;
+uniform vec3 camera;
+uniform float heightScale = 60.0f;
+uniform int chunkCells = 64;
+uniform float cellSize = 1.0f;
 
 
 void main(){
-	uv = vUv;
-	float height= texture(heightMap, vUv).r;
-	vec4 position = vPosition;
-	float difference = (maxHeight- minHeight) * height;
-	position.y += difference;
+	// the base vertex is part of gl_VertexID, so it gives away the slot as well as the vertex within the chunk
+	int side = chunkCells + 1;
+	int slot = gl_VertexID / (side * side);
+	int vertex = gl_VertexID - slot * side * side;
+	ivec2 cell = chunkOrigins[slot] * chunkCells + ivec2(vertex % side, vertex / side);
+	vec3 position = vec3(float(cell.x) * cellSize, (vHeight * 2.0 - 1.0) * heightScale, float(cell.y) * cellSize);
 
-    gl_Position =  mvp * position;
+	normal = vec3(vNormal.x, sqrt(max(1.0 - dot(vNormal, vNormal), 0.0)), vNormal.y);
+	// 0..1 like the old heightmap texel
+	height = vHeight;
+	viewDistance = length(position.xz - camera.xz);
+
+    gl_Position =  mvp * vec4(position, 1.0);
 }
@@ -0,0 +1,335 @@
+#include <glad\glad.h>
+#include <GLFW\glfw3.h>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <streambuf>
+#include <glm\glm.hpp>
+#include <glm\gtc\matrix_transform.hpp>
+#include <cmath>
+#include <vector>
+#include "Heightfield.h"
+#include "Noise.h"
+#include "TerrainFile.h"
+#include "TerrainLod.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "GpuTimer.h"
+
+using std::vector;
+
+void error_callback(int error, const char* description)
+{
+	fprintf(stderr, "Error: %s\n", description);
+}
+
+bool culling = true;
+bool morphing = true;
+bool wireframe = true;
+bool picking = false;
+
+static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+	// keep every node in range to compare against
+	if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+		culling = !culling;
+		std::cout << "Frustum culling " << (culling ? "on" : "off") << std::endl;
+	}
+
+	// without the morph the levels pop and crack where they meet
+	if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+		morphing = !morphing;
+		std::cout << "Geomorphing " << (morphing ? "on" : "off") << std::endl;
+	}
+
+	if (key == GLFW_KEY_F && action == GLFW_PRESS)
+		wireframe = !wireframe;
+}
+
+static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+		picking = true;
+}
+
+void init();
+
+GLFWwindow* window;
+int width, height;
+
+GLuint createShader(const char * filename, GLuint shaderType) {
+
+	std::ifstream shaderCodeStream(filename);
+	if (!shaderCodeStream.is_open()) {
+		std::cout << "The file " << filename << " does not exist!" << std::endl;
+		exit(-1);
+	}
+
+	auto shaderCode = std::string((std::istreambuf_iterator<char>(shaderCodeStream)), std::istreambuf_iterator<char>());
+	auto shaderCharArray = shaderCode.c_str();
+
+	GLuint shader = glCreateShader(shaderType);
+	glShaderSource(shader, 1, &shaderCharArray, nullptr);
+	glCompileShader(shader);
+	GLint status;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+	if (status != GL_TRUE) {
+		GLint logSize = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logSize);
+		char * log = new char[logSize];
+		glGetShaderInfoLog(shader, logSize, nullptr, log);
+		std::cout << "Shader Error: " << log << std::endl;
+		delete[] log;
+		exit(-1);
+	}
+
+	return shader;
+}
+
+int main() {
+	init();
+
+	/*Continuous distance dependent LOD: a quadtree over the heightmap picks nodes by distance on the CPU, every node is
+	an instance of the same small grid and the vertex shader displaces it from the heightmap, morphing each level into
+	the next coarser one towards the end of its range. C toggles frustum culling, M the morph, F the wireframe. Clicking
+	casts a ray from the cursor against the heights on the CPU and prints what it hit.*/
+
+	ThreadPool pool;
+	const uint32_t heightMapSize = 2049;
+	const float heightScale = 120.0f;
+
+	// generated and baked on the first launch, later ones map the float terrain file and read its full resolution level
+	NoiseOptions noise;
+	noise.octaves = 6;
+	noise.frequency = 1.0f / 512.0f;
+	uint64_t terrainKey = terrainNoiseKey(heightMapSize, heightMapSize, noise, { heightScale });
+
+	Timer loadTimer;
+	vector<float> heights(size_t(heightMapSize) * heightMapSize);
+	TerrainFile terrain;
+	if (openTerrainFile("terrain.rwterrain", terrainKey, terrain)) {
+		terrain.readRegion(0, 0, 0, heightMapSize, heightMapSize, heights.data(), heightMapSize, &pool);
+		terrain.file.close();
+		std::cout << "Read terrain.rwterrain in " << loadTimer.elapsedMilliseconds() << " ms" << std::endl;
+	}
+	else {
+		generateNoise(heights.data(), heightMapSize, heightMapSize, heightMapSize, 0.0f, 0.0f, 1.0f, 1.0f, noise, &pool);
+		for (auto & height : heights) height *= heightScale;
+
+		TerrainFileOptions options;
+		options.format = TERRAIN_FILE_FLOAT;
+		if (!bakeTerrainFile("terrain.rwterrain", heights.data(), heightMapSize, heightMapSize, terrainKey, options, &pool))
+			std::cout << "Could not bake terrain.rwterrain" << std::endl;
+		std::cout << "Generated and baked terrain.rwterrain in " << loadTimer.elapsedMilliseconds() << " ms" << std::endl;
+	}
+
+	TerrainLodSettings settings;
+	TerrainLod lod(heights.data(), heightMapSize, heightMapSize, settings, &pool);
+	Heightfield field(heights.data(), heightMapSize, heightMapSize, settings.sampleSpacing, &pool);
+
+	// world heights straight from the texture, filtered so the morphed vertices between samples interpolate
+	GLuint heightTexture;
+	glGenTextures(1, &heightTexture);
+	glBindTexture(GL_TEXTURE_2D, heightTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, heightMapSize, heightMapSize);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, heightMapSize, heightMapSize, GL_RED, GL_FLOAT, heights.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	GLuint gridVertexArray;
+	glGenVertexArrays(1, &gridVertexArray);
+	glBindVertexArray(gridVertexArray);
+
+	GLuint gridBuffer;
+	glGenBuffers(1, &gridBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, gridBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * lod.gridVertices().size(), lod.gridVertices().data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), reinterpret_cast<void*>(0));
+	glEnableVertexAttribArray(0);
+
+	GLuint gridIndexBuffer;
+	glGenBuffers(1, &gridIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gridIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * lod.gridIndices().size(), lod.gridIndices().data(), GL_STATIC_DRAW);
+
+	// one node per instance, refilled every frame
+	GLuint nodeBuffer;
+	glGenBuffers(1, &nodeBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, nodeBuffer);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TerrainLodNode), reinterpret_cast<void*>(0));
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+
+	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
+	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+
+	GLint programStatus;
+	glGetProgramiv(program, GL_LINK_STATUS, &programStatus);
+	if (programStatus != GL_TRUE) {
+		GLint logLength;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+		char * log = new char[logLength];
+		glGetProgramInfoLog(program, logLength, nullptr, log);
+		std::cerr << "Program Error: " << log << std::endl;
+		delete[] log;
+		exit(-1);
+	}
+
+	glDetachShader(program, vertexShader);
+	glDetachShader(program, fragmentShader);
+	glUseProgram(program);
+
+	auto viewProjectionIndex = glGetUniformLocation(program, "viewProjection");
+	auto eyeIndex = glGetUniformLocation(program, "eye");
+	auto morphingIndex = glGetUniformLocation(program, "morphing");
+	glUniform2fv(glGetUniformLocation(program, "morphRanges"), lod.levelCount(), &lod.morphRanges()[0][0]);
+	glUniform1f(glGetUniformLocation(program, "gridResolution"), static_cast<float>(settings.gridResolution));
+	glUniform1f(glGetUniformLocation(program, "sampleSpacing"), settings.sampleSpacing);
+	glUniform2f(glGetUniformLocation(program, "heightMapSize"), static_cast<float>(heightMapSize), static_cast<float>(heightMapSize));
+	glUniform1f(glGetUniformLocation(program, "heightScale"), heightScale);
+	glUniform1f(glGetUniformLocation(program, "fogEnd"), lod.viewDistance());
+
+	std::cout << "Terrain " << heightMapSize << " x " << heightMapSize << " samples, " << lod.nodeCount() << " nodes in "
+		<< lod.levelCount() << " levels, view distance " << lod.viewDistance() << std::endl;
+
+	TerrainLodSelection selection;
+	GpuTimer drawTimer;
+	double selectMilliseconds = 0.0;
+	uint64_t triangles = 0;
+	int frame = 0;
+
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.6f, 0.75f, 0.9f, 1.0f);
+	while (!glfwWindowShouldClose(window))
+	{
+		// the eye circles the middle of the terrain looking along its path
+		glm::vec2 center = lod.extent() * 0.5f;
+		float radius = std::min(center.x, center.y) * 0.7f;
+		float angle = static_cast<float>(glfwGetTime()) * 0.05f;
+		glm::vec3 eye(center.x + radius * std::cos(angle), heightScale + 30.0f, center.y + radius * std::sin(angle));
+		glm::vec3 forward(-std::sin(angle), -0.3f, std::cos(angle));
+		glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), static_cast<float>(width) / height, 0.5f, lod.viewDistance())
+			* glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+
+		if (picking) {
+			// the cursor on the near and far plane, back through the inverse view projection
+			double cursorX, cursorY;
+			glfwGetCursorPos(window, &cursorX, &cursorY);
+			glm::vec2 ndc(2.0f * static_cast<float>(cursorX) / width - 1.0f, 1.0f - 2.0f * static_cast<float>(cursorY) / height);
+			glm::mat4 inverse = glm::inverse(viewProjection);
+			glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f), farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+
+			HeightfieldRay ray;
+			ray.origin = glm::vec3(nearPoint) / nearPoint.w;
+			ray.direction = glm::vec3(farPoint) / farPoint.w - ray.origin;
+			ray.maxDistance = lod.viewDistance();
+			HeightfieldHit hit;
+			Timer pickTimer;
+			if (field.raycast(ray, hit))
+				std::cout << "Picked (" << hit.position.x << ", " << hit.position.y << ", " << hit.position.z << ") "
+					<< hit.distance << " away in " << pickTimer.elapsedMilliseconds() * 1000.0 << " us" << std::endl;
+			else
+				std::cout << "Picked nothing" << std::endl;
+			picking = false;
+		}
+
+		lod.select(viewProjection, eye, selection, culling);
+		selectMilliseconds += selection.milliseconds;
+		triangles += selection.triangles;
+
+		glBindBuffer(GL_ARRAY_BUFFER, nodeBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(TerrainLodNode) * selection.nodes.size(), selection.nodes.data(), GL_STREAM_DRAW);
+
+		glViewport(0, 0, width, height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
+		glUniformMatrix4fv(viewProjectionIndex, 1, GL_FALSE, &viewProjection[0][0]);
+		glUniform3fv(eyeIndex, 1, &eye[0]);
+		glUniform1i(morphingIndex, morphing);
+
+		// one instanced draw of the grid (or one quadrant of it) per level and part
+		drawTimer.begin();
+		for (uint32_t level = 0; level < lod.levelCount(); level++)
+		{
+			for (uint32_t part = 0; part < TERRAIN_LOD_PARTS; part++)
+			{
+				if (!selection.count[level][part]) continue;
+				glDrawElementsInstancedBaseInstance(GL_TRIANGLES, lod.partIndexCount(part), GL_UNSIGNED_SHORT,
+					reinterpret_cast<void*>(sizeof(uint16_t) * lod.partIndexOffset(part)), selection.count[level][part], selection.first[level][part]);
+			}
+		}
+		drawTimer.end();
+
+		if (++frame % 120 == 0) {
+			std::cout << "nodes " << selection.nodes.size()
+				<< ", visited " << selection.visited
+				<< ", culled " << selection.culled
+				<< ", triangles " << triangles / 120
+				<< ", select " << selectMilliseconds / 120 << " ms"
+				<< ", draw " << drawTimer.averageMilliseconds() << " ms" << std::endl;
+			selectMilliseconds = 0.0;
+			triangles = 0;
+			drawTimer.reset();
+		}
+
+#ifndef NDEBUG
+		glFinish();
+#endif
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	drawTimer.release();
+	glDeleteTextures(1, &heightTexture);
+	glDeleteBuffers(1, &nodeBuffer);
+	glDeleteBuffers(1, &gridIndexBuffer);
+	glDeleteBuffers(1, &gridBuffer);
+	glDeleteVertexArrays(1, &gridVertexArray);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	glDeleteProgram(program);
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	return 0;
+}
+
+void init() {
+	if (!glfwInit()) {
+		//failed
+		glfwTerminate();
+		exit(-1);
+	}
+
+	glfwSetErrorCallback(error_callback);
+
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+	window = glfwCreateWindow(1024, 768, "Terrain LOD", NULL, NULL);
+	if (!window)
+	{
+		// Window or OpenGL context creation failed
+		glfwTerminate();
+		exit(-1);
+	}
+
+	glfwMakeContextCurrent(window);
+	gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+	glfwSwapInterval(1);
+	glfwGetFramebufferSize(window, &width, &height);
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	std::cout << "OpenGL Version: " << GLVersion.major << "." << GLVersion.minor << " loaded" << std::endl;
+}
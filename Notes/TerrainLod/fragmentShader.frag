@@ -0,0 +1,31 @@
+#version 440 core
+
+out vec4 fColor;
+in vec3 normal;
+in float height;
+in float viewDistance;
+flat in int level;
+uniform float heightScale = 120.0;
+uniform float fogEnd = 3072.0;
+uniform vec3 fogColor = vec3(0.6, 0.75, 0.9);
+const vec3 sun = normalize(vec3(0.4, 0.8, 0.3));
+
+// a tint per level so the wireframe shows where the bands are
+const vec3 levelTints[4] = vec3[](vec3(1.0, 0.85, 0.85), vec3(0.85, 1.0, 0.85), vec3(0.85, 0.85, 1.0), vec3(1.0, 1.0, 0.8));
+
+void main() {
+	float relative = height / heightScale * 0.5 + 0.5;
+	vec3 color;
+	if(relative > .6) {
+		color = vec3(1);
+	} else if (relative > .4) {
+		color = vec3(0.0,0.7,0.2);
+	} else {
+		color = vec3(0.0,0.2,0.8);
+	}
+
+	color *= levelTints[level & 3];
+	color *= 0.3 + 0.7 * max(dot(normalize(normal), sun), 0.0);
+	float fog = smoothstep(fogEnd * 0.6, fogEnd, viewDistance);
+	fColor = vec4(mix(color, fogColor, fog), 1.0);
+}
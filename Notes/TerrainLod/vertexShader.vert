@@ -0,0 +1,47 @@
+#version 440 core
+
+layout (location = 0) in vec2 vGrid; // 0 .. gridResolution
+layout (location = 1) in vec4 vNode; // corner x, corner z, size, level
+
+layout(binding=0) uniform sampler2D heightMap;
+
+uniform mat4 viewProjection;
+uniform vec3 eye;
+uniform vec2 morphRanges[12]; // per level: start, 1 / (end - start)
+uniform float gridResolution;
+uniform float sampleSpacing;
+uniform vec2 heightMapSize;
+uniform bool morphing = true;
+
+out vec3 normal;
+out float height;
+out float viewDistance;
+flat out int level;
+
+float sampleHeight(vec2 world) {
+	return textureLod(heightMap, (world / sampleSpacing + 0.5) / heightMapSize, 0.0).r;
+}
+
+void main(){
+	level = int(vNode.w);
+	float cellSize = vNode.z / gridResolution;
+	vec2 world = vNode.xy + vGrid * cellSize;
+
+	// odd grid vertices slide onto their even neighbour towards the end of the level's range, at the end the node has
+	// the shape of its parent
+	if (morphing) {
+		float eyeDistance = length(eye - vec3(world.x, sampleHeight(world), world.y));
+		float morph = clamp((eyeDistance - morphRanges[level].x) * morphRanges[level].y, 0.0, 1.0);
+		vec2 odd = vGrid - 2.0 * floor(vGrid * 0.5);
+		world = vNode.xy + (vGrid - odd * morph) * cellSize;
+	}
+
+	float y = sampleHeight(world);
+	float dx = sampleHeight(world + vec2(cellSize, 0.0)) - sampleHeight(world - vec2(cellSize, 0.0));
+	float dz = sampleHeight(world + vec2(0.0, cellSize)) - sampleHeight(world - vec2(0.0, cellSize));
+	normal = normalize(vec3(-dx, 2.0 * cellSize, -dz));
+	height = y;
+	viewDistance = length(eye - vec3(world.x, y, world.y));
+
+	gl_Position = viewProjection * vec4(world.x, y, world.y, 1.0);
+}
@@ -4,10 +4,15 @@
 #include <string>
 #include <fstream>
 #include <streambuf>
-#include <glm\gtc\noise.hpp>
-#include <SOIL.h>
 #include <glm\gtc\matrix_transform.hpp>
 #include <glm\gtx\transform.hpp>
+#include <algorithm>
+#include <vector>
+#include "Erosion.h"
+#include "Noise.h"
+#include "TerrainFile.h"
+#include "ThreadPool.h"
+#include "Timer.h"
 
 void error_callback(int error, const char* description)
 {
@@ -63,33 +68,66 @@ GLuint createShader(const char * filename, GLuint shaderType) {
 int main() {
 	init();
 	
-	GLubyte * heightMap = new GLubyte[width * height];
-
+	/*The heightmap is baked once into a tiled 16 bit terrain file (TerrainFile.h) and only mapped on later launches.
+	The heights are stored as the 0..1 the shaders expect, so the texture levels are the file's tiles copied as they are.
+	Before baking, the noise is eroded (Erosion.h) at the size the shaders draw it: 64 units across and 10 high.*/
+	ThreadPool pool;
+	const uint32_t heightMapSize = 1024;
 	GLfloat freqency = 6.0;
 	GLfloat scale = 0.8;
-	GLfloat xFactor = 1.0f / (width - 1);
-	GLfloat yFactor = 1.0f / (height - 1);
-	for (size_t x = 0; x < width; x++)
-	{
-		for (size_t y = 0; y < height; y++)
-		{
-			glm::vec2 p(x * xFactor * freqency, y * yFactor * freqency);
-			float value = glm::perlin(p) / scale;
-			float result = (value + 1.0f) / 2.0f;
-
-			heightMap[(x + width * y)] = static_cast<GLubyte>(result * 255.0f);
+	float step = freqency / (heightMapSize - 1);
+	NoiseOptions noise;
+	const float worldSize = 64.0f, worldHeight = 10.0f;
+	const uint32_t erosionIterations = 400;
+	ErosionOptions erosion;
+	uint64_t terrainKey = erosionKey(terrainNoiseKey(heightMapSize, heightMapSize, noise, { step, scale, worldSize, worldHeight }),
+		erosionIterations, erosion);
+
+	TerrainFile terrain;
+	if (!openTerrainFile("heightMap.rwterrain", terrainKey, terrain)) {
+		// the same perlin field glm::perlin gives, generated row by row in SIMD tiles spread over the pool
+		std::vector<float> heights(size_t(heightMapSize) * heightMapSize);
+		generateNoise(heights.data(), heightMapSize, heightMapSize, heightMapSize, 0.0f, 0.0f, step, step, noise, &pool);
+		for (auto & value : heights) value = (value / scale + 1.0f) * 0.5f * worldHeight;
+
+		Timer erosionTimer;
+		erodeHeights(heights.data(), heightMapSize, heightMapSize, worldSize / (heightMapSize - 1), erosionIterations, erosion, &pool);
+		std::cout << "Eroded the heightmap in " << erosionTimer.elapsedMilliseconds() << " ms" << std::endl;
+		for (auto & value : heights) value = std::min(std::max(value / worldHeight, 0.0f), 1.0f);
+
+		TerrainFileOptions options;
+		options.minHeight = 0.0f;
+		options.maxHeight = 1.0f;
+		if (!bakeTerrainFile("heightMap.rwterrain", heights.data(), heightMapSize, heightMapSize, terrainKey, options, &pool)
+			|| !openTerrainFile("heightMap.rwterrain", terrainKey, terrain)) {
+			std::cout << "Could not bake heightMap.rwterrain" << std::endl;
+			exit(-1);
 		}
 	}
 
-	SOIL_save_image("heightMap.bmp", SOIL_SAVE_TYPE_BMP, width, height, 1, heightMap);
-
+	uint32_t tileSize = terrain.tileSize();
 	GLuint heightTexture;
 	glGenTextures(1, &heightTexture);
 	glBindTexture(GL_TEXTURE_2D, heightTexture);
-	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, heightMap);
-
-	delete[] heightMap;
+	glTexStorage2D(GL_TEXTURE_2D, terrain.levelCount(), GL_R16, heightMapSize, heightMapSize);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, tileSize);
+	for (uint32_t level = 0; level < terrain.levelCount(); level++)
+	{
+		const TerrainFileLevel & info = terrain.level(level);
+		for (uint32_t tileZ = 0; tileZ < info.tilesZ; tileZ++)
+		{
+			for (uint32_t tileX = 0; tileX < info.tilesX; tileX++)
+			{
+				// edge tiles are padded, only the part inside the level goes up
+				GLsizei w = std::min(tileSize, info.width - tileX * tileSize);
+				GLsizei h = std::min(tileSize, info.depth - tileZ * tileSize);
+				glTexSubImage2D(GL_TEXTURE_2D, level, tileX * tileSize, tileZ * tileSize, w, h, GL_RED, GL_UNSIGNED_SHORT,
+					terrain.tileData(level, tileX, tileZ));
+			}
+		}
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	terrain.file.close();
 
 
 	/*Tesselation is the process of breaking a large primitive into smaller ones before rendering it.
@@ -11,6 +11,9 @@
 #include <glm\gtx\transform.hpp>
 #include <vector>
 #include <SOIL.h>
+#include "MipGenerator.h"
+#include "StagingUploader.h"
+#include "ThreadPool.h"
 
 using std::vector;
 
@@ -106,24 +109,23 @@ int main() {
 	GLuint normalOffset = positionOffset + normalSize * vertexCount;
 	GLuint uvOffset = normalOffset + uvSize * vertexCount;
 
+	// everything goes through the staging ring, the uvs and indices are gathered straight into it
+	// and the GPU copies them over, no per element flushes and no glFinish
+	StagingUploader uploader;
+
 	GLuint dogBuffer; // position, normal, texture
 	glGenBuffers(1, &dogBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, dogBuffer);
 	glBufferData(GL_ARRAY_BUFFER, uvOffset, nullptr, GL_STATIC_DRAW);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, positionOffset, mesh->mVertices);
-	glBufferSubData(GL_ARRAY_BUFFER, positionOffset, normalSize * vertexCount, mesh->mNormals);
+	uploader.upload(dogBuffer, 0, mesh->mVertices, positionOffset);
+	uploader.upload(dogBuffer, positionOffset, mesh->mNormals, normalSize * vertexCount);
 
-	auto uvData = reinterpret_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, normalOffset, uvSize * vertexCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	auto uvData = reinterpret_cast<char*>(uploader.allocate(dogBuffer, normalOffset, uvSize * vertexCount));
 	for (GLuint i = 0; i < vertexCount; i++)
 	{
-		auto offset = uvSize * i;
-		memcpy(uvData + offset, &mesh->mTextureCoords[0][i], uvSize);
-		glFlushMappedBufferRange(GL_ARRAY_BUFFER, offset, uvSize);
+		memcpy(uvData + uvSize * i, &mesh->mTextureCoords[0][i], uvSize);
 	}
 
-	glFinish();
-	glUnmapBuffer(GL_ARRAY_BUFFER);
-
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void*>(positionOffset));
@@ -136,25 +138,29 @@ int main() {
 	glGenBuffers(1, &indexBuffer);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * indexCount, nullptr, GL_STATIC_DRAW);
-	auto indexData = reinterpret_cast<char*>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indexSize * indexCount, GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	auto indexData = reinterpret_cast<char*>(uploader.allocate(indexBuffer, 0, indexSize * indexCount));
 	for (GLuint i = 0; i < faceCount; i++)
 	{
-		auto offset = indexSize * 3 * i;
-		auto copySize = indexSize * 3;
-		memcpy(indexData + offset, mesh->mFaces[i].mIndices, copySize);
-		glFlushMappedBufferRange(GL_ELEMENT_ARRAY_BUFFER, offset, copySize);
+		memcpy(indexData + indexSize * 3 * i, mesh->mFaces[i].mIndices, indexSize * 3);
 	}
-	glFinish();
-	glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+
+	uploader.flush();
+	uploader.printStatistics();
+	uploader.release();
 
 	// Creating textures
 	/*The nice thing about texture objects in opengl is that they are not limited to only images, they can be
 	just a generic way of storing data for use in shaders. Generally for use with GPGPU*/
 	// Checkout proxy texture targets to know if you have the space to create a texture.
 	int imageWidth, imageHeight, channels;
-	GLubyte * imageBytes = SOIL_load_image("../../Models/Dog/dogColor.png", &imageWidth, &imageHeight, &channels, SOIL_LOAD_AUTO);
+	GLubyte * imageBytes = SOIL_load_image("../../Models/Dog/dogColor.png", &imageWidth, &imageHeight, &channels, SOIL_LOAD_RGBA);
+
+	// the whole mip chain is built on the CPU, filtered in linear space since the color map is sRGB encoded.
+	// glGenerateMipmap only works on levels that exist and have data, and box filters the encoded values.
+	ThreadPool pool;
+	vector<MipLevel> mipLevels;
+	buildMipChain(mipLevels, imageBytes, imageWidth, imageHeight, MipChainOptions(), &pool);
 
-	GLuint imageSize = sizeof(GLubyte) * imageWidth * imageHeight * channels;
 	GLuint dogTexture;
 	glGenTextures(1, &dogTexture);
 
@@ -162,16 +168,19 @@ int main() {
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, dogTexture);
 	/*glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);*/
-	glTexStorage2D(GL_TEXTURE_2D, 1, (channels == 4) ? GL_RGBA8 : GL_RGB8, imageWidth, imageHeight);
-	glGenerateMipmap(GL_TEXTURE_2D);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, imageWidth, imageHeight,
-		(channels == 4) ? GL_RGBA : GL_RGB, // format GL_RED - GL_RGBA as well as integer equivalents which allow you to take in data exactly as presented in the texture.
-											// this could be useful with ray tracing to transfer data around while maintaining values.
-		GL_UNSIGNED_BYTE, // the type of the texture data? FLOAT, INT, BYTE, DOUBLE etc
-		imageBytes);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);*/
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	// immutable storage for every level of the chain, not just the first
+	glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(mipLevels.size()), GL_RGBA8, imageWidth, imageHeight);
+	for (size_t level = 0; level < mipLevels.size(); level++)
+	{
+		glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0, mipLevels[level].width, mipLevels[level].height,
+			GL_RGBA, // format GL_RED - GL_RGBA as well as integer equivalents which allow you to take in data exactly as presented in the texture.
+					 // this could be useful with ray tracing to transfer data around while maintaining values.
+			GL_UNSIGNED_BYTE, // the type of the texture data? FLOAT, INT, BYTE, DOUBLE etc
+			mipLevels[level].pixels.data());
+	}
 
 	//glGetTexImage() //to get texture pixels
 
@@ -187,7 +196,8 @@ int main() {
 	//glTexStorage2D(GL_TEXTURE_2D, 1, (channels == 4) ? GL_RGBA8 : GL_RGB8, imageWidth, imageHeight);
 	//glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, imageWidth, imageHeight, (channels == 4) ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 
-	delete[] imageBytes;
+	SOIL_free_image_data(imageBytes);
+	mipLevels.clear();
 
 	GLuint vertexShader = createShader("vertexShader.vert", GL_VERTEX_SHADER);
 	GLuint fragmentShader = createShader("fragmentShader.frag", GL_FRAGMENT_SHADER);